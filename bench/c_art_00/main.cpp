@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "rcn_c/art.h"
+#include "rcn_c/djb2_hash.h"
+#include "rcn_c/dlhash.h"
+#include "rcn_c/rbtree.h"
+
+/* Either a 64 bit id, or a short string with a shared head. */
+static bool use_string;
+
+struct TestData {
+    uint64_t id_;
+    uint8_t key_[8];
+    char str_[24];
+    rcn_c::artleaf leaf_;
+    rcn_c::rbnode rbnode_;
+    rcn_c::dlnode dlnode_;
+};
+
+static const void *KeyOf(const void *e, size_t *len)
+{
+    auto d = (const TestData *)e;
+
+    if (use_string) {
+        *len = strlen(d->str_) + 1;
+        return d->str_;
+    }
+
+    *len = sizeof(d->key_);
+
+    return d->key_;
+}
+
+static int ValueCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_tree = (const TestData *)_in_tree;
+
+    if (use_string) {
+        return strcmp(ke->str_, in_tree->str_);
+    }
+
+    return (ke->id_ > in_tree->id_) - (ke->id_ < in_tree->id_);
+}
+
+static size_t KeyHash(const void *_ke)
+{
+    auto ke = (const TestData *)_ke;
+    uint64_t h = ke->id_;
+
+    if (use_string) {
+        return rcn_c::djb2_hash(ke->str_);
+    }
+
+    h = (h ^ (h >> 33)) * 0xff51afd7ed558ccdULL;
+
+    return h ^ (h >> 33);
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point t0, size_t n)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+static void Run(std::vector<TestData> &data, const std::vector<size_t> &order)
+{
+    const size_t n = data.size();
+    std::vector<rcn_c::dlist> bucket(n);
+    rcn_c::dlhash table;
+    rcn_c::rbtree tree;
+    rcn_c::art art;
+    size_t nr_found = 0;
+
+    rcn_c::art_init(&art, KeyOf);
+    rcn_c::rbtree_init(&tree, ValueCompare);
+    rcn_c::dlhash_init(&table, n, KeyHash, ValueCompare, bucket.data());
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (auto &d : data) {
+        rcn_c::art_insert(&art, &d.leaf_, &d);
+    }
+
+    double art_insert = Elapsed(t0, n);
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto &d : data) {
+        rcn_c::rbtree_insert(&tree, &d.rbnode_, &d);
+    }
+
+    double rbtree_insert = Elapsed(t0, n);
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto &d : data) {
+        rcn_c::dlhash_insert(&table, &d.dlnode_, &d);
+    }
+
+    double dlhash_insert = Elapsed(t0, n);
+
+    /* Looked up with a copy of the key, as a request would. */
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i : order) {
+        TestData key = data[i];
+        size_t len;
+        const void *k = KeyOf(&key, &len);
+
+        nr_found += rcn_c::art_find(&art, k, len) != NULL;
+    }
+
+    double art_find = Elapsed(t0, n);
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i : order) {
+        TestData key = data[i];
+
+        nr_found += !rcn_c::rbnode_is_nil(rcn_c::rbtree_find(&tree, &key));
+    }
+
+    double rbtree_find = Elapsed(t0, n);
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i : order) {
+        TestData key = data[i];
+
+        nr_found += rcn_c::dlhash_find(&table, &key) != NULL;
+    }
+
+    double dlhash_find = Elapsed(t0, n);
+
+    printf("  art    : insert %7.1f ns, find %7.1f ns\n", art_insert,
+           art_find);
+    printf("  rbtree : insert %7.1f ns, find %7.1f ns\n", rbtree_insert,
+           rbtree_find);
+    printf("  dlhash : insert %7.1f ns, find %7.1f ns (unordered)\n",
+           dlhash_insert, dlhash_find);
+
+    if (nr_found != 3 * n) {
+        printf("  MISSING %zu\n", 3 * n - nr_found);
+    }
+
+    rcn_c::art_clear(&art);
+}
+
+/* Usage : main [nr_entries], 1M by default. Times are per entry. */
+int main(int argc, char **argv)
+{
+    const size_t nr_entries = argc > 1 ? atol(argv[1]) : 1000000;
+    std::vector<TestData> data(nr_entries);
+    std::vector<size_t> order(nr_entries);
+    std::mt19937_64 gen(45);
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        /* Unique : a random high half over the index. */
+        data[i].id_ = (gen() << 32) | i;
+        rcn_c::art_key_u64(data[i].key_, data[i].id_);
+        /* An odd multiplier is a bijection modulo 2^48 : no duplicates. */
+        snprintf(data[i].str_, sizeof(data[i].str_), "session:%012llx",
+                 (i * 0x9e3779b97f4a7c15ULL) & ((1ULL << 48) - 1));
+        order[i] = i;
+    }
+
+    std::shuffle(order.begin(), order.end(), gen);
+
+    for (bool s : { false, true }) {
+        use_string = s;
+        printf("%zu %s keys\n", nr_entries, s ? "string" : "64 bit");
+        Run(data, order);
+    }
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "rcn_c/avltree.h"
+#include "rcn_c/bplustree.h"
+#include "rcn_c/rbtree.h"
+
+struct TestData {
+    rcn_c::rbnode rbnode_;
+    rcn_c::avlnode avlnode_;
+    long value_;
+};
+
+static int ValueCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_tree = (const TestData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point t0, size_t n)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+static void Run(size_t nr_entries)
+{
+    const size_t nr_queries = 1000000;
+    std::vector<TestData> data(nr_entries);
+    std::vector<TestData *> order(nr_entries);
+    std::vector<TestData> key(nr_queries);
+    std::mt19937_64 gen(0);
+    rcn_c::rbtree rbtree;
+    rcn_c::avltree avltree;
+    rcn_c::bplustree bplustree;
+    size_t sink = 0;
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        data[i].value_ = i;
+        order[i] = &data[i];
+    }
+
+    std::shuffle(order.begin(), order.end(), gen);
+
+    for (auto &k : key) {
+        k.value_ = gen() % nr_entries;
+    }
+
+    rcn_c::rbtree_init(&rbtree, ValueCompare);
+    rcn_c::avltree_init(&avltree, ValueCompare);
+    rcn_c::bplustree_init(&bplustree, ValueCompare);
+
+    printf("%zu entries, %u-byte B+ tree nodes\n", nr_entries,
+           (unsigned int)BPLUSTREE_NODE_SIZE);
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (auto d : order) {
+        rcn_c::rbtree_insert(&rbtree, &d->rbnode_, d);
+    }
+
+    printf("  rbtree    insert : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto d : order) {
+        rcn_c::avltree_insert(&avltree, &d->avlnode_, d);
+    }
+
+    printf("  avltree   insert : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto d : order) {
+        rcn_c::bplustree_insert(&bplustree, d);
+    }
+
+    printf("  bplustree insert : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto &k : key) {
+        sink += ((TestData *)rcn_c::rbtree_find(&rbtree, &k)->entry_)->value_;
+    }
+
+    printf("  rbtree    find   : %8.1f ns/op\n", Elapsed(t0, nr_queries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto &k : key) {
+        sink +=
+            ((TestData *)rcn_c::avltree_find(&avltree, &k)->entry_)->value_;
+    }
+
+    printf("  avltree   find   : %8.1f ns/op\n", Elapsed(t0, nr_queries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto &k : key) {
+        sink += ((TestData *)*rcn_c::bplustree_find(&bplustree, &k))->value_;
+    }
+
+    printf("  bplustree find   : %8.1f ns/op\n", Elapsed(t0, nr_queries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (rcn_c::rbnode *x = rcn_c::rbtree_begin(&rbtree);
+         x != rcn_c::rbtree_end(&rbtree); x = rcn_c::rbtree_next(&rbtree, x)) {
+        sink += ((TestData *)x->entry_)->value_;
+    }
+
+    printf("  rbtree    scan   : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (rcn_c::avlnode *x = rcn_c::avltree_begin(&avltree);
+         x != rcn_c::avltree_end(&avltree);
+         x = rcn_c::avltree_next(&avltree, x)) {
+        sink += ((TestData *)x->entry_)->value_;
+    }
+
+    printf("  avltree   scan   : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (void **x = rcn_c::bplustree_begin(&bplustree);
+         x != rcn_c::bplustree_end(&bplustree);
+         x = rcn_c::bplustree_next(&bplustree, x)) {
+        sink += ((TestData *)*x)->value_;
+    }
+
+    printf("  bplustree scan   : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto d : order) {
+        rcn_c::rbtree_erase(&rbtree, &d->rbnode_);
+    }
+
+    printf("  rbtree    erase  : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto d : order) {
+        rcn_c::avltree_erase(&avltree, &d->avlnode_);
+    }
+
+    printf("  avltree   erase  : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto d : order) {
+        rcn_c::bplustree_erase(&bplustree,
+                               rcn_c::bplustree_find(&bplustree, d));
+    }
+
+    printf("  bplustree erase  : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+    printf("  (%zu)\n", sink % 10);
+
+    rcn_c::bplustree_clear(&bplustree);
+}
+
+/* Usage : main [nr_entries ...], e.g. main 1000000 10000000 100000000 */
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        Run(1000000);
+        return 0;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        Run(strtoul(argv[i], NULL, 0));
+    }
+
+    return 0;
+}
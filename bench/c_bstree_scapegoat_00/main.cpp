@@ -0,0 +1,134 @@
+#define BSTREE_SCAPEGOAT
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "rcn_c/avltree.h"
+#include "rcn_c/bstree.h"
+#include "rcn_c/rbtree.h"
+
+struct TestData {
+    rcn_c::bsnode bsnode_;
+    rcn_c::rbnode rbnode_;
+    rcn_c::avlnode avlnode_;
+    int value_;
+};
+
+static int ValueCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_tree = (const TestData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point t0, size_t n)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+/* Inserts in 'order', looks each entry up at random, then erases all. */
+template <typename Insert, typename Find, typename Erase>
+static void Run(const char *name, std::vector<TestData> &data,
+                const std::vector<int> &order, const std::vector<int> &lookup,
+                Insert insert, Find find, Erase erase)
+{
+    size_t nr_found = 0;
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (int i : order) {
+        insert(&data[i]);
+    }
+
+    double t_insert = Elapsed(t0, order.size());
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (int i : lookup) {
+        nr_found += find(&data[i]);
+    }
+
+    double t_find = Elapsed(t0, lookup.size());
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (int i : lookup) {
+        erase(&data[i]);
+    }
+
+    printf("  %-9s : insert %6.1f ns, find %6.1f ns, erase %6.1f ns%s\n", name,
+           t_insert, t_find, Elapsed(t0, lookup.size()),
+           nr_found == lookup.size() ? "" : " (MISSING)");
+}
+
+/* Usage : main [nr_entries], 1M by default. Times are per entry. */
+int main(int argc, char **argv)
+{
+    const size_t nr_entries = argc > 1 ? atol(argv[1]) : 1000000;
+    std::vector<TestData> data(nr_entries);
+    std::vector<int> sorted(nr_entries), shuffled, lookup;
+    std::mt19937 gen(46);
+    rcn_c::bstree bstree;
+    rcn_c::rbtree rbtree;
+    rcn_c::avltree avltree;
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        data[i].value_ = i;
+        sorted[i] = i;
+    }
+
+    shuffled = lookup = sorted;
+    std::shuffle(shuffled.begin(), shuffled.end(), gen);
+    std::shuffle(lookup.begin(), lookup.end(), gen);
+
+    printf("node size : bsnode %zu, rbnode %zu, avlnode %zu bytes\n",
+           sizeof(rcn_c::bsnode), sizeof(rcn_c::rbnode),
+           sizeof(rcn_c::avlnode));
+
+    rcn_c::bstree_init(&bstree, ValueCompare);
+    rcn_c::rbtree_init(&rbtree, ValueCompare);
+    rcn_c::avltree_init(&avltree, ValueCompare);
+
+    for (auto order : { &sorted, &shuffled }) {
+        printf("%zu %s inserts\n", nr_entries,
+               order == &sorted ? "ascending" : "random");
+
+        Run(
+            "scapegoat", data, *order, lookup,
+            [&](TestData *d) {
+                rcn_c::bstree_insert(&bstree, &d->bsnode_, d);
+            },
+            [&](TestData *d) {
+                return rcn_c::bstree_find(&bstree, d) != NULL;
+            },
+            [&](TestData *d) { rcn_c::bstree_erase(&bstree, &d->bsnode_); });
+        Run(
+            "rbtree", data, *order, lookup,
+            [&](TestData *d) {
+                rcn_c::rbtree_insert(&rbtree, &d->rbnode_, d);
+            },
+            [&](TestData *d) {
+                return !rcn_c::rbnode_is_nil(rcn_c::rbtree_find(&rbtree, d));
+            },
+            [&](TestData *d) { rcn_c::rbtree_erase(&rbtree, &d->rbnode_); });
+        Run(
+            "avltree", data, *order, lookup,
+            [&](TestData *d) {
+                rcn_c::avltree_insert(&avltree, &d->avlnode_, d);
+            },
+            [&](TestData *d) {
+                return rcn_c::avltree_find(&avltree, d) != NULL;
+            },
+            [&](TestData *d) {
+                rcn_c::avltree_erase(&avltree, &d->avlnode_);
+            });
+    }
+
+    return 0;
+}
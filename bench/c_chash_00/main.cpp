@@ -0,0 +1,280 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "rcn_c/chash.h"
+#include "rcn_c/dlhash.h"
+
+struct TestData {
+    rcn_c::dlnode dlnode_;
+    rcn_c::chnode chnode_;
+    long value_;
+};
+
+static size_t KeyHash(const void *_ke)
+{
+    return ((const TestData *)_ke)->value_;
+}
+
+static int ValueCompare(const void *_ke, const void *_in_table)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_table = (const TestData *)_in_table;
+
+    return (ke->value_ > in_table->value_) - (ke->value_ < in_table->value_);
+}
+
+enum Mode { MUTEX, RWLOCK, CHASH };
+
+static const char *mode_name[] = { "dlhash mutex ", "dlhash rwlock",
+                                   "chash        " };
+
+/* What a key is at : its node may only be linked again once synchronized. */
+enum State : char { ABSENT, PRESENT, RETIRED };
+
+struct Shared {
+    rcn_c::dlhash dlhash_;
+    rcn_c::chash chash_;
+    pthread_mutex_t mutex_;
+    pthread_rwlock_t rwlock_;
+    std::atomic<bool> stop_;
+};
+
+static bool Find(Shared *s, Mode mode, const TestData *key)
+{
+    bool found = false;
+    unsigned int token;
+
+    switch (mode) {
+    case MUTEX:
+        pthread_mutex_lock(&s->mutex_);
+        found = rcn_c::dlhash_find(&s->dlhash_, key) != NULL;
+        pthread_mutex_unlock(&s->mutex_);
+        break;
+    case RWLOCK:
+        pthread_rwlock_rdlock(&s->rwlock_);
+        found = rcn_c::dlhash_find(&s->dlhash_, key) != NULL;
+        pthread_rwlock_unlock(&s->rwlock_);
+        break;
+    case CHASH:
+        token = rcn_c::chash_read_lock(&s->chash_);
+        found = rcn_c::chash_find(&s->chash_, key) != NULL;
+        rcn_c::chash_read_unlock(&s->chash_, token);
+        break;
+    }
+
+    return found;
+}
+
+static void Insert(Shared *s, Mode mode, TestData *d)
+{
+    switch (mode) {
+    case MUTEX:
+        pthread_mutex_lock(&s->mutex_);
+        rcn_c::dlhash_insert(&s->dlhash_, &d->dlnode_, d);
+        pthread_mutex_unlock(&s->mutex_);
+        break;
+    case RWLOCK:
+        pthread_rwlock_wrlock(&s->rwlock_);
+        rcn_c::dlhash_insert(&s->dlhash_, &d->dlnode_, d);
+        pthread_rwlock_unlock(&s->rwlock_);
+        break;
+    case CHASH:
+        rcn_c::chash_insert(&s->chash_, &d->chnode_, d);
+        break;
+    }
+}
+
+static void Erase(Shared *s, Mode mode, TestData *d)
+{
+    switch (mode) {
+    case MUTEX:
+        pthread_mutex_lock(&s->mutex_);
+        rcn_c::dlhash_erase(&s->dlhash_, &d->dlnode_);
+        pthread_mutex_unlock(&s->mutex_);
+        break;
+    case RWLOCK:
+        pthread_rwlock_wrlock(&s->rwlock_);
+        rcn_c::dlhash_erase(&s->dlhash_, &d->dlnode_);
+        pthread_rwlock_unlock(&s->rwlock_);
+        break;
+    case CHASH:
+        rcn_c::chash_erase(&s->chash_, &d->chnode_);
+        break;
+    }
+}
+
+static void Setup(Shared *s)
+{
+    rcn_c::dlhash_init_resizable(&s->dlhash_, 1024, KeyHash, ValueCompare);
+    rcn_c::chash_init(&s->chash_, 1024, KeyHash, ValueCompare);
+    pthread_mutex_init(&s->mutex_, NULL);
+    pthread_rwlock_init(&s->rwlock_, NULL);
+    s->stop_ = false;
+}
+
+static void Teardown(Shared *s)
+{
+    rcn_c::dlhash_destroy(&s->dlhash_);
+    rcn_c::chash_destroy(&s->chash_);
+    pthread_mutex_destroy(&s->mutex_);
+    pthread_rwlock_destroy(&s->rwlock_);
+}
+
+/*
+ * Each thread looks up random keys, and 'write_pct' percent of the time
+ * erases or inserts back one of the keys it owns instead : those equal to
+ * its index modulo the number of threads. chash nodes erased are recycled
+ * by the batch, after chash_synchronize().
+ */
+static void Mixed(Mode mode, int nr_threads, int write_pct,
+                  std::vector<TestData> &data)
+{
+    const auto duration = std::chrono::milliseconds(200);
+    const size_t n = data.size();
+    std::vector<State> state(n, ABSENT);
+    std::vector<std::thread> threads;
+    std::atomic<size_t> nr_ops(0);
+    auto s = new Shared;
+
+    Setup(s);
+
+    for (size_t i = 0; i < n; i += 2) {
+        Insert(s, mode, &data[i]);
+        state[i] = PRESENT;
+    }
+
+    for (int t = 0; t < nr_threads; t++) {
+        threads.emplace_back([&, t] {
+            std::mt19937_64 gen(t);
+            std::vector<size_t> retired;
+            size_t nr_own = (n - t + nr_threads - 1) / nr_threads;
+            size_t ops = 0;
+            TestData key;
+
+            for (; !s->stop_.load(std::memory_order_relaxed); ops++) {
+                if ((int)(gen() % 100) >= write_pct) {
+                    key.value_ = gen() % n;
+                    Find(s, mode, &key);
+                    continue;
+                }
+
+                size_t i = t + (gen() % nr_own) * nr_threads;
+
+                if (state[i] == PRESENT) {
+                    Erase(s, mode, &data[i]);
+                    state[i] = mode == CHASH ? RETIRED : ABSENT;
+
+                    if (state[i] == RETIRED) {
+                        retired.push_back(i);
+                    }
+                } else {
+                    if ((state[i] == RETIRED) || (retired.size() >= 1024)) {
+                        rcn_c::chash_synchronize(&s->chash_);
+
+                        for (size_t j : retired) {
+                            state[j] = ABSENT;
+                        }
+
+                        retired.clear();
+                    }
+
+                    Insert(s, mode, &data[i]);
+                    state[i] = PRESENT;
+                }
+            }
+
+            nr_ops += ops;
+        });
+    }
+
+    std::this_thread::sleep_for(duration);
+    s->stop_ = true;
+
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    printf("  %s %2d threads, %2d%% writes : %8.2f Mops/s\n", mode_name[mode],
+           nr_threads, write_pct,
+           nr_ops.load() / std::chrono::duration<double>(duration).count() /
+               1e6);
+
+    Teardown(s);
+    delete s;
+}
+
+/* The threads insert all keys, each its share, into an empty table. */
+static void Fill(Mode mode, int nr_threads, std::vector<TestData> &data)
+{
+    std::vector<std::thread> threads;
+    auto s = new Shared;
+
+    Setup(s);
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (int t = 0; t < nr_threads; t++) {
+        threads.emplace_back([&, t] {
+            for (size_t i = t; i < data.size(); i += nr_threads) {
+                Insert(s, mode, &data[i]);
+            }
+        });
+    }
+
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    auto t1 = std::chrono::steady_clock::now();
+
+    printf("  %s %2d threads, fill      : %8.2f Minserts/s\n",
+           mode_name[mode], nr_threads,
+           data.size() / std::chrono::duration<double>(t1 - t0).count() /
+               1e6);
+
+    Teardown(s);
+    delete s;
+}
+
+/* Usage : main [nr_threads ...], e.g. main 1 2 4 8 16 32 64 */
+int main(int argc, char **argv)
+{
+    const size_t nr_keys = 1000000;
+    std::vector<TestData> data(nr_keys);
+    std::vector<int> nr_threads;
+
+    for (size_t i = 0; i < nr_keys; i++) {
+        data[i].value_ = i;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        nr_threads.push_back(atoi(argv[i]));
+    }
+
+    if (nr_threads.empty()) {
+        nr_threads = { 1, 2, 4, 8, 16, 32, 64 };
+    }
+
+    printf("%zu keys, half of them in, %u hardware threads\n", nr_keys,
+           std::thread::hardware_concurrency());
+
+    for (int n : nr_threads) {
+        for (int write_pct : { 0, 10, 50 }) {
+            for (Mode mode : { MUTEX, RWLOCK, CHASH }) {
+                Mixed(mode, n, write_pct, data);
+            }
+        }
+
+        for (Mode mode : { MUTEX, CHASH }) {
+            Fill(mode, n, data);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "rcn_c/dlhash.h"
+
+struct TestData {
+    rcn_c::dlnode node_;
+    uint64_t key_;
+};
+
+/* The keys are random already. */
+static size_t DataHash(const void *_ke)
+{
+    return ((const TestData *)_ke)->key_;
+}
+
+static int DataCompare(const void *_ke, const void *_in_table)
+{
+    uint64_t ke = ((const TestData *)_ke)->key_;
+    uint64_t in_table = ((const TestData *)_in_table)->key_;
+
+    return (ke > in_table) - (ke < in_table);
+}
+
+static double Nanos(std::chrono::steady_clock::time_point t0,
+                    std::chrono::steady_clock::time_point t1)
+{
+    return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+/*
+ * What a table of a fixed size has to do to grow : move all entries to a
+ * table twice as large, at once.
+ */
+static void GrowAtOnce(rcn_c::dlhash *table)
+{
+    rcn_c::dlhash grown;
+
+    rcn_c::dlhash_init(&grown, rcn_c::dlhash_buckets(table) * 2, DataHash,
+                       DataCompare, NULL);
+    rcn_c::__dlhash_alloc_bucket(&grown);
+
+    for (rcn_c::dlnode *x = rcn_c::dlhash_begin(table), *y;
+         x != rcn_c::dlhash_end(table); x = y) {
+        y = rcn_c::dlhash_next(table, x);
+        rcn_c::dlhash_insert_multi(&grown, x, rcn_c::dlhash_erase(table, x));
+    }
+
+    rcn_c::__dlhash_free_bucket(table);
+    *table = grown;
+}
+
+/*
+ * Inserts all, timing each insert, then finds all at random. 'grow' is
+ * called before each insert. The slowest inserts are those that grow the
+ * table at once : there are few of them, the 99.99th percentile and the
+ * maximum show them.
+ */
+template <typename Grow>
+static void Run(const char *name, rcn_c::dlhash *table,
+                std::vector<TestData> &data, const std::vector<TestData> &keys,
+                Grow grow)
+{
+    const size_t n = data.size();
+    std::vector<double> latency;
+    size_t nr_found = 0;
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (auto &d : data) {
+        auto t = std::chrono::steady_clock::now();
+
+        grow(table);
+        rcn_c::dlhash_insert(table, &d.node_, &d);
+        latency.push_back(Nanos(t, std::chrono::steady_clock::now()));
+    }
+
+    double t_insert = Nanos(t0, std::chrono::steady_clock::now()) / n;
+
+    std::sort(latency.begin(), latency.end());
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto &key : keys) {
+        nr_found += rcn_c::dlhash_find(table, &key) != NULL;
+    }
+
+    printf("  %-12s : insert %6.1f ns, 99.99%% %8.1f us, max %8.1f us, "
+           "find %6.1f ns, %8zu buckets%s\n",
+           name, t_insert, latency[n - 1 - n / 10000] / 1000,
+           latency[n - 1] / 1000,
+           Nanos(t0, std::chrono::steady_clock::now()) / n,
+           rcn_c::dlhash_buckets(table), nr_found == n ? "" : " (MISMATCH)");
+
+    for (rcn_c::dlnode *x = rcn_c::dlhash_begin(table), *y;
+         x != rcn_c::dlhash_end(table); x = y) {
+        y = rcn_c::dlhash_next(table, x);
+        rcn_c::dlhash_erase(table, x);
+    }
+}
+
+/*
+ * Usage : main [nr_entries...], 1M by default. Every table starts at 1024
+ * buckets.
+ */
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes;
+
+    for (int i = 1; i < argc; i++) {
+        sizes.push_back(atol(argv[i]));
+    }
+
+    if (sizes.empty()) {
+        sizes = { 1000000 };
+    }
+
+    for (size_t n : sizes) {
+        std::mt19937_64 gen(49);
+        std::vector<TestData> data(n), keys(n);
+        rcn_c::dlhash table;
+
+        for (size_t i = 0; i < n; i++) {
+            data[i].key_ = keys[i].key_ = gen();
+        }
+
+        std::shuffle(keys.begin(), keys.end(), gen);
+
+        printf("%zu random keys\n", n);
+        fflush(stdout);
+
+        rcn_c::dlhash_init(&table, 1024, DataHash, DataCompare, NULL);
+        rcn_c::__dlhash_alloc_bucket(&table);
+        Run("fixed", &table, data, keys, [](rcn_c::dlhash *) {});
+        rcn_c::__dlhash_free_bucket(&table);
+
+        rcn_c::dlhash_init(&table, 1024, DataHash, DataCompare, NULL);
+        rcn_c::__dlhash_alloc_bucket(&table);
+        Run("grow at once", &table, data, keys, [](rcn_c::dlhash *t) {
+            if (rcn_c::dlhash_size(t) >= rcn_c::dlhash_buckets(t)) {
+                GrowAtOnce(t);
+            }
+        });
+        rcn_c::__dlhash_free_bucket(&table);
+
+        rcn_c::dlhash_init_resizable(&table, 1024, DataHash, DataCompare);
+        Run("incremental", &table, data, keys, [](rcn_c::dlhash *) {});
+        rcn_c::dlhash_destroy(&table);
+    }
+
+    return 0;
+}
@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "rcn_c/dlhash.h"
+#include "rcn_c/flathash.h"
+
+struct TestData {
+    rcn_c::dlnode node_;
+    uint64_t key_;
+    uint64_t value_;
+};
+
+/* What the slots of the flat table hold, the key first as in TestData. */
+struct Pair {
+    uint64_t key_;
+    uint64_t value_;
+};
+
+/* The keys are random already. */
+static size_t KeyHash(const void *_ke)
+{
+    return *(const uint64_t *)_ke;
+}
+
+static int KeyCompare(const void *_ke, const void *_in_table)
+{
+    uint64_t ke = *(const uint64_t *)_ke;
+    uint64_t in_table = *(const uint64_t *)_in_table;
+
+    return (ke > in_table) - (ke < in_table);
+}
+
+static size_t DataHash(const void *_ke)
+{
+    return ((const TestData *)_ke)->key_;
+}
+
+static int DataCompare(const void *_ke, const void *_in_table)
+{
+    return KeyCompare(&((const TestData *)_ke)->key_,
+                      &((const TestData *)_in_table)->key_);
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point t0, size_t n)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+/*
+ * Inserts all, finds all at random, misses as many times, then erases all
+ * by key. The keys to look up are read in a row, so that only the table is
+ * missed in the caches.
+ */
+template <typename Insert, typename Find, typename Erase>
+static void Run(const char *name, std::vector<TestData> &data,
+                const std::vector<uint64_t> &keys, Insert insert, Find find,
+                Erase erase)
+{
+    const size_t n = data.size();
+    size_t nr_found = 0;
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (auto &d : data) {
+        insert(&d);
+    }
+
+    double t_insert = Elapsed(t0, n);
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (uint64_t key : keys) {
+        nr_found += find(key);
+    }
+
+    double t_hit = Elapsed(t0, n);
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (uint64_t key : keys) {
+        nr_found -= find(key + 1);
+    }
+
+    double t_miss = Elapsed(t0, n);
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (uint64_t key : keys) {
+        erase(key);
+    }
+
+    printf("  %-17s : insert %6.1f ns, hit %6.1f ns, miss %6.1f ns, "
+           "erase %6.1f ns%s\n",
+           name, t_insert, t_hit, t_miss, Elapsed(t0, n),
+           nr_found == n ? "" : " (MISMATCH)");
+}
+
+/* Usage : main [nr_entries ...], e.g. main 1000000 10000000 100000000 */
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes;
+
+    for (int i = 1; i < argc; i++) {
+        sizes.push_back(atol(argv[i]));
+    }
+
+    if (sizes.empty()) {
+        sizes = { 1000000, 10000000 };
+    }
+
+    for (size_t n : sizes) {
+        std::vector<TestData> data(n);
+        std::vector<uint64_t> keys;
+        std::mt19937_64 gen(48);
+        rcn_c::flathash flat, ptrs;
+        rcn_c::dlhash dlhash;
+
+        /* Even keys, so that key + 1 misses. */
+        for (size_t i = 0; i < n; i++) {
+            data[i].key_ = gen() & ~1ULL;
+            data[i].value_ = i;
+        }
+
+        std::sort(data.begin(), data.end(),
+                  [](const TestData &a, const TestData &b) {
+                      return a.key_ < b.key_;
+                  });
+        data.erase(std::unique(data.begin(), data.end(),
+                               [](const TestData &a, const TestData &b) {
+                                   return a.key_ == b.key_;
+                               }),
+                   data.end());
+        std::shuffle(data.begin(), data.end(), gen);
+
+        for (auto &d : data) {
+            keys.push_back(d.key_);
+        }
+
+        std::shuffle(keys.begin(), keys.end(), gen);
+
+        printf("%zu random keys\n", data.size());
+
+        rcn_c::dlhash_init(&dlhash, data.size(), DataHash, DataCompare, NULL);
+        rcn_c::__dlhash_alloc_bucket(&dlhash);
+
+        Run(
+            "dlhash", data, keys,
+            [&](TestData *d) { rcn_c::dlhash_insert(&dlhash, &d->node_, d); },
+            [&](uint64_t key) {
+                TestData ke;
+
+                ke.key_ = key;
+
+                return rcn_c::dlhash_find(&dlhash, &ke) != NULL;
+            },
+            [&](uint64_t key) {
+                TestData ke;
+
+                ke.key_ = key;
+                rcn_c::dlhash_remove(&dlhash, &ke);
+            });
+
+        rcn_c::__dlhash_free_bucket(&dlhash);
+
+        /* The key and value in the slots, looked up by the key alone. */
+        rcn_c::flathash_init(&flat, sizeof(Pair), KeyHash, KeyCompare);
+
+        Run(
+            "flathash", data, keys,
+            [&](TestData *d) {
+                Pair p = { d->key_, d->value_ };
+
+                rcn_c::flathash_insert(&flat, &p);
+            },
+            [&](uint64_t key) {
+                return rcn_c::flathash_find(&flat, &key) != NULL;
+            },
+            [&](uint64_t key) { rcn_c::flathash_remove(&flat, &key, NULL); });
+
+        rcn_c::flathash_destroy(&flat);
+
+        /* Same, with the room made first. */
+        rcn_c::flathash_init(&flat, sizeof(Pair), KeyHash, KeyCompare);
+        rcn_c::flathash_reserve(&flat, data.size());
+
+        Run(
+            "flathash reserved", data, keys,
+            [&](TestData *d) {
+                Pair p = { d->key_, d->value_ };
+
+                rcn_c::flathash_insert(&flat, &p);
+            },
+            [&](uint64_t key) {
+                return rcn_c::flathash_find(&flat, &key) != NULL;
+            },
+            [&](uint64_t key) { rcn_c::flathash_remove(&flat, &key, NULL); });
+
+        rcn_c::flathash_destroy(&flat);
+
+        /* Pointers to the entries, with the callbacks of dlhash. */
+        rcn_c::flathash_init(&ptrs, 0, DataHash, DataCompare);
+
+        Run(
+            "flathash pointers", data, keys,
+            [&](TestData *d) { rcn_c::flathash_insert(&ptrs, d); },
+            [&](uint64_t key) {
+                TestData ke;
+
+                ke.key_ = key;
+
+                return rcn_c::flathash_find(&ptrs, &ke) != NULL;
+            },
+            [&](uint64_t key) {
+                TestData ke;
+
+                ke.key_ = key;
+                rcn_c::flathash_remove(&ptrs, &ke, NULL);
+            });
+
+        rcn_c::flathash_destroy(&ptrs);
+    }
+
+    return 0;
+}
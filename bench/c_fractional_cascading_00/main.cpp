@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "rcn_c/binary_search.h"
+#include "rcn_c/fractional_cascading.h"
+
+static int IntCompar(const void *a, const void *b)
+{
+    return (*(int *)a > *(int *)b) - (*(int *)a < *(int *)b);
+}
+
+int main(int argc, char **argv)
+{
+    const size_t nr_entries = 4096;
+    const size_t nr_queries = 200000;
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> dist(0, 1 << 30);
+
+    printf("%8s %14s %14s %8s\n", "K", "binary(ns/q)", "cascade(ns/q)",
+           "speedup");
+
+    for (size_t k = 16; k <= 256; k *= 2) {
+        std::vector<std::vector<int>> lists(k);
+        std::vector<const void *> base(k);
+        std::vector<size_t> nmemb(k);
+        std::vector<int> keys(nr_queries);
+        std::vector<size_t> pos(k);
+        rcn_c::fcascade fc;
+        size_t sink = 0;
+
+        for (size_t n = 0; n < k; n++) {
+            lists[n].resize(nr_entries);
+
+            for (auto &x : lists[n]) {
+                x = dist(gen);
+            }
+
+            std::sort(lists[n].begin(), lists[n].end());
+            base[n] = lists[n].data();
+            nmemb[n] = lists[n].size();
+        }
+
+        for (auto &key : keys) {
+            key = lists[gen() % k][gen() % nr_entries];
+        }
+
+        rcn_c::fcascade_init(&fc, k, sizeof(int), IntCompar, nullptr);
+        rcn_c::__fcascade_alloc_level(&fc);
+        rcn_c::fcascade_build(&fc, base.data(), nmemb.data());
+
+        auto t0 = std::chrono::steady_clock::now();
+
+        for (auto &key : keys) {
+            for (size_t n = 0; n < k; n++) {
+                sink += rcn_c::binary_search(&key, base[n], nmemb[n],
+                                             sizeof(int), IntCompar) != NULL;
+            }
+        }
+
+        auto t1 = std::chrono::steady_clock::now();
+
+        for (auto &key : keys) {
+            rcn_c::fcascade_lower_bound(&fc, &key, pos.data());
+            sink += pos[k - 1];
+        }
+
+        auto t2 = std::chrono::steady_clock::now();
+
+        double binary =
+            std::chrono::duration<double, std::nano>(t1 - t0).count() /
+            nr_queries;
+        double cascade =
+            std::chrono::duration<double, std::nano>(t2 - t1).count() /
+            nr_queries;
+
+        printf("%8zu %14.1f %14.1f %7.2fx (%zu)\n", k, binary, cascade,
+               binary / cascade, sink % 10);
+
+        rcn_c::__fcascade_free_level(&fc);
+    }
+
+    return 0;
+}
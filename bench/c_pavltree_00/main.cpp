@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "rcn_c/avltree.h"
+#include "rcn_c/pavltree.h"
+
+struct TestData {
+    rcn_c::avlnode avlnode_;
+    long value_;
+};
+
+static int ValueCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_tree = (const TestData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point t0, size_t n)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+/* Inserts all of 'order' into 'tree', taking a snapshot every 'interval'. */
+static double Insert(rcn_c::pavltree *tree, std::vector<TestData *> &order,
+                     size_t interval, std::vector<rcn_c::pavltree> &snaps)
+{
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < order.size(); i++) {
+        if ((interval != 0) && (i % interval == 0)) {
+            snaps.emplace_back();
+            rcn_c::pavltree_snapshot(tree, &snaps.back());
+        }
+
+        rcn_c::pavltree_insert(tree, order[i]);
+    }
+
+    return Elapsed(t0, order.size());
+}
+
+int main(int argc, char **argv)
+{
+    const size_t nr_entries = 1000000;
+    std::vector<TestData> data(nr_entries);
+    std::vector<TestData *> order(nr_entries);
+    std::mt19937_64 gen(0);
+    rcn_c::avltree avltree;
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        data[i].value_ = i;
+        order[i] = &data[i];
+    }
+
+    std::shuffle(order.begin(), order.end(), gen);
+
+    rcn_c::avltree_init(&avltree, ValueCompare);
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (auto d : order) {
+        rcn_c::avltree_insert(&avltree, &d->avlnode_, d);
+    }
+
+    printf("avltree  insert                  : %8.1f ns/op\n",
+           Elapsed(t0, nr_entries));
+
+    for (size_t interval : { 0, 100000, 1000, 10 }) {
+        std::vector<rcn_c::pavltree> snaps;
+        rcn_c::pavltree pavltree;
+        double ns;
+
+        snaps.reserve(interval == 0 ? 0 : nr_entries / interval);
+        rcn_c::pavltree_init(&pavltree, ValueCompare);
+        ns = Insert(&pavltree, order, interval, snaps);
+
+        if (interval == 0) {
+            printf("pavltree insert                  : %8.1f ns/op\n", ns);
+        } else {
+            printf("pavltree insert, snapshot / %-6zu: %8.1f ns/op\n",
+                   interval, ns);
+        }
+
+        t0 = std::chrono::steady_clock::now();
+
+        for (auto &snap : snaps) {
+            rcn_c::pavltree_clear(&snap);
+        }
+
+        rcn_c::pavltree_clear(&pavltree);
+
+        if (!snaps.empty()) {
+            printf("  %zu snapshots dropped in %.1f ms\n", snaps.size(),
+                   Elapsed(t0, 1000000));
+        }
+    }
+
+    return 0;
+}
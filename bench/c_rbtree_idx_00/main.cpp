@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "rcn_c/rbtree.h"
+#include "rcn_c/rbtree_idx.h"
+
+struct TestData {
+    rcn_c::rbnode rbnode_;
+    int value_;
+};
+
+struct IdxData {
+    rcn_c::rbidx_node node_;
+    int value_;
+};
+
+static int TestDataCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_tree = (const TestData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+static int IdxDataCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const IdxData *)_ke;
+    auto in_tree = (const IdxData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point t0, size_t n)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t nr_entries = 1000000;
+    std::vector<TestData> data(nr_entries);
+    std::vector<IdxData> pool(nr_entries + 1);
+    std::vector<int> order(nr_entries);
+    rcn_c::rbtree rbtree;
+    rcn_c::rbidx_root root;
+    rcn_c::rbidx rbidx;
+    size_t found = 0;
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        order[i] = i;
+        data[i].value_ = i;
+        pool[i + 1].value_ = i;
+    }
+
+    std::shuffle(order.begin(), order.end(), std::mt19937(37));
+
+    rcn_c::rbtree_init(&rbtree, TestDataCompare);
+    rcn_c::rbidx_init(&rbidx, &root, pool.data(), sizeof(IdxData),
+                      offsetof(IdxData, node_), IdxDataCompare);
+    rcn_c::rbidx_clear(&rbidx);
+
+    printf("record size : rbtree %zu bytes, rbidx %zu bytes\n",
+           sizeof(TestData), sizeof(IdxData));
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (int i : order) {
+        rcn_c::rbtree_insert(&rbtree, &data[i].rbnode_, &data[i]);
+    }
+
+    printf("rbtree  insert : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (int i : order) {
+        rcn_c::rbidx_insert(&rbidx, i + 1);
+    }
+
+    printf("rbidx   insert : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (int i : order) {
+        found += rcn_c::rbtree_find(&rbtree, &data[i]) !=
+                 rcn_c::rbtree_nil(&rbtree);
+    }
+
+    printf("rbtree  find   : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (int i : order) {
+        found += rcn_c::rbidx_find(&rbidx, &pool[i + 1]) != RBIDX_NIL;
+    }
+
+    printf("rbidx   find   : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (int i : order) {
+        rcn_c::rbtree_erase(&rbtree, &data[i].rbnode_);
+    }
+
+    printf("rbtree  erase  : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (int i : order) {
+        rcn_c::rbidx_erase(&rbidx, i + 1);
+    }
+
+    printf("rbidx   erase  : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    return found != 2 * nr_entries;
+}
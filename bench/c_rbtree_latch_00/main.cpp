@@ -0,0 +1,179 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "rcn_c/rbtree_latch.h"
+
+struct TestData {
+    rcn_c::rbnode rbnode_;
+    rcn_c::rblatch_node latch_node_;
+    long value_;
+};
+
+static int ValueCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_tree = (const TestData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+enum Mode { MUTEX, RWLOCK, LATCH };
+
+static const char *mode_name[] = { "mutex ", "rwlock", "latch " };
+
+struct Shared {
+    rcn_c::rbtree rbtree_;
+    rcn_c::rbtree_latch latch_;
+    pthread_mutex_t mutex_;
+    pthread_rwlock_t rwlock_;
+    std::atomic<bool> stop_;
+};
+
+static void *Find(Shared *s, Mode mode, const TestData *key)
+{
+    void *e = NULL;
+    rcn_c::rbnode *x;
+    unsigned int token;
+
+    switch (mode) {
+    case MUTEX:
+        pthread_mutex_lock(&s->mutex_);
+        x = rcn_c::rbtree_find(&s->rbtree_, key);
+        e = x->entry_;
+        pthread_mutex_unlock(&s->mutex_);
+        break;
+    case RWLOCK:
+        pthread_rwlock_rdlock(&s->rwlock_);
+        x = rcn_c::rbtree_find(&s->rbtree_, key);
+        e = x->entry_;
+        pthread_rwlock_unlock(&s->rwlock_);
+        break;
+    case LATCH:
+        token = rcn_c::rbtree_latch_read_lock(&s->latch_);
+        e = rcn_c::rbtree_latch_find(&s->latch_, key);
+        rcn_c::rbtree_latch_read_unlock(&s->latch_, token);
+        break;
+    }
+
+    return e;
+}
+
+/* Moves one entry out of and back into the tree every millisecond. */
+static void Update(Shared *s, Mode mode, std::vector<TestData> &data)
+{
+    for (size_t i = 0; !s->stop_.load(); i = (i + 1) % data.size()) {
+        TestData *d = &data[i];
+
+        switch (mode) {
+        case MUTEX:
+            pthread_mutex_lock(&s->mutex_);
+            rcn_c::rbtree_erase(&s->rbtree_, &d->rbnode_);
+            rcn_c::rbtree_insert(&s->rbtree_, &d->rbnode_, d);
+            pthread_mutex_unlock(&s->mutex_);
+            break;
+        case RWLOCK:
+            pthread_rwlock_wrlock(&s->rwlock_);
+            rcn_c::rbtree_erase(&s->rbtree_, &d->rbnode_);
+            rcn_c::rbtree_insert(&s->rbtree_, &d->rbnode_, d);
+            pthread_rwlock_unlock(&s->rwlock_);
+            break;
+        case LATCH:
+            rcn_c::rbtree_latch_erase(&s->latch_, &d->latch_node_);
+            rcn_c::rbtree_latch_synchronize(&s->latch_);
+            rcn_c::rbtree_latch_insert(&s->latch_, &d->latch_node_, d);
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+static void Run(Mode mode, int nr_readers, std::vector<TestData> &data)
+{
+    const auto duration = std::chrono::milliseconds(500);
+    std::vector<std::thread> readers;
+    std::atomic<size_t> nr_lookups(0);
+    Shared s;
+
+    rcn_c::rbtree_init(&s.rbtree_, ValueCompare);
+    rcn_c::rbtree_latch_init(&s.latch_, ValueCompare);
+    pthread_mutex_init(&s.mutex_, NULL);
+    pthread_rwlock_init(&s.rwlock_, NULL);
+    s.stop_ = false;
+
+    for (auto &d : data) {
+        rcn_c::rbtree_insert(&s.rbtree_, &d.rbnode_, &d);
+        rcn_c::rbtree_latch_insert(&s.latch_, &d.latch_node_, &d);
+    }
+
+    for (int t = 0; t < nr_readers; t++) {
+        readers.emplace_back([&, t] {
+            std::mt19937_64 gen(t);
+            TestData key;
+            size_t n = 0;
+
+            while (!s.stop_.load(std::memory_order_relaxed)) {
+                key.value_ = gen() % data.size();
+                n += Find(&s, mode, &key) != NULL;
+            }
+
+            nr_lookups += n;
+        });
+    }
+
+    std::thread writer(Update, &s, mode, std::ref(data));
+
+    std::this_thread::sleep_for(duration);
+    s.stop_ = true;
+
+    for (auto &r : readers) {
+        r.join();
+    }
+
+    writer.join();
+
+    printf("  %s %3d readers : %8.2f Mlookups/s\n", mode_name[mode],
+           nr_readers,
+           nr_lookups.load() / std::chrono::duration<double>(duration).count() /
+               1e6);
+
+    rcn_c::rbtree_latch_destroy(&s.latch_);
+    pthread_mutex_destroy(&s.mutex_);
+    pthread_rwlock_destroy(&s.rwlock_);
+}
+
+/* Usage : main [nr_readers ...], e.g. main 1 2 4 8 16 32 64 */
+int main(int argc, char **argv)
+{
+    const size_t nr_entries = 100000;
+    std::vector<TestData> data(nr_entries);
+    std::vector<int> nr_readers;
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        data[i].value_ = i;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        nr_readers.push_back(atoi(argv[i]));
+    }
+
+    if (nr_readers.empty()) {
+        nr_readers = { 1, 2, 4 };
+    }
+
+    printf("%zu entries, one writer updating every 1 ms\n", nr_entries);
+
+    for (int n : nr_readers) {
+        for (Mode mode : { MUTEX, RWLOCK, LATCH }) {
+            Run(mode, n, data);
+        }
+    }
+
+    return 0;
+}
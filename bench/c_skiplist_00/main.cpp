@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "rcn_c/rbtree.h"
+#include "rcn_c/skiplist.h"
+
+struct TestData {
+    rcn_c::rbnode rbnode_;
+    rcn_c::skipnode skipnode_;
+    long value_;
+};
+
+static int ValueCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_tree = (const TestData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+enum Mode { MUTEX, SKIPLIST };
+
+static const char *mode_name[] = { "rbtree+mutex", "skiplist    " };
+
+struct Shared {
+    rcn_c::rbtree rbtree_;
+    rcn_c::skiplist skiplist_;
+    pthread_mutex_t mutex_;
+};
+
+static void Insert(Shared *s, Mode mode, TestData *d)
+{
+    unsigned int token;
+
+    switch (mode) {
+    case MUTEX:
+        pthread_mutex_lock(&s->mutex_);
+        rcn_c::rbtree_insert(&s->rbtree_, &d->rbnode_, d);
+        pthread_mutex_unlock(&s->mutex_);
+        break;
+    case SKIPLIST:
+        token = rcn_c::skiplist_read_lock(&s->skiplist_);
+        rcn_c::skiplist_insert(&s->skiplist_, &d->skipnode_, d);
+        rcn_c::skiplist_read_unlock(&s->skiplist_, token);
+        break;
+    }
+}
+
+static bool Find(Shared *s, Mode mode, const TestData *key)
+{
+    bool found = false;
+    unsigned int token;
+
+    switch (mode) {
+    case MUTEX:
+        pthread_mutex_lock(&s->mutex_);
+        found = rcn_c::rbtree_find(&s->rbtree_, key) != NULL;
+        pthread_mutex_unlock(&s->mutex_);
+        break;
+    case SKIPLIST:
+        token = rcn_c::skiplist_read_lock(&s->skiplist_);
+        found = rcn_c::skiplist_find(&s->skiplist_, key) != NULL;
+        rcn_c::skiplist_read_unlock(&s->skiplist_, token);
+        break;
+    }
+
+    return found;
+}
+
+/* Runs 'fn(t, i)' for i in [0, n) split over 'nr_threads' threads. */
+template <typename Fn>
+static double Parallel(int nr_threads, size_t n, Fn fn)
+{
+    std::vector<std::thread> threads;
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (int t = 0; t < nr_threads; t++) {
+        threads.emplace_back([&, t] {
+            for (size_t i = t; i < n; i += nr_threads) {
+                fn(t, i);
+            }
+        });
+    }
+
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    return n / std::chrono::duration<double>(
+                   std::chrono::steady_clock::now() - t0)
+                   .count() /
+           1e6;
+}
+
+static void Run(Mode mode, int nr_threads, std::vector<TestData> &data,
+                const std::vector<size_t> &order)
+{
+    std::atomic<size_t> nr_found(0);
+    double insert, find;
+    Shared s;
+
+    rcn_c::rbtree_init(&s.rbtree_, ValueCompare);
+    rcn_c::skiplist_init(&s.skiplist_, ValueCompare);
+    pthread_mutex_init(&s.mutex_, NULL);
+
+    insert = Parallel(nr_threads, order.size(), [&](int t, size_t i) {
+        Insert(&s, mode, &data[order[i]]);
+    });
+
+    find = Parallel(nr_threads, order.size(), [&](int t, size_t i) {
+        TestData key;
+
+        key.value_ = order[order.size() - 1 - i];
+
+        if (Find(&s, mode, &key)) {
+            nr_found.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    printf("  %s %3d threads : insert %8.2f Mops/s, find %8.2f Mops/s%s\n",
+           mode_name[mode], nr_threads, insert, find,
+           nr_found.load() == order.size() ? "" : " (MISSING)");
+
+    rcn_c::skiplist_destroy(&s.skiplist_);
+    pthread_mutex_destroy(&s.mutex_);
+}
+
+/* Usage : main [nr_threads ...], e.g. main 1 2 4 8 16 32 */
+int main(int argc, char **argv)
+{
+    const size_t nr_entries = 200000;
+    std::vector<TestData> data(nr_entries);
+    std::vector<size_t> order(nr_entries);
+    std::vector<int> nr_threads;
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        data[i].value_ = i;
+        order[i] = i;
+    }
+
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(0));
+
+    for (int i = 1; i < argc; i++) {
+        nr_threads.push_back(atoi(argv[i]));
+    }
+
+    if (nr_threads.empty()) {
+        nr_threads = { 1, 2, 4, 8, 16, 32 };
+    }
+
+    printf("%zu random keys\n", nr_entries);
+
+    for (int n : nr_threads) {
+        for (Mode mode : { MUTEX, SKIPLIST }) {
+            Run(mode, n, data, order);
+        }
+    }
+
+    return 0;
+}
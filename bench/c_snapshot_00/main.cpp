@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unistd.h>
+#include <vector>
+
+#include "rcn_c/rbtree.h"
+#include "rcn_c/snapshot.h"
+
+struct TestData {
+    long value_;
+    long payload_;
+    rcn_c::rbnode node_;
+};
+
+static int ValueCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_tree = (const TestData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+static const void *Next(void *_it)
+{
+    auto it = (std::pair<rcn_c::rbtree *, rcn_c::rbnode *> *)_it;
+    const void *e = it->second->entry_;
+
+    it->second = rcn_c::rbtree_next(it->first, it->second);
+
+    return e;
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point t0, size_t n)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+/* Usage : main [nr_entries], 1M by default. Times are per entry or lookup. */
+int main(int argc, char **argv)
+{
+    const size_t nr_entries = argc > 1 ? atol(argv[1]) : 1000000;
+    const char *path[] = { "/tmp/c_snapshot_00.sorted",
+                           "/tmp/c_snapshot_00.eytzinger" };
+    const char *name[] = { "sorted   ", "eytzinger" };
+    std::vector<TestData> data(nr_entries);
+    std::vector<long> keys(nr_entries);
+    std::mt19937_64 gen(44);
+    rcn_c::rbtree tree;
+    size_t nr_found = 0;
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        keys[i] = i * 3;
+    }
+
+    std::shuffle(keys.begin(), keys.end(), gen);
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        data[i].value_ = keys[i];
+    }
+
+    rcn_c::rbtree_init(&tree, ValueCompare);
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (auto &d : data) {
+        rcn_c::rbtree_insert(&tree, &d.node_, &d);
+    }
+
+    printf("rbtree    insert build   : %6.1f ns\n", Elapsed(t0, nr_entries));
+
+    std::shuffle(keys.begin(), keys.end(), gen);
+    t0 = std::chrono::steady_clock::now();
+
+    for (long k : keys) {
+        TestData key = { k, 0, {} };
+
+        nr_found += !rcn_c::rbnode_is_nil(rcn_c::rbtree_find(&tree, &key));
+    }
+
+    printf("rbtree    find           : %6.1f ns\n", Elapsed(t0, nr_entries));
+
+    for (int layout = 0; layout < 2; layout++) {
+        std::pair<rcn_c::rbtree *, rcn_c::rbnode *> it(
+            &tree, rcn_c::rbtree_begin(&tree));
+        std::vector<void *> entries(nr_entries);
+        std::vector<rcn_c::rbnode *> nodes(nr_entries);
+        rcn_c::snapshot snap = {};
+        rcn_c::rbtree loaded;
+
+        t0 = std::chrono::steady_clock::now();
+        rcn_c::snapshot_save(path[layout], sizeof(TestData), nr_entries,
+                             (rcn_c::snapshot_layout)layout, Next, &it);
+        printf("%s save           : %6.1f ns\n", name[layout],
+               Elapsed(t0, nr_entries));
+
+        t0 = std::chrono::steady_clock::now();
+
+        if (rcn_c::snapshot_open(&snap, path[layout], sizeof(TestData),
+                                 ValueCompare) != 0) {
+            printf("open failed\n");
+            return 1;
+        }
+
+        rcn_c::snapshot_sorted(&snap, entries.data());
+
+        for (size_t i = 0; i < nr_entries; i++) {
+            nodes[i] = &((TestData *)entries[i])->node_;
+        }
+
+        rcn_c::rbtree_init(&loaded, ValueCompare);
+        rcn_c::rbtree_build_sorted(&loaded, nodes.data(), entries.data(),
+                                   nr_entries);
+        printf("%s load + build   : %6.1f ns\n", name[layout],
+               Elapsed(t0, nr_entries));
+
+        t0 = std::chrono::steady_clock::now();
+
+        for (long k : keys) {
+            TestData key = { k, 0, {} };
+
+            nr_found += rcn_c::snapshot_find(&snap, &key) != NULL;
+        }
+
+        printf("%s find in place  : %6.1f ns\n", name[layout],
+               Elapsed(t0, nr_entries));
+
+        rcn_c::snapshot_close(&snap);
+        unlink(path[layout]);
+    }
+
+    if (nr_found != 3 * nr_entries) {
+        printf("MISSING %zu\n", 3 * nr_entries - nr_found);
+    }
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "rcn_c/splseq.h"
+
+struct TestData {
+    rcn_c::splseq_node node_;
+    char c_;
+};
+
+static double Elapsed(std::chrono::steady_clock::time_point t0, size_t n)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+/*
+ * A text buffer of 1M characters under random edits : single character
+ * inserts, erases of up to 8 characters and cut & paste of a block, against
+ * a std::vector<char> doing the same.
+ */
+int main(int argc, char **argv)
+{
+    const size_t nr_chars = 1000000;
+    const size_t nr_edits = 200000;
+    std::vector<TestData> data(nr_chars + nr_edits);
+    std::vector<char> text(nr_chars, 'a');
+    std::mt19937_64 gen(39);
+    rcn_c::splseq seq, out, rest;
+    size_t next = 0;
+
+    rcn_c::splseq_init(&seq, NULL);
+    rcn_c::splseq_init(&out, NULL);
+    rcn_c::splseq_init(&rest, NULL);
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (; next < nr_chars; next++) {
+        data[next].c_ = 'a';
+        rcn_c::splseq_push_back(&seq, &data[next].node_, &data[next]);
+    }
+
+    printf("splseq push_back   : %8.1f ns/op\n", Elapsed(t0, nr_chars));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < nr_edits; i++, next++) {
+        size_t pos = gen() % (rcn_c::splseq_size(&seq) + 1);
+
+        data[next].c_ = 'b';
+        rcn_c::splseq_insert(&seq, pos, &data[next].node_, &data[next]);
+    }
+
+    printf("splseq insert      : %8.1f ns/op\n", Elapsed(t0, nr_edits));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < nr_edits; i++) {
+        size_t pos = gen() % (rcn_c::splseq_size(&seq) - 8);
+
+        rcn_c::splseq_erase_range(&seq, pos, gen() % 8, &out);
+        rcn_c::splseq_clear(&out);
+    }
+
+    printf("splseq erase_range : %8.1f ns/op\n", Elapsed(t0, nr_edits));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < nr_edits; i++) {
+        size_t size = rcn_c::splseq_size(&seq);
+        size_t pos = gen() % (size - 1024);
+
+        /* Moves 1024 characters from 'pos' to the end. */
+        rcn_c::splseq_split(&seq, pos, &out);
+        rcn_c::splseq_split(&out, 1024, &rest);
+        rcn_c::splseq_concat(&seq, &rest);
+        rcn_c::splseq_concat(&seq, &out);
+    }
+
+    printf("splseq cut & paste : %8.1f ns/op\n", Elapsed(t0, nr_edits));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < nr_edits; i++) {
+        size_t pos = gen() % (rcn_c::splseq_size(&seq) - 1024);
+
+        rcn_c::splseq_reverse(&seq, pos, 1024);
+    }
+
+    printf("splseq reverse     : %8.1f ns/op\n", Elapsed(t0, nr_edits));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < nr_edits; i++) {
+        text.insert(text.begin() + gen() % (text.size() + 1), 'b');
+    }
+
+    printf("vector insert      : %8.1f ns/op\n", Elapsed(t0, nr_edits));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < nr_edits; i++) {
+        size_t pos = gen() % (text.size() - 8);
+
+        text.erase(text.begin() + pos, text.begin() + pos + gen() % 8);
+    }
+
+    printf("vector erase_range : %8.1f ns/op\n", Elapsed(t0, nr_edits));
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "rcn_c/spltree.h"
+
+struct TestData {
+    rcn_c::splnode node_;
+    int value_;
+};
+
+static int ValueCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_tree = (const TestData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point t0, size_t n)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+/* Keys drawn with P(rank k) ~ 1 / k^s, the hot keys scattered over the set. */
+static std::vector<int> Zipf(size_t nr_keys, size_t n, double s)
+{
+    std::vector<double> cdf(nr_keys);
+    std::vector<int> perm(nr_keys);
+    std::vector<int> keys(n);
+    std::mt19937_64 gen(40);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    double sum = 0.0;
+
+    for (size_t k = 0; k < nr_keys; k++) {
+        sum += 1.0 / std::pow(k + 1, s);
+        cdf[k] = sum;
+        perm[k] = k;
+    }
+
+    std::shuffle(perm.begin(), perm.end(), gen);
+
+    for (auto &key : keys) {
+        double u = uniform(gen) * sum;
+
+        key = perm[std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin()];
+    }
+
+    return keys;
+}
+
+static std::vector<int> Uniform(size_t nr_keys, size_t n)
+{
+    std::vector<int> keys(n);
+    std::mt19937_64 gen(40);
+
+    for (auto &key : keys) {
+        key = gen() % nr_keys;
+    }
+
+    return keys;
+}
+
+struct Mode {
+    const char *name_;
+    bool splay_;
+    rcn_c::spltree_policy policy_;
+};
+
+static void Run(const char *workload, const std::vector<int> &keys,
+                std::vector<TestData> &data, const Mode &mode)
+{
+    std::vector<rcn_c::splnode *> nodes(data.size());
+    std::vector<void *> entries(data.size());
+    rcn_c::spltree tree;
+    TestData key;
+    size_t found = 0;
+
+    for (size_t i = 0; i < data.size(); i++) {
+        nodes[i] = &data[i].node_;
+        entries[i] = &data[i];
+    }
+
+    /* Balanced to start with. */
+    rcn_c::spltree_init(&tree, ValueCompare);
+    rcn_c::spltree_set_policy(&tree, &mode.policy_);
+    rcn_c::spltree_build_sorted(&tree, nodes.data(), entries.data(),
+                                data.size());
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (int k : keys) {
+        key.value_ = k;
+
+        if (mode.splay_) {
+            found += rcn_c::spltree_find(&tree, &key) != NULL;
+        } else {
+            found += rcn_c::spltree_find_const(&tree, &key) != NULL;
+        }
+    }
+
+    printf("%-7s %-14s : %8.1f ns/op\n", workload, mode.name_,
+           Elapsed(t0, keys.size()));
+
+    if (found != keys.size()) {
+        printf("  %zu keys not found\n", keys.size() - found);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const size_t nr_keys = 1 << 20;
+    const size_t nr_lookups = 2000000;
+    const unsigned int log_n = 20;
+    std::vector<TestData> data(nr_keys);
+    const Mode modes[] = {
+        { "find_const", false, { 1, 0, false } },
+        { "splay", true, { 1, 0, false } },
+        { "semi-splay", true, { 1, 0, true } },
+        { "splay 1/16", true, { 16, 0, false } },
+        { "splay deep", true, { 1, log_n - 4, false } },
+        { "semi deep", true, { 1, log_n - 4, true } },
+    };
+
+    for (size_t i = 0; i < nr_keys; i++) {
+        data[i].value_ = i;
+    }
+
+    auto zipf = Zipf(nr_keys, nr_lookups, 0.99);
+    auto uniform = Uniform(nr_keys, nr_lookups);
+
+    for (const auto &mode : modes) {
+        Run("zipf", zipf, data, mode);
+    }
+
+    for (const auto &mode : modes) {
+        Run("uniform", uniform, data, mode);
+    }
+
+    return 0;
+}
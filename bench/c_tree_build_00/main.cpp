@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "rcn_c/avltree.h"
+#include "rcn_c/rbtree.h"
+
+struct TestData {
+    rcn_c::rbnode rbnode_;
+    rcn_c::avlnode avlnode_;
+    int value_;
+};
+
+static int ValueCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_tree = (const TestData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point t0, size_t n)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t nr_entries = 1000000;
+    std::vector<TestData> data(nr_entries);
+    std::vector<rcn_c::rbnode *> rbnodes(nr_entries);
+    std::vector<rcn_c::avlnode *> avlnodes(nr_entries);
+    std::vector<void *> entries(nr_entries);
+    rcn_c::rbtree rbtree;
+    rcn_c::avltree avltree;
+    rcn_c::rbnode *rbhint;
+    rcn_c::avlnode *avlhint = NULL;
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        data[i].value_ = i;
+        rbnodes[i] = &data[i].rbnode_;
+        avlnodes[i] = &data[i].avlnode_;
+        entries[i] = &data[i];
+    }
+
+    rcn_c::rbtree_init(&rbtree, ValueCompare);
+    rcn_c::avltree_init(&avltree, ValueCompare);
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (auto &d : data) {
+        rcn_c::rbtree_insert(&rbtree, &d.rbnode_, &d);
+    }
+
+    printf("rbtree  insert        : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    rcn_c::rbtree_clear(&rbtree);
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto &d : data) {
+        rcn_c::rbtree_append_sorted(&rbtree, &d.rbnode_, &d);
+    }
+
+    printf("rbtree  append_sorted : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    rcn_c::rbtree_clear(&rbtree);
+    rbhint = (rcn_c::rbnode *)rcn_c::rbtree_end(&rbtree);
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto &d : data) {
+        rcn_c::rbtree_insert_hint(&rbtree, rbhint, &d.rbnode_, &d);
+        rbhint = &d.rbnode_;
+    }
+
+    printf("rbtree  insert_hint   : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+    rcn_c::rbtree_build_sorted(&rbtree, rbnodes.data(), entries.data(),
+                               nr_entries);
+    printf("rbtree  build_sorted  : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto &d : data) {
+        rcn_c::avltree_insert(&avltree, &d.avlnode_, &d);
+    }
+
+    printf("avltree insert        : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    rcn_c::avltree_clear(&avltree);
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto &d : data) {
+        rcn_c::avltree_append_sorted(&avltree, &d.avlnode_, &d);
+    }
+
+    printf("avltree append_sorted : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    rcn_c::avltree_clear(&avltree);
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto &d : data) {
+        rcn_c::avltree_insert_hint(&avltree, avlhint, &d.avlnode_, &d);
+        avlhint = &d.avlnode_;
+    }
+
+    printf("avltree insert_hint   : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+    rcn_c::avltree_build_sorted(&avltree, avlnodes.data(), entries.data(),
+                                nr_entries);
+    printf("avltree build_sorted  : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+#define AVLTREE_KEY_PREFIX
+#define RBTREE_KEY_PREFIX
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "rcn_c/avltree.h"
+#include "rcn_c/rbtree.h"
+
+/* The entries live apart from the nodes, as with intrusive nodes in objects. */
+struct Entry {
+    char name_[32];
+    char payload_[32];
+};
+
+struct Node {
+    rcn_c::rbnode rbnode_;
+    rcn_c::avlnode avlnode_;
+};
+
+static int NameCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const Entry *)_ke;
+    auto in_tree = (const Entry *)_in_tree;
+
+    return strcmp(ke->name_, in_tree->name_);
+}
+
+static uint64_t NamePrefix(const void *_e)
+{
+    auto e = (const Entry *)_e;
+    uint64_t key = 0;
+
+    for (size_t i = 0; i < 8; i++) {
+        key = (key << 8) | (unsigned char)e->name_[i];
+    }
+
+    return key;
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point t0, size_t n)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+/* Random lookups of 16 byte names, with and without the key prefix. */
+int main(int argc, char **argv)
+{
+    const size_t nr_entries = 1000000;
+    std::vector<Entry> entries(nr_entries);
+    std::vector<Node> nodes(nr_entries);
+    std::vector<Entry *> order(nr_entries);
+    std::mt19937 gen(42);
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        for (size_t j = 0; j < 16; j++) {
+            entries[i].name_[j] = 'a' + gen() % 26;
+        }
+
+        entries[i].name_[16] = '\0';
+        order[i] = &entries[i];
+    }
+
+    std::shuffle(order.begin(), order.end(), gen);
+
+    for (bool keyed : { false, true }) {
+        const char *mode = keyed ? "keyed" : "plain";
+        rcn_c::rbtree rbtree;
+        rcn_c::avltree avltree;
+        size_t nr_found = 0;
+
+        rcn_c::rbtree_init_keyed(&rbtree, NameCompare,
+                                 keyed ? NamePrefix : NULL);
+        rcn_c::avltree_init_keyed(&avltree, NameCompare,
+                                  keyed ? NamePrefix : NULL);
+
+        for (size_t i = 0; i < nr_entries; i++) {
+            rcn_c::rbtree_insert(&rbtree, &nodes[i].rbnode_, order[i]);
+            rcn_c::avltree_insert(&avltree, &nodes[i].avlnode_, order[i]);
+        }
+
+        std::shuffle(order.begin(), order.end(), gen);
+
+        auto t0 = std::chrono::steady_clock::now();
+
+        for (Entry *e : order) {
+            nr_found += !rcn_c::rbnode_is_nil(rcn_c::rbtree_find(&rbtree, e));
+        }
+
+        printf("rbtree  find %s : %8.1f ns/op\n", mode,
+               Elapsed(t0, nr_entries));
+
+        t0 = std::chrono::steady_clock::now();
+
+        for (Entry *e : order) {
+            nr_found += rcn_c::avltree_find(&avltree, e) != NULL;
+        }
+
+        printf("avltree find %s : %8.1f ns/op\n", mode,
+               Elapsed(t0, nr_entries));
+
+        if (nr_found != 2 * nr_entries) {
+            printf("MISSING %zu\n", 2 * nr_entries - nr_found);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "rcn_c/avltree.h"
+#include "rcn_c/rbtree.h"
+
+struct TestData {
+    rcn_c::rbnode rbnode_;
+    rcn_c::avlnode avlnode_;
+    long value_;
+};
+
+static int ValueCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_tree = (const TestData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+static void Sum(void *e, void *arg)
+{
+    *(long *)arg += ((TestData *)e)->value_;
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point t0, size_t n)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+/*
+ * Time windows of 'window' entries over 1M timestamps : visited with a
+ * lower_bound + next loop or the range visitor, then dropped one erase at
+ * a time or cut out at once. Times are per entry.
+ */
+int main(int argc, char **argv)
+{
+    const size_t nr_entries = 1000000;
+    const size_t window = 1000;
+    std::vector<TestData> data(nr_entries);
+    rcn_c::rbtree rbtree, rbout;
+    rcn_c::avltree avltree, avlout;
+    TestData lo, hi;
+    long sum = 0;
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        data[i].value_ = i;
+    }
+
+    rcn_c::rbtree_init(&rbtree, ValueCompare);
+    rcn_c::rbtree_init(&rbout, ValueCompare);
+    rcn_c::avltree_init(&avltree, ValueCompare);
+    rcn_c::avltree_init(&avlout, ValueCompare);
+
+    for (auto &d : data) {
+        rcn_c::rbtree_insert(&rbtree, &d.rbnode_, &d);
+        rcn_c::avltree_insert(&avltree, &d.avlnode_, &d);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < nr_entries; i += window) {
+        lo.value_ = i;
+        hi.value_ = i + window;
+
+        for (auto x = rcn_c::rbtree_lower_bound(&rbtree, &lo);
+             (x != rcn_c::rbtree_end(&rbtree)) &&
+             (ValueCompare(&hi, x->entry_) > 0);
+             x = rcn_c::rbtree_next(&rbtree, x)) {
+            Sum(x->entry_, &sum);
+        }
+    }
+
+    printf("rbtree  next loop      : %6.1f ns/entry\n",
+           Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < nr_entries; i += window) {
+        lo.value_ = i;
+        hi.value_ = i + window;
+        rcn_c::rbtree_for_each_range(&rbtree, &lo, &hi, Sum, &sum);
+    }
+
+    printf("rbtree  for_each_range : %6.1f ns/entry (sum %ld)\n",
+           Elapsed(t0, nr_entries), sum);
+
+    /* The first half one erase at a time, the second half by ranges. */
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < nr_entries / 2; i += window) {
+        lo.value_ = i;
+        hi.value_ = i + window;
+
+        for (auto x = rcn_c::rbtree_lower_bound(&rbtree, &lo);
+             (x != rcn_c::rbtree_end(&rbtree)) &&
+             (ValueCompare(&hi, x->entry_) > 0);) {
+            auto next = rcn_c::rbtree_next(&rbtree, x);
+
+            rcn_c::rbtree_erase(&rbtree, x);
+            x = next;
+        }
+    }
+
+    printf("rbtree  erase loop     : %6.1f ns/entry\n",
+           Elapsed(t0, nr_entries / 2));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = nr_entries / 2; i < nr_entries; i += window) {
+        lo.value_ = i;
+        hi.value_ = i + window;
+        rcn_c::rbtree_erase_range(&rbtree, &lo, &hi, &rbout);
+    }
+
+    printf("rbtree  erase_range    : %6.1f ns/entry\n",
+           Elapsed(t0, nr_entries / 2));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < nr_entries / 2; i += window) {
+        lo.value_ = i;
+        hi.value_ = i + window;
+
+        for (auto x = rcn_c::avltree_lower_bound(&avltree, &lo);
+             (x != rcn_c::avltree_end(&avltree)) &&
+             (ValueCompare(&hi, x->entry_) > 0);) {
+            auto next = rcn_c::avltree_next(&avltree, x);
+
+            rcn_c::avltree_erase(&avltree, x);
+            x = next;
+        }
+    }
+
+    printf("avltree erase loop     : %6.1f ns/entry\n",
+           Elapsed(t0, nr_entries / 2));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = nr_entries / 2; i < nr_entries; i += window) {
+        lo.value_ = i;
+        hi.value_ = i + window;
+        rcn_c::avltree_erase_range(&avltree, &lo, &hi, &avlout);
+    }
+
+    printf("avltree erase_range    : %6.1f ns/entry\n",
+           Elapsed(t0, nr_entries / 2));
+
+    if (!rcn_c::rbtree_empty(&rbtree) || !rcn_c::avltree_empty(&avltree)) {
+        printf("NOT EMPTY\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "rcn_c/avltree.h"
+#include "rcn_c/rbtree.h"
+
+struct TestData {
+    rcn_c::rbnode rbnode_;
+    rcn_c::avlnode avlnode_;
+    int value_;
+};
+
+static int ValueCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_tree = (const TestData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point t0, size_t n)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t nr_entries = 1000000;
+    const size_t nr_queries = 1000000;
+    const size_t nr_walks = 100;
+    const double percentile[] = { 0.50, 0.90, 0.99, 0.999 };
+    std::vector<TestData> data(nr_entries);
+    std::vector<size_t> rank(nr_queries);
+    std::mt19937 gen(0);
+    rcn_c::rbtree rbtree;
+    rcn_c::avltree avltree;
+    size_t sink = 0;
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        data[i].value_ = i;
+    }
+
+    std::shuffle(data.begin(), data.end(), gen);
+
+    for (auto &r : rank) {
+        r = percentile[gen() % 4] * nr_entries;
+    }
+
+    rcn_c::rbtree_init(&rbtree, ValueCompare);
+    rcn_c::avltree_init(&avltree, ValueCompare);
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (auto &d : data) {
+        rcn_c::rbtree_insert(&rbtree, &d.rbnode_, &d);
+    }
+
+    printf("rbtree  insert        : %10.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto &d : data) {
+        rcn_c::avltree_insert(&avltree, &d.avlnode_, &d);
+    }
+
+    printf("avltree insert        : %10.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto r : rank) {
+        sink += ((TestData *)rcn_c::rbtree_at(&rbtree, r))->value_;
+    }
+
+    printf("rbtree  at            : %10.1f ns/op\n", Elapsed(t0, nr_queries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto r : rank) {
+        sink += ((TestData *)rcn_c::avltree_at(&avltree, r))->value_;
+    }
+
+    printf("avltree at            : %10.1f ns/op\n", Elapsed(t0, nr_queries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto r : rank) {
+        TestData key;
+
+        key.value_ = r;
+        sink += rcn_c::rbtree_rank(&rbtree, &key);
+    }
+
+    printf("rbtree  rank          : %10.1f ns/op\n", Elapsed(t0, nr_queries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (auto r : rank) {
+        TestData key;
+
+        key.value_ = r;
+        sink += rcn_c::avltree_rank(&avltree, &key);
+    }
+
+    printf("avltree rank          : %10.1f ns/op\n", Elapsed(t0, nr_queries));
+
+    /* What rbtree_at() used to do : walk next() n times. */
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < nr_walks; i++) {
+        rcn_c::rbnode *x = rcn_c::rbtree_begin(&rbtree);
+
+        for (size_t n = rank[i]; n != 0; --n) {
+            x = rcn_c::rbtree_next(&rbtree, x);
+        }
+
+        sink += ((TestData *)x->entry_)->value_;
+    }
+
+    printf("rbtree  begin + next  : %10.1f ns/op\n", Elapsed(t0, nr_walks));
+    printf("(%zu)\n", sink % 10);
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "rcn_c/avltree_set.h"
+#include "rcn_c/rbtree_set.h"
+
+struct TestData {
+    rcn_c::rbnode rbnode_;
+    rcn_c::avlnode avlnode_;
+    int value_;
+};
+
+static int ValueCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_tree = (const TestData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point t0)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+/* 'a' holds the multiples of 2, 'b' the multiples of 'step'. */
+static void Fill(rcn_c::rbtree *ra, rcn_c::rbtree *rb, rcn_c::avltree *aa,
+                 rcn_c::avltree *ab, std::vector<TestData> &a,
+                 std::vector<TestData> &b, int step)
+{
+    for (size_t i = 0; i < a.size(); i++) {
+        a[i].value_ = i * 2;
+        rcn_c::rbtree_insert(ra, &a[i].rbnode_, &a[i]);
+        rcn_c::avltree_insert(aa, &a[i].avlnode_, &a[i]);
+    }
+
+    for (size_t i = 0; i < b.size(); i++) {
+        b[i].value_ = i * step;
+        rcn_c::rbtree_insert(rb, &b[i].rbnode_, &b[i]);
+        rcn_c::avltree_insert(ab, &b[i].avlnode_, &b[i]);
+    }
+}
+
+static void Run(size_t nr_a, size_t nr_b, int step)
+{
+    std::vector<TestData> a(nr_a), b(nr_b);
+    rcn_c::rbtree ra, rb, rrest;
+    rcn_c::avltree aa, ab, arest;
+
+    rcn_c::rbtree_init(&ra, ValueCompare);
+    rcn_c::rbtree_init(&rb, ValueCompare);
+    rcn_c::rbtree_init(&rrest, ValueCompare);
+    rcn_c::avltree_init(&aa, ValueCompare);
+    rcn_c::avltree_init(&ab, ValueCompare);
+    rcn_c::avltree_init(&arest, ValueCompare);
+
+    printf("union of %zu and %zu entries\n", nr_a, nr_b);
+    Fill(&ra, &rb, &aa, &ab, a, b, step);
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    while (!rcn_c::rbtree_empty(&rb)) {
+        auto d = (TestData *)rcn_c::rbtree_pop_front(&rb);
+
+        rcn_c::rbtree_insert(&ra, &d->rbnode_, d);
+    }
+
+    printf("  rbtree  pop + insert : %8.1f ms\n", Elapsed(t0));
+
+    t0 = std::chrono::steady_clock::now();
+
+    while (!rcn_c::avltree_empty(&ab)) {
+        auto d = (TestData *)rcn_c::avltree_pop_front(&ab);
+
+        rcn_c::avltree_insert(&aa, &d->avlnode_, d);
+    }
+
+    printf("  avltree pop + insert : %8.1f ms\n", Elapsed(t0));
+
+    rcn_c::rbtree_clear(&ra);
+    rcn_c::avltree_clear(&aa);
+    Fill(&ra, &rb, &aa, &ab, a, b, step);
+
+    t0 = std::chrono::steady_clock::now();
+    rcn_c::rbtree_union(&ra, &rb, &rrest);
+    printf("  rbtree  union        : %8.1f ms\n", Elapsed(t0));
+
+    t0 = std::chrono::steady_clock::now();
+    rcn_c::avltree_union(&aa, &ab, &arest);
+    printf("  avltree union        : %8.1f ms\n", Elapsed(t0));
+}
+
+int main(int argc, char **argv)
+{
+    /* Interleaved sets of the same size, then a small set into a large. */
+    Run(1000000, 1000000, 3);
+    Run(1000000, 10000, 201);
+
+    return 0;
+}
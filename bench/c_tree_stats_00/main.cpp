@@ -0,0 +1,203 @@
+#define AVLTREE_STATS
+#define BSTREE_SCAPEGOAT
+#define BSTREE_STATS
+#define RBTREE_STATS
+#define SPLTREE_STATS
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "rcn_c/avltree.h"
+#include "rcn_c/bstree.h"
+#include "rcn_c/rbtree.h"
+#include "rcn_c/spltree.h"
+
+struct TestData {
+    rcn_c::bsnode bsnode_;
+    rcn_c::rbnode rbnode_;
+    rcn_c::avlnode avlnode_;
+    rcn_c::splnode splnode_;
+    int value_;
+};
+
+static int ValueCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_tree = (const TestData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point t0, size_t n)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+#define DEFINE_STATS_OF(_tree)                                                \
+    static const rcn_c::tree_stats *stats_of(rcn_c::_tree *tree)              \
+    {                                                                         \
+        return rcn_c::_tree##_stats(tree);                                    \
+    }                                                                         \
+                                                                              \
+    static void stats_reset(rcn_c::_tree *tree)                               \
+    {                                                                         \
+        rcn_c::_tree##_stats_reset(tree);                                     \
+    }                                                                         \
+                                                                              \
+    static size_t depth_histogram(rcn_c::_tree *tree, size_t hist[],          \
+                                  size_t nr)                                  \
+    {                                                                         \
+        return rcn_c::_tree##_depth_histogram(tree, hist, nr);                \
+    }
+
+DEFINE_STATS_OF(bstree)
+DEFINE_STATS_OF(avltree)
+DEFINE_STATS_OF(rbtree)
+DEFINE_STATS_OF(spltree)
+
+/*
+ * Inserts in 'order', looks each entry up at random, then erases half of
+ * them, printing what the counters of each phase come to per operation.
+ */
+template <typename Tree, typename Insert, typename Find, typename Erase>
+static void Run(const char *name, Tree *tree, std::vector<TestData> &data,
+                const std::vector<int> &order, const std::vector<int> &lookup,
+                Insert insert, Find find, Erase erase)
+{
+    const rcn_c::tree_stats *stats = stats_of(tree);
+    size_t height, sum = 0, n = order.size();
+    std::vector<size_t> hist(n);
+
+    stats_reset(tree);
+
+    for (int i : order) {
+        insert(&data[i]);
+    }
+
+    printf("  %-7s : insert %5.1f compars %5.2f rotations %5.2f fixups %5.2f "
+           "rebuilt", name, (double)stats->nr_insert_compars_ / n,
+           (double)stats->nr_rotations_ / n, (double)stats->nr_fixups_ / n,
+           (double)stats->nr_rebuilt_ / n);
+
+    height = depth_histogram(tree, hist.data(), n);
+
+    for (size_t d = 0; d < height; d++) {
+        sum += d * hist[d];
+    }
+
+    stats_reset(tree);
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (int i : lookup) {
+        find(&data[i]);
+    }
+
+    double t_find = Elapsed(t0, lookup.size());
+
+    printf(", depth %5.2f avg %3zu max\n"
+           "            find %5.1f compars %5.2f rotations (%6.1f ns), ",
+           (double)sum / n, height - 1,
+           (double)stats->nr_find_compars_ / stats->nr_finds_,
+           (double)stats->nr_rotations_ / stats->nr_finds_, t_find);
+
+    stats_reset(tree);
+
+    for (size_t i = 0; i < lookup.size() / 2; i++) {
+        erase(&data[lookup[i]]);
+    }
+
+    printf("erase %5.2f rotations %5.2f fixups\n",
+           (double)stats->nr_rotations_ / stats->nr_erases_,
+           (double)stats->nr_fixups_ / stats->nr_erases_);
+
+    for (size_t i = lookup.size() / 2; i < lookup.size(); i++) {
+        erase(&data[lookup[i]]);
+    }
+}
+
+static void RunAll(const char *title, std::vector<TestData> &data,
+                   const std::vector<int> &order,
+                   const std::vector<int> &lookup)
+{
+    rcn_c::bstree bstree;
+    rcn_c::avltree avltree;
+    rcn_c::rbtree rbtree;
+    rcn_c::spltree spltree;
+
+    rcn_c::bstree_init(&bstree, ValueCompare);
+    rcn_c::avltree_init(&avltree, ValueCompare);
+    rcn_c::rbtree_init(&rbtree, ValueCompare);
+    rcn_c::spltree_init(&spltree, ValueCompare);
+
+    printf("%s, %zu entries\n", title, order.size());
+
+    Run(
+        "bstree", &bstree, data, order, lookup,
+        [&](TestData *d) { rcn_c::bstree_insert(&bstree, &d->bsnode_, d); },
+        [&](TestData *d) { return rcn_c::bstree_find(&bstree, d) != NULL; },
+        [&](TestData *d) { rcn_c::bstree_erase(&bstree, &d->bsnode_); });
+    Run(
+        "avltree", &avltree, data, order, lookup,
+        [&](TestData *d) { rcn_c::avltree_insert(&avltree, &d->avlnode_, d); },
+        [&](TestData *d) { return rcn_c::avltree_find(&avltree, d) != NULL; },
+        [&](TestData *d) { rcn_c::avltree_erase(&avltree, &d->avlnode_); });
+    Run(
+        "rbtree", &rbtree, data, order, lookup,
+        [&](TestData *d) { rcn_c::rbtree_insert(&rbtree, &d->rbnode_, d); },
+        [&](TestData *d) {
+            return !rcn_c::rbnode_is_nil(rcn_c::rbtree_find(&rbtree, d));
+        },
+        [&](TestData *d) { rcn_c::rbtree_erase(&rbtree, &d->rbnode_); });
+    Run(
+        "spltree", &spltree, data, order, lookup,
+        [&](TestData *d) { rcn_c::spltree_insert(&spltree, &d->splnode_, d); },
+        [&](TestData *d) { return rcn_c::spltree_find(&spltree, d) != NULL; },
+        [&](TestData *d) { rcn_c::spltree_erase(&spltree, &d->splnode_); });
+}
+
+/* Usage : main [nr_entries], 1M by default. */
+int main(int argc, char **argv)
+{
+    const size_t nr_entries = argc > 1 ? atol(argv[1]) : 1000000;
+    std::vector<TestData> data(nr_entries);
+    std::vector<int> sorted(nr_entries), shuffled;
+    std::mt19937 gen(47);
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        data[i].value_ = i;
+    }
+
+    std::iota(sorted.begin(), sorted.end(), 0);
+    shuffled = sorted;
+    std::shuffle(shuffled.begin(), shuffled.end(), gen);
+
+    RunAll("random inserts", data, shuffled, shuffled);
+    RunAll("sorted inserts", data, sorted, shuffled);
+
+    /* What a scraper gets, for a small tree. */
+    rcn_c::rbtree rbtree;
+    size_t hist[12];
+    char buf[4096];
+
+    rcn_c::rbtree_init(&rbtree, ValueCompare);
+
+    for (size_t i = 0; i < std::min<size_t>(nr_entries, 1000); i++) {
+        rcn_c::rbtree_insert(&rbtree, &data[shuffled[i]].rbnode_,
+                             &data[shuffled[i]]);
+    }
+
+    rcn_c::rbtree_depth_histogram(&rbtree, hist, 12);
+    rcn_c::tree_stats_format(buf, sizeof(buf), "sample",
+                             rcn_c::rbtree_stats(&rbtree), hist, 12);
+    printf("\n%s", buf);
+
+    return 0;
+}
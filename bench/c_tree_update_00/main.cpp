@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "rcn_c/avltree.h"
+#include "rcn_c/rbtree.h"
+
+struct TestData {
+    rcn_c::rbnode rbnode_;
+    rcn_c::avlnode avlnode_;
+    int value_;
+};
+
+static int ValueCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const TestData *)_ke;
+    auto in_tree = (const TestData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point t0, size_t n)
+{
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+/* Random order inserts and erases, then a steady erase + insert churn. */
+int main(int argc, char **argv)
+{
+    const size_t nr_entries = 1000000;
+    std::vector<TestData> data(nr_entries);
+    std::vector<size_t> order(nr_entries);
+    std::mt19937 gen(38);
+    rcn_c::rbtree rbtree;
+    rcn_c::avltree avltree;
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        data[i].value_ = i;
+        order[i] = i;
+    }
+
+    std::shuffle(order.begin(), order.end(), gen);
+
+    rcn_c::rbtree_init(&rbtree, ValueCompare);
+    rcn_c::avltree_init(&avltree, ValueCompare);
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (size_t i : order) {
+        rcn_c::rbtree_insert(&rbtree, &data[i].rbnode_, &data[i]);
+    }
+
+    printf("rbtree  insert : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i : order) {
+        rcn_c::avltree_insert(&avltree, &data[i].avlnode_, &data[i]);
+    }
+
+    printf("avltree insert : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    std::shuffle(order.begin(), order.end(), gen);
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        TestData *d = &data[order[i]];
+
+        rcn_c::rbtree_erase(&rbtree, &d->rbnode_);
+        rcn_c::rbtree_insert(&rbtree, &d->rbnode_, d);
+    }
+
+    printf("rbtree  churn  : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < nr_entries; i++) {
+        TestData *d = &data[order[i]];
+
+        rcn_c::avltree_erase(&avltree, &d->avlnode_);
+        rcn_c::avltree_insert(&avltree, &d->avlnode_, d);
+    }
+
+    printf("avltree churn  : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    std::shuffle(order.begin(), order.end(), gen);
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i : order) {
+        rcn_c::rbtree_erase(&rbtree, &data[i].rbnode_);
+    }
+
+    printf("rbtree  erase  : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    t0 = std::chrono::steady_clock::now();
+
+    for (size_t i : order) {
+        rcn_c::avltree_erase(&avltree, &data[i].avlnode_);
+    }
+
+    printf("avltree erase  : %8.1f ns/op\n", Elapsed(t0, nr_entries));
+
+    return 0;
+}
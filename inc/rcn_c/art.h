@@ -0,0 +1,1087 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ *
+ * Reference : V. Leis, A. Kemper, T. Neumann, "The Adaptive Radix Tree:
+ *             ARTful Indexing for Main-Memory Databases", ICDE 2013
+ */
+
+/* Adaptive Radix Tree */
+#ifndef __RCN_C_ART_H__
+#define __RCN_C_ART_H__
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/*
+ * An ordered map of byte string keys, looked up one byte per level without
+ * calling compar. Keys are ordered byte by byte as unsigned, and no key may
+ * be a proper prefix of another : C strings are keyed with their
+ * terminating NUL, integers with their big endian bytes (art_key_u64()).
+ *
+ * Entries are linked through an artleaf embedded in them, and key_of(e,
+ * &len) gives the key of an entry. Inner nodes are allocated by the tree,
+ * with 4, 16, 48 or 256 children as needed. A failed allocation fails
+ * art_insert() with -ENOMEM and leaves the tree unchanged. art_erase()
+ * never fails : a node that cannot be shrunk is kept as it is.
+ *
+ * A chain of nodes with a single child is collapsed into the path of the
+ * node below it. Only the first ART_PREFIX_MAX bytes of a path are kept in
+ * the node, the rest are read from a leaf below when needed.
+ */
+#ifndef ART_PREFIX_MAX
+#define ART_PREFIX_MAX 8
+#endif /* ART_PREFIX_MAX */
+
+enum art_type {
+    ART_NODE4 = 0,
+    ART_NODE16,
+    ART_NODE48,
+    ART_NODE256,
+};
+
+struct artleaf {
+    void *entry_;
+};
+
+/* A child is either an inner node or an artleaf tagged with bit 0. */
+struct artnode {
+    uint8_t type_;
+    uint16_t nr_children_;
+    uint32_t prefix_len_;
+    uint8_t prefix_[ART_PREFIX_MAX];
+};
+
+struct artnode4 {
+    struct artnode node_;
+    uint8_t key_[4];
+    struct artnode *child_[4];
+};
+
+struct artnode16 {
+    struct artnode node_;
+    uint8_t key_[16];
+    struct artnode *child_[16];
+};
+
+/* index_[c] is 1 + the slot of the child for the byte 'c', 0 if none. */
+struct artnode48 {
+    struct artnode node_;
+    uint8_t index_[256];
+    struct artnode *child_[48];
+};
+
+struct artnode256 {
+    struct artnode node_;
+    struct artnode *child_[256];
+};
+
+struct art {
+    struct artnode *root_;
+    const void *(*key_of_)(const void *e, size_t *len);
+    size_t size_;
+};
+
+#define __ART_NODE(type, x) ((struct type *)(x))
+
+static inline bool __art_is_leaf(const struct artnode *x)
+{
+    return (uintptr_t)x & 1;
+}
+
+static inline struct artleaf *__art_leaf(const struct artnode *x)
+{
+    return (struct artleaf *)((uintptr_t)x & ~(uintptr_t)1);
+}
+
+static inline struct artnode *__art_tag(struct artleaf *z)
+{
+    return (struct artnode *)((uintptr_t)z | 1);
+}
+
+static inline const uint8_t *__art_key(const struct art *self,
+                                       const struct artleaf *z, size_t *len)
+{
+    return (const uint8_t *)self->key_of_(z->entry_, len);
+}
+
+static inline int __art_compare(const uint8_t *a, size_t alen,
+                                const uint8_t *b, size_t blen)
+{
+    int r = memcmp(a, b, alen < blen ? alen : blen);
+
+    if (r != 0) {
+        return r;
+    }
+
+    return (alen > blen) - (alen < blen);
+}
+
+/* Big endian bytes of 'v', ordered as the integers. */
+static inline void art_key_u64(uint8_t key[8], uint64_t v)
+{
+    for (int i = 7; i >= 0; i--) {
+        key[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+static inline struct artnode *__artnode_alloc(enum art_type type)
+{
+    static const size_t size[] = {
+        sizeof(struct artnode4),
+        sizeof(struct artnode16),
+        sizeof(struct artnode48),
+        sizeof(struct artnode256),
+    };
+    struct artnode *x = (struct artnode *)calloc(1, size[type]);
+
+    if (x != NULL) {
+        x->type_ = type;
+    }
+
+    return x;
+}
+
+/* Moves the header of 'x' to its replacement 'y'. */
+static inline void __artnode_copy_header(struct artnode *y,
+                                         const struct artnode *x)
+{
+    y->nr_children_ = x->nr_children_;
+    y->prefix_len_ = x->prefix_len_;
+    memcpy(y->prefix_, x->prefix_, sizeof(y->prefix_));
+}
+
+static inline uint32_t __artnode_prefix_stored(const struct artnode *x)
+{
+    return x->prefix_len_ < ART_PREFIX_MAX ? x->prefix_len_ : ART_PREFIX_MAX;
+}
+
+/* Slot of the key byte 'c' in a Node16, -1 if none. */
+static inline int __artnode16_find(const struct artnode16 *x, uint8_t c)
+{
+#ifdef __SSE2__
+    __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8((char)c),
+                                 _mm_loadu_si128((const __m128i *)x->key_));
+    unsigned int mask = (unsigned int)_mm_movemask_epi8(cmp) &
+                        ((1U << x->node_.nr_children_) - 1);
+
+    return mask != 0 ? __builtin_ctz(mask) : -1;
+#else
+    for (unsigned int i = 0; i < x->node_.nr_children_; i++) {
+        if (x->key_[i] == c) {
+            return i;
+        }
+    }
+
+    return -1;
+#endif
+}
+
+/* Slot of the first key byte above 'c' in a Node16, nr_children_ if none. */
+static inline unsigned int __artnode16_upper(const struct artnode16 *x,
+                                             uint8_t c)
+{
+#ifdef __SSE2__
+    /* There is no unsigned byte compare : flip the sign bits. */
+    const __m128i bias = _mm_set1_epi8((char)0x80);
+    __m128i gt = _mm_cmpgt_epi8(
+        _mm_xor_si128(_mm_loadu_si128((const __m128i *)x->key_), bias),
+        _mm_xor_si128(_mm_set1_epi8((char)c), bias));
+    unsigned int mask = (unsigned int)_mm_movemask_epi8(gt) &
+                        ((1U << x->node_.nr_children_) - 1);
+
+    return mask != 0 ? __builtin_ctz(mask) : x->node_.nr_children_;
+#else
+    unsigned int i;
+
+    for (i = 0; i < x->node_.nr_children_; i++) {
+        if (x->key_[i] > c) {
+            break;
+        }
+    }
+
+    return i;
+#endif
+}
+
+static inline struct artnode **__artnode_child(const struct artnode *x,
+                                               uint8_t c)
+{
+    int i;
+
+    switch (x->type_) {
+    case ART_NODE4:
+        for (i = 0; i < x->nr_children_; i++) {
+            if (__ART_NODE(artnode4, x)->key_[i] == c) {
+                return &__ART_NODE(artnode4, x)->child_[i];
+            }
+        }
+
+        return NULL;
+    case ART_NODE16:
+        i = __artnode16_find(__ART_NODE(artnode16, x), c);
+
+        return i >= 0 ? &__ART_NODE(artnode16, x)->child_[i] : NULL;
+    case ART_NODE48:
+        i = __ART_NODE(artnode48, x)->index_[c];
+
+        return i != 0 ? &__ART_NODE(artnode48, x)->child_[i - 1] : NULL;
+    default:
+        return __ART_NODE(artnode256, x)->child_[c] != NULL
+                   ? &__ART_NODE(artnode256, x)->child_[c]
+                   : NULL;
+    }
+}
+
+/*
+ * The child with the lowest key byte above 'c', from -1 for the first one,
+ * and its key byte in '*key'. NULL if none.
+ */
+static inline struct artnode *__artnode_after(const struct artnode *x, int c,
+                                              int *key)
+{
+    unsigned int i;
+
+    switch (x->type_) {
+    case ART_NODE4:
+        for (i = 0; i < x->nr_children_; i++) {
+            if (__ART_NODE(artnode4, x)->key_[i] > c) {
+                *key = __ART_NODE(artnode4, x)->key_[i];
+                return __ART_NODE(artnode4, x)->child_[i];
+            }
+        }
+
+        return NULL;
+    case ART_NODE16:
+        i = c < 0 ? 0 : __artnode16_upper(__ART_NODE(artnode16, x), c);
+
+        if (i == x->nr_children_) {
+            return NULL;
+        }
+
+        *key = __ART_NODE(artnode16, x)->key_[i];
+
+        return __ART_NODE(artnode16, x)->child_[i];
+    case ART_NODE48:
+        for (*key = c + 1; *key < 256; (*key)++) {
+            i = __ART_NODE(artnode48, x)->index_[*key];
+
+            if (i != 0) {
+                return __ART_NODE(artnode48, x)->child_[i - 1];
+            }
+        }
+
+        return NULL;
+    default:
+        for (*key = c + 1; *key < 256; (*key)++) {
+            if (__ART_NODE(artnode256, x)->child_[*key] != NULL) {
+                return __ART_NODE(artnode256, x)->child_[*key];
+            }
+        }
+
+        return NULL;
+    }
+}
+
+static inline struct artnode *__artnode_last(const struct artnode *x)
+{
+    int c;
+
+    switch (x->type_) {
+    case ART_NODE4:
+        return __ART_NODE(artnode4, x)->child_[x->nr_children_ - 1];
+    case ART_NODE16:
+        return __ART_NODE(artnode16, x)->child_[x->nr_children_ - 1];
+    case ART_NODE48:
+        for (c = 255; __ART_NODE(artnode48, x)->index_[c] == 0; c--) {
+        }
+
+        return __ART_NODE(artnode48, x)
+            ->child_[__ART_NODE(artnode48, x)->index_[c] - 1];
+    default:
+        for (c = 255; __ART_NODE(artnode256, x)->child_[c] == NULL; c--) {
+        }
+
+        return __ART_NODE(artnode256, x)->child_[c];
+    }
+}
+
+static inline struct artleaf *__art_minimum(const struct artnode *x)
+{
+    int c;
+
+    while (!__art_is_leaf(x)) {
+        x = __artnode_after(x, -1, &c);
+    }
+
+    return __art_leaf(x);
+}
+
+static inline struct artleaf *__art_maximum(const struct artnode *x)
+{
+    while (!__art_is_leaf(x)) {
+        x = __artnode_last(x);
+    }
+
+    return __art_leaf(x);
+}
+
+/*
+ * Number of bytes of the path of 'x' matching 'key' from 'depth'. The bytes
+ * not kept in the node are read from its leftmost leaf.
+ */
+static inline uint32_t __art_prefix_match(const struct art *self,
+                                          const struct artnode *x,
+                                          const uint8_t *key, size_t len,
+                                          size_t depth)
+{
+    uint32_t n = __artnode_prefix_stored(x), i;
+    const uint8_t *lkey;
+    size_t llen;
+
+    for (i = 0; i < n; i++) {
+        if ((depth + i >= len) || (key[depth + i] != x->prefix_[i])) {
+            return i;
+        }
+    }
+
+    if (x->prefix_len_ > ART_PREFIX_MAX) {
+        lkey = __art_key(self, __art_minimum(x), &llen);
+
+        for (; i < x->prefix_len_; i++) {
+            if ((depth + i >= len) || (key[depth + i] != lkey[depth + i])) {
+                return i;
+            }
+        }
+    }
+
+    return i;
+}
+
+/* The i-th byte of the path of 'x' at 'depth'. */
+static inline uint8_t __art_prefix_at(const struct art *self,
+                                      const struct artnode *x, size_t depth,
+                                      uint32_t i)
+{
+    size_t llen;
+
+    if (i < ART_PREFIX_MAX) {
+        return x->prefix_[i];
+    }
+
+    return __art_key(self, __art_minimum(x), &llen)[depth + i];
+}
+
+static inline void __artnode_free(struct artnode *x)
+{
+    struct artnode *y;
+    int c = -1;
+
+    if (__art_is_leaf(x)) {
+        return;
+    }
+
+    while ((y = __artnode_after(x, c, &c)) != NULL) {
+        __artnode_free(y);
+    }
+
+    free(x);
+}
+
+/* Frees the inner nodes. The entries are left as they are. */
+static inline void art_clear(struct art *self)
+{
+    if (self->root_ != NULL) {
+        __artnode_free(self->root_);
+    }
+
+    self->root_ = NULL;
+    self->size_ = 0;
+}
+
+static inline void art_init(struct art *self,
+                            const void *(*key_of)(const void *e, size_t *len))
+{
+    self->root_ = NULL;
+    self->key_of_ = key_of;
+    self->size_ = 0;
+}
+
+static inline size_t art_size(const struct art *self)
+{
+    return self->size_;
+}
+
+static inline bool art_empty(const struct art *self)
+{
+    return art_size(self) == 0;
+}
+
+static inline struct artleaf *art_find(const struct art *self,
+                                       const void *_key, size_t len)
+{
+    const uint8_t *key = (const uint8_t *)_key;
+    const struct artnode *x = self->root_;
+    struct artnode **slot;
+    const uint8_t *lkey;
+    size_t depth = 0, llen;
+    uint32_t n;
+
+    while (x != NULL) {
+        if (__art_is_leaf(x)) {
+            lkey = __art_key(self, __art_leaf(x), &llen);
+
+            return __art_compare(lkey, llen, key, len) == 0 ? __art_leaf(x)
+                                                            : NULL;
+        }
+
+        /* The bytes not kept in the node are checked at the leaf. */
+        n = __artnode_prefix_stored(x);
+
+        if ((depth + n > len) || (memcmp(&key[depth], x->prefix_, n) != 0)) {
+            return NULL;
+        }
+
+        depth += x->prefix_len_;
+
+        if (depth >= len) {
+            return NULL;
+        }
+
+        slot = __artnode_child(x, key[depth++]);
+        x = slot != NULL ? *slot : NULL;
+    }
+
+    return NULL;
+}
+
+static struct artleaf *__art_bound(const struct art *self,
+                                   const struct artnode *x,
+                                   const uint8_t *key, size_t len,
+                                   size_t depth, bool upper)
+{
+    struct artnode **slot, *y;
+    const uint8_t *lkey;
+    struct artleaf *z;
+    size_t llen;
+    uint32_t i;
+    int cmp, c;
+
+    if (__art_is_leaf(x)) {
+        lkey = __art_key(self, __art_leaf(x), &llen);
+        cmp = __art_compare(lkey, llen, key, len);
+
+        return (cmp > 0) || ((cmp == 0) && !upper) ? __art_leaf(x) : NULL;
+    }
+
+    i = __art_prefix_match(self, x, key, len, depth);
+
+    /* Parted in the path : the whole subtree is on one side of the key. */
+    if (i < x->prefix_len_) {
+        if ((depth + i >= len) ||
+            (key[depth + i] < __art_prefix_at(self, x, depth, i))) {
+            return __art_minimum(x);
+        }
+
+        return NULL;
+    }
+
+    depth += x->prefix_len_;
+
+    if (depth >= len) {
+        return __art_minimum(x);
+    }
+
+    if ((slot = __artnode_child(x, key[depth])) != NULL) {
+        z = __art_bound(self, *slot, key, len, depth + 1, upper);
+
+        if (z != NULL) {
+            return z;
+        }
+    }
+
+    y = __artnode_after(x, key[depth], &c);
+
+    return y != NULL ? __art_minimum(y) : NULL;
+}
+
+/* The first entry with a key not below 'key', NULL if none. */
+static inline struct artleaf *art_lower_bound(const struct art *self,
+                                              const void *key, size_t len)
+{
+    if (self->root_ == NULL) {
+        return NULL;
+    }
+
+    return __art_bound(self, self->root_, (const uint8_t *)key, len, 0,
+                       false);
+}
+
+/* The first entry with a key above 'key', NULL if none. */
+static inline struct artleaf *art_upper_bound(const struct art *self,
+                                              const void *key, size_t len)
+{
+    if (self->root_ == NULL) {
+        return NULL;
+    }
+
+    return __art_bound(self, self->root_, (const uint8_t *)key, len, 0,
+                       true);
+}
+
+static inline struct artleaf *art_begin(const struct art *self)
+{
+    return self->root_ != NULL ? __art_minimum(self->root_) : NULL;
+}
+
+static inline struct artleaf *art_rbegin(const struct art *self)
+{
+    return self->root_ != NULL ? __art_maximum(self->root_) : NULL;
+}
+
+static inline const struct artleaf *art_end(const struct art *self)
+{
+    return NULL;
+}
+
+/* There are no parent links : a step is a lookup of the key of 'z'. */
+static inline struct artleaf *art_next(const struct art *self,
+                                       const struct artleaf *z)
+{
+    size_t len;
+    const uint8_t *key = __art_key(self, z, &len);
+
+    return art_upper_bound(self, key, len);
+}
+
+static size_t __art_for_each(const struct artnode *x,
+                             void (*fn)(void *e, void *arg), void *arg)
+{
+    struct artnode *y;
+    size_t n = 0;
+    int c = -1;
+
+    if (__art_is_leaf(x)) {
+        fn(__art_leaf(x)->entry_, arg);
+        return 1;
+    }
+
+    while ((y = __artnode_after(x, c, &c)) != NULL) {
+        n += __art_for_each(y, fn, arg);
+    }
+
+    return n;
+}
+
+/*
+ * Calls 'fn' on every entry in order and returns their number. Cheaper than
+ * art_next() as the tree is walked once. 'fn' must not change the tree.
+ */
+static inline size_t art_for_each(const struct art *self,
+                                  void (*fn)(void *e, void *arg), void *arg)
+{
+    return self->root_ != NULL ? __art_for_each(self->root_, fn, arg) : 0;
+}
+
+/* Adds 'y' for the key byte 'c' to '*ref', grown into a new node if full. */
+static inline int __artnode_add(struct artnode **ref, uint8_t c,
+                                struct artnode *y)
+{
+    struct artnode *x = *ref, *grown;
+    struct artnode4 *x4 = __ART_NODE(artnode4, x);
+    struct artnode16 *x16 = __ART_NODE(artnode16, x);
+    struct artnode48 *x48 = __ART_NODE(artnode48, x);
+    unsigned int i, n = x->nr_children_;
+
+    switch (x->type_) {
+    case ART_NODE4:
+        if (n < 4) {
+            for (i = 0; (i < n) && (x4->key_[i] < c); i++) {
+            }
+
+            memmove(&x4->key_[i + 1], &x4->key_[i], n - i);
+            memmove(&x4->child_[i + 1], &x4->child_[i],
+                    (n - i) * sizeof(x4->child_[0]));
+            x4->key_[i] = c;
+            x4->child_[i] = y;
+            x->nr_children_++;
+
+            return 0;
+        }
+
+        if ((grown = __artnode_alloc(ART_NODE16)) == NULL) {
+            return -ENOMEM;
+        }
+
+        memcpy(__ART_NODE(artnode16, grown)->key_, x4->key_, n);
+        memcpy(__ART_NODE(artnode16, grown)->child_, x4->child_,
+               n * sizeof(x4->child_[0]));
+        break;
+    case ART_NODE16:
+        if (n < 16) {
+            i = __artnode16_upper(x16, c);
+            memmove(&x16->key_[i + 1], &x16->key_[i], n - i);
+            memmove(&x16->child_[i + 1], &x16->child_[i],
+                    (n - i) * sizeof(x16->child_[0]));
+            x16->key_[i] = c;
+            x16->child_[i] = y;
+            x->nr_children_++;
+
+            return 0;
+        }
+
+        if ((grown = __artnode_alloc(ART_NODE48)) == NULL) {
+            return -ENOMEM;
+        }
+
+        for (i = 0; i < n; i++) {
+            __ART_NODE(artnode48, grown)->index_[x16->key_[i]] = i + 1;
+            __ART_NODE(artnode48, grown)->child_[i] = x16->child_[i];
+        }
+
+        break;
+    case ART_NODE48:
+        if (n < 48) {
+            /* Erasing leaves holes : take the first free slot. */
+            for (i = 0; x48->child_[i] != NULL; i++) {
+            }
+
+            x48->child_[i] = y;
+            x48->index_[c] = i + 1;
+            x->nr_children_++;
+
+            return 0;
+        }
+
+        if ((grown = __artnode_alloc(ART_NODE256)) == NULL) {
+            return -ENOMEM;
+        }
+
+        for (i = 0; i < 256; i++) {
+            if (x48->index_[i] != 0) {
+                __ART_NODE(artnode256, grown)->child_[i] =
+                    x48->child_[x48->index_[i] - 1];
+            }
+        }
+
+        break;
+    default:
+        __ART_NODE(artnode256, x)->child_[c] = y;
+        x->nr_children_++;
+
+        return 0;
+    }
+
+    __artnode_copy_header(grown, x);
+    free(x);
+    *ref = grown;
+
+    return __artnode_add(ref, c, y);
+}
+
+static int __art_insert(struct art *self, struct artnode **ref,
+                        struct artleaf *z, const uint8_t *key, size_t len,
+                        size_t depth)
+{
+    struct artnode *x = *ref, *y, **slot;
+    const uint8_t *lkey;
+    size_t i, llen;
+    uint32_t n, rest;
+    uint8_t c;
+
+    if (__art_is_leaf(x)) {
+        lkey = __art_key(self, __art_leaf(x), &llen);
+
+        for (i = depth; (i < len) && (i < llen) && (key[i] == lkey[i]); i++) {
+        }
+
+        if ((i == len) && (i == llen)) {
+            return -EEXIST;
+        }
+
+        if ((i == len) || (i == llen)) {
+            return -EINVAL;
+        }
+
+        /* Lazy expansion : a new Node4 over both leaves, where they part. */
+        if ((y = __artnode_alloc(ART_NODE4)) == NULL) {
+            return -ENOMEM;
+        }
+
+        y->prefix_len_ = i - depth;
+        memcpy(y->prefix_, &key[depth], __artnode_prefix_stored(y));
+        __artnode_add(&y, lkey[i], x);
+        __artnode_add(&y, key[i], __art_tag(z));
+        *ref = y;
+
+        return 0;
+    }
+
+    n = __art_prefix_match(self, x, key, len, depth);
+
+    if (n < x->prefix_len_) {
+        if (depth + n >= len) {
+            return -EINVAL;
+        }
+
+        if ((y = __artnode_alloc(ART_NODE4)) == NULL) {
+            return -ENOMEM;
+        }
+
+        /* 'x' keeps the rest of its path, past the byte that parts them. */
+        y->prefix_len_ = n;
+        memcpy(y->prefix_, x->prefix_, __artnode_prefix_stored(y));
+
+        rest = x->prefix_len_ - n - 1;
+
+        if (x->prefix_len_ <= ART_PREFIX_MAX) {
+            c = x->prefix_[n];
+            memmove(x->prefix_, &x->prefix_[n + 1], rest);
+        } else {
+            lkey = __art_key(self, __art_minimum(x), &llen);
+            c = lkey[depth + n];
+            memcpy(x->prefix_, &lkey[depth + n + 1],
+                   rest < ART_PREFIX_MAX ? rest : ART_PREFIX_MAX);
+        }
+
+        x->prefix_len_ = rest;
+        __artnode_add(&y, c, x);
+        __artnode_add(&y, key[depth + n], __art_tag(z));
+        *ref = y;
+
+        return 0;
+    }
+
+    depth += x->prefix_len_;
+
+    if (depth >= len) {
+        return -EINVAL;
+    }
+
+    if ((slot = __artnode_child(x, key[depth])) != NULL) {
+        return __art_insert(self, slot, z, key, len, depth + 1);
+    }
+
+    return __artnode_add(ref, key[depth], __art_tag(z));
+}
+
+/*
+ * Returns -EEXIST if the key of 'e' is in the tree, -EINVAL if it is a
+ * proper prefix of a key in the tree or the other way around, -ENOMEM.
+ */
+static inline int art_insert(struct art *self, struct artleaf *z, void *e)
+{
+    const uint8_t *key;
+    size_t len;
+    int err;
+
+    z->entry_ = e;
+    key = __art_key(self, z, &len);
+
+    if (self->root_ == NULL) {
+        self->root_ = __art_tag(z);
+        self->size_++;
+
+        return 0;
+    }
+
+    if ((err = __art_insert(self, &self->root_, z, key, len, 0)) == 0) {
+        self->size_++;
+    }
+
+    return err;
+}
+
+/*
+ * Removes the child in 'slot' for the key byte 'c' from '*ref'. A Node4
+ * left with one child is replaced by it, the other nodes are shrunk when a
+ * quarter or so of their room is in use.
+ */
+static inline void __artnode_remove(struct artnode **ref, uint8_t c,
+                                    struct artnode **slot)
+{
+    struct artnode *x = *ref, *y, *shrunk = NULL;
+    struct artnode4 *x4 = __ART_NODE(artnode4, x);
+    struct artnode16 *x16 = __ART_NODE(artnode16, x);
+    struct artnode48 *x48 = __ART_NODE(artnode48, x);
+    struct artnode256 *x256 = __ART_NODE(artnode256, x);
+    uint8_t prefix[ART_PREFIX_MAX];
+    unsigned int i, n;
+
+    switch (x->type_) {
+    case ART_NODE4:
+        i = slot - x4->child_;
+        n = --x->nr_children_;
+        memmove(&x4->key_[i], &x4->key_[i + 1], n - i);
+        memmove(&x4->child_[i], &x4->child_[i + 1],
+                (n - i) * sizeof(x4->child_[0]));
+
+        if (n > 1) {
+            return;
+        }
+
+        /* The path of 'x', its key byte and the path of 'y', in 'y'. */
+        y = x4->child_[0];
+
+        if (!__art_is_leaf(y)) {
+            n = __artnode_prefix_stored(x);
+            memcpy(prefix, x->prefix_, n);
+
+            if (n < ART_PREFIX_MAX) {
+                prefix[n++] = x4->key_[0];
+            }
+
+            i = __artnode_prefix_stored(y);
+            memcpy(&prefix[n], y->prefix_,
+                   i < ART_PREFIX_MAX - n ? i : ART_PREFIX_MAX - n);
+            memcpy(y->prefix_, prefix, sizeof(prefix));
+            y->prefix_len_ += x->prefix_len_ + 1;
+        }
+
+        free(x);
+        *ref = y;
+
+        return;
+    case ART_NODE16:
+        i = slot - x16->child_;
+        n = --x->nr_children_;
+        memmove(&x16->key_[i], &x16->key_[i + 1], n - i);
+        memmove(&x16->child_[i], &x16->child_[i + 1],
+                (n - i) * sizeof(x16->child_[0]));
+
+        if ((n != 3) || ((shrunk = __artnode_alloc(ART_NODE4)) == NULL)) {
+            return;
+        }
+
+        memcpy(__ART_NODE(artnode4, shrunk)->key_, x16->key_, n);
+        memcpy(__ART_NODE(artnode4, shrunk)->child_, x16->child_,
+               n * sizeof(x16->child_[0]));
+        break;
+    case ART_NODE48:
+        *slot = NULL;
+        x48->index_[c] = 0;
+        n = --x->nr_children_;
+
+        if ((n != 12) || ((shrunk = __artnode_alloc(ART_NODE16)) == NULL)) {
+            return;
+        }
+
+        for (i = 0, n = 0; i < 256; i++) {
+            if (x48->index_[i] != 0) {
+                __ART_NODE(artnode16, shrunk)->key_[n] = i;
+                __ART_NODE(artnode16, shrunk)->child_[n++] =
+                    x48->child_[x48->index_[i] - 1];
+            }
+        }
+
+        break;
+    default:
+        *slot = NULL;
+        n = --x->nr_children_;
+
+        if ((n != 37) || ((shrunk = __artnode_alloc(ART_NODE48)) == NULL)) {
+            return;
+        }
+
+        for (i = 0, n = 0; i < 256; i++) {
+            if (x256->child_[i] != NULL) {
+                __ART_NODE(artnode48, shrunk)->index_[i] = n + 1;
+                __ART_NODE(artnode48, shrunk)->child_[n++] = x256->child_[i];
+            }
+        }
+
+        break;
+    }
+
+    __artnode_copy_header(shrunk, x);
+    free(x);
+    *ref = shrunk;
+}
+
+static struct artleaf *__art_remove(const struct art *self,
+                                    struct artnode **ref, const uint8_t *key,
+                                    size_t len, size_t depth)
+{
+    struct artnode *x = *ref, **slot;
+    const uint8_t *lkey;
+    struct artleaf *z;
+    size_t llen;
+    uint32_t n;
+
+    n = __artnode_prefix_stored(x);
+
+    if ((depth + n > len) || (memcmp(&key[depth], x->prefix_, n) != 0)) {
+        return NULL;
+    }
+
+    depth += x->prefix_len_;
+
+    if ((depth >= len) || ((slot = __artnode_child(x, key[depth])) == NULL)) {
+        return NULL;
+    }
+
+    if (!__art_is_leaf(*slot)) {
+        return __art_remove(self, slot, key, len, depth + 1);
+    }
+
+    z = __art_leaf(*slot);
+    lkey = __art_key(self, z, &llen);
+
+    if (__art_compare(lkey, llen, key, len) != 0) {
+        return NULL;
+    }
+
+    __artnode_remove(ref, key[depth], slot);
+
+    return z;
+}
+
+/* Removes the entry with 'key' and returns its node, NULL if none. */
+static inline struct artleaf *art_remove(struct art *self, const void *_key,
+                                         size_t len)
+{
+    const uint8_t *key = (const uint8_t *)_key;
+    const uint8_t *lkey;
+    struct artleaf *z;
+    size_t llen;
+
+    if (self->root_ == NULL) {
+        return NULL;
+    }
+
+    if (__art_is_leaf(self->root_)) {
+        z = __art_leaf(self->root_);
+        lkey = __art_key(self, z, &llen);
+
+        if (__art_compare(lkey, llen, key, len) != 0) {
+            return NULL;
+        }
+
+        self->root_ = NULL;
+    } else if ((z = __art_remove(self, &self->root_, key, len, 0)) == NULL) {
+        return NULL;
+    }
+
+    self->size_--;
+
+    return z;
+}
+
+static inline void *art_erase(struct art *self, struct artleaf *z)
+{
+    size_t len;
+    const uint8_t *key = __art_key(self, z, &len);
+
+    return art_remove(self, key, len) != NULL ? z->entry_ : NULL;
+}
+
+struct __art_check {
+    const struct art *self_;
+    const struct artleaf *prev_;
+    size_t size_;
+};
+
+static bool __art_validate(struct __art_check *check, const struct artnode *x,
+                           size_t depth)
+{
+    static const unsigned int room[] = { 4, 16, 48, 256 };
+    const struct art *self = check->self_;
+    const uint8_t *key, *lo, *hi;
+    size_t len, lo_len, hi_len;
+    struct artnode *y;
+    unsigned int n = 0;
+    int c = -1;
+
+    if (__art_is_leaf(x)) {
+        key = __art_key(self, __art_leaf(x), &len);
+
+        if (check->prev_ != NULL) {
+            lo = __art_key(self, check->prev_, &lo_len);
+
+            if (__art_compare(lo, lo_len, key, len) >= 0) {
+                return false;
+            }
+        }
+
+        check->prev_ = __art_leaf(x);
+        check->size_++;
+
+        return art_find(self, key, len) == __art_leaf(x);
+    }
+
+    if ((x->type_ > ART_NODE256) || (x->nr_children_ < 2) ||
+        (x->nr_children_ > room[x->type_])) {
+        return false;
+    }
+
+    /* In order, the leaves in between share the path as well. */
+    lo = __art_key(self, __art_minimum(x), &lo_len);
+    hi = __art_key(self, __art_maximum(x), &hi_len);
+
+    if ((lo_len <= depth + x->prefix_len_) ||
+        (hi_len <= depth + x->prefix_len_) ||
+        (memcmp(lo, hi, depth + x->prefix_len_) != 0) ||
+        (memcmp(&lo[depth], x->prefix_, __artnode_prefix_stored(x)) != 0)) {
+        return false;
+    }
+
+    depth += x->prefix_len_;
+
+    while ((y = __artnode_after(x, c, &c)) != NULL) {
+        if ((__art_key(self, __art_minimum(y), &len)[depth] != c) ||
+            (__art_key(self, __art_maximum(y), &len)[depth] != c) ||
+            !__art_validate(check, y, depth + 1)) {
+            return false;
+        }
+
+        n++;
+    }
+
+    if (n != x->nr_children_) {
+        return false;
+    }
+
+    if (x->type_ == ART_NODE48) {
+        n = 0;
+
+        for (unsigned int i = 0; i < 48; i++) {
+            n += __ART_NODE(artnode48, x)->child_[i] != NULL;
+        }
+
+        return n == x->nr_children_;
+    }
+
+    return true;
+}
+
+static inline bool art_validate(const struct art *self)
+{
+    struct __art_check check = { self, NULL, 0 };
+
+    if ((self->root_ != NULL) && !__art_validate(&check, self->root_, 0)) {
+        return false;
+    }
+
+    return check.size_ == self->size_;
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_ART_H__ */
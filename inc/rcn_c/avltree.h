@@ -13,27 +13,103 @@
 #include <errno.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <sys/types.h>
 
+#ifdef AVLTREE_STATS
+#include "tree_stats.h"
+#endif /* AVLTREE_STATS */
+
 #ifdef __cplusplus
 namespace rcn_c
 {
 #endif
 
+#ifdef AVLTREE_COMPACT
+/*
+ * The height shares a word with the subtree size : a node is then 5 words
+ * instead of 6. The height of a tree of 2^56 nodes still fits the top byte.
+ */
+#define __AVLNODE_COUNT_BITS (8 * sizeof(size_t) - 8)
+
+struct avlnode {
+    struct avlnode *parent_;
+    struct avlnode *left_;
+    struct avlnode *right_;
+    void *entry_;
+    size_t height_count_;
+#ifdef AVLTREE_KEY_PREFIX
+    uint64_t key_;
+#endif /* AVLTREE_KEY_PREFIX */
+};
+
+static inline ssize_t __avlnode_height(const struct avlnode *x)
+{
+    return x == NULL ? 0 : x->height_count_ >> __AVLNODE_COUNT_BITS;
+}
+
+static inline size_t __avlnode_count(const struct avlnode *x)
+{
+    const size_t mask = ((size_t)1 << __AVLNODE_COUNT_BITS) - 1;
+
+    return x == NULL ? 0 : x->height_count_ & mask;
+}
+
+static inline void __avlnode_set(struct avlnode *x, ssize_t height,
+                                 size_t count)
+{
+    x->height_count_ = ((size_t)height << __AVLNODE_COUNT_BITS) | count;
+}
+#else
 struct avlnode {
     struct avlnode *parent_;
     struct avlnode *left_;
     struct avlnode *right_;
     void *entry_;
     ssize_t height_;
+    size_t count_;
+#ifdef AVLTREE_KEY_PREFIX
+    uint64_t key_;
+#endif /* AVLTREE_KEY_PREFIX */
 };
 
+static inline ssize_t __avlnode_height(const struct avlnode *x)
+{
+    return x == NULL ? 0 : x->height_;
+}
+
+static inline size_t __avlnode_count(const struct avlnode *x)
+{
+    return x == NULL ? 0 : x->count_;
+}
+
+static inline void __avlnode_set(struct avlnode *x, ssize_t height,
+                                 size_t count)
+{
+    x->height_ = height;
+    x->count_ = count;
+}
+#endif /* AVLTREE_COMPACT */
+
 struct avltree {
     struct avlnode *root_;
     int (*compar_)(const void *ke, const void *in_tree);
+#ifdef AVLTREE_KEY_PREFIX
+    uint64_t (*key_of_)(const void *e);
+#endif /* AVLTREE_KEY_PREFIX */
     size_t size_;
+#ifdef AVLTREE_STATS
+    struct tree_stats stats_;
+#endif /* AVLTREE_STATS */
 };
 
+#ifdef AVLTREE_STATS
+#define __AVLTREE_STATS(self, field, n) \
+    TREE_STATS_ADD(&(self)->stats_, field, n)
+#else
+#define __AVLTREE_STATS(self, field, n) ((void)0)
+#endif /* AVLTREE_STATS */
+
 static inline void avltree_clear(struct avltree *self)
 {
     self->root_ = NULL;
@@ -46,8 +122,78 @@ static inline void avltree_init(struct avltree *self,
 {
     avltree_clear(self);
     self->compar_ = compar;
+#ifdef AVLTREE_KEY_PREFIX
+    self->key_of_ = NULL;
+#endif /* AVLTREE_KEY_PREFIX */
+#ifdef AVLTREE_STATS
+    tree_stats_reset(&self->stats_);
+#endif /* AVLTREE_STATS */
+}
+
+#ifdef AVLTREE_KEY_PREFIX
+/*
+ * Each node keeps a 64 bit key computed from its entry by 'key_of', as in
+ * rbtree_init_keyed(). compar is then only called on a tie.
+ */
+static inline void
+avltree_init_keyed(struct avltree *self,
+                   int (*compar)(const void *ke, const void *in_tree),
+                   uint64_t (*key_of)(const void *e))
+{
+    avltree_init(self, compar);
+    self->key_of_ = key_of;
 }
 
+static inline uint64_t __avltree_key(const struct avltree *self, const void *e)
+{
+    return self->key_of_ != NULL ? self->key_of_(e) : 0;
+}
+
+static inline uint64_t __avlnode_key(const struct avlnode *x)
+{
+    return x->key_;
+}
+
+static inline void __avlnode_set_entry(const struct avltree *self,
+                                       struct avlnode *x, void *e)
+{
+    x->entry_ = e;
+    x->key_ = __avltree_key(self, e);
+}
+
+static inline int __avltree_compar(const struct avltree *self, uint64_t key,
+                                   const void *ke, const struct avlnode *x)
+{
+    if (key != x->key_) {
+        return key < x->key_ ? -1 : 1;
+    }
+
+    return self->compar_(ke, x->entry_);
+}
+#else
+static inline uint64_t __avltree_key(const struct avltree *self, const void *e)
+{
+    return 0;
+}
+
+static inline uint64_t __avlnode_key(const struct avlnode *x)
+{
+    return 0;
+}
+
+static inline void __avlnode_set_entry(const struct avltree *self,
+                                       struct avlnode *x, void *e)
+{
+    x->entry_ = e;
+}
+
+static inline int __avltree_compar(const struct avltree *self, uint64_t key,
+                                   const void *ke, const struct avlnode *x)
+{
+    return self->compar_(ke, x->entry_);
+}
+#endif /* AVLTREE_KEY_PREFIX */
+
 static inline bool avltree_empty(const struct avltree *self)
 {
     return self->root_ == NULL;
@@ -160,17 +306,14 @@ static inline void *avltree_back(const struct avltree *self)
     return avltree_empty(self) ? NULL : avltree_rbegin(self)->entry_;
 }
 
-static inline ssize_t __avlnode_height(const struct avlnode *x)
-{
-    return x == NULL ? 0 : x->height_;
-}
-
-static inline void __avlnode_update_height(struct avlnode *x)
+static inline void __avlnode_update(struct avlnode *x)
 {
     ssize_t left_height = __avlnode_height(x->left_);
     ssize_t right_height = __avlnode_height(x->right_);
 
-    x->height_ = (left_height > right_height ? left_height : right_height) + 1;
+    __avlnode_set(x,
+                  (left_height > right_height ? left_height : right_height) + 1,
+                  __avlnode_count(x->left_) + __avlnode_count(x->right_) + 1);
 }
 
 static inline ssize_t __avlnode_BF(const struct avlnode *x)
@@ -193,8 +336,8 @@ static inline struct avlnode *__avlnode_RR(struct avlnode *x)
     y->parent_ = x->parent_;
     x->parent_ = y;
 
-    __avlnode_update_height(x);
-    __avlnode_update_height(y);
+    __avlnode_update(x);
+    __avlnode_update(y);
 
     return y;
 }
@@ -214,8 +357,8 @@ static inline struct avlnode *__avlnode_LL(struct avlnode *x)
     y->parent_ = x->parent_;
     x->parent_ = y;
 
-    __avlnode_update_height(x);
-    __avlnode_update_height(y);
+    __avlnode_update(x);
+    __avlnode_update(y);
 
     return y;
 }
@@ -236,14 +379,14 @@ static inline struct avlnode *__avlnode_RL(struct avlnode *x)
 
 static inline struct avlnode *__avltree_rebalance(struct avlnode *x)
 {
-    __avlnode_update_height(x);
+    __avlnode_update(x);
 
     ssize_t bf = __avlnode_BF(x);
 
     if (bf >= 2) {
         bf = __avlnode_BF(x->left_);
 
-        if (bf >= 1) {
+        if (bf >= 0) {
             x = __avlnode_LL(x);
         } else {
             x = __avlnode_LR(x);
@@ -251,7 +394,7 @@ static inline struct avlnode *__avltree_rebalance(struct avlnode *x)
     } else if (bf <= -2) {
         bf = __avlnode_BF(x->right_);
 
-        if (bf <= -1) {
+        if (bf <= 0) {
             x = __avlnode_RR(x);
         } else {
             x = __avlnode_RL(x);
@@ -261,125 +404,242 @@ static inline struct avlnode *__avltree_rebalance(struct avlnode *x)
     return x;
 }
 
-static struct avlnode *__avltree_insert(struct avltree *self, struct avlnode *x,
-                                        struct avlnode *z, int *err)
+/* Puts 'y' in the place of 'x' under the parent of 'x'. 'y' may be NULL. */
+static inline void __avltree_replace(struct avltree *self, struct avlnode *x,
+                                     struct avlnode *y)
 {
-    if (x == NULL) {
-        return z;
-    }
+    struct avlnode *parent = x->parent_;
 
-    int diff = self->compar_(z->entry_, x->entry_);
+    if (y != NULL) {
+        y->parent_ = parent;
+    }
 
-    if (diff < 0) {
-        x->left_ = __avltree_insert(self, x->left_, z, err);
-        x->left_->parent_ = x;
-    } else if (diff > 0) {
-        x->right_ = __avltree_insert(self, x->right_, z, err);
-        x->right_->parent_ = x;
+    if (parent == NULL) {
+        self->root_ = y;
+    } else if (parent->left_ == x) {
+        parent->left_ = y;
     } else {
-        *err = -EEXIST;
-        return x;
+        parent->right_ = y;
     }
-
-    return __avltree_rebalance(x);
 }
 
-static inline int avltree_insert(struct avltree *self, struct avlnode *z,
-                                 void *e)
+/*
+ * Rebalances from 'x' up, after the subtree sizes below 'x' changed by
+ * 'delta'. Once a subtree is back to the height it had, the nodes above it
+ * keep their heights and balance : only their sizes are updated.
+ */
+static inline void __avltree_retrace(struct avltree *self, struct avlnode *x,
+                                     ssize_t delta)
 {
-    int err = 0;
+    while (x != NULL) {
+        struct avlnode *parent = x->parent_;
+        ssize_t height = __avlnode_height(x);
+#ifdef AVLTREE_STATS
+        const struct avlnode *l = x->left_, *r = x->right_;
+#endif /* AVLTREE_STATS */
+        struct avlnode *y = __avltree_rebalance(x);
+
+        /* A single rotation lifts a child, a double one a grandchild. */
+        __AVLTREE_STATS(self, nr_fixups_, 1);
+        __AVLTREE_STATS(self, nr_rotations_,
+                        y == x ? 0 : (y == l) || (y == r) ? 1 : 2);
+
+        if (parent == NULL) {
+            self->root_ = y;
+        } else if (parent->left_ == x) {
+            parent->left_ = y;
+        } else {
+            parent->right_ = y;
+        }
 
-    z->parent_ = z->left_ = z->right_ = NULL;
-    z->entry_ = e;
-    z->height_ = 1;
+        x = parent;
 
-    self->root_ = __avltree_insert(self, self->root_, z, &err);
+        if (__avlnode_height(y) == height) {
+            break;
+        }
+    }
 
-    if (err != 0) {
-        return err;
+    for (; x != NULL; x = x->parent_) {
+        __avlnode_set(x, __avlnode_height(x), __avlnode_count(x) + delta);
+    }
+}
+
+/* Links 'z' holding 'e' as the 'diff' side child of 'y', or as the root. */
+static inline void __avltree_link(struct avltree *self, struct avlnode *y,
+                                  int diff, struct avlnode *z, void *e)
+{
+    z->parent_ = y;
+    z->left_ = z->right_ = NULL;
+    __avlnode_set_entry(self, z, e);
+    __avlnode_set(z, 1, 1);
+
+    if (y == NULL) {
+        self->root_ = z;
+    } else if (diff < 0) {
+        y->left_ = z;
+    } else {
+        y->right_ = z;
     }
 
+    __avltree_retrace(self, y, 1);
+    __AVLTREE_STATS(self, nr_inserts_, 1);
     self->size_++;
+}
 
-    return 0;
+/*
+ * Returns the node holding an entry equal to 'e', or NULL after linking 'z'
+ * holding 'e' where it belongs.
+ */
+static inline struct avlnode *__avltree_insert(struct avltree *self,
+                                               struct avlnode *z, void *e)
+{
+    struct avlnode *x = self->root_;
+    struct avlnode *y = NULL;
+    uint64_t key = __avltree_key(self, e);
+    int diff = 0;
+
+    while (x != NULL) {
+        y = x;
+        diff = __avltree_compar(self, key, e, y);
+        __AVLTREE_STATS(self, nr_insert_compars_, 1);
+
+        if (diff < 0) {
+            x = x->left_;
+        } else if (diff > 0) {
+            x = x->right_;
+        } else {
+            return x;
+        }
+    }
+
+    __avltree_link(self, y, diff, z, e);
+
+    return NULL;
 }
 
-static struct avlnode *__avlnode_successor(struct avlnode *x,
-                                           struct avlnode *parent)
+static inline int avltree_insert(struct avltree *self, struct avlnode *z,
+                                 void *e)
 {
-    if (x->left_ == NULL) {
-        if (x->parent_ != NULL) {
-            if (parent != x->parent_) {
-                x->parent_->left_ = x->right_;
-            } else {
-                x->parent_->right_ = x->right_;
-            }
+    return __avltree_insert(self, z, e) == NULL ? 0 : -EEXIST;
+}
 
-            if (x->right_ != NULL) {
-                x->right_->parent_ = x->parent_;
-            }
+/*
+ * Inserts 'z' holding 'e' unless an equal entry is there already. Returns
+ * the node holding the entry in the tree, which is 'z' if it was inserted.
+ */
+static inline struct avlnode *avltree_insert_or_get(struct avltree *self,
+                                                    struct avlnode *z, void *e)
+{
+    struct avlnode *x = __avltree_insert(self, z, e);
+
+    return x == NULL ? z : x;
+}
+
+/*
+ * Inserts 'z' holding 'e' right after 'hint', or first if 'hint' is NULL,
+ * without a descent when 'e' does belong there. Otherwise falls back to
+ * avltree_insert().
+ */
+static inline int avltree_insert_hint(struct avltree *self,
+                                      struct avlnode *hint, struct avlnode *z,
+                                      void *e)
+{
+    struct avlnode *next = hint == NULL ? avltree_begin(self) :
+                                          avltree_next(self, hint);
+    uint64_t key = __avltree_key(self, e);
+    int diff;
+
+    if (hint != NULL) {
+        if ((diff = __avltree_compar(self, key, e, hint)) <= 0) {
+            return diff == 0 ? -EEXIST : avltree_insert(self, z, e);
         }
+    }
 
-        return x;
+    if (next != NULL) {
+        if ((diff = __avltree_compar(self, key, e, next)) >= 0) {
+            return diff == 0 ? -EEXIST : avltree_insert(self, z, e);
+        }
+    }
+
+    if ((hint != NULL) && (hint->right_ == NULL)) {
+        __avltree_link(self, hint, 1, z, e);
     } else {
-        return __avlnode_successor(x->left_, parent);
+        /* 'next' is the leftmost node of the right subtree of 'hint'. */
+        __avltree_link(self, next, -1, z, e);
     }
+
+    return 0;
 }
 
-static struct avlnode *__avltree_erase(struct avltree *self, struct avlnode *x,
-                                       struct avlnode *z)
+static struct avlnode *__avltree_build(const struct avltree *self,
+                                       struct avlnode *parent,
+                                       struct avlnode *nodes[],
+                                       void *entries[], size_t n)
 {
-    if (x == NULL) {
+    size_t mid = n / 2;
+    struct avlnode *x;
+
+    if (n == 0) {
         return NULL;
     }
 
-    int diff = self->compar_(z->entry_, x->entry_);
+    x = nodes[mid];
+    __avlnode_set_entry(self, x, entries[mid]);
+    x->parent_ = parent;
+    x->left_ = __avltree_build(self, x, nodes, entries, mid);
+    x->right_ = __avltree_build(self, x, &nodes[mid + 1], &entries[mid + 1],
+                                n - mid - 1);
+    __avlnode_update(x);
 
-    if (diff < 0) {
-        x->left_ = __avltree_erase(self, x->left_, z);
-        x = __avltree_rebalance(x);
-    } else if (diff > 0) {
-        x->right_ = __avltree_erase(self, x->right_, z);
-        x = __avltree_rebalance(x);
-    } else {
-        if ((x->left_ != NULL) && (x->right_ != NULL)) {
-            struct avlnode *y = __avlnode_successor(x->right_, x);
-
-            y->parent_ = x->parent_;
-            y->left_ = x->left_;
-            y->right_ = x->right_;
-            y->height_ = x->height_;
+    return x;
+}
 
-            if (x->left_ != NULL) {
-                x->left_->parent_ = y;
-            }
+/*
+ * Replaces the content of the tree with the 'n' entries of 'entries', which
+ * must be sorted in strictly ascending order, using nodes[i] for entries[i].
+ * compar is never called. The result is perfectly balanced. O(n).
+ */
+static inline void avltree_build_sorted(struct avltree *self,
+                                        struct avlnode *nodes[],
+                                        void *entries[], size_t n)
+{
+    self->root_ = __avltree_build(self, NULL, nodes, entries, n);
+    self->size_ = n;
+}
 
-            if (x->right_ != NULL) {
-                x->right_->parent_ = y;
-            }
+/*
+ * Fast path for ascending inserts : an entry greater than the last one is
+ * linked after it with a single comparison, the last one being found down
+ * the right spine, which is then rebalanced. Others fall back to
+ * avltree_insert(). See also avltree_insert_hint().
+ */
+static inline int avltree_append_sorted(struct avltree *self,
+                                        struct avlnode *z, void *e)
+{
+    struct avlnode *x = avltree_rbegin(self);
 
-            x = y;
-        } else if (x->left_ != NULL) {
-            x->left_->parent_ = x->parent_;
-            x = x->left_;
-        } else if (x->right_ != NULL) {
-            x->right_->parent_ = x->parent_;
-            x = x->right_;
-        } else {
-            x = NULL;
-        }
+    if ((x != NULL) &&
+        (__avltree_compar(self, __avltree_key(self, e), e, x) <= 0)) {
+        return avltree_insert(self, z, e);
     }
 
-    return x;
+    __avltree_link(self, x, 1, z, e);
+
+    return 0;
 }
 
 static inline struct avlnode *avltree_find(const struct avltree *self,
                                            const void *ke)
 {
     struct avlnode *x = self->root_;
+    uint64_t key = __avltree_key(self, ke);
+
+    __AVLTREE_STATS(self, nr_finds_, 1);
 
     while (x != NULL) {
-        int diff = self->compar_(ke, x->entry_);
+        int diff = __avltree_compar(self, key, ke, x);
+
+        __AVLTREE_STATS(self, nr_find_compars_, 1);
 
         if (diff == 0) {
             return x;
@@ -393,15 +653,83 @@ static inline struct avlnode *avltree_find(const struct avltree *self,
     return NULL;
 }
 
+/*
+ * Whether 'z' is a node of the tree, looked up as a find would, but left out
+ * of the statistics.
+ */
+static inline bool __avltree_has(const struct avltree *self,
+                                 const struct avlnode *z)
+{
+    const struct avlnode *x = self->root_;
+    uint64_t key = __avltree_key(self, z->entry_);
+
+    while (x != NULL) {
+        int diff = __avltree_compar(self, key, z->entry_, x);
+
+        if (diff == 0) {
+            return x == z;
+        } else if (diff < 0) {
+            x = x->left_;
+        } else {
+            x = x->right_;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Unlinks 'z', which must be a node of the tree, and rebalances from its
+ * parent up. 'z' is trusted as is when NDEBUG is defined, and looked up to
+ * check it otherwise.
+ */
 static inline void *avltree_erase(struct avltree *self, struct avlnode *z)
 {
-    struct avlnode *x = avltree_find(self, z->entry_);
+    struct avlnode *parent;
 
-    if ((x == NULL) || (x != z)) {
+    if (z == NULL) {
         return NULL;
     }
 
-    self->root_ = __avltree_erase(self, self->root_, z);
+#ifndef NDEBUG
+    if (!__avltree_has(self, z)) {
+        return NULL;
+    }
+#endif /* NDEBUG */
+
+    if ((z->left_ != NULL) && (z->right_ != NULL)) {
+        struct avlnode *y = z->right_;
+
+        while (y->left_ != NULL) {
+            y = y->left_;
+        }
+
+        parent = y->parent_;
+
+        if (parent == z) {
+            parent = y;
+        } else {
+            parent->left_ = y->right_;
+
+            if (y->right_ != NULL) {
+                y->right_->parent_ = parent;
+            }
+
+            y->right_ = z->right_;
+            y->right_->parent_ = y;
+        }
+
+        y->left_ = z->left_;
+        y->left_->parent_ = y;
+        __avlnode_set(y, __avlnode_height(z), __avlnode_count(z));
+        __avltree_replace(self, z, y);
+    } else {
+        parent = z->parent_;
+        __avltree_replace(self, z, z->left_ != NULL ? z->left_ : z->right_);
+    }
+
+    __avltree_retrace(self, parent, -1);
+    __AVLTREE_STATS(self, nr_erases_, 1);
     self->size_--;
 
     return z->entry_;
@@ -419,13 +747,41 @@ static inline void *avltree_pop_back(struct avltree *self)
 
 static inline void *avltree_at(struct avltree *self, size_t n)
 {
-    struct avlnode *x;
+    struct avlnode *x = self->root_;
+
+    while (x != NULL) {
+        size_t nr_left = __avlnode_count(x->left_);
 
-    for (x = avltree_begin(self); n != 0 && x != avltree_end(self); --n) {
-        x = avltree_next(self, x);
+        if (n == nr_left) {
+            return x->entry_;
+        } else if (n < nr_left) {
+            x = x->left_;
+        } else {
+            n -= nr_left + 1;
+            x = x->right_;
+        }
     }
 
-    return x == avltree_end(self) ? NULL : x->entry_;
+    return NULL;
+}
+
+/* Number of entries less than 'ke', i.e. the position of its lower bound. */
+static inline size_t avltree_rank(const struct avltree *self, const void *ke)
+{
+    struct avlnode *x = self->root_;
+    uint64_t key = __avltree_key(self, ke);
+    size_t rank = 0;
+
+    while (x != NULL) {
+        if (__avltree_compar(self, key, ke, x) <= 0) {
+            x = x->left_;
+        } else {
+            rank += __avlnode_count(x->left_) + 1;
+            x = x->right_;
+        }
+    }
+
+    return rank;
 }
 
 static inline struct avlnode *avltree_lower_bound(const struct avltree *self,
@@ -433,9 +789,14 @@ static inline struct avlnode *avltree_lower_bound(const struct avltree *self,
 {
     struct avlnode *x = self->root_;
     struct avlnode *result = NULL;
+    uint64_t key = __avltree_key(self, ke);
+
+    __AVLTREE_STATS(self, nr_finds_, 1);
 
     while (x != NULL) {
-        int diff = self->compar_(ke, x->entry_);
+        int diff = __avltree_compar(self, key, ke, x);
+
+        __AVLTREE_STATS(self, nr_find_compars_, 1);
 
         if (diff <= 0) {
             result = x;
@@ -453,9 +814,14 @@ static inline struct avlnode *avltree_upper_bound(const struct avltree *self,
 {
     struct avlnode *x = self->root_;
     struct avlnode *result = NULL;
+    uint64_t key = __avltree_key(self, ke);
+
+    __AVLTREE_STATS(self, nr_finds_, 1);
 
     while (x != NULL) {
-        int diff = self->compar_(ke, x->entry_);
+        int diff = __avltree_compar(self, key, ke, x);
+
+        __AVLTREE_STATS(self, nr_find_compars_, 1);
 
         if (diff < 0) {
             result = x;
@@ -468,6 +834,300 @@ static inline struct avlnode *avltree_upper_bound(const struct avltree *self,
     return result;
 }
 
+/*
+ * Calls 'fn' on the entries from 'lo' included to 'hi' excluded, in order,
+ * and returns their number. Both ends are looked up once, so the walk in
+ * between calls compar no more. 'fn' must not change the tree.
+ */
+static inline size_t avltree_for_each_range(const struct avltree *self,
+                                            const void *lo, const void *hi,
+                                            void (*fn)(void *e, void *arg),
+                                            void *arg)
+{
+    struct avlnode *x, *end;
+    size_t n = 0;
+
+    if (self->compar_(lo, hi) >= 0) {
+        return 0;
+    }
+
+    end = avltree_lower_bound(self, hi);
+
+    for (x = avltree_lower_bound(self, lo); x != end;
+         x = avltree_next(self, x)) {
+        fn(x->entry_, arg);
+        n++;
+    }
+
+    return n;
+}
+
+/* Number of entries from 'lo' included to 'hi' excluded. O(log(n)). */
+static inline size_t avltree_count_range(const struct avltree *self,
+                                         const void *lo, const void *hi)
+{
+    if (self->compar_(lo, hi) >= 0) {
+        return 0;
+    }
+
+    return avltree_rank(self, hi) - avltree_rank(self, lo);
+}
+
+/*
+ * Join-based operations, after G. E. Blelloch, D. Ferizovic, Y. Sun,
+ * "Just Join for Parallel Ordered Sets", SPAA 2016. The helpers work on
+ * detached subtrees : the parent_ of the subtree they return is stale and
+ * set by the caller. Union, intersection and difference, which may fork
+ * threads, are in avltree_set.h.
+ */
+
+/* All entries of 'l' < k->entry_ < all entries of 'r'. */
+static struct avlnode *__avltree_join(struct avlnode *l, struct avlnode *k,
+                                      struct avlnode *r)
+{
+    ssize_t left_height = __avlnode_height(l);
+    ssize_t right_height = __avlnode_height(r);
+
+    if (left_height > right_height + 1) {
+        l->right_ = __avltree_join(l->right_, k, r);
+        l->right_->parent_ = l;
+
+        return __avltree_rebalance(l);
+    }
+
+    if (right_height > left_height + 1) {
+        r->left_ = __avltree_join(l, k, r->left_);
+        r->left_->parent_ = r;
+
+        return __avltree_rebalance(r);
+    }
+
+    k->left_ = l;
+    k->right_ = r;
+
+    if (l != NULL) {
+        l->parent_ = k;
+    }
+
+    if (r != NULL) {
+        r->parent_ = k;
+    }
+
+    __avlnode_update(k);
+
+    return k;
+}
+
+/* Detaches the last node of 'x' into 'last' and returns the rest. */
+static struct avlnode *__avltree_split_last(struct avlnode *x,
+                                            struct avlnode **last)
+{
+    if (x->right_ == NULL) {
+        *last = x;
+        return x->left_;
+    }
+
+    struct avlnode *r = __avltree_split_last(x->right_, last);
+
+    return __avltree_join(x->left_, x, r);
+}
+
+static struct avlnode *__avltree_join2(struct avlnode *l, struct avlnode *r)
+{
+    struct avlnode *k;
+
+    if (l == NULL) {
+        return r;
+    }
+
+    if (r == NULL) {
+        return l;
+    }
+
+    l = __avltree_split_last(l, &k);
+
+    return __avltree_join(l, k, r);
+}
+
+/*
+ * Splits 'x' into the entries less than 'ke' and the ones greater than 'ke',
+ * whose key is 'key'. Returns the node matching 'ke', detached from both, or
+ * NULL.
+ */
+static struct avlnode *__avltree_split(const struct avltree *self,
+                                       struct avlnode *x, uint64_t key,
+                                       const void *ke, struct avlnode **l,
+                                       struct avlnode **r)
+{
+    struct avlnode *m, *t;
+
+    if (x == NULL) {
+        *l = *r = NULL;
+        return NULL;
+    }
+
+    int diff = __avltree_compar(self, key, ke, x);
+
+    if (diff == 0) {
+        *l = x->left_;
+        *r = x->right_;
+        return x;
+    } else if (diff < 0) {
+        m = __avltree_split(self, x->left_, key, ke, l, &t);
+        *r = __avltree_join(t, x, x->right_);
+    } else {
+        m = __avltree_split(self, x->right_, key, ke, &t, r);
+        *l = __avltree_join(x->left_, x, t);
+    }
+
+    return m;
+}
+
+static inline void __avltree_set_root(struct avltree *self, struct avlnode *x)
+{
+    if (x != NULL) {
+        x->parent_ = NULL;
+    }
+
+    self->root_ = x;
+    self->size_ = __avlnode_count(x);
+}
+
+/*
+ * Appends 'z' holding 'e', then the entries of 'other' which is left empty.
+ * The entries of the tree must be less than 'e', and 'e' less than the ones
+ * of 'other'. O(log(n)).
+ */
+static inline void avltree_join(struct avltree *self, struct avlnode *z,
+                                void *e, struct avltree *other)
+{
+    __avlnode_set_entry(self, z, e);
+    __avltree_set_root(self, __avltree_join(self->root_, z, other->root_));
+    avltree_clear(other);
+}
+
+/* Same as avltree_join() without a middle entry. */
+static inline void avltree_concat(struct avltree *self, struct avltree *other)
+{
+    __avltree_set_root(self, __avltree_join2(self->root_, other->root_));
+    avltree_clear(other);
+}
+
+/*
+ * Keeps the entries less than 'ke' and moves the ones greater than 'ke' into
+ * 'right', whose content is replaced. The node matching 'ke' is removed and
+ * returned, or NULL if there is none. O(log(n)).
+ */
+static inline struct avlnode *avltree_split(struct avltree *self,
+                                            const void *ke,
+                                            struct avltree *right)
+{
+    struct avlnode *l, *r;
+    struct avlnode *m = __avltree_split(self, self->root_,
+                                        __avltree_key(self, ke), ke, &l, &r);
+
+    __avltree_set_root(self, l);
+    __avltree_set_root(right, r);
+
+    return m;
+}
+
+/*
+ * Moves the entries from 'lo' included to 'hi' excluded into 'out', whose
+ * content is replaced, and returns their number. The range is cut out with
+ * two splits and the rest joined back, O(log(n)) whatever its size.
+ */
+static inline size_t avltree_erase_range(struct avltree *self,
+                                         const void *lo, const void *hi,
+                                         struct avltree *out)
+{
+    struct avlnode *l, *m, *r, *first, *last;
+
+    if (self->compar_(lo, hi) >= 0) {
+        __avltree_set_root(out, NULL);
+        return 0;
+    }
+
+    first = __avltree_split(self, self->root_, __avltree_key(self, lo), lo,
+                            &l, &m);
+    last = __avltree_split(self, m, __avltree_key(self, hi), hi, &m, &r);
+
+    /* The nodes matching 'lo' and 'hi' go back to their side. */
+    if (first != NULL) {
+        m = __avltree_join(NULL, first, m);
+    }
+
+    if (last != NULL) {
+        r = __avltree_join(NULL, last, r);
+    }
+
+    __avltree_set_root(self, __avltree_join2(l, r));
+    __avltree_set_root(out, m);
+
+    return out->size_;
+}
+
+#ifdef AVLTREE_STATS
+static inline const struct tree_stats *avltree_stats(const struct avltree *self)
+{
+    return &self->stats_;
+}
+
+static inline void avltree_stats_reset(struct avltree *self)
+{
+    tree_stats_reset(&self->stats_);
+}
+#endif /* AVLTREE_STATS */
+
+/*
+ * Counts the nodes at each depth in hist[], the root at depth 0 and the ones
+ * at depth 'nr' - 1 or deeper in hist[nr - 1], and returns the height, 0 if
+ * the tree is empty. 'nr' must not be 0. O(n), without recursion.
+ */
+static inline size_t avltree_depth_histogram(const struct avltree *self,
+                                             size_t hist[], size_t nr)
+{
+    const struct avlnode *x = self->root_;
+    size_t depth = 0, height = 0;
+
+    for (size_t i = 0; i < nr; i++) {
+        hist[i] = 0;
+    }
+
+    if (x == NULL) {
+        return 0;
+    }
+
+    for (; x->left_ != NULL; x = x->left_) {
+        depth++;
+    }
+
+    while (x != NULL) {
+        const struct avlnode *parent;
+
+        hist[depth < nr ? depth : nr - 1]++;
+        height = depth + 1 > height ? depth + 1 : height;
+
+        if (x->right_ != NULL) {
+            for (x = x->right_, depth++; x->left_ != NULL; x = x->left_) {
+                depth++;
+            }
+
+            continue;
+        }
+
+        while (((parent = x->parent_) != NULL) && x == parent->right_) {
+            x = parent;
+            depth--;
+        }
+
+        x = parent;
+        depth--;
+    }
+
+    return height;
+}
+
 static inline bool __avltree_validate_node(const struct avlnode *x)
 {
     if (x == NULL) {
@@ -476,12 +1136,20 @@ static inline bool __avltree_validate_node(const struct avlnode *x)
 
     ssize_t bf = __avlnode_BF(x);
 
-    if ((bf > 2) || (bf < -2)) {
+    if ((bf > 1) || (bf < -1)) {
         return false;
     }
 
-    if ((__avlnode_height(x) == __avlnode_height(x->left_)) ||
-        (__avlnode_height(x) == __avlnode_height(x->right_))) {
+    if (__avlnode_count(x) !=
+        __avlnode_count(x->left_) + __avlnode_count(x->right_) + 1) {
+        return false;
+    }
+
+    ssize_t left_height = __avlnode_height(x->left_);
+    ssize_t right_height = __avlnode_height(x->right_);
+
+    if (__avlnode_height(x) !=
+        (left_height > right_height ? left_height : right_height) + 1) {
         return false;
     }
 
@@ -499,6 +1167,10 @@ static inline bool avltree_validate(const struct avltree *self)
 
     for (struct avlnode *x = avltree_begin(self); x != avltree_end(self);
          x = avltree_next(self, x)) {
+        if (__avlnode_key(x) != __avltree_key(self, x->entry_)) {
+            return false;
+        }
+
         size++;
     }
 
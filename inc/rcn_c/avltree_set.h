@@ -0,0 +1,234 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ *
+ * Reference : G. E. Blelloch, D. Ferizovic, Y. Sun, "Just Join for Parallel
+ *             Ordered Sets", 2016
+ */
+
+/* AVL Tree - Parallel Set Operations */
+#ifndef __RCN_C_AVLTREE_SET_H__
+#define __RCN_C_AVLTREE_SET_H__
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <unistd.h>
+
+#include "avltree.h"
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/*
+ * Set operations, O(m log(n / m + 1)) for sizes n >= m. The two halves of a
+ * recursion step run on a new thread when there are at least
+ * AVLTREE_FORK_GRAIN entries left and the fork depth allows it.
+ */
+#ifndef AVLTREE_FORK_GRAIN
+#define AVLTREE_FORK_GRAIN 16384
+#endif /* AVLTREE_FORK_GRAIN */
+
+/* CPUs to fork for, 0 for those online. */
+#ifndef AVLTREE_FORK_CPUS
+#define AVLTREE_FORK_CPUS 0
+#endif /* AVLTREE_FORK_CPUS */
+
+struct __avltree_set_args {
+    const struct avltree *self_;
+    struct avlnode *t1_;
+    struct avlnode *t2_;
+    struct avlnode *result_;
+    struct avlnode *rest_;
+    int depth_;
+};
+
+static inline void __avltree_set_args_init(struct __avltree_set_args *args,
+                                           const struct avltree *self,
+                                           struct avlnode *t2, int depth)
+{
+    args->self_ = self;
+    args->t1_ = NULL;
+    args->t2_ = t2;
+    args->result_ = args->rest_ = NULL;
+    args->depth_ = depth;
+}
+
+static inline void __avltree_set_fork(void *(*fn)(void *),
+                                      struct __avltree_set_args *left,
+                                      struct __avltree_set_args *right)
+{
+    size_t nr_entries = __avlnode_count(left->t1_) +
+                        __avlnode_count(left->t2_) +
+                        __avlnode_count(right->t1_) +
+                        __avlnode_count(right->t2_);
+    bool forked = false;
+    pthread_t thread;
+
+    if ((left->depth_ >= 0) && (nr_entries >= AVLTREE_FORK_GRAIN)) {
+        forked = pthread_create(&thread, NULL, fn, left) == 0;
+    }
+
+    if (!forked) {
+        fn(left);
+    }
+
+    fn(right);
+
+    if (forked) {
+        pthread_join(thread, NULL);
+    }
+}
+
+/* Number of levels to fork at : enough for two threads per CPU. */
+static inline int __avltree_fork_depth(void)
+{
+    long nr_cpus = AVLTREE_FORK_CPUS != 0 ? AVLTREE_FORK_CPUS
+                                          : sysconf(_SC_NPROCESSORS_ONLN);
+    int depth = 0;
+
+    while ((1L << depth) < nr_cpus) {
+        depth++;
+    }
+
+    return depth;
+}
+
+/* result_ : t1_ U t2_, rest_ : the nodes of t2_ already in t1_. */
+static void *__avltree_union(void *_args)
+{
+    struct __avltree_set_args *args = (struct __avltree_set_args *)_args;
+    struct avlnode *t1 = args->t1_;
+    struct avlnode *t2 = args->t2_;
+    struct __avltree_set_args left, right;
+    struct avlnode *m;
+
+    if ((t1 == NULL) || (t2 == NULL)) {
+        args->result_ = t1 == NULL ? t2 : t1;
+        args->rest_ = NULL;
+        return NULL;
+    }
+
+    __avltree_set_args_init(&left, args->self_, t2->left_, args->depth_ - 1);
+    __avltree_set_args_init(&right, args->self_, t2->right_,
+                            args->depth_ - 1);
+    m = __avltree_split(args->self_, t1, __avlnode_key(t2), t2->entry_,
+                        &left.t1_, &right.t1_);
+    __avltree_set_fork(__avltree_union, &left, &right);
+
+    if (m == NULL) {
+        args->result_ = __avltree_join(left.result_, t2, right.result_);
+        args->rest_ = __avltree_join2(left.rest_, right.rest_);
+    } else {
+        args->result_ = __avltree_join(left.result_, m, right.result_);
+        args->rest_ = __avltree_join(left.rest_, t2, right.rest_);
+    }
+
+    return NULL;
+}
+
+/* result_ : t1_ & t2_, rest_ : t1_ - t2_. t2_ is only read. */
+static void *__avltree_intersect(void *_args)
+{
+    struct __avltree_set_args *args = (struct __avltree_set_args *)_args;
+    struct avlnode *t1 = args->t1_;
+    struct avlnode *t2 = args->t2_;
+    struct __avltree_set_args left, right;
+    struct avlnode *m;
+
+    if ((t1 == NULL) || (t2 == NULL)) {
+        args->result_ = NULL;
+        args->rest_ = t1;
+        return NULL;
+    }
+
+    __avltree_set_args_init(&left, args->self_, t2->left_, args->depth_ - 1);
+    __avltree_set_args_init(&right, args->self_, t2->right_,
+                            args->depth_ - 1);
+    m = __avltree_split(args->self_, t1, __avlnode_key(t2), t2->entry_,
+                        &left.t1_, &right.t1_);
+    __avltree_set_fork(__avltree_intersect, &left, &right);
+
+    if (m == NULL) {
+        args->result_ = __avltree_join2(left.result_, right.result_);
+    } else {
+        args->result_ = __avltree_join(left.result_, m, right.result_);
+    }
+
+    args->rest_ = __avltree_join2(left.rest_, right.rest_);
+
+    return NULL;
+}
+
+/*
+ * Moves the entries of 'other' into the tree. 'other' is left empty, and the
+ * nodes of the entries the tree already had are moved into 'rest' if it is
+ * not NULL. 'rest' may be 'other'.
+ */
+static inline void avltree_union(struct avltree *self, struct avltree *other,
+                                 struct avltree *rest)
+{
+    struct __avltree_set_args args;
+
+    __avltree_set_args_init(&args, self, other->root_, __avltree_fork_depth());
+    args.t1_ = self->root_;
+    __avltree_union(&args);
+
+    __avltree_set_root(self, args.result_);
+    avltree_clear(other);
+
+    if (rest != NULL) {
+        __avltree_set_root(rest, args.rest_);
+    }
+}
+
+/*
+ * Keeps the entries which are also in 'other'. The others are moved into
+ * 'rest' if it is not NULL. 'other' is not modified.
+ */
+static inline void avltree_intersection(struct avltree *self,
+                                        const struct avltree *other,
+                                        struct avltree *rest)
+{
+    struct __avltree_set_args args;
+
+    __avltree_set_args_init(&args, self, other->root_, __avltree_fork_depth());
+    args.t1_ = self->root_;
+    __avltree_intersect(&args);
+
+    __avltree_set_root(self, args.result_);
+
+    if (rest != NULL) {
+        __avltree_set_root(rest, args.rest_);
+    }
+}
+
+/*
+ * Removes the entries which are also in 'other', and moves them into 'rest'
+ * if it is not NULL. 'other' is not modified.
+ */
+static inline void avltree_difference(struct avltree *self,
+                                      const struct avltree *other,
+                                      struct avltree *rest)
+{
+    struct __avltree_set_args args;
+
+    __avltree_set_args_init(&args, self, other->root_, __avltree_fork_depth());
+    args.t1_ = self->root_;
+    __avltree_intersect(&args);
+
+    __avltree_set_root(self, args.rest_);
+
+    if (rest != NULL) {
+        __avltree_set_root(rest, args.result_);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_AVLTREE_SET_H__ */
@@ -65,7 +65,7 @@ static inline int binary_delete(void *key, void *base, size_t *nmemb,
         return -EEXIST;
     }
 
-    memcpy(__base(pos), __base(pos + 1), (*nmemb - pos) * size);
+    memmove(__base(pos), __base(pos + 1), (*nmemb - pos - 1) * size);
     (*nmemb)--;
 
     return 0;
@@ -0,0 +1,821 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ */
+
+/* B+ Tree */
+#ifndef __RCN_C_BPLUSTREE_H__
+#define __RCN_C_BPLUSTREE_H__
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Must be a power of 2. 256 is 4 cache lines, 4096 is a page. */
+#ifndef BPLUSTREE_NODE_SIZE
+#define BPLUSTREE_NODE_SIZE 256
+#endif /* BPLUSTREE_NODE_SIZE */
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+struct bpnode {
+    struct bpnode *parent_;
+    unsigned int nr_keys_;
+    bool leaf_;
+};
+
+#define BPLUSTREE_LEAF_MAX                                              \
+    ((BPLUSTREE_NODE_SIZE - sizeof(struct bpnode) - 2 * sizeof(void *)) / \
+     sizeof(void *))
+#define BPLUSTREE_LEAF_MIN (BPLUSTREE_LEAF_MAX / 2)
+
+#define BPLUSTREE_INNER_MAX                                       \
+    ((BPLUSTREE_NODE_SIZE - sizeof(struct bpnode) - sizeof(void *)) / \
+     (2 * sizeof(void *)))
+#define BPLUSTREE_INNER_MIN (BPLUSTREE_INNER_MAX / 2)
+
+/*
+ * Nodes are BPLUSTREE_NODE_SIZE bytes and aligned on that size, so the leaf
+ * holding an entry slot is found by masking the slot address. Iterators are
+ * pointers to entry slots, and stay valid until the tree is modified.
+ */
+struct bpleaf {
+    struct bpnode node_;
+    struct bpleaf *prev_;
+    struct bpleaf *next_;
+    void *entry_[BPLUSTREE_LEAF_MAX];
+};
+
+/* key_[n] is the first entry of the leftmost leaf under child_[n + 1]. */
+struct bpinner {
+    struct bpnode node_;
+    void *key_[BPLUSTREE_INNER_MAX];
+    struct bpnode *child_[BPLUSTREE_INNER_MAX + 1];
+};
+
+struct bplustree {
+    struct bpnode *root_;
+    int (*compar_)(const void *ke, const void *in_tree);
+    struct bpleaf *head_;
+    struct bpleaf *tail_;
+    size_t size_;
+};
+
+static inline struct bpleaf *__bpleaf(const struct bpnode *x)
+{
+    return (struct bpleaf *)x;
+}
+
+static inline struct bpinner *__bpinner(const struct bpnode *x)
+{
+    return (struct bpinner *)x;
+}
+
+static inline struct bpleaf *__bpleaf_of(void *const *x)
+{
+    return (struct bpleaf *)((uintptr_t)x &
+                             ~(uintptr_t)(BPLUSTREE_NODE_SIZE - 1));
+}
+
+static inline struct bpnode *__bpnode_alloc(bool leaf)
+{
+    struct bpnode *x = (struct bpnode *)aligned_alloc(BPLUSTREE_NODE_SIZE,
+                                                      BPLUSTREE_NODE_SIZE);
+
+    if (x != NULL) {
+        x->parent_ = NULL;
+        x->nr_keys_ = 0;
+        x->leaf_ = leaf;
+    }
+
+    return x;
+}
+
+static inline void __bpnode_free(struct bpnode *x)
+{
+    if (!x->leaf_) {
+        for (unsigned int i = 0; i <= x->nr_keys_; i++) {
+            __bpnode_free(__bpinner(x)->child_[i]);
+        }
+    }
+
+    free(x);
+}
+
+static inline void bplustree_clear(struct bplustree *self)
+{
+    if (self->root_ != NULL) {
+        __bpnode_free(self->root_);
+    }
+
+    self->root_ = NULL;
+    self->head_ = self->tail_ = NULL;
+    self->size_ = 0;
+}
+
+static inline void bplustree_init(struct bplustree *self,
+                                  int (*compar)(const void *ke,
+                                                const void *in_tree))
+{
+    self->root_ = NULL;
+    self->compar_ = compar;
+    self->head_ = self->tail_ = NULL;
+    self->size_ = 0;
+}
+
+static inline bool bplustree_empty(const struct bplustree *self)
+{
+    return self->size_ == 0;
+}
+
+static inline size_t bplustree_size(const struct bplustree *self)
+{
+    return self->size_;
+}
+
+static inline void **bplustree_begin(const struct bplustree *self)
+{
+    return bplustree_empty(self) ? NULL : &self->head_->entry_[0];
+}
+
+static inline void **bplustree_rbegin(const struct bplustree *self)
+{
+    struct bpleaf *leaf = self->tail_;
+
+    return bplustree_empty(self) ? NULL :
+                                   &leaf->entry_[leaf->node_.nr_keys_ - 1];
+}
+
+static inline void *const *bplustree_end(const struct bplustree *self)
+{
+    return NULL;
+}
+
+static inline void *const *bplustree_rend(const struct bplustree *self)
+{
+    return NULL;
+}
+
+static inline void **bplustree_next(const struct bplustree *self,
+                                    void *const *x)
+{
+    struct bpleaf *leaf = __bpleaf_of(x);
+
+    if (x + 1 < &leaf->entry_[leaf->node_.nr_keys_]) {
+        return (void **)x + 1;
+    }
+
+    return leaf->next_ == NULL ? NULL : &leaf->next_->entry_[0];
+}
+
+static inline void **bplustree_prev(const struct bplustree *self,
+                                    void *const *x)
+{
+    struct bpleaf *leaf = __bpleaf_of(x);
+
+    if (x > &leaf->entry_[0]) {
+        return (void **)x - 1;
+    }
+
+    leaf = leaf->prev_;
+
+    return leaf == NULL ? NULL : &leaf->entry_[leaf->node_.nr_keys_ - 1];
+}
+
+static inline void *bplustree_front(const struct bplustree *self)
+{
+    return bplustree_empty(self) ? NULL : *bplustree_begin(self);
+}
+
+static inline void *bplustree_back(const struct bplustree *self)
+{
+    return bplustree_empty(self) ? NULL : *bplustree_rbegin(self);
+}
+
+/* Number of keys of 'x' which are less than (bias 0) or not greater than
+ * (bias -1) 'ke'. */
+static inline unsigned int __bpnode_search(const struct bplustree *self,
+                                           void *const *key, unsigned int n,
+                                           const void *ke, int bias)
+{
+    unsigned int left = 0, right = n;
+
+    while (left < right) {
+        unsigned int mid = (left + right) / 2;
+
+        if (self->compar_(ke, key[mid]) > bias) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+
+    return left;
+}
+
+static inline struct bpleaf *__bplustree_leaf(const struct bplustree *self,
+                                              const void *ke)
+{
+    struct bpnode *x = self->root_;
+
+    while (!x->leaf_) {
+        struct bpinner *inner = __bpinner(x);
+
+        x = inner->child_[__bpnode_search(self, inner->key_, x->nr_keys_, ke,
+                                          -1)];
+    }
+
+    return __bpleaf(x);
+}
+
+static inline void **__bplustree_bound(const struct bplustree *self,
+                                       const void *ke, int bias)
+{
+    if (bplustree_empty(self)) {
+        return NULL;
+    }
+
+    struct bpleaf *leaf = __bplustree_leaf(self, ke);
+    unsigned int pos =
+        __bpnode_search(self, leaf->entry_, leaf->node_.nr_keys_, ke, bias);
+
+    if (pos < leaf->node_.nr_keys_) {
+        return &leaf->entry_[pos];
+    }
+
+    return leaf->next_ == NULL ? NULL : &leaf->next_->entry_[0];
+}
+
+static inline void **bplustree_lower_bound(const struct bplustree *self,
+                                           const void *ke)
+{
+    return __bplustree_bound(self, ke, 0);
+}
+
+static inline void **bplustree_upper_bound(const struct bplustree *self,
+                                           const void *ke)
+{
+    return __bplustree_bound(self, ke, -1);
+}
+
+static inline void **bplustree_find(const struct bplustree *self,
+                                    const void *ke)
+{
+    void **x = bplustree_lower_bound(self, ke);
+
+    return (x != NULL && self->compar_(ke, *x) == 0) ? x : NULL;
+}
+
+static inline unsigned int __bpnode_index(const struct bpnode *x)
+{
+    const struct bpinner *parent = __bpinner(x->parent_);
+    unsigned int i = 0;
+
+    while (parent->child_[i] != x) {
+        i++;
+    }
+
+    return i;
+}
+
+/* The first entry of 'leaf' changed : update the key which refers to it. */
+static inline void __bplustree_update_key(struct bpleaf *leaf)
+{
+    struct bpnode *x = &leaf->node_;
+
+    while (x->parent_ != NULL) {
+        unsigned int i = __bpnode_index(x);
+
+        if (i > 0) {
+            __bpinner(x->parent_)->key_[i - 1] = leaf->entry_[0];
+            return;
+        }
+
+        x = x->parent_;
+    }
+}
+
+/* Depth bound for the nodes reserved by an insertion. */
+#define BPLUSTREE_MAX_DEPTH 32
+
+/*
+ * Allocates the nodes a split of 'leaf' may need, one per full node on the
+ * path to the root plus a new root, so that a failed allocation leaves the
+ * tree untouched.
+ */
+static inline int __bplustree_reserve(struct bpleaf *leaf,
+                                      struct bpnode **spare)
+{
+    const struct bpnode *x = &leaf->node_;
+    unsigned int max = BPLUSTREE_LEAF_MAX, n = 0;
+
+    while (x != NULL && x->nr_keys_ == max) {
+        n++;
+        x = x->parent_;
+        max = BPLUSTREE_INNER_MAX;
+    }
+
+    if (x == NULL) {
+        n++;
+    }
+
+    for (unsigned int i = 0; i < n; i++) {
+        if ((spare[i] = __bpnode_alloc(i == 0)) == NULL) {
+            while (i-- > 0) {
+                free(spare[i]);
+            }
+
+            return -ENOMEM;
+        }
+    }
+
+    return 0;
+}
+
+/* Links 'right' after 'left' with 'key' as separator in their parent. */
+static inline void __bplustree_insert_parent(struct bplustree *self,
+                                             struct bpnode *left, void *key,
+                                             struct bpnode *right,
+                                             struct bpnode **spare)
+{
+    struct bpinner *parent;
+    unsigned int i;
+
+    if (left->parent_ == NULL) {
+        parent = __bpinner(*spare);
+        parent->key_[0] = key;
+        parent->child_[0] = left;
+        parent->child_[1] = right;
+        parent->node_.nr_keys_ = 1;
+        left->parent_ = right->parent_ = &parent->node_;
+        self->root_ = &parent->node_;
+
+        return;
+    }
+
+    parent = __bpinner(left->parent_);
+    i = __bpnode_index(left);
+
+    if (parent->node_.nr_keys_ < BPLUSTREE_INNER_MAX) {
+        unsigned int n = parent->node_.nr_keys_;
+
+        memmove(&parent->key_[i + 1], &parent->key_[i],
+                (n - i) * sizeof(parent->key_[0]));
+        memmove(&parent->child_[i + 2], &parent->child_[i + 1],
+                (n - i) * sizeof(parent->child_[0]));
+        parent->key_[i] = key;
+        parent->child_[i + 1] = right;
+        parent->node_.nr_keys_++;
+        right->parent_ = &parent->node_;
+
+        return;
+    }
+
+    /* Split a full inner node around its middle key. */
+    void *key_[BPLUSTREE_INNER_MAX + 1];
+    struct bpnode *child_[BPLUSTREE_INNER_MAX + 2];
+    struct bpinner *sibling = __bpinner(*spare++);
+    unsigned int n = BPLUSTREE_INNER_MAX + 1, mid = n / 2;
+
+    memcpy(key_, parent->key_, i * sizeof(key_[0]));
+    key_[i] = key;
+    memcpy(&key_[i + 1], &parent->key_[i],
+           (BPLUSTREE_INNER_MAX - i) * sizeof(key_[0]));
+    memcpy(child_, parent->child_, (i + 1) * sizeof(child_[0]));
+    child_[i + 1] = right;
+    memcpy(&child_[i + 2], &parent->child_[i + 1],
+           (BPLUSTREE_INNER_MAX - i) * sizeof(child_[0]));
+
+    memcpy(parent->key_, key_, mid * sizeof(key_[0]));
+    memcpy(parent->child_, child_, (mid + 1) * sizeof(child_[0]));
+    parent->node_.nr_keys_ = mid;
+
+    memcpy(sibling->key_, &key_[mid + 1], (n - mid - 1) * sizeof(key_[0]));
+    memcpy(sibling->child_, &child_[mid + 1], (n - mid) * sizeof(child_[0]));
+    sibling->node_.nr_keys_ = n - mid - 1;
+
+    for (unsigned int j = 0; j <= mid; j++) {
+        parent->child_[j]->parent_ = &parent->node_;
+    }
+
+    for (unsigned int j = 0; j <= sibling->node_.nr_keys_; j++) {
+        sibling->child_[j]->parent_ = &sibling->node_;
+    }
+
+    __bplustree_insert_parent(self, &parent->node_, key_[mid],
+                              &sibling->node_, spare);
+}
+
+static inline int bplustree_insert(struct bplustree *self, void *e)
+{
+    struct bpleaf *leaf;
+    unsigned int pos, n;
+
+    if (self->root_ == NULL) {
+        leaf = __bpleaf(__bpnode_alloc(true));
+
+        if (leaf == NULL) {
+            return -ENOMEM;
+        }
+
+        leaf->prev_ = leaf->next_ = NULL;
+        self->root_ = &leaf->node_;
+        self->head_ = self->tail_ = leaf;
+    }
+
+    leaf = __bplustree_leaf(self, e);
+    n = leaf->node_.nr_keys_;
+    pos = __bpnode_search(self, leaf->entry_, n, e, 0);
+
+    if ((pos < n) && (self->compar_(e, leaf->entry_[pos]) == 0)) {
+        return -EEXIST;
+    }
+
+    self->size_++;
+
+    if (n < BPLUSTREE_LEAF_MAX) {
+        memmove(&leaf->entry_[pos + 1], &leaf->entry_[pos],
+                (n - pos) * sizeof(leaf->entry_[0]));
+        leaf->entry_[pos] = e;
+        leaf->node_.nr_keys_++;
+
+        return 0;
+    }
+
+    /* Split a full leaf : the upper half moves to a new right sibling. */
+    struct bpnode *spare[BPLUSTREE_MAX_DEPTH + 1];
+    unsigned int mid = (BPLUSTREE_LEAF_MAX + 1) / 2;
+    struct bpleaf *sibling;
+
+    if (__bplustree_reserve(leaf, spare) != 0) {
+        self->size_--;
+        return -ENOMEM;
+    }
+
+    sibling = __bpleaf(spare[0]);
+
+    if (pos < mid) {
+        memcpy(sibling->entry_, &leaf->entry_[mid - 1],
+               (n - mid + 1) * sizeof(leaf->entry_[0]));
+        memmove(&leaf->entry_[pos + 1], &leaf->entry_[pos],
+                (mid - 1 - pos) * sizeof(leaf->entry_[0]));
+        leaf->entry_[pos] = e;
+    } else {
+        memcpy(sibling->entry_, &leaf->entry_[mid],
+               (pos - mid) * sizeof(leaf->entry_[0]));
+        sibling->entry_[pos - mid] = e;
+        memcpy(&sibling->entry_[pos - mid + 1], &leaf->entry_[pos],
+               (n - pos) * sizeof(leaf->entry_[0]));
+    }
+
+    leaf->node_.nr_keys_ = mid;
+    sibling->node_.nr_keys_ = n + 1 - mid;
+
+    sibling->prev_ = leaf;
+    sibling->next_ = leaf->next_;
+
+    if (leaf->next_ != NULL) {
+        leaf->next_->prev_ = sibling;
+    } else {
+        self->tail_ = sibling;
+    }
+
+    leaf->next_ = sibling;
+
+    __bplustree_insert_parent(self, &leaf->node_, sibling->entry_[0],
+                              &sibling->node_, &spare[1]);
+
+    return 0;
+}
+
+/* Removes key_[i] and child_[i + 1] from 'x'. */
+static inline void __bpinner_remove(struct bpinner *x, unsigned int i)
+{
+    unsigned int n = x->node_.nr_keys_;
+
+    memmove(&x->key_[i], &x->key_[i + 1], (n - i - 1) * sizeof(x->key_[0]));
+    memmove(&x->child_[i + 1], &x->child_[i + 2],
+            (n - i - 1) * sizeof(x->child_[0]));
+    x->node_.nr_keys_--;
+}
+
+static inline void __bplustree_rebalance_inner(struct bplustree *self,
+                                               struct bpinner *x)
+{
+    while (true) {
+        if (x->node_.parent_ == NULL) {
+            if (x->node_.nr_keys_ == 0) {
+                self->root_ = x->child_[0];
+                self->root_->parent_ = NULL;
+                free(x);
+            }
+
+            return;
+        }
+
+        if (x->node_.nr_keys_ >= BPLUSTREE_INNER_MIN) {
+            return;
+        }
+
+        struct bpinner *parent = __bpinner(x->node_.parent_);
+        unsigned int i = __bpnode_index(&x->node_);
+        struct bpinner *left = i > 0 ? __bpinner(parent->child_[i - 1]) : NULL;
+        struct bpinner *right = i < parent->node_.nr_keys_ ?
+                                    __bpinner(parent->child_[i + 1]) :
+                                    NULL;
+        unsigned int n = x->node_.nr_keys_;
+
+        if ((left != NULL) && (left->node_.nr_keys_ > BPLUSTREE_INNER_MIN)) {
+            unsigned int m = left->node_.nr_keys_;
+
+            memmove(&x->key_[1], &x->key_[0], n * sizeof(x->key_[0]));
+            memmove(&x->child_[1], &x->child_[0],
+                    (n + 1) * sizeof(x->child_[0]));
+            x->key_[0] = parent->key_[i - 1];
+            x->child_[0] = left->child_[m];
+            x->child_[0]->parent_ = &x->node_;
+            x->node_.nr_keys_++;
+            parent->key_[i - 1] = left->key_[m - 1];
+            left->node_.nr_keys_--;
+
+            return;
+        }
+
+        if ((right != NULL) && (right->node_.nr_keys_ > BPLUSTREE_INNER_MIN)) {
+            unsigned int m = right->node_.nr_keys_;
+
+            x->key_[n] = parent->key_[i];
+            x->child_[n + 1] = right->child_[0];
+            x->child_[n + 1]->parent_ = &x->node_;
+            x->node_.nr_keys_++;
+            parent->key_[i] = right->key_[0];
+            memmove(&right->key_[0], &right->key_[1],
+                    (m - 1) * sizeof(right->key_[0]));
+            memmove(&right->child_[0], &right->child_[1],
+                    m * sizeof(right->child_[0]));
+            right->node_.nr_keys_--;
+
+            return;
+        }
+
+        /* Merge with a sibling, pulling their separator down. */
+        if (left != NULL) {
+            right = x;
+            x = left;
+            i--;
+        }
+
+        n = x->node_.nr_keys_;
+        x->key_[n] = parent->key_[i];
+        memcpy(&x->key_[n + 1], right->key_,
+               right->node_.nr_keys_ * sizeof(x->key_[0]));
+        memcpy(&x->child_[n + 1], right->child_,
+               (right->node_.nr_keys_ + 1) * sizeof(x->child_[0]));
+
+        for (unsigned int j = n + 1; j <= n + 1 + right->node_.nr_keys_; j++) {
+            x->child_[j]->parent_ = &x->node_;
+        }
+
+        x->node_.nr_keys_ += right->node_.nr_keys_ + 1;
+        __bpinner_remove(parent, i);
+        free(right);
+
+        x = parent;
+    }
+}
+
+static inline void __bplustree_rebalance_leaf(struct bplustree *self,
+                                              struct bpleaf *x)
+{
+    if (x->node_.parent_ == NULL) {
+        if (x->node_.nr_keys_ == 0) {
+            free(x);
+            self->root_ = NULL;
+            self->head_ = self->tail_ = NULL;
+        }
+
+        return;
+    }
+
+    if (x->node_.nr_keys_ >= BPLUSTREE_LEAF_MIN) {
+        return;
+    }
+
+    struct bpinner *parent = __bpinner(x->node_.parent_);
+    unsigned int i = __bpnode_index(&x->node_);
+    struct bpleaf *left = i > 0 ? __bpleaf(parent->child_[i - 1]) : NULL;
+    struct bpleaf *right =
+        i < parent->node_.nr_keys_ ? __bpleaf(parent->child_[i + 1]) : NULL;
+    unsigned int n = x->node_.nr_keys_;
+
+    if ((left != NULL) && (left->node_.nr_keys_ > BPLUSTREE_LEAF_MIN)) {
+        memmove(&x->entry_[1], &x->entry_[0], n * sizeof(x->entry_[0]));
+        x->entry_[0] = left->entry_[--left->node_.nr_keys_];
+        x->node_.nr_keys_++;
+        parent->key_[i - 1] = x->entry_[0];
+
+        return;
+    }
+
+    if ((right != NULL) && (right->node_.nr_keys_ > BPLUSTREE_LEAF_MIN)) {
+        x->entry_[n] = right->entry_[0];
+        x->node_.nr_keys_++;
+        memmove(&right->entry_[0], &right->entry_[1],
+                --right->node_.nr_keys_ * sizeof(right->entry_[0]));
+        parent->key_[i] = right->entry_[0];
+
+        if (n == 0) {
+            __bplustree_update_key(x);
+        }
+
+        return;
+    }
+
+    /* Merge with a sibling. */
+    if (left != NULL) {
+        right = x;
+        x = left;
+        i--;
+    }
+
+    memcpy(&x->entry_[x->node_.nr_keys_], right->entry_,
+           right->node_.nr_keys_ * sizeof(x->entry_[0]));
+    x->node_.nr_keys_ += right->node_.nr_keys_;
+    x->next_ = right->next_;
+
+    if (right->next_ != NULL) {
+        right->next_->prev_ = x;
+    } else {
+        self->tail_ = x;
+    }
+
+    if (x->node_.nr_keys_ == right->node_.nr_keys_) {
+        /* 'x' was empty. */
+        __bplustree_update_key(x);
+    }
+
+    __bpinner_remove(parent, i);
+    free(right);
+    __bplustree_rebalance_inner(self, parent);
+}
+
+/* Erases the entry at 'x', which must be a valid iterator of the tree. */
+static inline void *bplustree_erase(struct bplustree *self, void **x)
+{
+    struct bpleaf *leaf;
+    unsigned int pos;
+    void *e;
+
+    if (x == NULL) {
+        return NULL;
+    }
+
+    leaf = __bpleaf_of(x);
+    pos = x - leaf->entry_;
+    e = *x;
+
+    memmove(&leaf->entry_[pos], &leaf->entry_[pos + 1],
+            (leaf->node_.nr_keys_ - pos - 1) * sizeof(leaf->entry_[0]));
+    leaf->node_.nr_keys_--;
+    self->size_--;
+
+    if ((pos == 0) && (leaf->node_.nr_keys_ > 0)) {
+        __bplustree_update_key(leaf);
+    }
+
+    __bplustree_rebalance_leaf(self, leaf);
+
+    return e;
+}
+
+static inline void *bplustree_pop_front(struct bplustree *self)
+{
+    return bplustree_erase(self, bplustree_begin(self));
+}
+
+static inline void *bplustree_pop_back(struct bplustree *self)
+{
+    return bplustree_erase(self, bplustree_rbegin(self));
+}
+
+/*
+ * The n-th entry from 0, or NULL. The nodes keep no subtree counts, so this
+ * walks the leaf chain from the front : O(n / BPLUSTREE_LEAF_MIN), where
+ * rbtree_at() is O(log(n)). Meant for occasional use, not for random access.
+ */
+static inline void *bplustree_at(const struct bplustree *self, size_t n)
+{
+    for (struct bpleaf *leaf = self->head_; leaf != NULL;
+         leaf = leaf->next_) {
+        if (n < leaf->node_.nr_keys_) {
+            return leaf->entry_[n];
+        }
+
+        n -= leaf->node_.nr_keys_;
+    }
+
+    return NULL;
+}
+
+/* Returns the depth of the leaves under 'x', or -1 if 'x' is broken. */
+static inline int __bplustree_validate_node(const struct bplustree *self,
+                                            const struct bpnode *x,
+                                            size_t *size)
+{
+    unsigned int min = x->leaf_ ? BPLUSTREE_LEAF_MIN : BPLUSTREE_INNER_MIN;
+
+    if ((x->parent_ != NULL) && (x->nr_keys_ < min)) {
+        return -1;
+    }
+
+    if (x->leaf_) {
+        const struct bpleaf *leaf = __bpleaf(x);
+
+        for (unsigned int i = 1; i < x->nr_keys_; i++) {
+            if (self->compar_(leaf->entry_[i - 1], leaf->entry_[i]) >= 0) {
+                return -1;
+            }
+        }
+
+        *size += x->nr_keys_;
+
+        return 0;
+    }
+
+    const struct bpinner *inner = __bpinner(x);
+    int depth = -1;
+
+    for (unsigned int i = 0; i <= x->nr_keys_; i++) {
+        const struct bpnode *child = inner->child_[i];
+        const struct bpnode *first = child;
+        int d;
+
+        if (child->parent_ != x) {
+            return -1;
+        }
+
+        while (!first->leaf_) {
+            first = __bpinner(first)->child_[0];
+        }
+
+        if ((i > 0) && (inner->key_[i - 1] != __bpleaf(first)->entry_[0])) {
+            return -1;
+        }
+
+        d = __bplustree_validate_node(self, child, size);
+
+        if ((d < 0) || ((depth >= 0) && (d != depth))) {
+            return -1;
+        }
+
+        depth = d;
+    }
+
+    return depth + 1;
+}
+
+static inline bool bplustree_validate(const struct bplustree *self)
+{
+    size_t size = 0;
+
+    if (self->root_ == NULL) {
+        return self->size_ == 0;
+    }
+
+    if (__bplustree_validate_node(self, self->root_, &size) < 0) {
+        return false;
+    }
+
+    if (bplustree_size(self) != size) {
+        return false;
+    }
+
+    size = 0;
+
+    const void *prev = NULL;
+
+    for (void **x = bplustree_begin(self); x != bplustree_end(self);
+         x = bplustree_next(self, x)) {
+        if ((prev != NULL) && (self->compar_(prev, *x) >= 0)) {
+            return false;
+        }
+
+        prev = *x;
+        size++;
+    }
+
+    return bplustree_size(self) == size;
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_BPLUSTREE_H__ */
@@ -11,6 +11,11 @@
 #include <errno.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+#ifdef BSTREE_STATS
+#include "tree_stats.h"
+#endif /* BSTREE_STATS */
 
 #ifdef __cplusplus
 namespace rcn_c
@@ -22,18 +27,58 @@ struct bsnode {
     struct bsnode *left_;
     struct bsnode *right_;
     void *entry_;
+#ifdef BSTREE_KEY_PREFIX
+    uint64_t key_;
+#endif /* BSTREE_KEY_PREFIX */
 };
 
+#ifdef BSTREE_SCAPEGOAT
+/*
+ * Scapegoat tree, after I. Galperin, R. L. Rivest, "Scapegoat Trees", SODA
+ * 1993 : the nodes keep no balance data at all. An insert deeper than
+ * log(n) in base 1/alpha walks back up to the first ancestor whose child
+ * on the way holds more than alpha of its nodes, and rebuilds that subtree
+ * perfectly balanced. The whole tree is rebuilt once erasing has taken it
+ * below alpha of its largest size since the last full rebuild. Updates are
+ * O(log(n)) amortized, lookups O(log(n)).
+ *
+ * Alpha is in percent, from 51 to 99 : lower keeps the tree flatter for
+ * more rebuilds.
+ */
+#ifndef BSTREE_SCAPEGOAT_ALPHA
+#define BSTREE_SCAPEGOAT_ALPHA 70
+#endif /* BSTREE_SCAPEGOAT_ALPHA */
+#endif /* BSTREE_SCAPEGOAT */
+
 struct bstree {
     struct bsnode *root_;
     int (*compar_)(const void *ke, const void *in_tree);
+#ifdef BSTREE_KEY_PREFIX
+    uint64_t (*key_of_)(const void *e);
+#endif /* BSTREE_KEY_PREFIX */
     size_t size_;
+#ifdef BSTREE_SCAPEGOAT
+    size_t max_size_;
+#endif /* BSTREE_SCAPEGOAT */
+#ifdef BSTREE_STATS
+    struct tree_stats stats_;
+#endif /* BSTREE_STATS */
 };
 
+#ifdef BSTREE_STATS
+#define __BSTREE_STATS(self, field, n) \
+    TREE_STATS_ADD(&(self)->stats_, field, n)
+#else
+#define __BSTREE_STATS(self, field, n) ((void)0)
+#endif /* BSTREE_STATS */
+
 static inline void bstree_clear(struct bstree *self)
 {
     self->root_ = NULL;
     self->size_ = 0;
+#ifdef BSTREE_SCAPEGOAT
+    self->max_size_ = 0;
+#endif /* BSTREE_SCAPEGOAT */
 }
 
 static inline void bstree_init(struct bstree *self,
@@ -42,7 +87,77 @@ static inline void bstree_init(struct bstree *self,
 {
     bstree_clear(self);
     self->compar_ = compar;
+#ifdef BSTREE_KEY_PREFIX
+    self->key_of_ = NULL;
+#endif /* BSTREE_KEY_PREFIX */
+#ifdef BSTREE_STATS
+    tree_stats_reset(&self->stats_);
+#endif /* BSTREE_STATS */
+}
+
+#ifdef BSTREE_KEY_PREFIX
+/*
+ * Each node keeps a 64 bit key computed from its entry by 'key_of', as in
+ * rbtree_init_keyed(). compar is then only called on a tie.
+ */
+static inline void
+bstree_init_keyed(struct bstree *self,
+                  int (*compar)(const void *ke, const void *in_tree),
+                  uint64_t (*key_of)(const void *e))
+{
+    bstree_init(self, compar);
+    self->key_of_ = key_of;
+}
+
+static inline uint64_t __bstree_key(const struct bstree *self, const void *e)
+{
+    return self->key_of_ != NULL ? self->key_of_(e) : 0;
+}
+
+static inline uint64_t __bsnode_key(const struct bsnode *x)
+{
+    return x->key_;
+}
+
+static inline void __bsnode_set_entry(const struct bstree *self,
+                                      struct bsnode *x, void *e)
+{
+    x->entry_ = e;
+    x->key_ = __bstree_key(self, e);
+}
+
+static inline int __bstree_compar(const struct bstree *self, uint64_t key,
+                                  const void *ke, const struct bsnode *x)
+{
+    if (key != x->key_) {
+        return key < x->key_ ? -1 : 1;
+    }
+
+    return self->compar_(ke, x->entry_);
+}
+#else
+static inline uint64_t __bstree_key(const struct bstree *self, const void *e)
+{
+    return 0;
+}
+
+static inline uint64_t __bsnode_key(const struct bsnode *x)
+{
+    return 0;
+}
+
+static inline void __bsnode_set_entry(const struct bstree *self,
+                                      struct bsnode *x, void *e)
+{
+    x->entry_ = e;
+}
+
+static inline int __bstree_compar(const struct bstree *self, uint64_t key,
+                                  const void *ke, const struct bsnode *x)
+{
+    return self->compar_(ke, x->entry_);
 }
+#endif /* BSTREE_KEY_PREFIX */
 
 static inline bool bstree_empty(const struct bstree *self)
 {
@@ -156,38 +271,246 @@ static inline void *bstree_back(const struct bstree *self)
     return bstree_empty(self) ? NULL : bstree_rbegin(self)->entry_;
 }
 
-static inline int bstree_insert(struct bstree *self, struct bsnode *z, void *e)
+/*
+ * Links the first 'n' nodes of 'list', chained by right_, into a perfectly
+ * balanced subtree and returns its root, with a stale parent_. '*list' is
+ * left at the next node.
+ */
+static struct bsnode *__bstree_build(struct bsnode **list, size_t n)
+{
+    struct bsnode *l, *x;
+
+    if (n == 0) {
+        return NULL;
+    }
+
+    l = __bstree_build(list, (n - 1) / 2);
+    x = *list;
+    *list = x->right_;
+
+    if ((x->left_ = l) != NULL) {
+        l->parent_ = x;
+    }
+
+    if ((x->right_ = __bstree_build(list, n - 1 - (n - 1) / 2)) != NULL) {
+        x->right_->parent_ = x;
+    }
+
+    return x;
+}
+
+/* Rebuilds the subtree 'y' of 'n' nodes perfectly balanced. O(n). */
+static inline void __bstree_rebuild(struct bstree *self, struct bsnode *y,
+                                    size_t n)
+{
+    struct bsnode *parent = y->parent_, *x = y, *list = NULL, *prev;
+    struct bsnode **link = parent == NULL   ? &self->root_
+                           : y == parent->left_ ? &parent->left_
+                                                : &parent->right_;
+
+    while (x->right_ != NULL) {
+        x = x->right_;
+    }
+
+    /* Backwards, so that right_ may chain the nodes already passed. */
+    for (size_t i = 0; i < n; i++) {
+        prev = bstree_prev(self, x);
+        x->right_ = list;
+        list = x;
+        x = prev;
+    }
+
+    *link = __bstree_build(&list, n);
+    (*link)->parent_ = parent;
+
+    __BSTREE_STATS(self, nr_fixups_, 1);
+    __BSTREE_STATS(self, nr_rebuilt_, n);
+}
+
+/*
+ * Rebuilds the tree perfectly balanced, of height floor(log2(n)) + 1, in
+ * O(n) without allocating.
+ */
+static inline void bstree_rebalance(struct bstree *self)
+{
+    if (self->root_ != NULL) {
+        __bstree_rebuild(self, self->root_, self->size_);
+    }
+
+#ifdef BSTREE_SCAPEGOAT
+    self->max_size_ = self->size_;
+#endif /* BSTREE_SCAPEGOAT */
+}
+
+#ifdef BSTREE_SCAPEGOAT
+static size_t __bsnode_count(const struct bsnode *x)
+{
+    return x == NULL ? 0 : __bsnode_count(x->left_) + 1 +
+                               __bsnode_count(x->right_);
+}
+
+/* True if 'depth' is above log(n) in base 1/alpha. */
+static inline bool __bstree_too_deep(size_t depth, size_t n)
+{
+    double bound = 1.0;
+
+    while (depth-- > 0) {
+        if ((bound *= 100.0 / BSTREE_SCAPEGOAT_ALPHA) > n) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static inline void __bstree_scapegoat(struct bstree *self, struct bsnode *z)
+{
+    struct bsnode *x, *y;
+    size_t depth = 0, size = 1, total;
+
+    if (self->max_size_ < self->size_) {
+        self->max_size_ = self->size_;
+    }
+
+    for (x = z; x->parent_ != NULL; x = x->parent_) {
+        depth++;
+    }
+
+    if (!__bstree_too_deep(depth, self->size_)) {
+        return;
+    }
+
+    for (x = z; (y = x->parent_) != NULL; x = y) {
+        total = size + 1 + __bsnode_count(x == y->left_ ? y->right_ : y->left_);
+
+        if (100 * size > BSTREE_SCAPEGOAT_ALPHA * total) {
+            __bstree_rebuild(self, y, total);
+            return;
+        }
+
+        size = total;
+    }
+
+    /* Only after an erase_range(), which may leave the tree a level off. */
+    bstree_rebalance(self);
+}
+
+static inline void __bstree_shrink(struct bstree *self)
+{
+    if (100 * self->size_ < BSTREE_SCAPEGOAT_ALPHA * self->max_size_) {
+        bstree_rebalance(self);
+    }
+}
+#else
+static inline void __bstree_scapegoat(struct bstree *self, struct bsnode *z)
+{
+}
+
+static inline void __bstree_shrink(struct bstree *self)
+{
+}
+#endif /* BSTREE_SCAPEGOAT */
+
+/* Links 'z' holding 'e' as the 'diff' side child of 'y', or as the root. */
+static inline void __bstree_link(struct bstree *self, struct bsnode *y,
+                                 int diff, struct bsnode *z, void *e)
+{
+    __bsnode_set_entry(self, z, e);
+    z->parent_ = y;
+    z->left_ = z->right_ = NULL;
+
+    if (y == NULL) {
+        self->root_ = z;
+    } else if (diff < 0) {
+        y->left_ = z;
+    } else {
+        y->right_ = z;
+    }
+
+    __BSTREE_STATS(self, nr_inserts_, 1);
+    self->size_++;
+    __bstree_scapegoat(self, z);
+}
+
+/*
+ * Returns the node holding an entry equal to 'e', or NULL after linking 'z'
+ * holding 'e' where it belongs.
+ */
+static inline struct bsnode *__bstree_insert(struct bstree *self,
+                                             struct bsnode *z, void *e)
 {
     struct bsnode *x = self->root_;
     struct bsnode *y = NULL;
+    uint64_t key = __bstree_key(self, e);
     int diff = 0;
 
     while (x != NULL) {
         y = x;
-        diff = self->compar_(e, y->entry_);
+        diff = __bstree_compar(self, key, e, y);
+        __BSTREE_STATS(self, nr_insert_compars_, 1);
 
         if (diff < 0) {
             x = x->left_;
         } else if (diff > 0) {
             x = x->right_;
         } else {
-            return -EEXIST;
+            return x;
         }
     }
 
-    z->entry_ = e;
-    z->parent_ = y;
-    z->left_ = z->right_ = NULL;
+    __bstree_link(self, y, diff, z, e);
 
-    if (y == NULL) {
-        self->root_ = z;
-    } else if (diff < 0) {
-        y->left_ = z;
-    } else {
-        y->right_ = z;
+    return NULL;
+}
+
+static inline int bstree_insert(struct bstree *self, struct bsnode *z, void *e)
+{
+    return __bstree_insert(self, z, e) == NULL ? 0 : -EEXIST;
+}
+
+/*
+ * Inserts 'z' holding 'e' unless an equal entry is there already. Returns
+ * the node holding the entry in the tree, which is 'z' if it was inserted.
+ */
+static inline struct bsnode *bstree_insert_or_get(struct bstree *self,
+                                                  struct bsnode *z, void *e)
+{
+    struct bsnode *x = __bstree_insert(self, z, e);
+
+    return x == NULL ? z : x;
+}
+
+/*
+ * Inserts 'z' holding 'e' right after 'hint', or first if 'hint' is NULL,
+ * without a descent when 'e' does belong there. Otherwise falls back to
+ * bstree_insert().
+ */
+static inline int bstree_insert_hint(struct bstree *self, struct bsnode *hint,
+                                     struct bsnode *z, void *e)
+{
+    struct bsnode *next = hint == NULL ? bstree_begin(self) :
+                                         bstree_next(self, hint);
+    uint64_t key = __bstree_key(self, e);
+    int diff;
+
+    if (hint != NULL) {
+        if ((diff = __bstree_compar(self, key, e, hint)) <= 0) {
+            return diff == 0 ? -EEXIST : bstree_insert(self, z, e);
+        }
     }
 
-    self->size_++;
+    if (next != NULL) {
+        if ((diff = __bstree_compar(self, key, e, next)) >= 0) {
+            return diff == 0 ? -EEXIST : bstree_insert(self, z, e);
+        }
+    }
+
+    if ((hint != NULL) && (hint->right_ == NULL)) {
+        __bstree_link(self, hint, 1, z, e);
+    } else {
+        /* 'next' is the leftmost node of the right subtree of 'hint'. */
+        __bstree_link(self, next, -1, z, e);
+    }
 
     return 0;
 }
@@ -212,9 +535,14 @@ static inline struct bsnode *bstree_find(const struct bstree *self,
                                          const void *ke)
 {
     struct bsnode *x = self->root_;
+    uint64_t key = __bstree_key(self, ke);
+
+    __BSTREE_STATS(self, nr_finds_, 1);
 
     while (x != NULL) {
-        int diff = self->compar_(ke, x->entry_);
+        int diff = __bstree_compar(self, key, ke, x);
+
+        __BSTREE_STATS(self, nr_find_compars_, 1);
 
         if (diff == 0) {
             return x;
@@ -228,15 +556,49 @@ static inline struct bsnode *bstree_find(const struct bstree *self,
     return NULL;
 }
 
+/*
+ * Whether 'z' is a node of the tree, looked up as a find would, but left out
+ * of the statistics.
+ */
+static inline bool __bstree_has(const struct bstree *self,
+                                const struct bsnode *z)
+{
+    const struct bsnode *x = self->root_;
+    uint64_t key = __bstree_key(self, z->entry_);
+
+    while (x != NULL) {
+        int diff = __bstree_compar(self, key, z->entry_, x);
+
+        if (diff == 0) {
+            return x == z;
+        } else if (diff < 0) {
+            x = x->left_;
+        } else {
+            x = x->right_;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Unlinks 'z', which must be a node of the tree. 'z' is trusted as is when
+ * NDEBUG is defined, and looked up to check it otherwise.
+ */
 static inline void *bstree_erase(struct bstree *self, struct bsnode *z)
 {
-    struct bsnode *x = bstree_find(self, z->entry_);
     struct bsnode *y;
     void *e;
 
-    if ((x == NULL) || (x != z)) {
+    if (z == NULL) {
+        return NULL;
+    }
+
+#ifndef NDEBUG
+    if (!__bstree_has(self, z)) {
         return NULL;
     }
+#endif /* NDEBUG */
 
     e = z->entry_;
     y = z;
@@ -263,7 +625,9 @@ static inline void *bstree_erase(struct bstree *self, struct bsnode *z)
         y->left_->parent_ = y;
     }
 
+    __BSTREE_STATS(self, nr_erases_, 1);
     self->size_--;
+    __bstree_shrink(self);
 
     return e;
 }
@@ -294,9 +658,14 @@ static inline struct bsnode *bstree_lower_bound(const struct bstree *self,
 {
     struct bsnode *x = self->root_;
     struct bsnode *result = NULL;
+    uint64_t key = __bstree_key(self, ke);
+
+    __BSTREE_STATS(self, nr_finds_, 1);
 
     while (x != NULL) {
-        int diff = self->compar_(ke, x->entry_);
+        int diff = __bstree_compar(self, key, ke, x);
+
+        __BSTREE_STATS(self, nr_find_compars_, 1);
 
         if (diff <= 0) {
             result = x;
@@ -314,9 +683,14 @@ static inline struct bsnode *bstree_upper_bound(const struct bstree *self,
 {
     struct bsnode *x = self->root_;
     struct bsnode *result = NULL;
+    uint64_t key = __bstree_key(self, ke);
+
+    __BSTREE_STATS(self, nr_finds_, 1);
 
     while (x != NULL) {
-        int diff = self->compar_(ke, x->entry_);
+        int diff = __bstree_compar(self, key, ke, x);
+
+        __BSTREE_STATS(self, nr_find_compars_, 1);
 
         if (diff < 0) {
             result = x;
@@ -329,15 +703,239 @@ static inline struct bsnode *bstree_upper_bound(const struct bstree *self,
     return result;
 }
 
+/*
+ * Calls 'fn' on the entries from 'lo' included to 'hi' excluded, in order,
+ * and returns their number. Both ends are looked up once, so the walk in
+ * between calls compar no more. 'fn' must not change the tree.
+ */
+static inline size_t bstree_for_each_range(const struct bstree *self,
+                                           const void *lo, const void *hi,
+                                           void (*fn)(void *e, void *arg),
+                                           void *arg)
+{
+    struct bsnode *x, *end;
+    size_t n = 0;
+
+    if (self->compar_(lo, hi) >= 0) {
+        return 0;
+    }
+
+    end = bstree_lower_bound(self, hi);
+
+    for (x = bstree_lower_bound(self, lo); x != end;
+         x = bstree_next(self, x)) {
+        if (fn != NULL) {
+            fn(x->entry_, arg);
+        }
+
+        n++;
+    }
+
+    return n;
+}
+
+/*
+ * Number of entries from 'lo' included to 'hi' excluded. The nodes keep no
+ * subtree size, so the range is walked.
+ */
+static inline size_t bstree_count_range(const struct bstree *self,
+                                        const void *lo, const void *hi)
+{
+    return bstree_for_each_range(self, lo, hi, NULL, NULL);
+}
+
+/*
+ * Splits the subtree 'x' into the entries less than 'ke' in '*l' and the
+ * others in '*r', in one pass down : the nodes keep their relative order.
+ */
+static inline void __bstree_split(const struct bstree *self, struct bsnode *x,
+                                  const void *ke, struct bsnode **l,
+                                  struct bsnode **r)
+{
+    uint64_t key = __bstree_key(self, ke);
+    struct bsnode *lparent = NULL, *rparent = NULL;
+
+    while (x != NULL) {
+        if (__bstree_compar(self, key, ke, x) > 0) {
+            *l = x;
+            x->parent_ = lparent;
+            lparent = x;
+            l = &x->right_;
+            x = x->right_;
+        } else {
+            *r = x;
+            x->parent_ = rparent;
+            rparent = x;
+            r = &x->left_;
+            x = x->left_;
+        }
+    }
+
+    *l = *r = NULL;
+}
+
+/*
+ * Moves the entries from 'lo' included to 'hi' excluded into 'out', whose
+ * content is replaced, and returns their number. The range is cut out with
+ * two splits and the rest hung under the last node before it : O(h) for a
+ * tree of height h, plus counting the entries moved.
+ */
+static inline size_t bstree_erase_range(struct bstree *self, const void *lo,
+                                        const void *hi, struct bstree *out)
+{
+    struct bsnode *l, *m, *r;
+    size_t n = 0;
+
+    bstree_clear(out);
+
+    if (self->compar_(lo, hi) >= 0) {
+        return 0;
+    }
+
+    __bstree_split(self, self->root_, lo, &l, &m);
+    __bstree_split(self, m, hi, &m, &r);
+
+    self->root_ = l;
+
+    if (l == NULL) {
+        self->root_ = r;
+    } else {
+        while (l->right_ != NULL) {
+            l = l->right_;
+        }
+
+#ifdef BSTREE_SCAPEGOAT
+        /* The last node before the range over both parts : a level more. */
+        if (r != NULL) {
+            __bstree_transplant(self, l, l->left_);
+
+            if ((l->left_ = self->root_) != NULL) {
+                l->left_->parent_ = l;
+            }
+
+            self->root_ = l;
+            l->parent_ = NULL;
+        }
+#endif /* BSTREE_SCAPEGOAT */
+
+        l->right_ = r;
+    }
+
+    if (r != NULL) {
+        r->parent_ = l;
+    }
+
+    out->root_ = m;
+
+    for (struct bsnode *x = bstree_begin(out); x != bstree_end(out);
+         x = bstree_next(out, x)) {
+        n++;
+    }
+
+    self->size_ -= n;
+    out->size_ = n;
+#ifdef BSTREE_SCAPEGOAT
+    out->max_size_ = n;
+#endif /* BSTREE_SCAPEGOAT */
+    __bstree_shrink(self);
+
+    return n;
+}
+
+#ifdef BSTREE_STATS
+static inline const struct tree_stats *bstree_stats(const struct bstree *self)
+{
+    return &self->stats_;
+}
+
+static inline void bstree_stats_reset(struct bstree *self)
+{
+    tree_stats_reset(&self->stats_);
+}
+#endif /* BSTREE_STATS */
+
+/*
+ * Counts the nodes at each depth in hist[], the root at depth 0 and the ones
+ * at depth 'nr' - 1 or deeper in hist[nr - 1], and returns the height, 0 if
+ * the tree is empty. 'nr' must not be 0. O(n), without recursion.
+ */
+static inline size_t bstree_depth_histogram(const struct bstree *self,
+                                            size_t hist[], size_t nr)
+{
+    const struct bsnode *x = self->root_;
+    size_t depth = 0, height = 0;
+
+    for (size_t i = 0; i < nr; i++) {
+        hist[i] = 0;
+    }
+
+    if (x == NULL) {
+        return 0;
+    }
+
+    for (; x->left_ != NULL; x = x->left_) {
+        depth++;
+    }
+
+    while (x != NULL) {
+        const struct bsnode *parent;
+
+        hist[depth < nr ? depth : nr - 1]++;
+        height = depth + 1 > height ? depth + 1 : height;
+
+        if (x->right_ != NULL) {
+            for (x = x->right_, depth++; x->left_ != NULL; x = x->left_) {
+                depth++;
+            }
+
+            continue;
+        }
+
+        while (((parent = x->parent_) != NULL) && x == parent->right_) {
+            x = parent;
+            depth--;
+        }
+
+        x = parent;
+        depth--;
+    }
+
+    return height;
+}
+
 static inline bool bstree_validate(const struct bstree *self)
 {
+    struct bsnode *prev = NULL;
     size_t size = 0;
 
+    if ((self->root_ != NULL) && (self->root_->parent_ != NULL)) {
+        return false;
+    }
+
     for (struct bsnode *x = bstree_begin(self); x != bstree_end(self);
-         x = bstree_next(self, x)) {
+         prev = x, x = bstree_next(self, x)) {
+        if (__bsnode_key(x) != __bstree_key(self, x->entry_)) {
+            return false;
+        }
+
+        if (((x->left_ != NULL) && (x->left_->parent_ != x)) ||
+            ((x->right_ != NULL) && (x->right_->parent_ != x))) {
+            return false;
+        }
+
+        if ((prev != NULL) && (self->compar_(prev->entry_, x->entry_) >= 0)) {
+            return false;
+        }
+
         size++;
     }
 
+#ifdef BSTREE_SCAPEGOAT
+    if (self->max_size_ < size) {
+        return false;
+    }
+#endif /* BSTREE_SCAPEGOAT */
+
     return bstree_size(self) == size;
 }
 
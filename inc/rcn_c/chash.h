@@ -0,0 +1,653 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ *
+ * Reference : linux/lib/rhashtable.c
+ *             J. Triplett, P. E. McKenney, J. Walpole, "Resizable, Scalable,
+ *             Concurrent Hash Tables via Relativistic Programming", 2011
+ */
+
+/* Hash Table - Concurrent (Striped Locks, Lock-Free Lookups) */
+#ifndef __RCN_C_CHASH_H__
+#define __RCN_C_CHASH_H__
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "epoch.h"
+#include "ilog2.h"
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/*
+ * Any number of threads may insert, erase and look up at the same time.
+ * The buckets are picked by the high bits of the hash times a large odd
+ * constant, and so are the CHASH_NR_STRIPES locks : as there are never
+ * fewer buckets than locks, every bucket falls under a single lock, in a
+ * table of any size. Updates take the lock of their bucket, lookups take
+ * none and walk the chains as they are being changed.
+ *
+ * Once a stripe holds more than CHASH_MAX_LOAD percent of its share of the
+ * buckets, or less than CHASH_MIN_LOAD percent, and the whole table does
+ * too, a table twice the size of the table is linked to it as its future
+ * one. From then on, entries are inserted into the future table, lookups
+ * search the current table then the future ones, and every update moves up
+ * to CHASH_REHASH_STEP buckets over, each under its own lock : the chains
+ * are moved tail first, a node being linked into the future table before
+ * it is unlinked from the current one, so a lookup always finds it in one
+ * of the two. The update that moves the last bucket makes the future table
+ * the current one. No thread ever waits for the whole table to move.
+ *
+ * chash_find() must be called between chash_read_lock() and
+ * chash_read_unlock(). An erased node may still be walked through by the
+ * lookups : it may only be reused or freed after chash_synchronize()
+ * returned, which also frees the bucket arrays left by the resizes.
+ */
+#ifndef CHASH_NR_STRIPES
+#define CHASH_NR_STRIPES 256
+#endif /* CHASH_NR_STRIPES */
+
+#ifndef CHASH_MAX_LOAD
+#define CHASH_MAX_LOAD 100
+#endif /* CHASH_MAX_LOAD */
+
+#ifndef CHASH_MIN_LOAD
+#define CHASH_MIN_LOAD 10
+#endif /* CHASH_MIN_LOAD */
+
+#ifndef CHASH_REHASH_STEP
+#define CHASH_REHASH_STEP 4
+#endif /* CHASH_REHASH_STEP */
+
+struct chnode {
+    struct chnode *next_;
+    void *entry_;
+    uint64_t hash_;
+};
+
+struct __chash_table {
+    struct chnode **bucket_;
+    size_t nr_buckets_;
+    unsigned int shift_;
+    struct __chash_table *future_;
+    struct __chash_table *retired_;
+    size_t rehash_idx_;
+    size_t nr_moved_;
+};
+
+/* The lock of a stripe, and the number of entries under it. */
+struct __chash_stripe {
+    pthread_mutex_t lock_;
+    size_t size_;
+} __attribute__((aligned(64)));
+
+struct chash {
+    struct __chash_table *table_;
+    size_t (*key_hash_)(const void *ke);
+    int (*compar_)(const void *ke, const void *in_table);
+    bool resizing_;
+    struct __chash_table *retired_;
+    struct epoch epoch_;
+    struct __chash_stripe stripe_[CHASH_NR_STRIPES];
+};
+
+static inline uint64_t __chash_mix(const struct chash *self, const void *ke)
+{
+    return (uint64_t)self->key_hash_(ke) * 0x9e3779b97f4a7c15ULL;
+}
+
+static inline unsigned int __chash_shift(size_t nr)
+{
+    return 64 - (unsigned int)ilog2ll(nr);
+}
+
+static inline struct __chash_stripe *__chash_stripe(struct chash *self,
+                                                    uint64_t m)
+{
+    return &self->stripe_[m >> __chash_shift(CHASH_NR_STRIPES)];
+}
+
+static inline struct chnode **__chash_bucket(const struct __chash_table *t,
+                                             uint64_t m)
+{
+    return &t->bucket_[m >> t->shift_];
+}
+
+static inline struct chnode *__chash_load(struct chnode *const *x)
+{
+    return __atomic_load_n(x, __ATOMIC_ACQUIRE);
+}
+
+static inline void __chash_store(struct chnode **x, struct chnode *y)
+{
+    __atomic_store_n(x, y, __ATOMIC_RELEASE);
+}
+
+static inline struct __chash_table *__chash_table_alloc(size_t nr_buckets)
+{
+    struct __chash_table *t =
+        (struct __chash_table *)malloc(sizeof(struct __chash_table));
+
+    if (t == NULL) {
+        return NULL;
+    }
+
+    t->bucket_ = (struct chnode **)calloc(nr_buckets, sizeof(*t->bucket_));
+
+    if (t->bucket_ == NULL) {
+        free(t);
+        return NULL;
+    }
+
+    t->nr_buckets_ = nr_buckets;
+    t->shift_ = __chash_shift(nr_buckets);
+    t->future_ = NULL;
+    t->retired_ = NULL;
+    t->rehash_idx_ = 0;
+    t->nr_moved_ = 0;
+
+    return t;
+}
+
+static inline void __chash_table_free(struct __chash_table *t)
+{
+    free(t->bucket_);
+    free(t);
+}
+
+/* The smallest power of 2 of buckets, no fewer than the stripes, for 'n'. */
+static inline size_t __chash_nr_buckets(size_t n)
+{
+    size_t nr = CHASH_NR_STRIPES;
+
+    while (nr < n) {
+        nr <<= 1;
+    }
+
+    return nr;
+}
+
+/*
+ * Sets up a table of 'sz_bucket' buckets at first, rounded up to a power of
+ * 2 no less than CHASH_NR_STRIPES. Returns 0, or -ENOMEM.
+ */
+static inline int chash_init(struct chash *self, size_t sz_bucket,
+                             size_t (*key_hash)(const void *ke),
+                             int (*compar)(const void *ke,
+                                           const void *in_table))
+{
+    self->table_ = __chash_table_alloc(__chash_nr_buckets(sz_bucket));
+
+    if (self->table_ == NULL) {
+        return -ENOMEM;
+    }
+
+    self->key_hash_ = key_hash;
+    self->compar_ = compar;
+    self->resizing_ = false;
+    self->retired_ = NULL;
+    epoch_init(&self->epoch_);
+
+    for (size_t i = 0; i < CHASH_NR_STRIPES; i++) {
+        pthread_mutex_init(&self->stripe_[i].lock_, NULL);
+        self->stripe_[i].size_ = 0;
+    }
+
+    return 0;
+}
+
+/* Frees the tables. No other thread may use the table anymore. */
+static inline void chash_destroy(struct chash *self)
+{
+    struct __chash_table *t = self->retired_;
+
+    while (t != NULL) {
+        struct __chash_table *next = t->retired_;
+
+        __chash_table_free(t);
+        t = next;
+    }
+
+    if (self->table_->future_ != NULL) {
+        __chash_table_free(self->table_->future_);
+    }
+
+    __chash_table_free(self->table_);
+
+    for (size_t i = 0; i < CHASH_NR_STRIPES; i++) {
+        pthread_mutex_destroy(&self->stripe_[i].lock_);
+    }
+
+    epoch_destroy(&self->epoch_);
+}
+
+static inline size_t chash_size(const struct chash *self)
+{
+    size_t size = 0;
+
+    for (size_t i = 0; i < CHASH_NR_STRIPES; i++) {
+        size += __atomic_load_n(&self->stripe_[i].size_, __ATOMIC_RELAXED);
+    }
+
+    return size;
+}
+
+static inline bool chash_empty(const struct chash *self)
+{
+    return chash_size(self) == 0;
+}
+
+static inline bool chash_rehashing(const struct chash *self)
+{
+    return __atomic_load_n(&self->resizing_, __ATOMIC_ACQUIRE);
+}
+
+/* Returns the token to pass to chash_read_unlock(). */
+static inline unsigned int chash_read_lock(struct chash *self)
+{
+    return epoch_read_lock(&self->epoch_);
+}
+
+static inline void chash_read_unlock(struct chash *self, unsigned int token)
+{
+    epoch_read_unlock(&self->epoch_, token);
+}
+
+/* The buckets of the current table, those of the future one if resizing. */
+static inline size_t chash_buckets(struct chash *self)
+{
+    unsigned int token = chash_read_lock(self);
+    const struct __chash_table *t =
+        __atomic_load_n(&self->table_, __ATOMIC_ACQUIRE);
+    const struct __chash_table *f =
+        __atomic_load_n(&t->future_, __ATOMIC_ACQUIRE);
+    size_t nr = f != NULL ? f->nr_buckets_ : t->nr_buckets_;
+
+    chash_read_unlock(self, token);
+
+    return nr;
+}
+
+/*
+ * Waits until no thread can reach the nodes erased before the call, then
+ * frees the bucket arrays the resizes left. Must not be called between
+ * chash_read_lock() and chash_read_unlock().
+ */
+static inline void chash_synchronize(struct chash *self)
+{
+    struct __chash_table *t =
+        __atomic_exchange_n(&self->retired_, NULL, __ATOMIC_ACQUIRE);
+
+    epoch_synchronize(&self->epoch_);
+
+    while (t != NULL) {
+        struct __chash_table *next = t->retired_;
+
+        __chash_table_free(t);
+        t = next;
+    }
+}
+
+static inline struct chnode *__chash_search(const struct chash *self,
+                                            const struct __chash_table *t,
+                                            uint64_t m, const void *ke)
+{
+    for (struct chnode *x = __chash_load(__chash_bucket(t, m)); x != NULL;
+         x = __chash_load(&x->next_)) {
+        if ((x->hash_ == m) && (self->compar_(ke, x->entry_) == 0)) {
+            return x;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * The entry equal to 'ke', or NULL. Must be called under the read lock. A
+ * node moved meanwhile is linked into the future table before it leaves the
+ * current one : if it was missed in the one, it is in the other. A lookup
+ * that fell behind more than one resize follows the future tables in turn,
+ * as a table keeps its future one once replaced.
+ */
+static inline void *chash_find(const struct chash *self, const void *ke)
+{
+    uint64_t m = __chash_mix(self, ke);
+
+    for (const struct __chash_table *t =
+             __atomic_load_n(&self->table_, __ATOMIC_ACQUIRE);
+         t != NULL; t = __atomic_load_n(&t->future_, __ATOMIC_ACQUIRE)) {
+        struct chnode *x = __chash_search(self, t, m, ke);
+
+        if (x != NULL) {
+            return x->entry_;
+        }
+    }
+
+    return NULL;
+}
+
+/* Moves the chain of bucket 'n' of 't' to 'f', tail first. */
+static inline void __chash_move(struct __chash_table *t,
+                                struct __chash_table *f, size_t n)
+{
+    struct chnode **head = &t->bucket_[n];
+
+    while (*head != NULL) {
+        struct chnode **pos = head, *x, **to;
+
+        while ((*pos)->next_ != NULL) {
+            pos = &(*pos)->next_;
+        }
+
+        x = *pos;
+        to = __chash_bucket(f, x->hash_);
+        __chash_store(&x->next_, *to);
+        __chash_store(to, x);
+        __chash_store(pos, NULL);
+    }
+}
+
+static inline void __chash_finish(struct chash *self, struct __chash_table *t,
+                                  struct __chash_table *f)
+{
+    __atomic_store_n(&self->table_, f, __ATOMIC_RELEASE);
+
+    t->retired_ = __atomic_load_n(&self->retired_, __ATOMIC_RELAXED);
+
+    while (!__atomic_compare_exchange_n(&self->retired_, &t->retired_, t,
+                                        false, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED)) {
+    }
+
+    __atomic_store_n(&self->resizing_, false, __ATOMIC_RELEASE);
+}
+
+/*
+ * Moves up to CHASH_REHASH_STEP buckets of the current table to the future
+ * one, if any. The buckets are handed out to the updates one by one.
+ */
+static inline void __chash_help(struct chash *self)
+{
+    struct __chash_table *t = __atomic_load_n(&self->table_, __ATOMIC_ACQUIRE);
+    struct __chash_table *f = __atomic_load_n(&t->future_, __ATOMIC_ACQUIRE);
+    unsigned int shift = __chash_shift(CHASH_NR_STRIPES) - t->shift_;
+
+    if (f == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < CHASH_REHASH_STEP; i++) {
+        size_t n = __atomic_fetch_add(&t->rehash_idx_, 1, __ATOMIC_RELAXED);
+        struct __chash_stripe *stripe;
+
+        if (n >= t->nr_buckets_) {
+            return;
+        }
+
+        stripe = &self->stripe_[n >> shift];
+        pthread_mutex_lock(&stripe->lock_);
+        __chash_move(t, f, n);
+        pthread_mutex_unlock(&stripe->lock_);
+
+        if (__atomic_add_fetch(&t->nr_moved_, 1, __ATOMIC_ACQ_REL) ==
+            t->nr_buckets_) {
+            __chash_finish(self, t, f);
+            return;
+        }
+    }
+}
+
+/*
+ * Helps the resize on, or starts one if the stripe of 'size' entries, and
+ * then the whole table, are too full or too empty.
+ */
+static inline void __chash_resize(struct chash *self, size_t size)
+{
+    struct __chash_table *t, *f;
+    size_t per_stripe, nr;
+    bool expected = false;
+
+    if (__atomic_load_n(&self->resizing_, __ATOMIC_ACQUIRE)) {
+        __chash_help(self);
+        return;
+    }
+
+    t = __atomic_load_n(&self->table_, __ATOMIC_ACQUIRE);
+    per_stripe = t->nr_buckets_ / CHASH_NR_STRIPES;
+
+    if ((size * 100 <= per_stripe * CHASH_MAX_LOAD) &&
+        ((size * 100 >= per_stripe * CHASH_MIN_LOAD) ||
+         (t->nr_buckets_ <= CHASH_NR_STRIPES))) {
+        return;
+    }
+
+    size = chash_size(self);
+
+    if ((size * 100 <= t->nr_buckets_ * CHASH_MAX_LOAD) &&
+        ((size * 100 >= t->nr_buckets_ * CHASH_MIN_LOAD) ||
+         (t->nr_buckets_ <= CHASH_NR_STRIPES))) {
+        return;
+    }
+
+    nr = __chash_nr_buckets(size * 2);
+
+    if (!__atomic_compare_exchange_n(&self->resizing_, &expected, true, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    /* A resize may have ended since : start from its table. */
+    t = __atomic_load_n(&self->table_, __ATOMIC_ACQUIRE);
+    f = nr != t->nr_buckets_ ? __chash_table_alloc(nr) : NULL;
+
+    if (f == NULL) {
+        __atomic_store_n(&self->resizing_, false, __ATOMIC_RELEASE);
+        return;
+    }
+
+    __atomic_store_n(&t->future_, f, __ATOMIC_RELEASE);
+    __chash_help(self);
+}
+
+/*
+ * Moves a few buckets of a resize on, e.g. from an idle thread. Returns
+ * true while the resize goes on, as chash_rehashing() does.
+ */
+static inline bool chash_rehash(struct chash *self)
+{
+    unsigned int token = epoch_read_lock(&self->epoch_);
+
+    __chash_help(self);
+    epoch_read_unlock(&self->epoch_, token);
+
+    return chash_rehashing(self);
+}
+
+/*
+ * Unlinks 'z' from the chain of 't' it hashes to, if it is there. Called
+ * under the lock of the stripe.
+ */
+static inline bool __chash_unlink(struct __chash_table *t, struct chnode *z)
+{
+    for (struct chnode **pos = __chash_bucket(t, z->hash_); *pos != NULL;
+         pos = &(*pos)->next_) {
+        if (*pos == z) {
+            __chash_store(pos, z->next_);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Links 'z', unless an entry equal to 'e' is there already : -EEXIST. */
+static inline int chash_insert(struct chash *self, struct chnode *z, void *e)
+{
+    uint64_t m = __chash_mix(self, e);
+    struct __chash_stripe *stripe = __chash_stripe(self, m);
+    unsigned int token = epoch_read_lock(&self->epoch_);
+    struct __chash_table *t, *f;
+    struct chnode **head;
+    size_t size = 0;
+    int err = 0;
+
+    pthread_mutex_lock(&stripe->lock_);
+
+    /* Under the lock, so that the bucket cannot move meanwhile. */
+    t = __atomic_load_n(&self->table_, __ATOMIC_ACQUIRE);
+    f = __atomic_load_n(&t->future_, __ATOMIC_ACQUIRE);
+
+    if ((__chash_search(self, t, m, e) != NULL) ||
+        ((f != NULL) && (__chash_search(self, f, m, e) != NULL))) {
+        err = -EEXIST;
+    } else {
+        head = __chash_bucket(f != NULL ? f : t, m);
+        z->entry_ = e;
+        z->hash_ = m;
+        z->next_ = *head;
+        __chash_store(head, z);
+        size = stripe->size_ + 1;
+        __atomic_store_n(&stripe->size_, size, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_unlock(&stripe->lock_);
+
+    if (err == 0) {
+        __chash_resize(self, size);
+    }
+
+    epoch_read_unlock(&self->epoch_, token);
+
+    return err;
+}
+
+/*
+ * Unlinks 'z', which must be in the table, and returns its entry. Lookups
+ * may still walk through 'z' : see chash_synchronize().
+ */
+static inline void *chash_erase(struct chash *self, struct chnode *z)
+{
+    struct __chash_stripe *stripe = __chash_stripe(self, z->hash_);
+    unsigned int token = epoch_read_lock(&self->epoch_);
+    struct __chash_table *t, *f;
+    size_t size;
+
+    pthread_mutex_lock(&stripe->lock_);
+
+    t = __atomic_load_n(&self->table_, __ATOMIC_ACQUIRE);
+    f = __atomic_load_n(&t->future_, __ATOMIC_ACQUIRE);
+
+    if (!__chash_unlink(t, z) && (f != NULL)) {
+        __chash_unlink(f, z);
+    }
+
+    size = stripe->size_ - 1;
+    __atomic_store_n(&stripe->size_, size, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&stripe->lock_);
+
+    __chash_resize(self, size);
+    epoch_read_unlock(&self->epoch_, token);
+
+    return z->entry_;
+}
+
+/* Unlinks the node of the entry equal to 'ke' and returns it, or NULL. */
+static inline struct chnode *chash_remove(struct chash *self, const void *ke)
+{
+    uint64_t m = __chash_mix(self, ke);
+    struct __chash_stripe *stripe = __chash_stripe(self, m);
+    unsigned int token = epoch_read_lock(&self->epoch_);
+    struct __chash_table *t, *f;
+    struct chnode *x;
+    size_t size = 0;
+
+    pthread_mutex_lock(&stripe->lock_);
+
+    t = __atomic_load_n(&self->table_, __ATOMIC_ACQUIRE);
+    f = __atomic_load_n(&t->future_, __ATOMIC_ACQUIRE);
+    x = __chash_search(self, t, m, ke);
+
+    if (x != NULL) {
+        __chash_unlink(t, x);
+    } else if ((f != NULL) && ((x = __chash_search(self, f, m, ke)) != NULL)) {
+        __chash_unlink(f, x);
+    }
+
+    if (x != NULL) {
+        size = stripe->size_ - 1;
+        __atomic_store_n(&stripe->size_, size, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_unlock(&stripe->lock_);
+
+    if (x != NULL) {
+        __chash_resize(self, size);
+    }
+
+    epoch_read_unlock(&self->epoch_, token);
+
+    return x;
+}
+
+static inline bool __chash_validate_table(const struct chash *self,
+                                          const struct __chash_table *t,
+                                          size_t size[])
+{
+    unsigned int shift = __chash_shift(CHASH_NR_STRIPES);
+
+    for (size_t n = 0; n < t->nr_buckets_; n++) {
+        for (const struct chnode *x = t->bucket_[n]; x != NULL;
+             x = x->next_) {
+            if ((__chash_bucket(t, x->hash_) != &t->bucket_[n]) ||
+                (__chash_mix(self, x->entry_) != x->hash_)) {
+                return false;
+            }
+
+            size[x->hash_ >> shift]++;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Checks that every node is in the bucket of its hash, and the counts of
+ * the stripes. Not to be called while the table is changing.
+ */
+static inline bool chash_validate(const struct chash *self)
+{
+    const struct __chash_table *t = self->table_;
+    size_t size[CHASH_NR_STRIPES] = { 0 };
+
+    if (!__chash_validate_table(self, t, size) ||
+        ((t->future_ != NULL) &&
+         !__chash_validate_table(self, t->future_, size))) {
+        return false;
+    }
+
+    if ((t->future_ != NULL) != self->resizing_) {
+        return false;
+    }
+
+    for (size_t i = 0; i < CHASH_NR_STRIPES; i++) {
+        if (size[i] != self->stripe_[i].size_) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_CHASH_H__ */
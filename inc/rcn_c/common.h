@@ -11,6 +11,9 @@
 
 #define NR_ELEM(a) (sizeof(a) / sizeof(a[0]))
 
+/* A single, untorn store to a field that lockless readers may load. */
+#define WRITE_ONCE(x, val) __atomic_store_n(&(x), (val), __ATOMIC_RELAXED)
+
 #define CONTAINER_OF(ptr, type, member)                    \
     ({                                                     \
         const typeof(((type *)0)->member) *__mptr = (ptr); \
@@ -14,18 +14,61 @@
 #include <string.h>
 
 #include "dlist.h"
+#include "ilog2.h"
 
 #ifdef __cplusplus
 namespace rcn_c
 {
 #endif
 
+/*
+ * A table set up by dlhash_init_resizable() allocates its buckets by itself,
+ * a power of 2 of them, and resizes them to twice its size once it holds
+ * more than DLHASH_MAX_LOAD percent of its buckets, or less than
+ * DLHASH_MIN_LOAD percent, but never below DLHASH_MIN_BUCKETS. Its buckets
+ * are picked by the high bits of the hash times a large odd constant : the
+ * entries of an old bucket all go to a run of new buckets, or the entries of
+ * a run of old buckets to a new one.
+ *
+ * The entries move to the new buckets a few buckets at a time : every
+ * insert and remove moves up to DLHASH_REHASH_STEP chains, and skips up to
+ * ten times as many empty buckets. Until all have moved, lookups search the
+ * bucket of the old array if it has not moved yet, that of the new one
+ * otherwise. The new buckets are set up as the old ones they take from
+ * move, so that starting a resize costs no more than a malloc().
+ *
+ * dlhash_erase() moves nothing and never resizes, so that the entries may be
+ * erased while iterating. A failed allocation leaves the table at its size.
+ */
+#ifndef DLHASH_MAX_LOAD
+#define DLHASH_MAX_LOAD 100
+#endif /* DLHASH_MAX_LOAD */
+
+#ifndef DLHASH_MIN_LOAD
+#define DLHASH_MIN_LOAD 10
+#endif /* DLHASH_MIN_LOAD */
+
+/* A power of 2. */
+#ifndef DLHASH_MIN_BUCKETS
+#define DLHASH_MIN_BUCKETS 16
+#endif /* DLHASH_MIN_BUCKETS */
+
+#ifndef DLHASH_REHASH_STEP
+#define DLHASH_REHASH_STEP 4
+#endif /* DLHASH_REHASH_STEP */
+
 struct dlhash {
     size_t nr_buckets_;
     size_t (*key_hash_)(const void *ke);
     int (*compar_)(const void *ke, const void *in_table);
     struct dlist *bucket_;
     size_t size_;
+    bool resizable_;
+    unsigned int shift_;
+    struct dlist *old_bucket_;
+    size_t nr_old_buckets_;
+    unsigned int old_shift_;
+    size_t rehash_idx_;
 };
 
 static inline size_t __dlhash_index(const struct dlhash *self, const void *ke)
@@ -33,10 +76,53 @@ static inline size_t __dlhash_index(const struct dlhash *self, const void *ke)
     return self->key_hash_(ke) % self->nr_buckets_;
 }
 
+/* The bucket of the key 'ke' : the old one until it has moved. */
+static inline struct dlist *__dlhash_bucket(const struct dlhash *self,
+                                            const void *ke)
+{
+    uint64_t m;
+
+    if (!self->resizable_) {
+        return &self->bucket_[__dlhash_index(self, ke)];
+    }
+
+    m = (uint64_t)self->key_hash_(ke) * 0x9e3779b97f4a7c15ULL;
+
+    if (self->old_bucket_ != NULL &&
+        (m >> self->old_shift_) >= self->rehash_idx_) {
+        return &self->old_bucket_[m >> self->old_shift_];
+    }
+
+    return &self->bucket_[m >> self->shift_];
+}
+
+/* The new buckets set up so far, all of them unless resizing. */
+static inline size_t __dlhash_ready(const struct dlhash *self)
+{
+    unsigned int shrink;
+
+    if (self->old_bucket_ == NULL) {
+        return self->nr_buckets_;
+    }
+
+    if (self->shift_ < self->old_shift_) {
+        return self->rehash_idx_ << (self->old_shift_ - self->shift_);
+    }
+
+    shrink = self->shift_ - self->old_shift_;
+
+    return (self->rehash_idx_ + ((size_t)1 << shrink) - 1) >> shrink;
+}
+
 static inline void dlhash_clear(struct dlhash *self)
 {
     self->size_ = 0;
 
+    free(self->old_bucket_);
+    self->old_bucket_ = NULL;
+    self->nr_old_buckets_ = 0;
+    self->rehash_idx_ = 0;
+
     if (self->bucket_ == NULL) {
         return;
     }
@@ -54,6 +140,9 @@ static inline void dlhash_init(
     self->key_hash_ = key_hash;
     self->compar_ = compar;
     self->bucket_ = bucket;
+    self->resizable_ = false;
+    self->shift_ = 0;
+    self->old_bucket_ = NULL;
     dlhash_clear(self);
 }
 
@@ -62,16 +151,36 @@ static inline size_t dlhash_buckets(const struct dlhash *self)
     return self->nr_buckets_;
 }
 
+static inline bool dlhash_rehashing(const struct dlhash *self)
+{
+    return self->old_bucket_ != NULL;
+}
+
 static inline const struct dlnode *dlhash_end(const struct dlhash *self)
 {
     return dlist_end(&self->bucket_[self->nr_buckets_ - 1]);
 }
 
-static inline struct dlnode *dlhash_begin(const struct dlhash *self)
+/*
+ * The first entry of the buckets from 'list' on, going on from the end of
+ * the old buckets to the new ones if 'list' is an old one.
+ */
+static inline struct dlnode *__dlhash_first(const struct dlhash *self,
+                                            const struct dlist *list, bool old)
 {
-    for (size_t n = 0; n < self->nr_buckets_; n++) {
-        struct dlist *list = &self->bucket_[n];
+    const struct dlist *end = &self->bucket_[__dlhash_ready(self)];
 
+    if (old) {
+        for (; list < &self->old_bucket_[self->nr_old_buckets_]; list++) {
+            if (!dlist_empty(list)) {
+                return dlist_begin(list);
+            }
+        }
+
+        list = self->bucket_;
+    }
+
+    for (; list < end; list++) {
         if (!dlist_empty(list)) {
             return dlist_begin(list);
         }
@@ -80,21 +189,28 @@ static inline struct dlnode *dlhash_begin(const struct dlhash *self)
     return (struct dlnode *)dlhash_end(self);
 }
 
+static inline struct dlnode *dlhash_begin(const struct dlhash *self)
+{
+    if (self->old_bucket_ != NULL) {
+        return __dlhash_first(self, &self->old_bucket_[self->rehash_idx_],
+                                true);
+    }
+
+    return __dlhash_first(self, self->bucket_, false);
+}
+
 static inline struct dlnode *dlhash_next(const struct dlhash *self,
                                          const struct dlnode *x)
 {
+    const struct dlist *old = self->old_bucket_;
+
     if (x->next_ != dlist_end(x->list_)) {
         return x->next_;
     }
 
-    for (size_t m = 1; (uintptr_t)(&x->list_[m]) < (uintptr_t)dlhash_end(self);
-         m++) {
-        if (!dlist_empty(&x->list_[m])) {
-            return dlist_begin(&x->list_[m]);
-        }
-    }
-
-    return (struct dlnode *)dlhash_end(self);
+    return __dlhash_first(self, x->list_ + 1,
+                            old != NULL && x->list_ >= old &&
+                                x->list_ < &old[self->nr_old_buckets_]);
 }
 
 static inline size_t dlhash_size(const struct dlhash *self)
@@ -107,10 +223,135 @@ static inline bool dlhash_empty(const struct dlhash *self)
     return dlhash_size(self) == 0;
 }
 
+/* Sets up the new buckets that take the entries of the old bucket 'n'. */
+static inline void __dlhash_prepare(struct dlhash *self, size_t n)
+{
+    unsigned int shrink;
+
+    if (self->shift_ < self->old_shift_) {
+        unsigned int grow = self->old_shift_ - self->shift_;
+
+        for (size_t i = n << grow; i < (n + 1) << grow; i++) {
+            dlist_init(&self->bucket_[i]);
+        }
+
+        return;
+    }
+
+    shrink = self->shift_ - self->old_shift_;
+
+    if ((n & (((size_t)1 << shrink) - 1)) == 0) {
+        dlist_init(&self->bucket_[n >> shrink]);
+    }
+}
+
+/*
+ * Moves the chains of up to 'nr' old buckets to the new ones, skipping up
+ * to ten times as many empty ones. Returns true while some are left, as
+ * dlhash_rehashing() does.
+ */
+static inline bool dlhash_rehash(struct dlhash *self, size_t nr)
+{
+    size_t nr_empty = nr * 10;
+
+    if (self->old_bucket_ == NULL) {
+        return false;
+    }
+
+    while (nr != 0 && self->rehash_idx_ < self->nr_old_buckets_) {
+        struct dlist *list = &self->old_bucket_[self->rehash_idx_];
+
+        __dlhash_prepare(self, self->rehash_idx_++);
+
+        if (dlist_empty(list)) {
+            if (--nr_empty == 0) {
+                break;
+            }
+
+            continue;
+        }
+
+        while (!dlist_empty(list)) {
+            struct dlnode *x = dlist_begin(list);
+            void *e = dlist_erase(x);
+
+            dlist_push_front(__dlhash_bucket(self, e), x, e);
+        }
+
+        nr--;
+    }
+
+    if (self->rehash_idx_ < self->nr_old_buckets_) {
+        return true;
+    }
+
+    free(self->old_bucket_);
+    self->old_bucket_ = NULL;
+    self->nr_old_buckets_ = 0;
+    self->rehash_idx_ = 0;
+
+    return false;
+}
+
+/* 'nr' buckets, a power of 2, are picked by the 'shift' high bits. */
+static inline unsigned int __dlhash_shift(size_t nr)
+{
+    return 64 - (unsigned int)ilog2ll(nr);
+}
+
+/*
+ * Moves a few chains if a resize is on, or starts one if the load calls for
+ * it. Called by the updates that may move entries.
+ */
+static inline void __dlhash_resize(struct dlhash *self)
+{
+    struct dlist *bucket;
+    size_t nr = DLHASH_MIN_BUCKETS;
+
+    if (!self->resizable_) {
+        return;
+    }
+
+    if (self->old_bucket_ != NULL) {
+        dlhash_rehash(self, DLHASH_REHASH_STEP);
+        return;
+    }
+
+    if (self->size_ * 100 <= self->nr_buckets_ * DLHASH_MAX_LOAD &&
+        (self->size_ * 100 >= self->nr_buckets_ * DLHASH_MIN_LOAD ||
+         self->nr_buckets_ <= DLHASH_MIN_BUCKETS)) {
+        return;
+    }
+
+    while (nr < self->size_ * 2) {
+        nr <<= 1;
+    }
+
+    if (nr == self->nr_buckets_) {
+        return;
+    }
+
+    bucket = (struct dlist *)malloc(nr * sizeof(*bucket));
+
+    if (bucket == NULL) {
+        return;
+    }
+
+    self->old_bucket_ = self->bucket_;
+    self->nr_old_buckets_ = self->nr_buckets_;
+    self->old_shift_ = self->shift_;
+    self->rehash_idx_ = 0;
+    self->bucket_ = bucket;
+    self->nr_buckets_ = nr;
+    self->shift_ = __dlhash_shift(nr);
+}
+
 static inline int dlhash_insert(struct dlhash *self, struct dlnode *z, void *e)
 {
-    size_t n = __dlhash_index(self, e);
-    struct dlist *bucket = &self->bucket_[n];
+    struct dlist *bucket;
+
+    __dlhash_resize(self);
+    bucket = __dlhash_bucket(self, e);
 
     for (struct dlnode *x = dlist_begin(bucket); x != dlist_end(bucket);
          x = x->next_) {
@@ -128,10 +369,8 @@ static inline int dlhash_insert(struct dlhash *self, struct dlnode *z, void *e)
 static inline void dlhash_insert_multi(struct dlhash *self, struct dlnode *z,
                                        void *e)
 {
-    size_t n = __dlhash_index(self, e);
-    struct dlist *bucket = &self->bucket_[n];
-
-    dlist_push_front(bucket, z, e);
+    __dlhash_resize(self);
+    dlist_push_front(__dlhash_bucket(self, e), z, e);
     self->size_++;
 }
 
@@ -145,8 +384,7 @@ static inline struct dlnode *dlhash_find(const struct dlhash *self,
                                          const void *ke)
 {
     struct dlnode *x;
-    size_t n = __dlhash_index(self, ke);
-    struct dlist *list = &self->bucket_[n];
+    struct dlist *list = __dlhash_bucket(self, ke);
 
     for (x = dlist_begin(list); x != dlist_end(list); x = x->next_) {
         if (self->compar_(ke, x->entry_) == 0) {
@@ -166,7 +404,10 @@ static inline void *dlhash_at(const struct dlhash *self, const void *ke)
 
 static inline struct dlnode *dlhash_remove(struct dlhash *self, const void *ke)
 {
-    struct dlnode *x = dlhash_find(self, ke);
+    struct dlnode *x;
+
+    __dlhash_resize(self);
+    x = dlhash_find(self, ke);
 
     if (x == NULL) {
         return NULL;
@@ -185,16 +426,39 @@ static inline void dlhash_swap(struct dlhash *self, struct dlhash *other)
     *other = tmp;
 }
 
-static inline bool dlhash_validate(struct dlhash *self)
+static inline bool __dlhash_validate_buckets(const struct dlhash *self,
+                                             const struct dlist *bucket,
+                                             size_t nr, size_t *size)
 {
-    size_t size = 0;
+    for (size_t n = 0; n < nr; n++) {
+        const struct dlist *list = &bucket[n];
 
-    for (size_t n = 0; n < self->nr_buckets_; n++) {
-        if (!dlist_validate(&self->bucket_[n])) {
+        if (!dlist_validate(list)) {
             return false;
         }
 
-        size += dlist_size(&self->bucket_[n]);
+        for (const struct dlnode *x = dlist_begin(list); x != dlist_end(list);
+             x = x->next_) {
+            if (__dlhash_bucket(self, x->entry_) != list) {
+                return false;
+            }
+        }
+
+        *size += dlist_size(list);
+    }
+
+    return true;
+}
+
+static inline bool dlhash_validate(struct dlhash *self)
+{
+    size_t size = 0;
+
+    if (!__dlhash_validate_buckets(self, self->bucket_, __dlhash_ready(self),
+                                   &size) ||
+        !__dlhash_validate_buckets(self, self->old_bucket_,
+                                   self->nr_old_buckets_, &size)) {
+        return false;
     }
 
     if (dlhash_size(self) != size) {
@@ -222,6 +486,37 @@ static inline int __dlhash_alloc_bucket(struct dlhash *self)
 static inline void __dlhash_free_bucket(struct dlhash *self)
 {
     free(self->bucket_);
+    free(self->old_bucket_);
+}
+
+/*
+ * Sets up a table that allocates its buckets by itself, 'sz_bucket' of them
+ * at first, rounded up to a power of 2, and resizes them with the load.
+ * Returns 0, or -ENOMEM. To be released by dlhash_destroy().
+ */
+static inline int dlhash_init_resizable(
+    struct dlhash *self, size_t sz_bucket, size_t (*key_hash)(const void *ke),
+    int (*compar)(const void *ke, const void *in_table))
+{
+    size_t nr = DLHASH_MIN_BUCKETS;
+
+    while (nr < sz_bucket) {
+        nr <<= 1;
+    }
+
+    dlhash_init(self, nr, key_hash, compar, NULL);
+    self->resizable_ = true;
+    self->shift_ = __dlhash_shift(nr);
+
+    return __dlhash_alloc_bucket(self);
+}
+
+static inline void dlhash_destroy(struct dlhash *self)
+{
+    __dlhash_free_bucket(self);
+    self->bucket_ = NULL;
+    self->old_bucket_ = NULL;
+    self->size_ = 0;
 }
 
 #ifdef __cplusplus
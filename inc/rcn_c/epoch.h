@@ -0,0 +1,126 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ */
+
+/* Epoch-Based Reclamation */
+#ifndef __RCN_C_EPOCH_H__
+#define __RCN_C_EPOCH_H__
+
+#include <pthread.h>
+#include <sched.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/*
+ * Lockless readers announce themselves in the current epoch for the time
+ * of a read-side section. epoch_synchronize() waits until every reader that
+ * was in a section when it was called has left it : a node unlinked before
+ * the call may then be reused or freed, as no reader can still reach it.
+ *
+ * Readers are counted per slot, each on its own cache line, so that they
+ * do not all bounce the same one. A thread takes a slot round robin on its
+ * first read_lock and keeps it, possibly sharing it with other threads.
+ */
+#ifndef EPOCH_NR_SLOTS
+#define EPOCH_NR_SLOTS 64
+#endif /* EPOCH_NR_SLOTS */
+
+/* Active readers of the two epochs. */
+struct __epoch_slot {
+    unsigned long active_[2];
+} __attribute__((aligned(64)));
+
+struct epoch {
+    unsigned int epoch_;
+    pthread_mutex_t lock_;
+    struct __epoch_slot slot_[EPOCH_NR_SLOTS];
+};
+
+static inline void epoch_init(struct epoch *self)
+{
+    self->epoch_ = 0;
+    pthread_mutex_init(&self->lock_, NULL);
+
+    for (size_t i = 0; i < EPOCH_NR_SLOTS; i++) {
+        self->slot_[i].active_[0] = self->slot_[i].active_[1] = 0;
+    }
+}
+
+static inline void epoch_destroy(struct epoch *self)
+{
+    pthread_mutex_destroy(&self->lock_);
+}
+
+static inline unsigned int __epoch_slot_id(void)
+{
+    static unsigned int nr_threads;
+    static __thread unsigned int id;
+
+    if (id == 0) {
+        id = __atomic_add_fetch(&nr_threads, 1, __ATOMIC_RELAXED);
+    }
+
+    return (id - 1) % EPOCH_NR_SLOTS;
+}
+
+/* Returns the token to pass to epoch_read_unlock(). */
+static inline unsigned int epoch_read_lock(struct epoch *self)
+{
+    unsigned int slot = __epoch_slot_id();
+    unsigned int idx = __atomic_load_n(&self->epoch_, __ATOMIC_RELAXED) & 1;
+
+    __atomic_fetch_add(&self->slot_[slot].active_[idx], 1, __ATOMIC_SEQ_CST);
+    /*
+     * Orders the count before the loads of the section, as smp_mb() does in
+     * srcu_read_lock() : pairs with the fence in epoch_synchronize().
+     */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    return slot * 2 + idx;
+}
+
+static inline void epoch_read_unlock(struct epoch *self, unsigned int token)
+{
+    __atomic_fetch_sub(&self->slot_[token / 2].active_[token & 1], 1,
+                       __ATOMIC_RELEASE);
+}
+
+/*
+ * Waits until every reader that entered before the call has left. The epoch
+ * is flipped twice, as a reader may have picked the old epoch just before
+ * the first flip and be counted only after it.
+ */
+static inline void epoch_synchronize(struct epoch *self)
+{
+    pthread_mutex_lock(&self->lock_);
+
+    /* Orders the unlinks of the caller before the loads of the counts. */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    for (int i = 0; i < 2; i++) {
+        unsigned int idx = self->epoch_ & 1;
+
+        __atomic_store_n(&self->epoch_, self->epoch_ + 1, __ATOMIC_SEQ_CST);
+
+        for (size_t j = 0; j < EPOCH_NR_SLOTS; j++) {
+            while (__atomic_load_n(&self->slot_[j].active_[idx],
+                                   __ATOMIC_SEQ_CST) != 0) {
+                sched_yield();
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&self->lock_);
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_EPOCH_H__ */
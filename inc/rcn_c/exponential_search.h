@@ -0,0 +1,158 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ *
+ * Reference : https://github.com/python/cpython/blob/main/Objects/listsort.txt
+ */
+
+/* Exponential Search / Galloping Search */
+#ifndef __RCN_C_EXPONENTIAL_SEARCH_H__
+#define __RCN_C_EXPONENTIAL_SEARCH_H__
+
+#include <errno.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+#define __base(n) (&((char *)base)[(n) * size])
+
+/*
+ * gallop_left() returns the first position in [0, nmemb] whose entry is not
+ * less than 'key', gallop_right() the first one whose entry is greater than
+ * 'key'. Both start probing at 'hint' and double the step towards the answer,
+ * so the cost is O(log(distance from hint)) instead of O(log(nmemb)).
+ * A hint of 0 searches forward, a hint of (nmemb - 1) searches backward.
+ */
+static inline size_t __gallop(const void *key, const void *base, size_t nmemb,
+                              size_t size,
+                              int (*compar)(const void *a, const void *b),
+                              size_t hint, int bias)
+{
+    size_t lo, hi, ofs = 1, last_ofs = 0;
+
+    if (nmemb == 0) {
+        return 0;
+    }
+
+    if (compar(key, __base(hint)) > bias) {
+        /* __base(hint) is on the left : gallop right. */
+        size_t max_ofs = nmemb - hint;
+
+        while (ofs < max_ofs && compar(key, __base(hint + ofs)) > bias) {
+            last_ofs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+
+        if (ofs > max_ofs) {
+            ofs = max_ofs;
+        }
+
+        lo = hint + last_ofs + 1;
+        hi = hint + ofs;
+    } else {
+        /* __base(hint) is on the right : gallop left. */
+        size_t max_ofs = hint + 1;
+
+        while (ofs < max_ofs && compar(key, __base(hint - ofs)) <= bias) {
+            last_ofs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+
+        if (ofs > max_ofs) {
+            ofs = max_ofs;
+        }
+
+        lo = hint + 1 - ofs;
+        hi = hint - last_ofs;
+    }
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+
+        if (compar(key, __base(mid)) > bias) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+static inline size_t gallop_left(const void *key, const void *base,
+                                 size_t nmemb, size_t size,
+                                 int (*compar)(const void *a, const void *b),
+                                 size_t hint)
+{
+    return __gallop(key, base, nmemb, size, compar, hint, 0);
+}
+
+static inline size_t gallop_right(const void *key, const void *base,
+                                  size_t nmemb, size_t size,
+                                  int (*compar)(const void *a, const void *b),
+                                  size_t hint)
+{
+    return __gallop(key, base, nmemb, size, compar, hint, -1);
+}
+
+static inline ssize_t
+__exponential_search(const void *key, const void *base, size_t nmemb,
+                     size_t size, int (*compar)(const void *a, const void *b))
+{
+    size_t pos = gallop_left(key, base, nmemb, size, compar, 0);
+
+    if (pos < nmemb && compar(key, __base(pos)) == 0) {
+        return pos;
+    }
+
+    return -EEXIST;
+}
+
+static inline void *
+exponential_search(const void *key, const void *base, size_t nmemb,
+                   size_t size, int (*compar)(const void *a, const void *b))
+{
+    ssize_t pos = __exponential_search(key, base, nmemb, size, compar);
+
+    return pos >= 0 ? __base(pos) : NULL;
+}
+
+static inline ssize_t
+__exponential_search_hint(const void *key, const void *base, size_t nmemb,
+                          size_t size,
+                          int (*compar)(const void *a, const void *b),
+                          size_t hint)
+{
+    size_t pos = gallop_left(key, base, nmemb, size, compar, hint);
+
+    if (pos < nmemb && compar(key, __base(pos)) == 0) {
+        return pos;
+    }
+
+    return -EEXIST;
+}
+
+static inline void *
+exponential_search_hint(const void *key, const void *base, size_t nmemb,
+                        size_t size,
+                        int (*compar)(const void *a, const void *b),
+                        size_t hint)
+{
+    ssize_t pos =
+        __exponential_search_hint(key, base, nmemb, size, compar, hint);
+
+    return pos >= 0 ? __base(pos) : NULL;
+}
+
+#undef __base
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RCN_C_EXPONENTIAL_SEARCH_H__ */
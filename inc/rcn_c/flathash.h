@@ -0,0 +1,532 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ *
+ * Reference : M. Kulukundis, "Designing a Fast, Efficient, Cache-friendly
+ *             Hash Table, Step by Step", CppCon 2017
+ */
+
+/* Hash Table - Open Addressing (SIMD Probed Control Bytes) */
+#ifndef __RCN_C_FLATHASH_H__
+#define __RCN_C_FLATHASH_H__
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/*
+ * A flat table of slots, with a control byte per slot : FLATHASH_EMPTY, or
+ * 7 bits of the hash of the entry in the slot. A lookup loads the control
+ * bytes of a whole group of slots from the home slot on, compares them to
+ * the 7 bits of its key at once, and calls compar only on the slots that
+ * match. The probe is linear, so that an erase shifts the entries after it
+ * back instead of leaving a tombstone : lookups never get slower with the
+ * updates, only with the load.
+ *
+ * The slots hold either the entries themselves, of a fixed size, or
+ * pointers to entries kept elsewhere, with an esize of 0. key_hash and
+ * compar are those of dlhash and slhash, and get the entry in the slot or
+ * the entry pointed to alike. Entries in the slots move as the table grows
+ * and as entries before them are erased : pointers to them only last until
+ * the next update. They must be aligned to 16 bytes at most.
+ *
+ * The table is allocated by itself and doubles once more than
+ * FLATHASH_MAX_LOAD percent of its slots are taken. A failed allocation
+ * fails the insert with -ENOMEM and leaves the table unchanged.
+ */
+#ifndef FLATHASH_MAX_LOAD
+#define FLATHASH_MAX_LOAD 75
+#endif /* FLATHASH_MAX_LOAD */
+
+#define FLATHASH_EMPTY ((int8_t)0x80)
+
+#if defined(__AVX2__)
+#define __FLATHASH_GROUP 32
+#elif defined(__SSE2__)
+#define __FLATHASH_GROUP 16
+#else
+#define __FLATHASH_GROUP 8
+#endif
+
+struct flathash {
+    int8_t *ctrl_;
+    char *slot_;
+    size_t nr_slots_;
+    unsigned int shift_;
+    size_t esize_;
+    bool indirect_;
+    size_t (*key_hash_)(const void *ke);
+    int (*compar_)(const void *ke, const void *in_table);
+    size_t size_;
+};
+
+/* Bit i set if the i-th control byte of the group is 'tag'. */
+static inline uint32_t __flathash_match(const int8_t *ctrl, int8_t tag)
+{
+#if defined(__AVX2__)
+    __m256i group = _mm256_loadu_si256((const __m256i *)ctrl);
+
+    return (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(group, _mm256_set1_epi8(tag)));
+#elif defined(__SSE2__)
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+
+    return (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(group, _mm_set1_epi8(tag)));
+#else
+    uint32_t mask = 0;
+
+    for (int i = 0; i < __FLATHASH_GROUP; i++) {
+        mask |= (uint32_t)(ctrl[i] == tag) << i;
+    }
+
+    return mask;
+#endif
+}
+
+/* Bit i set if the i-th slot of the group is empty : only EMPTY is < 0. */
+static inline uint32_t __flathash_match_empty(const int8_t *ctrl)
+{
+#if defined(__AVX2__)
+    return (uint32_t)_mm256_movemask_epi8(
+        _mm256_loadu_si256((const __m256i *)ctrl));
+#elif defined(__SSE2__)
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl));
+#else
+    return __flathash_match(ctrl, FLATHASH_EMPTY);
+#endif
+}
+
+/*
+ * Spreads weak hashes, e.g. of consecutive integers, over the high bits : a
+ * product only carries bits upward, so the low ones still depend only on the
+ * low bits of the hash.
+ */
+static inline uint64_t __flathash_mix(const struct flathash *self,
+                                      const void *ke)
+{
+    return (uint64_t)self->key_hash_(ke) * 0x9e3779b97f4a7c15ULL;
+}
+
+static inline size_t __flathash_home(const struct flathash *self, uint64_t m)
+{
+    return (size_t)(m >> self->shift_);
+}
+
+/*
+ * Taken from the middle bits, so that hashes with constant low bits, e.g.
+ * of pointers or aligned ids, still get tags of their own, and below the
+ * home bits of most tables.
+ */
+static inline int8_t __flathash_tag(uint64_t m)
+{
+    return (int8_t)((m >> 32) & 0x7f);
+}
+
+static inline char *__flathash_slot(const struct flathash *self, size_t i)
+{
+    return self->slot_ + i * self->esize_;
+}
+
+static inline void *flathash_entry(const struct flathash *self, size_t i)
+{
+    char *slot = __flathash_slot(self, i);
+
+    return self->indirect_ ? *(void **)slot : (void *)slot;
+}
+
+/* The bytes past the last slot mirror the first ones, for the groups. */
+static inline void __flathash_set_ctrl(struct flathash *self, size_t i,
+                                       int8_t ctrl)
+{
+    self->ctrl_[i] = ctrl;
+
+    if (i < __FLATHASH_GROUP - 1) {
+        self->ctrl_[self->nr_slots_ + i] = ctrl;
+    }
+}
+
+static inline void flathash_init(struct flathash *self, size_t esize,
+                                 size_t (*key_hash)(const void *ke),
+                                 int (*compar)(const void *ke,
+                                               const void *in_table))
+{
+    self->ctrl_ = NULL;
+    self->slot_ = NULL;
+    self->nr_slots_ = 0;
+    self->shift_ = 64;
+    self->indirect_ = esize == 0;
+    self->esize_ = esize == 0 ? sizeof(void *) : esize;
+    self->key_hash_ = key_hash;
+    self->compar_ = compar;
+    self->size_ = 0;
+}
+
+static inline void flathash_clear(struct flathash *self)
+{
+    if (self->ctrl_ != NULL) {
+        memset(self->ctrl_, FLATHASH_EMPTY,
+               self->nr_slots_ + __FLATHASH_GROUP - 1);
+    }
+
+    self->size_ = 0;
+}
+
+static inline void flathash_destroy(struct flathash *self)
+{
+    free(self->ctrl_);
+    flathash_init(self, self->indirect_ ? 0 : self->esize_, self->key_hash_,
+                  self->compar_);
+}
+
+static inline size_t flathash_size(const struct flathash *self)
+{
+    return self->size_;
+}
+
+static inline bool flathash_empty(const struct flathash *self)
+{
+    return flathash_size(self) == 0;
+}
+
+static inline size_t flathash_slots(const struct flathash *self)
+{
+    return self->nr_slots_;
+}
+
+/*
+ * Returns the slot holding an entry equal to 'ke', or nr_slots_ with the
+ * first empty slot from the home one in '*hole'.
+ */
+static inline size_t __flathash_lookup(const struct flathash *self,
+                                       const void *ke, uint64_t m,
+                                       size_t *hole)
+{
+    const size_t mask = self->nr_slots_ - 1;
+    const int8_t tag = __flathash_tag(m);
+    size_t pos = __flathash_home(self, m);
+
+    while (true) {
+        const int8_t *ctrl = &self->ctrl_[pos];
+        uint32_t empty = __flathash_match_empty(ctrl);
+        uint32_t match = __flathash_match(ctrl, tag);
+
+        /* Nothing past the first empty slot is on the probe. */
+        if (empty != 0) {
+            match &= (empty & -empty) - 1;
+        }
+
+        for (; match != 0; match &= match - 1) {
+            size_t i = (pos + __builtin_ctz(match)) & mask;
+
+            if (self->compar_(ke, flathash_entry(self, i)) == 0) {
+                return i;
+            }
+        }
+
+        if (empty != 0) {
+            *hole = (pos + __builtin_ctz(empty)) & mask;
+            return self->nr_slots_;
+        }
+
+        pos = (pos + __FLATHASH_GROUP) & mask;
+    }
+}
+
+/* The first empty slot from the home one. */
+static inline size_t __flathash_hole(const struct flathash *self, uint64_t m)
+{
+    const size_t mask = self->nr_slots_ - 1;
+    size_t pos = __flathash_home(self, m);
+    uint32_t empty;
+
+    while ((empty = __flathash_match_empty(&self->ctrl_[pos])) == 0) {
+        pos = (pos + __FLATHASH_GROUP) & mask;
+    }
+
+    return (pos + __builtin_ctz(empty)) & mask;
+}
+
+static inline void __flathash_put(struct flathash *self, size_t i, uint64_t m,
+                                  const void *e)
+{
+    if (self->indirect_) {
+        *(const void **)__flathash_slot(self, i) = e;
+    } else {
+        memcpy(__flathash_slot(self, i), e, self->esize_);
+    }
+
+    __flathash_set_ctrl(self, i, __flathash_tag(m));
+}
+
+/* Moves the entries to 'nr_slots' slots, a power of 2. */
+static inline int __flathash_resize(struct flathash *self, size_t nr_slots)
+{
+    size_t ctrl_size = (nr_slots + __FLATHASH_GROUP - 1 + 15) & ~(size_t)15;
+    struct flathash old = *self;
+    int8_t *ctrl;
+
+    ctrl = (int8_t *)malloc(ctrl_size + nr_slots * self->esize_);
+
+    if (ctrl == NULL) {
+        return -ENOMEM;
+    }
+
+    memset(ctrl, FLATHASH_EMPTY, nr_slots + __FLATHASH_GROUP - 1);
+    self->ctrl_ = ctrl;
+    self->slot_ = (char *)ctrl + ctrl_size;
+    self->nr_slots_ = nr_slots;
+    self->shift_ = 64 - __builtin_ctzll(nr_slots);
+
+    for (size_t i = 0; i < old.nr_slots_; i++) {
+        if (old.ctrl_[i] != FLATHASH_EMPTY) {
+            uint64_t m = __flathash_mix(self, flathash_entry(&old, i));
+            size_t j = __flathash_hole(self, m);
+
+            memcpy(__flathash_slot(self, j), __flathash_slot(&old, i),
+                   self->esize_);
+            __flathash_set_ctrl(self, j, old.ctrl_[i]);
+        }
+    }
+
+    free(old.ctrl_);
+
+    return 0;
+}
+
+/* Makes room for 'n' entries in all, so that they go in without a resize. */
+static inline int flathash_reserve(struct flathash *self, size_t n)
+{
+    size_t nr_slots = __FLATHASH_GROUP;
+
+    while (100 * n > FLATHASH_MAX_LOAD * nr_slots) {
+        nr_slots *= 2;
+    }
+
+    return nr_slots > self->nr_slots_ ? __flathash_resize(self, nr_slots) : 0;
+}
+
+static inline int __flathash_insert(struct flathash *self, const void *e,
+                                    size_t *i)
+{
+    uint64_t m = __flathash_mix(self, e);
+    size_t hole = 0;
+    int err;
+
+    if ((self->nr_slots_ != 0) &&
+        ((*i = __flathash_lookup(self, e, m, &hole)) != self->nr_slots_)) {
+        return -EEXIST;
+    }
+
+    *i = hole;
+
+    if (100 * (self->size_ + 1) > FLATHASH_MAX_LOAD * self->nr_slots_) {
+        if ((err = flathash_reserve(self, self->size_ + 1)) != 0) {
+            return err;
+        }
+
+        *i = __flathash_hole(self, m);
+    }
+
+    __flathash_put(self, *i, m, e);
+    self->size_++;
+
+    return 0;
+}
+
+/*
+ * Copies 'e' to the table, or the pointer 'e' with an esize of 0, unless an
+ * equal entry is there already. Returns 0, -EEXIST or -ENOMEM.
+ */
+static inline int flathash_insert(struct flathash *self, const void *e)
+{
+    size_t i;
+
+    return __flathash_insert(self, e, &i);
+}
+
+/*
+ * Inserts 'e' unless an equal entry is there already. Returns the entry in
+ * the table, which is the copy of 'e' if it was inserted, or NULL if the
+ * table could not grow.
+ */
+static inline void *flathash_insert_or_get(struct flathash *self,
+                                           const void *e)
+{
+    size_t i;
+
+    if (__flathash_insert(self, e, &i) == -ENOMEM) {
+        return NULL;
+    }
+
+    return flathash_entry(self, i);
+}
+
+static inline void *flathash_find(const struct flathash *self, const void *ke)
+{
+    size_t i, hole;
+
+    if (self->size_ == 0) {
+        return NULL;
+    }
+
+    i = __flathash_lookup(self, ke, __flathash_mix(self, ke), &hole);
+
+    return i == self->nr_slots_ ? NULL : flathash_entry(self, i);
+}
+
+/*
+ * Empties slot 'i', then shifts back each entry after it that is not in its
+ * home slot, up to the next empty one. Every entry shifted is hashed again.
+ */
+static inline void __flathash_erase_at(struct flathash *self, size_t i)
+{
+    const size_t mask = self->nr_slots_ - 1;
+    size_t j = i;
+
+    while (self->ctrl_[j = (j + 1) & mask] != FLATHASH_EMPTY) {
+        uint64_t m = __flathash_mix(self, flathash_entry(self, j));
+        size_t home = __flathash_home(self, m);
+
+        /* It may take 'i' if its probe goes through 'i' before 'j'. */
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            memcpy(__flathash_slot(self, i), __flathash_slot(self, j),
+                   self->esize_);
+            __flathash_set_ctrl(self, i, self->ctrl_[j]);
+            i = j;
+        }
+    }
+
+    __flathash_set_ctrl(self, i, FLATHASH_EMPTY);
+    self->size_--;
+}
+
+/*
+ * Removes the entry equal to 'ke', after copying it to 'out' unless NULL :
+ * esize bytes, or the pointer to it with an esize of 0. Returns 0 or
+ * -ENOENT.
+ */
+static inline int flathash_remove(struct flathash *self, const void *ke,
+                                  void *out)
+{
+    size_t i, hole;
+
+    if (self->size_ == 0) {
+        return -ENOENT;
+    }
+
+    i = __flathash_lookup(self, ke, __flathash_mix(self, ke), &hole);
+
+    if (i == self->nr_slots_) {
+        return -ENOENT;
+    }
+
+    if (out != NULL) {
+        memcpy(out, __flathash_slot(self, i), self->esize_);
+    }
+
+    __flathash_erase_at(self, i);
+
+    return 0;
+}
+
+/* Removes 'e', as returned by flathash_find() or the iteration. */
+static inline void flathash_erase(struct flathash *self, void *e)
+{
+    if (self->indirect_) {
+        flathash_remove(self, e, NULL);
+    } else {
+        __flathash_erase_at(self, ((char *)e - self->slot_) / self->esize_);
+    }
+}
+
+/*
+ * Slot indexes of the entries, in no order : for (i = flathash_begin(t); i
+ * != flathash_end(t); i = flathash_next(t, i)) with flathash_entry(t, i).
+ * Updates move the entries around, the walk must not be mixed with them.
+ */
+static inline size_t flathash_end(const struct flathash *self)
+{
+    return self->nr_slots_;
+}
+
+static inline size_t flathash_next(const struct flathash *self, size_t i)
+{
+    while ((++i < self->nr_slots_) && (self->ctrl_[i] == FLATHASH_EMPTY)) {
+    }
+
+    return i;
+}
+
+static inline size_t flathash_begin(const struct flathash *self)
+{
+    return flathash_next(self, (size_t)-1);
+}
+
+static inline void flathash_swap(struct flathash *self, struct flathash *other)
+{
+    struct flathash tmp = *self;
+
+    *self = *other;
+    *other = tmp;
+}
+
+static inline bool flathash_validate(const struct flathash *self)
+{
+    const size_t mask = self->nr_slots_ - 1;
+    size_t size = 0;
+
+    if (self->nr_slots_ == 0) {
+        return self->size_ == 0;
+    }
+
+    if ((100 * self->size_ > FLATHASH_MAX_LOAD * self->nr_slots_) ||
+        (memcmp(self->ctrl_, &self->ctrl_[self->nr_slots_],
+                __FLATHASH_GROUP - 1) != 0)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < self->nr_slots_; i++) {
+        if (self->ctrl_[i] == FLATHASH_EMPTY) {
+            continue;
+        }
+
+        uint64_t m = __flathash_mix(self, flathash_entry(self, i));
+
+        if (self->ctrl_[i] != __flathash_tag(m)) {
+            return false;
+        }
+
+        /* No empty slot between the home slot and the entry. */
+        for (size_t j = __flathash_home(self, m); j != i; j = (j + 1) & mask) {
+            if (self->ctrl_[j] == FLATHASH_EMPTY) {
+                return false;
+            }
+        }
+
+        size++;
+    }
+
+    return flathash_size(self) == size;
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_FLATHASH_H__ */
@@ -0,0 +1,248 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ *
+ * Reference : B. Chazelle, L. J. Guibas, "Fractional Cascading",
+ *             Algorithmica 1 (1986).
+ */
+
+/* Fractional Cascading */
+#ifndef __RCN_C_FRACTIONAL_CASCADING_H__
+#define __RCN_C_FRACTIONAL_CASCADING_H__
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/*
+ * Level 'n' keeps the entries of the n-th list merged with every other entry
+ * of level 'n + 1'. For the node at position 'p' of a level :
+ *  - own_  : number of entries of the level's own list placed before 'p'.
+ *  - down_ : position in level 'n + 1' of the first promoted entry placed at
+ *            or after 'p'.
+ * The key is copied right after the node, so that a level step touches one
+ * record instead of chasing a pointer back into the original array. Each
+ * level ends with a sentinel node which carries no key. Positions are kept
+ * in 32 bits to keep the records small, so a level holds less than 4G nodes.
+ */
+struct fcnode {
+    uint32_t own_;
+    uint32_t down_;
+};
+
+struct fclevel {
+    char *node_;
+    size_t nr_nodes_;
+};
+
+struct fcascade {
+    size_t nr_lists_;
+    size_t size_;
+    size_t stride_;
+    int (*compar_)(const void *a, const void *b);
+    struct fclevel *level_;
+};
+
+static inline struct fcnode *__fcascade_node(const struct fcascade *self,
+                                             const struct fclevel *level,
+                                             size_t p)
+{
+    return (struct fcnode *)&level->node_[p * self->stride_];
+}
+
+static inline void *__fcnode_key(const struct fcnode *x)
+{
+    return (void *)(x + 1);
+}
+
+static inline void fcascade_clear(struct fcascade *self)
+{
+    if (self->level_ == NULL) {
+        return;
+    }
+
+    for (size_t n = 0; n < self->nr_lists_; n++) {
+        free(self->level_[n].node_);
+        self->level_[n].node_ = NULL;
+        self->level_[n].nr_nodes_ = 0;
+    }
+}
+
+static inline void fcascade_init(struct fcascade *self, size_t nr_lists,
+                                 size_t size,
+                                 int (*compar)(const void *a, const void *b),
+                                 struct fclevel *level)
+{
+    self->nr_lists_ = nr_lists;
+    self->size_ = size;
+    self->stride_ = (sizeof(struct fcnode) + size + sizeof(uint32_t) - 1) &
+                    ~(sizeof(uint32_t) - 1);
+    self->compar_ = compar;
+    self->level_ = level;
+
+    if (level == NULL) {
+        return;
+    }
+
+    for (size_t n = 0; n < nr_lists; n++) {
+        level[n].node_ = NULL;
+        level[n].nr_nodes_ = 0;
+    }
+}
+
+static inline size_t fcascade_lists(const struct fcascade *self)
+{
+    return self->nr_lists_;
+}
+
+static inline int __fcascade_build_level(struct fcascade *self, size_t n,
+                                         const void *base, size_t nmemb)
+{
+#define __base(n) (&((const char *)base)[(n) * self->size_])
+
+    struct fclevel *level = &self->level_[n];
+    const struct fclevel *lower =
+        n + 1 < self->nr_lists_ ? &self->level_[n + 1] : NULL;
+    size_t nr_lower = lower == NULL ? 0 : lower->nr_nodes_;
+    size_t nr_nodes = nmemb + nr_lower / 2;
+    size_t i = 0, j = 1, p;
+
+    if (nr_nodes >= UINT32_MAX) {
+        return -EOVERFLOW;
+    }
+
+    level->node_ = (char *)calloc(nr_nodes + 1, self->stride_);
+
+    if (level->node_ == NULL) {
+        return -ENOMEM;
+    }
+
+    level->nr_nodes_ = nr_nodes;
+
+    for (p = 0; p < nr_nodes; p++) {
+        struct fcnode *x = __fcascade_node(self, level, p);
+        const void *key;
+
+        x->own_ = i;
+        x->down_ = j < nr_lower ? j : nr_lower;
+
+        if (j < nr_lower) {
+            key = __fcnode_key(__fcascade_node(self, lower, j));
+        }
+
+        if ((j >= nr_lower) ||
+            ((i < nmemb) && (self->compar_(__base(i), key) <= 0))) {
+            key = __base(i++);
+        } else {
+            j += 2;
+        }
+
+        memcpy(__fcnode_key(x), key, self->size_);
+    }
+
+    __fcascade_node(self, level, p)->own_ = i;
+    __fcascade_node(self, level, p)->down_ = nr_lower;
+
+    return 0;
+
+#undef __base
+}
+
+/*
+ * Builds the levels over 'nr_lists_' sorted arrays. The n-th array starts at
+ * base[n] and holds nmemb[n] entries of 'size_' bytes. The keys are copied
+ * into the levels : the arrays may be freed once fcascade_build() returned.
+ */
+static inline int fcascade_build(struct fcascade *self,
+                                 const void *const base[],
+                                 const size_t nmemb[])
+{
+    fcascade_clear(self);
+
+    for (size_t n = self->nr_lists_; n-- > 0;) {
+        int err = __fcascade_build_level(self, n, base[n], nmemb[n]);
+
+        if (err != 0) {
+            fcascade_clear(self);
+            return err;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Stores into pos[n] the lower bound of 'key' in the n-th array, that is the
+ * position of its first entry which is not less than 'key'. One binary
+ * search on the first level, then at most one comparison per level.
+ */
+static inline void fcascade_lower_bound(const struct fcascade *self,
+                                        const void *key, size_t pos[])
+{
+    const struct fclevel *level = &self->level_[0];
+    size_t left = 0, right = level->nr_nodes_;
+
+    if (self->nr_lists_ == 0) {
+        return;
+    }
+
+    while (left < right) {
+        size_t mid = left + (right - left) / 2;
+
+        if (self->compar_(key,
+                          __fcnode_key(__fcascade_node(self, level, mid))) >
+            0) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+
+    for (size_t n = 0; n < self->nr_lists_; n++) {
+        const struct fcnode *x = __fcascade_node(self, level, left);
+
+        pos[n] = x->own_;
+
+        if (n + 1 == self->nr_lists_) {
+            break;
+        }
+
+        level = &self->level_[n + 1];
+        left = x->down_;
+
+        if ((left > 0) &&
+            (self->compar_(key, __fcnode_key(__fcascade_node(
+                                    self, level, left - 1))) <= 0)) {
+            left--;
+        }
+    }
+}
+
+static inline int __fcascade_alloc_level(struct fcascade *self)
+{
+    self->level_ =
+        (struct fclevel *)calloc(self->nr_lists_, sizeof(*self->level_));
+    return self->level_ == NULL ? -ENOMEM : 0;
+}
+
+static inline void __fcascade_free_level(struct fcascade *self)
+{
+    fcascade_clear(self);
+    free(self->level_);
+    self->level_ = NULL;
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_FRACTIONAL_CASCADING_H__ */
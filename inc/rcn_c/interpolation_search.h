@@ -70,7 +70,7 @@ interpolation_delete(void *key, void *base, size_t *nmemb, size_t size,
         return -EEXIST;
     }
 
-    memcpy(__base(pos), __base(pos + 1), (*nmemb - pos) * size);
+    memmove(__base(pos), __base(pos + 1), (*nmemb - pos - 1) * size);
     (*nmemb)--;
 
     return 0;
@@ -0,0 +1,243 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ *
+ * Reference : linux/include/linux/interval_tree_generic.h
+ */
+
+/* Interval Tree (Augmented Red-Black Tree) */
+#ifndef __RCN_C_INTERVAL_TREE_H__
+#define __RCN_C_INTERVAL_TREE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+#include "rbtree.h"
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/*
+ * A closed interval [start_, last_]. subtree_last_ is the largest last_ in
+ * the subtree rooted at this node.
+ */
+struct itnode {
+    struct rbnode rbnode_;
+    uintptr_t start_;
+    uintptr_t last_;
+    uintptr_t subtree_last_;
+    void *entry_;
+};
+
+struct itree {
+    struct rbtree rbtree_;
+};
+
+static inline struct itnode *__itnode(const struct rbnode *x)
+{
+    return CONTAINER_OF(x, struct itnode, rbnode_);
+}
+
+static inline uintptr_t __itnode_subtree_last(const struct itnode *x)
+{
+    uintptr_t max = x->last_;
+
+    if (!rbnode_is_nil(x->rbnode_.left_) &&
+        (__itnode(x->rbnode_.left_)->subtree_last_ > max)) {
+        max = __itnode(x->rbnode_.left_)->subtree_last_;
+    }
+
+    if (!rbnode_is_nil(x->rbnode_.right_) &&
+        (__itnode(x->rbnode_.right_)->subtree_last_ > max)) {
+        max = __itnode(x->rbnode_.right_)->subtree_last_;
+    }
+
+    return max;
+}
+
+static inline bool __itnode_compute(struct itnode *x, bool exit)
+{
+    uintptr_t max = __itnode_subtree_last(x);
+
+    if (exit && (x->subtree_last_ == max)) {
+        return true;
+    }
+
+    x->subtree_last_ = max;
+
+    return false;
+}
+
+RBTREE_DECLARE_CALLBACKS(__itree_augment, struct itnode, rbnode_,
+                         subtree_last_, __itnode_compute);
+
+/* Orders by start_, last_, then address so equal intervals can coexist. */
+static inline int __itree_compar(const void *_ke, const void *_in_tree)
+{
+    const struct itnode *ke = (const struct itnode *)_ke;
+    const struct itnode *in_tree = (const struct itnode *)_in_tree;
+
+    if (ke->start_ != in_tree->start_) {
+        return ke->start_ < in_tree->start_ ? -1 : 1;
+    }
+
+    if (ke->last_ != in_tree->last_) {
+        return ke->last_ < in_tree->last_ ? -1 : 1;
+    }
+
+    if (ke != in_tree) {
+        return (uintptr_t)ke < (uintptr_t)in_tree ? -1 : 1;
+    }
+
+    return 0;
+}
+
+static inline void itree_clear(struct itree *self)
+{
+    rbtree_clear(&self->rbtree_);
+}
+
+static inline void itree_init(struct itree *self)
+{
+    rbtree_init_augmented(&self->rbtree_, __itree_compar, &__itree_augment);
+}
+
+static inline bool itree_empty(const struct itree *self)
+{
+    return rbtree_empty(&self->rbtree_);
+}
+
+static inline size_t itree_size(const struct itree *self)
+{
+    return rbtree_size(&self->rbtree_);
+}
+
+static inline int itree_insert(struct itree *self, struct itnode *z,
+                               uintptr_t start, uintptr_t last, void *e)
+{
+    z->start_ = start;
+    z->last_ = last;
+    z->subtree_last_ = last;
+    z->entry_ = e;
+
+    return rbtree_insert(&self->rbtree_, &z->rbnode_, z);
+}
+
+static inline void *itree_erase(struct itree *self, struct itnode *z)
+{
+    return rbtree_erase(&self->rbtree_, &z->rbnode_) == NULL ? NULL :
+                                                                z->entry_;
+}
+
+/* Leftmost node under 'x' overlapping [start, last], or NULL. */
+static inline struct itnode *__itree_subtree_search(struct itnode *x,
+                                                    uintptr_t start,
+                                                    uintptr_t last)
+{
+    while (true) {
+        struct rbnode *left = x->rbnode_.left_;
+        struct rbnode *right = x->rbnode_.right_;
+
+        if (!rbnode_is_nil(left) && (start <= __itnode(left)->subtree_last_)) {
+            /*
+             * The leftmost node with start <= last_ is in the left subtree.
+             * Either it overlaps, or every node right of it starts after
+             * 'last'.
+             */
+            x = __itnode(left);
+            continue;
+        }
+
+        if (x->start_ <= last) {
+            if (start <= x->last_) {
+                return x;
+            }
+
+            if (!rbnode_is_nil(right) &&
+                (start <= __itnode(right)->subtree_last_)) {
+                x = __itnode(right);
+                continue;
+            }
+        }
+
+        return NULL;
+    }
+}
+
+/* First node, by start_, overlapping [start, last]. O(log n). */
+static inline struct itnode *
+itree_iter_first(const struct itree *self, uintptr_t start, uintptr_t last)
+{
+    struct rbnode *root = self->rbtree_.root_;
+
+    if (rbnode_is_nil(root) || (__itnode(root)->subtree_last_ < start)) {
+        return NULL;
+    }
+
+    return __itree_subtree_search(__itnode(root), start, last);
+}
+
+/* Next node after 'x' overlapping [start, last]. */
+static inline struct itnode *itree_iter_next(const struct itree *self,
+                                             const struct itnode *x,
+                                             uintptr_t start, uintptr_t last)
+{
+    struct rbnode *rb = x->rbnode_.right_;
+    struct rbnode *prev;
+
+    while (true) {
+        /*
+         * Loop invariant : start <= x->last_, and the nodes on the left of
+         * 'x' are done with.
+         */
+        if (!rbnode_is_nil(rb) && (start <= __itnode(rb)->subtree_last_)) {
+            return __itree_subtree_search(__itnode(rb), start, last);
+        }
+
+        /* Move up the tree until we come from a node's left child. */
+        do {
+            rb = rbnode_parent(&x->rbnode_);
+
+            if (rbnode_is_nil(rb)) {
+                return NULL;
+            }
+
+            prev = (struct rbnode *)&x->rbnode_;
+            x = __itnode(rb);
+            rb = x->rbnode_.right_;
+        } while (prev == rb);
+
+        if (last < x->start_) {
+            return NULL;
+        } else if (start <= x->last_) {
+            return (struct itnode *)x;
+        }
+    }
+}
+
+static inline bool itree_validate(const struct itree *self)
+{
+    const struct rbtree *tree = &self->rbtree_;
+
+    for (struct rbnode *x = rbtree_begin(tree); x != rbtree_end(tree);
+         x = rbtree_next(tree, x)) {
+        const struct itnode *n = __itnode(x);
+
+        if (n->subtree_last_ != __itnode_subtree_last(n)) {
+            return false;
+        }
+    }
+
+    return rbtree_validate(tree);
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_INTERVAL_TREE_H__ */
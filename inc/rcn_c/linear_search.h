@@ -52,13 +52,11 @@ static inline void *linear_insert(void *key, void *base, size_t *nmemb,
 {
     size_t pos = 0;
 
-    while (compar(key, __base(pos)) > 0 && pos < *nmemb) {
+    while (pos < *nmemb && compar(key, __base(pos)) > 0) {
         pos++;
     }
 
-    for (size_t i = *nmemb; i > pos; --i) {
-        memcpy(__base(i), __base(i - 1), size);
-    }
+    memmove(__base(pos + 1), __base(pos), (*nmemb - pos) * size);
 
     memcpy(__base(pos), key, size);
     (*nmemb)++;
@@ -76,7 +74,7 @@ static inline int linear_delete(void *key, void *base, size_t *nmemb,
         return -EEXIST;
     }
 
-    memcpy(__base(pos), __base(pos + 1), (*nmemb - pos) * size);
+    memmove(__base(pos), __base(pos + 1), (*nmemb - pos - 1) * size);
     (*nmemb)--;
 
     return 0;
@@ -11,11 +11,24 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "exponential_search.h"
+
+#ifndef MERGE_SORT_GALLOP
+#define MERGE_SORT_GALLOP 7
+#endif /* MERGE_SORT_GALLOP */
+
 #ifdef __cplusplus
 namespace rcn_c
 {
 #endif
 
+/*
+ * Entries of the left run which are not greater than the first entry of the
+ * right run, and entries of the right run which are not less than the last
+ * entry of the left run, are already in place. Once one run wins
+ * MERGE_SORT_GALLOP times in a row, the rest of its winning streak is found
+ * by galloping and copied at once.
+ */
 static void __merge(void *base, void *sorted, size_t left, size_t mid,
                     size_t right, size_t size,
                     int (*compar)(const void *a, const void *b))
@@ -23,13 +36,45 @@ static void __merge(void *base, void *sorted, size_t left, size_t mid,
 #define __base(n) (&((char *)base)[(n) * size])
 #define __sorted(n) (&((char *)sorted)[(n) * size])
 
-    size_t i = left, j = mid + 1., k = left;
+    size_t nr_left = 0, nr_right = 0;
+    size_t i, j = mid + 1, k;
+
+    i = left + gallop_right(__base(j), __base(left), mid - left + 1, size,
+                            compar, 0);
+
+    if (i > mid) {
+        return;
+    }
+
+    right = j - 1 + gallop_left(__base(mid), __base(j), right - mid, size,
+                                compar, right - mid - 1);
+    k = left = i;
 
     while (i <= mid && j <= right) {
-        if (compar(__base(i), __base(j)) <= 0) {
+        if (nr_left >= MERGE_SORT_GALLOP) {
+            size_t n = gallop_right(__base(j), __base(i), mid - i + 1, size,
+                                    compar, 0);
+
+            memcpy(__sorted(k), __base(i), size * n);
+            i += n;
+            k += n;
+            nr_left = 0;
+        } else if (nr_right >= MERGE_SORT_GALLOP) {
+            size_t n = gallop_left(__base(i), __base(j), right - j + 1, size,
+                                   compar, 0);
+
+            memcpy(__sorted(k), __base(j), size * n);
+            j += n;
+            k += n;
+            nr_right = 0;
+        } else if (compar(__base(i), __base(j)) <= 0) {
             memcpy(__sorted(k++), __base(i++), size);
+            nr_left++;
+            nr_right = 0;
         } else {
             memcpy(__sorted(k++), __base(j++), size);
+            nr_right++;
+            nr_left = 0;
         }
     }
 
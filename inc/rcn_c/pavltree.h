@@ -0,0 +1,550 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ *
+ * Reference : Driscoll, Sarnak, Sleator and Tarjan, "Making Data Structures
+ *             Persistent"
+ */
+
+/* Persistent (Path Copying) AVL Tree */
+#ifndef __RCN_C_PAVLTREE_H__
+#define __RCN_C_PAVLTREE_H__
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/*
+ * Nodes are allocated by the tree and shared between versions : a node
+ * reachable from several trees is never changed, the path down to it is
+ * copied instead. A node only reachable from one tree is changed in place.
+ * 'refcnt_' counts the parents and trees pointing to the node, and a node is
+ * freed when the last of them lets it go, from whichever thread that is.
+ *
+ * A tree is used by one thread at a time : readers of another thread each
+ * get their own snapshot, and never hold up the writer nor each other.
+ * Entries are not owned : an entry erased from a tree may still be seen
+ * through older snapshots.
+ */
+struct pavlnode {
+    struct pavlnode *left_;
+    struct pavlnode *right_;
+    void *entry_;
+    size_t count_;
+    unsigned int refcnt_;
+    int height_;
+};
+
+struct pavltree {
+    struct pavlnode *root_;
+    int (*compar_)(const void *ke, const void *in_tree);
+    size_t size_;
+    struct pavlnode *spare_;
+    size_t nr_spares_;
+};
+
+/* 1.44 * log2(n + 2), for any n a size_t can count. */
+#define PAVLTREE_MAX_HEIGHT 96
+
+struct pavltree_iter {
+    const struct pavlnode *stack_[PAVLTREE_MAX_HEIGHT];
+    int depth_;
+};
+
+static inline void pavltree_init(struct pavltree *self,
+                                 int (*compar)(const void *ke,
+                                               const void *in_tree))
+{
+    self->root_ = NULL;
+    self->compar_ = compar;
+    self->size_ = 0;
+    self->spare_ = NULL;
+    self->nr_spares_ = 0;
+}
+
+static inline void __pavlnode_get(struct pavlnode *x)
+{
+    if (x != NULL) {
+        __atomic_fetch_add(&x->refcnt_, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static void __pavlnode_put(struct pavlnode *x)
+{
+    if ((x != NULL) &&
+        (__atomic_sub_fetch(&x->refcnt_, 1, __ATOMIC_ACQ_REL) == 0)) {
+        __pavlnode_put(x->left_);
+        __pavlnode_put(x->right_);
+        free(x);
+    }
+}
+
+/* Drops this version. Nodes shared with snapshots stay until they go. */
+static inline void pavltree_clear(struct pavltree *self)
+{
+    __pavlnode_put(self->root_);
+    self->root_ = NULL;
+    self->size_ = 0;
+
+    while (self->spare_ != NULL) {
+        struct pavlnode *x = self->spare_;
+
+        self->spare_ = x->left_;
+        free(x);
+    }
+
+    self->nr_spares_ = 0;
+}
+
+/*
+ * Makes 'snap' an O(1) copy of the tree. Both may be read and changed
+ * independently afterwards, 'snap' must be cleared once done with.
+ */
+static inline void pavltree_snapshot(const struct pavltree *self,
+                                     struct pavltree *snap)
+{
+    pavltree_init(snap, self->compar_);
+    __pavlnode_get(self->root_);
+    snap->root_ = self->root_;
+    snap->size_ = self->size_;
+}
+
+static inline bool pavltree_empty(const struct pavltree *self)
+{
+    return self->root_ == NULL;
+}
+
+static inline size_t pavltree_size(const struct pavltree *self)
+{
+    return self->size_;
+}
+
+static inline int __pavlnode_height(const struct pavlnode *x)
+{
+    return x == NULL ? 0 : x->height_;
+}
+
+static inline size_t __pavlnode_count(const struct pavlnode *x)
+{
+    return x == NULL ? 0 : x->count_;
+}
+
+/*
+ * Enough spare nodes for one update : the path, and the two nodes a rotation
+ * may have to copy off it at every level, plus the node to insert.
+ */
+static inline int __pavltree_reserve(struct pavltree *self)
+{
+    size_t nr = 3 * (size_t)__pavlnode_height(self->root_) + 1;
+
+    while (self->nr_spares_ < nr) {
+        struct pavlnode *x = (struct pavlnode *)malloc(sizeof(*x));
+
+        if (x == NULL) {
+            return -ENOMEM;
+        }
+
+        x->left_ = self->spare_;
+        self->spare_ = x;
+        self->nr_spares_++;
+    }
+
+    return 0;
+}
+
+static inline struct pavlnode *__pavltree_alloc(struct pavltree *self)
+{
+    struct pavlnode *x = self->spare_;
+
+    self->spare_ = x->left_;
+    self->nr_spares_--;
+
+    return x;
+}
+
+/* 'x' is only reachable from this tree, and no longer from it. */
+static inline void __pavltree_free(struct pavltree *self, struct pavlnode *x)
+{
+    x->left_ = self->spare_;
+    self->spare_ = x;
+    self->nr_spares_++;
+}
+
+/*
+ * Takes the reference to 'x' held by a node of this tree that may be
+ * changed, and returns a node holding the same that may be changed too :
+ * 'x' itself if nothing else refers to it, or a copy of it.
+ */
+static inline struct pavlnode *__pavltree_own(struct pavltree *self,
+                                              struct pavlnode *x)
+{
+    struct pavlnode *y;
+
+    if (__atomic_load_n(&x->refcnt_, __ATOMIC_ACQUIRE) == 1) {
+        return x;
+    }
+
+    y = __pavltree_alloc(self);
+    y->left_ = x->left_;
+    y->right_ = x->right_;
+    y->entry_ = x->entry_;
+    y->count_ = x->count_;
+    y->refcnt_ = 1;
+    y->height_ = x->height_;
+    __pavlnode_get(y->left_);
+    __pavlnode_get(y->right_);
+    __pavlnode_put(x);
+
+    return y;
+}
+
+static inline void __pavlnode_update(struct pavlnode *x)
+{
+    int left_height = __pavlnode_height(x->left_);
+    int right_height = __pavlnode_height(x->right_);
+
+    x->height_ = (left_height > right_height ? left_height : right_height) + 1;
+    x->count_ = __pavlnode_count(x->left_) + __pavlnode_count(x->right_) + 1;
+}
+
+static inline int __pavlnode_BF(const struct pavlnode *x)
+{
+    return __pavlnode_height(x->left_) - __pavlnode_height(x->right_);
+}
+
+/* 'x' and its right child may be changed. */
+static inline struct pavlnode *__pavlnode_RR(struct pavlnode *x)
+{
+    struct pavlnode *y = x->right_;
+
+    x->right_ = y->left_;
+    y->left_ = x;
+
+    __pavlnode_update(x);
+    __pavlnode_update(y);
+
+    return y;
+}
+
+/* 'x' and its left child may be changed. */
+static inline struct pavlnode *__pavlnode_LL(struct pavlnode *x)
+{
+    struct pavlnode *y = x->left_;
+
+    x->left_ = y->right_;
+    y->right_ = x;
+
+    __pavlnode_update(x);
+    __pavlnode_update(y);
+
+    return y;
+}
+
+/* 'x' may be changed. Owns what the rotations touch before doing them. */
+static inline struct pavlnode *__pavltree_rebalance(struct pavltree *self,
+                                                    struct pavlnode *x)
+{
+    __pavlnode_update(x);
+
+    int bf = __pavlnode_BF(x);
+
+    if (bf >= 2) {
+        x->left_ = __pavltree_own(self, x->left_);
+
+        if (__pavlnode_BF(x->left_) < 0) {
+            x->left_->right_ = __pavltree_own(self, x->left_->right_);
+            x->left_ = __pavlnode_RR(x->left_);
+        }
+
+        x = __pavlnode_LL(x);
+    } else if (bf <= -2) {
+        x->right_ = __pavltree_own(self, x->right_);
+
+        if (__pavlnode_BF(x->right_) > 0) {
+            x->right_->left_ = __pavltree_own(self, x->right_->left_);
+            x->right_ = __pavlnode_LL(x->right_);
+        }
+
+        x = __pavlnode_RR(x);
+    }
+
+    return x;
+}
+
+/* 'e' must not be in the subtree under 'x'. */
+static struct pavlnode *__pavltree_insert(struct pavltree *self,
+                                          struct pavlnode *x, void *e)
+{
+    if (x == NULL) {
+        x = __pavltree_alloc(self);
+        x->left_ = x->right_ = NULL;
+        x->entry_ = e;
+        x->count_ = 1;
+        x->refcnt_ = 1;
+        x->height_ = 1;
+
+        return x;
+    }
+
+    x = __pavltree_own(self, x);
+
+    if (self->compar_(e, x->entry_) < 0) {
+        x->left_ = __pavltree_insert(self, x->left_, e);
+    } else {
+        x->right_ = __pavltree_insert(self, x->right_, e);
+    }
+
+    return __pavltree_rebalance(self, x);
+}
+
+static struct pavlnode *__pavltree_erase_min(struct pavltree *self,
+                                             struct pavlnode *x, void **e)
+{
+    struct pavlnode *right;
+
+    x = __pavltree_own(self, x);
+
+    if (x->left_ != NULL) {
+        x->left_ = __pavltree_erase_min(self, x->left_, e);
+
+        return __pavltree_rebalance(self, x);
+    }
+
+    *e = x->entry_;
+    right = x->right_;
+    __pavltree_free(self, x);
+
+    return right;
+}
+
+/* An entry equal to 'ke' must be in the subtree under 'x'. */
+static struct pavlnode *__pavltree_erase(struct pavltree *self,
+                                         struct pavlnode *x, const void *ke)
+{
+    int diff = self->compar_(ke, x->entry_);
+
+    x = __pavltree_own(self, x);
+
+    if (diff < 0) {
+        x->left_ = __pavltree_erase(self, x->left_, ke);
+    } else if (diff > 0) {
+        x->right_ = __pavltree_erase(self, x->right_, ke);
+    } else if ((x->left_ != NULL) && (x->right_ != NULL)) {
+        x->right_ = __pavltree_erase_min(self, x->right_, &x->entry_);
+    } else {
+        struct pavlnode *child = x->left_ != NULL ? x->left_ : x->right_;
+
+        __pavltree_free(self, x);
+
+        return child;
+    }
+
+    return __pavltree_rebalance(self, x);
+}
+
+static inline void *pavltree_find(const struct pavltree *self, const void *ke)
+{
+    const struct pavlnode *x = self->root_;
+
+    while (x != NULL) {
+        int diff = self->compar_(ke, x->entry_);
+
+        if (diff == 0) {
+            return x->entry_;
+        }
+
+        x = diff < 0 ? x->left_ : x->right_;
+    }
+
+    return NULL;
+}
+
+/* Leaves at most the spare nodes the next update needs. */
+static inline void __pavltree_trim(struct pavltree *self)
+{
+    size_t nr = 3 * (size_t)__pavlnode_height(self->root_) + 1;
+
+    while (self->nr_spares_ > nr) {
+        free(__pavltree_alloc(self));
+    }
+}
+
+static inline int pavltree_insert(struct pavltree *self, void *e)
+{
+    int err;
+
+    if (pavltree_find(self, e) != NULL) {
+        return -EEXIST;
+    }
+
+    if ((err = __pavltree_reserve(self)) != 0) {
+        return err;
+    }
+
+    self->root_ = __pavltree_insert(self, self->root_, e);
+    self->size_++;
+
+    return 0;
+}
+
+/*
+ * Returns the entry equal to 'ke' it took out of the tree, or NULL if there
+ * is none or no memory was left to copy the nodes shared with snapshots.
+ */
+static inline void *pavltree_erase(struct pavltree *self, const void *ke)
+{
+    void *e = pavltree_find(self, ke);
+
+    if (e == NULL) {
+        return NULL;
+    }
+
+    if (__pavltree_reserve(self) != 0) {
+        return NULL;
+    }
+
+    self->root_ = __pavltree_erase(self, self->root_, ke);
+    self->size_--;
+    __pavltree_trim(self);
+
+    return e;
+}
+
+static inline void *pavltree_lower_bound(const struct pavltree *self,
+                                         const void *ke)
+{
+    const struct pavlnode *x = self->root_;
+    void *found = NULL;
+
+    while (x != NULL) {
+        if (self->compar_(ke, x->entry_) <= 0) {
+            found = x->entry_;
+            x = x->left_;
+        } else {
+            x = x->right_;
+        }
+    }
+
+    return found;
+}
+
+static inline void *pavltree_at(const struct pavltree *self, size_t n)
+{
+    const struct pavlnode *x = self->root_;
+
+    while (x != NULL) {
+        size_t left_count = __pavlnode_count(x->left_);
+
+        if (n == left_count) {
+            return x->entry_;
+        } else if (n < left_count) {
+            x = x->left_;
+        } else {
+            n -= left_count + 1;
+            x = x->right_;
+        }
+    }
+
+    return NULL;
+}
+
+static inline void __pavltree_iter_push(struct pavltree_iter *it,
+                                        const struct pavlnode *x)
+{
+    for (; x != NULL; x = x->left_) {
+        it->stack_[it->depth_++] = x;
+    }
+}
+
+/*
+ * In-order walk without parent pointers. The tree, or the snapshot it was
+ * taken from, must not change during the walk.
+ */
+static inline void *pavltree_iter_begin(const struct pavltree *self,
+                                        struct pavltree_iter *it)
+{
+    it->depth_ = 0;
+    __pavltree_iter_push(it, self->root_);
+
+    return it->depth_ == 0 ? NULL : it->stack_[it->depth_ - 1]->entry_;
+}
+
+static inline void *pavltree_iter_next(struct pavltree_iter *it)
+{
+    const struct pavlnode *x = it->stack_[--it->depth_];
+
+    __pavltree_iter_push(it, x->right_);
+
+    return it->depth_ == 0 ? NULL : it->stack_[it->depth_ - 1]->entry_;
+}
+
+static inline bool __pavltree_validate_node(const struct pavltree *self,
+                                            const struct pavlnode *x)
+{
+    if (x == NULL) {
+        return true;
+    }
+
+    if ((__atomic_load_n(&x->refcnt_, __ATOMIC_RELAXED) == 0) ||
+        (__pavlnode_BF(x) < -1) ||
+        (__pavlnode_BF(x) > 1)) {
+        return false;
+    }
+
+    if ((x->left_ != NULL) &&
+        (self->compar_(x->left_->entry_, x->entry_) >= 0)) {
+        return false;
+    }
+
+    if ((x->right_ != NULL) &&
+        (self->compar_(x->right_->entry_, x->entry_) <= 0)) {
+        return false;
+    }
+
+    if ((x->height_ != 1 + (__pavlnode_height(x->left_) >
+                                    __pavlnode_height(x->right_) ?
+                                __pavlnode_height(x->left_) :
+                                __pavlnode_height(x->right_))) ||
+        (x->count_ !=
+         __pavlnode_count(x->left_) + __pavlnode_count(x->right_) + 1)) {
+        return false;
+    }
+
+    return __pavltree_validate_node(self, x->left_) &&
+           __pavltree_validate_node(self, x->right_);
+}
+
+static inline bool pavltree_validate(const struct pavltree *self)
+{
+    struct pavltree_iter it;
+    void *prev = NULL;
+
+    if (!__pavltree_validate_node(self, self->root_) ||
+        (__pavlnode_count(self->root_) != self->size_)) {
+        return false;
+    }
+
+    for (void *e = pavltree_iter_begin(self, &it); e != NULL;
+         e = pavltree_iter_next(&it)) {
+        if ((prev != NULL) && (self->compar_(prev, e) >= 0)) {
+            return false;
+        }
+
+        prev = e;
+    }
+
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_PAVLTREE_H__ */
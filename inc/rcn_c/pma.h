@@ -0,0 +1,533 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ *
+ * Reference : M. A. Bender, E. D. Demaine, M. Farach-Colton,
+ *             "Cache-Oblivious B-Trees", FOCS 2000.
+ */
+
+/* Packed-Memory Array */
+#ifndef __RCN_C_PMA_H__
+#define __RCN_C_PMA_H__
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "binary_search.h"
+#include "ilog2.h"
+
+#ifndef PMA_SEGMENT_MIN
+#define PMA_SEGMENT_MIN 8
+#endif /* PMA_SEGMENT_MIN */
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/* Density thresholds of a window : leaf segment -> whole array. */
+#define PMA_UPPER_LEAF 1.00
+#define PMA_UPPER_ROOT 0.75
+#define PMA_LOWER_LEAF 0.125
+#define PMA_LOWER_ROOT 0.25
+
+/*
+ * The array is split into 'nr_segs_' segments of 'seg_size_' slots.
+ * Entries of a segment are packed to its front, 'count_[n]' tells how many
+ * slots of the n-th segment are in use. Gaps between segments absorb inserts,
+ * and a window of 2^k segments is re-spread once its density leaves the
+ * thresholds for that height.
+ */
+struct pma {
+    size_t width_;
+    int (*compar_)(const void *a, const void *b);
+    char *slot_;
+    size_t *count_;
+    char *scratch_;
+    size_t seg_size_;
+    size_t nr_segs_;
+    size_t size_;
+};
+
+static inline char *__pma_slot(const struct pma *self, size_t seg, size_t off)
+{
+    return &self->slot_[(seg * self->seg_size_ + off) * self->width_];
+}
+
+static inline size_t pma_size(const struct pma *self)
+{
+    return self->size_;
+}
+
+static inline bool pma_empty(const struct pma *self)
+{
+    return pma_size(self) == 0;
+}
+
+static inline size_t pma_capacity(const struct pma *self)
+{
+    return self->seg_size_ * self->nr_segs_;
+}
+
+static inline void pma_clear(struct pma *self)
+{
+    self->size_ = 0;
+
+    if (self->count_ == NULL) {
+        return;
+    }
+
+    memset(self->count_, 0, self->nr_segs_ * sizeof(*self->count_));
+}
+
+static inline void pma_init(struct pma *self, size_t size,
+                            int (*compar)(const void *a, const void *b))
+{
+    self->width_ = size;
+    self->compar_ = compar;
+    self->slot_ = NULL;
+    self->count_ = NULL;
+    self->scratch_ = NULL;
+    self->seg_size_ = PMA_SEGMENT_MIN;
+    self->nr_segs_ = 1;
+    self->size_ = 0;
+}
+
+static inline size_t __pma_seg_size(size_t capacity)
+{
+    size_t seg_size = PMA_SEGMENT_MIN;
+    size_t lg = ilog2l(capacity);
+
+    while (seg_size < lg) {
+        seg_size <<= 1;
+    }
+
+    return seg_size;
+}
+
+static inline int __pma_alloc(struct pma *self, size_t capacity)
+{
+    size_t seg_size = __pma_seg_size(capacity);
+    size_t nr_segs = capacity < seg_size ? 1 : capacity / seg_size;
+    char *slot = (char *)malloc(nr_segs * seg_size * self->width_);
+    size_t *count = (size_t *)calloc(nr_segs, sizeof(*count));
+    char *scratch = (char *)malloc((nr_segs * seg_size + 1) * self->width_);
+
+    if ((slot == NULL) || (count == NULL) || (scratch == NULL)) {
+        free(slot);
+        free(count);
+        free(scratch);
+        return -ENOMEM;
+    }
+
+    self->slot_ = slot;
+    self->count_ = count;
+    self->scratch_ = scratch;
+    self->seg_size_ = seg_size;
+    self->nr_segs_ = nr_segs;
+
+    return 0;
+}
+
+static inline int __pma_alloc_slot(struct pma *self)
+{
+    int err = __pma_alloc(self, PMA_SEGMENT_MIN);
+
+    pma_clear(self);
+
+    return err;
+}
+
+static inline void __pma_free_slot(struct pma *self)
+{
+    free(self->slot_);
+    free(self->count_);
+    free(self->scratch_);
+    self->slot_ = NULL;
+    self->count_ = NULL;
+    self->scratch_ = NULL;
+}
+
+/* Threshold of a window of 2^level segments, the root being the whole array. */
+static inline double __pma_threshold(const struct pma *self, size_t level,
+                                     double leaf, double root)
+{
+    size_t height = ilog2l(self->nr_segs_);
+
+    if (height == 0) {
+        return root;
+    }
+
+    return leaf - (leaf - root) * (double)level / (double)height;
+}
+
+static inline size_t __pma_gather(const struct pma *self, size_t first,
+                                  size_t nr_segs, char *buf)
+{
+    size_t n = 0;
+
+    for (size_t seg = first; seg < first + nr_segs; seg++) {
+        size_t count = self->count_[seg];
+
+        memcpy(&buf[n * self->width_], __pma_slot(self, seg, 0),
+               count * self->width_);
+        n += count;
+    }
+
+    return n;
+}
+
+static inline void __pma_spread(struct pma *self, size_t first, size_t nr_segs,
+                                const char *buf, size_t n)
+{
+    size_t quot = n / nr_segs;
+    size_t rem = n % nr_segs;
+
+    for (size_t seg = first; seg < first + nr_segs; seg++) {
+        size_t count = quot + (seg - first < rem ? 1 : 0);
+
+        memcpy(__pma_slot(self, seg, 0), buf, count * self->width_);
+        self->count_[seg] = count;
+        buf += count * self->width_;
+    }
+}
+
+static inline int __pma_resize(struct pma *self, size_t capacity)
+{
+    struct pma old = *self;
+    size_t n = __pma_gather(&old, 0, old.nr_segs_, old.scratch_);
+    int err;
+
+    if ((err = __pma_alloc(self, capacity)) != 0) {
+        return err;
+    }
+
+    __pma_spread(self, 0, self->nr_segs_, old.scratch_, n);
+    __pma_free_slot(&old);
+
+    return 0;
+}
+
+/* First non-empty segment in [first, last), or 'last'. */
+static inline size_t __pma_next_seg(const struct pma *self, size_t first,
+                                    size_t last)
+{
+    while (first < last && self->count_[first] == 0) {
+        first++;
+    }
+
+    return first;
+}
+
+/* First segment whose last entry is not less than 'key', or 'nr_segs_'. */
+static inline size_t __pma_find_seg(const struct pma *self, const void *key)
+{
+    size_t left = 0, right = self->nr_segs_;
+
+    while (left < right) {
+        size_t mid = left + (right - left) / 2;
+        size_t seg = __pma_next_seg(self, mid, right);
+
+        if (seg == right) {
+            right = mid;
+        } else if (self->compar_(
+                       key, __pma_slot(self, seg, self->count_[seg] - 1)) >
+                   0) {
+            left = seg + 1;
+        } else {
+            right = mid;
+        }
+    }
+
+    return __pma_next_seg(self, left, self->nr_segs_);
+}
+
+static inline size_t __pma_lower_bound_off(const struct pma *self, size_t seg,
+                                           const void *key)
+{
+    size_t left = 0, right = self->count_[seg];
+
+    while (left < right) {
+        size_t mid = left + (right - left) / 2;
+
+        if (self->compar_(key, __pma_slot(self, seg, mid)) > 0) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+
+    return left;
+}
+
+static inline ssize_t __pma_search(const struct pma *self, const void *key)
+{
+    if (self->count_ == NULL) {
+        return -EEXIST;
+    }
+
+    size_t seg = __pma_find_seg(self, key);
+    ssize_t off;
+
+    if (seg == self->nr_segs_) {
+        return -EEXIST;
+    }
+
+    off = __binary_search(key, __pma_slot(self, seg, 0), self->count_[seg],
+                          self->width_, self->compar_);
+
+    return off < 0 ? off : (ssize_t)(seg * self->seg_size_ + off);
+}
+
+static inline void *pma_search(const struct pma *self, const void *key)
+{
+    ssize_t pos = __pma_search(self, key);
+
+    return pos >= 0 ? &self->slot_[pos * self->width_] : NULL;
+}
+
+/*
+ * Smallest window of 2^k segments around 'seg' whose density, with 'extra'
+ * more entries, stays within the upper (or lower) threshold of its height.
+ */
+static inline bool __pma_window(const struct pma *self, size_t seg,
+                                size_t extra, bool upper, size_t *first,
+                                size_t *nr_segs)
+{
+    size_t count = self->count_[seg] + extra;
+    size_t level = 0;
+
+    *first = seg;
+    *nr_segs = 1;
+
+    while (true) {
+        double slots = (double)(*nr_segs * self->seg_size_);
+
+        if (upper && (double)count <= __pma_threshold(self, level,
+                                                      PMA_UPPER_LEAF,
+                                                      PMA_UPPER_ROOT) *
+                                          slots) {
+            return true;
+        }
+
+        if (!upper && (double)count >= __pma_threshold(self, level,
+                                                       PMA_LOWER_LEAF,
+                                                       PMA_LOWER_ROOT) *
+                                           slots) {
+            return true;
+        }
+
+        if (*nr_segs == self->nr_segs_) {
+            return false;
+        }
+
+        size_t buddy = *first ^ *nr_segs;
+
+        for (size_t i = buddy; i < buddy + *nr_segs; i++) {
+            count += self->count_[i];
+        }
+
+        *first &= ~*nr_segs;
+        *nr_segs <<= 1;
+        level++;
+    }
+}
+
+static inline int pma_insert(struct pma *self, const void *e)
+{
+    size_t seg, off, first, nr_segs;
+    int err;
+
+    if ((self->count_ == NULL) && ((err = __pma_alloc_slot(self)) != 0)) {
+        return err;
+    }
+
+    seg = __pma_find_seg(self, e);
+
+    if (seg == self->nr_segs_) {
+        seg = self->nr_segs_ - 1;
+        off = self->count_[seg];
+    } else {
+        off = __pma_lower_bound_off(self, seg, e);
+
+        if (self->compar_(e, __pma_slot(self, seg, off)) == 0) {
+            return -EEXIST;
+        }
+    }
+
+    if (self->count_[seg] < self->seg_size_) {
+        memmove(__pma_slot(self, seg, off + 1), __pma_slot(self, seg, off),
+                (self->count_[seg] - off) * self->width_);
+        memcpy(__pma_slot(self, seg, off), e, self->width_);
+        self->count_[seg]++;
+        self->size_++;
+
+        return 0;
+    }
+
+    if (!__pma_window(self, seg, 1, true, &first, &nr_segs)) {
+        if ((err = __pma_resize(self, pma_capacity(self) * 2)) != 0) {
+            return err;
+        }
+
+        return pma_insert(self, e);
+    }
+
+    size_t n = 0, pos;
+
+    for (size_t i = first; i < seg; i++) {
+        n += self->count_[i];
+    }
+
+    pos = n + off;
+    n = __pma_gather(self, first, nr_segs, self->scratch_);
+    memmove(&self->scratch_[(pos + 1) * self->width_],
+            &self->scratch_[pos * self->width_], (n - pos) * self->width_);
+    memcpy(&self->scratch_[pos * self->width_], e, self->width_);
+    __pma_spread(self, first, nr_segs, self->scratch_, n + 1);
+    self->size_++;
+
+    return 0;
+}
+
+static inline int pma_delete(struct pma *self, const void *key)
+{
+    ssize_t pos = __pma_search(self, key);
+    size_t seg, off, first, nr_segs;
+
+    if (pos < 0) {
+        return -EEXIST;
+    }
+
+    seg = pos / self->seg_size_;
+    off = pos % self->seg_size_;
+
+    memmove(__pma_slot(self, seg, off), __pma_slot(self, seg, off + 1),
+            (self->count_[seg] - off - 1) * self->width_);
+    self->count_[seg]--;
+    self->size_--;
+
+    if (__pma_window(self, seg, 0, false, &first, &nr_segs)) {
+        if (nr_segs > 1) {
+            size_t n = __pma_gather(self, first, nr_segs, self->scratch_);
+
+            __pma_spread(self, first, nr_segs, self->scratch_, n);
+        }
+
+        return 0;
+    }
+
+    if (pma_capacity(self) <= PMA_SEGMENT_MIN) {
+        return 0;
+    }
+
+    return __pma_resize(self, pma_capacity(self) / 2);
+}
+
+static inline size_t pma_end(const struct pma *self)
+{
+    return pma_capacity(self);
+}
+
+static inline size_t __pma_seg_begin(const struct pma *self, size_t seg)
+{
+    seg = __pma_next_seg(self, seg, self->nr_segs_);
+
+    return seg == self->nr_segs_ ? pma_end(self) : seg * self->seg_size_;
+}
+
+static inline size_t pma_begin(const struct pma *self)
+{
+    return self->count_ == NULL ? pma_end(self) : __pma_seg_begin(self, 0);
+}
+
+static inline size_t pma_next(const struct pma *self, size_t pos)
+{
+    size_t seg = pos / self->seg_size_;
+
+    if ((pos % self->seg_size_) + 1 < self->count_[seg]) {
+        return pos + 1;
+    }
+
+    return __pma_seg_begin(self, seg + 1);
+}
+
+static inline void *pma_entry(const struct pma *self, size_t pos)
+{
+    return &self->slot_[pos * self->width_];
+}
+
+static inline size_t pma_lower_bound(const struct pma *self, const void *key)
+{
+    if (self->count_ == NULL) {
+        return pma_end(self);
+    }
+
+    size_t seg = __pma_find_seg(self, key);
+
+    if (seg == self->nr_segs_) {
+        return pma_end(self);
+    }
+
+    return seg * self->seg_size_ + __pma_lower_bound_off(self, seg, key);
+}
+
+static inline size_t pma_upper_bound(const struct pma *self, const void *key)
+{
+    size_t pos = pma_lower_bound(self, key);
+
+    if ((pos != pma_end(self)) &&
+        (self->compar_(key, pma_entry(self, pos)) == 0)) {
+        pos = pma_next(self, pos);
+    }
+
+    return pos;
+}
+
+static inline void *pma_at(const struct pma *self, size_t n)
+{
+    if (n >= pma_size(self)) {
+        return NULL;
+    }
+
+    for (size_t seg = 0; seg < self->nr_segs_; seg++) {
+        if (n < self->count_[seg]) {
+            return __pma_slot(self, seg, n);
+        }
+
+        n -= self->count_[seg];
+    }
+
+    return NULL;
+}
+
+static inline bool pma_validate(const struct pma *self)
+{
+    const void *prev = NULL;
+    size_t size = 0;
+
+    for (size_t pos = pma_begin(self); pos != pma_end(self);
+         pos = pma_next(self, pos)) {
+        const void *e = pma_entry(self, pos);
+
+        if ((prev != NULL) && (self->compar_(prev, e) >= 0)) {
+            return false;
+        }
+
+        prev = e;
+        size++;
+    }
+
+    return pma_size(self) == size;
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_PMA_H__ */
@@ -11,6 +11,12 @@
 #include <errno.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+#ifdef RBTREE_STATS
+#include "tree_stats.h"
+#endif /* RBTREE_STATS */
 
 #ifdef __cplusplus
 namespace rcn_c
@@ -22,21 +28,174 @@ enum rbcolor {
     RBCOLOR_BLACK,
 };
 
+#ifdef RBTREE_COMPACT
+/*
+ * The color lives in bit 0 of the parent pointer, as in the Linux kernel :
+ * a node is then 5 words instead of 6. Nodes must be at least 2 bytes
+ * aligned. The parent and the color are only reached through rbnode_parent()
+ * and rbnode_color().
+ */
+struct rbnode {
+    uintptr_t parent_color_;
+    struct rbnode *left_;
+    struct rbnode *right_;
+    size_t count_;
+    void *entry_;
+#ifdef RBTREE_KEY_PREFIX
+    uint64_t key_;
+#endif /* RBTREE_KEY_PREFIX */
+};
+
+static inline struct rbnode *rbnode_parent(const struct rbnode *x)
+{
+    return (struct rbnode *)(x->parent_color_ & ~(uintptr_t)1);
+}
+
+static inline enum rbcolor rbnode_color(const struct rbnode *x)
+{
+    return (enum rbcolor)(x->parent_color_ & 1);
+}
+
+static inline void __rbnode_set_parent(struct rbnode *x, struct rbnode *p)
+{
+    x->parent_color_ = (uintptr_t)p | (x->parent_color_ & 1);
+}
+
+static inline void __rbnode_set_color(struct rbnode *x, enum rbcolor color)
+{
+    x->parent_color_ = (x->parent_color_ & ~(uintptr_t)1) | color;
+}
+
+static inline void __rbnode_set_parent_color(struct rbnode *x,
+                                             struct rbnode *p,
+                                             enum rbcolor color)
+{
+    x->parent_color_ = (uintptr_t)p | color;
+}
+#else
 struct rbnode {
     enum rbcolor color_;
     struct rbnode *parent_;
     struct rbnode *left_;
     struct rbnode *right_;
+    size_t count_;
     void *entry_;
+#ifdef RBTREE_KEY_PREFIX
+    uint64_t key_;
+#endif /* RBTREE_KEY_PREFIX */
+};
+
+static inline struct rbnode *rbnode_parent(const struct rbnode *x)
+{
+    return x->parent_;
+}
+
+static inline enum rbcolor rbnode_color(const struct rbnode *x)
+{
+    return x->color_;
+}
+
+static inline void __rbnode_set_parent(struct rbnode *x, struct rbnode *p)
+{
+    x->parent_ = p;
+}
+
+static inline void __rbnode_set_color(struct rbnode *x, enum rbcolor color)
+{
+    x->color_ = color;
+}
+
+static inline void __rbnode_set_parent_color(struct rbnode *x,
+                                             struct rbnode *p,
+                                             enum rbcolor color)
+{
+    x->parent_ = p;
+    x->color_ = color;
+}
+#endif /* RBTREE_COMPACT */
+
+/*
+ * Hooks to keep per-node augmented data (e.g. the max end of an interval
+ * subtree) in sync with the tree shape, after the Linux kernel's
+ * rb_augment_callbacks :
+ *  - propagate : recompute 'x' and its ancestors, up to (not including)
+ *                'stop' or NIL. It may stop early once a value is unchanged.
+ *  - copy      : 'new' takes the place of 'old' in the tree.
+ *  - rotate    : 'new' became the root of the subtree 'old' was root of.
+ * The augmented value of a node must be set up as for a leaf before it is
+ * passed to rbtree_insert().
+ */
+struct rbtree_augment {
+    void (*propagate)(struct rbnode *x, struct rbnode *stop);
+    void (*copy)(struct rbnode *old, struct rbnode *new_);
+    void (*rotate)(struct rbnode *old, struct rbnode *new_);
 };
 
 struct rbtree {
     struct rbnode *root_;
     int (*compar_)(const void *ke, const void *in_tree);
+    const struct rbtree_augment *augment_;
+#ifdef RBTREE_KEY_PREFIX
+    uint64_t (*key_of_)(const void *e);
+#endif /* RBTREE_KEY_PREFIX */
     struct rbnode NIL_;
     size_t size_;
+#ifdef RBTREE_STATS
+    struct tree_stats stats_;
+#endif /* RBTREE_STATS */
 };
 
+#ifdef RBTREE_STATS
+#define __RBTREE_STATS(self, field, n) \
+    TREE_STATS_ADD(&(self)->stats_, field, n)
+#else
+#define __RBTREE_STATS(self, field, n) ((void)0)
+#endif /* RBTREE_STATS */
+
+/* NIL is the only node of a tree with an empty subtree. */
+static inline bool rbnode_is_nil(const struct rbnode *x)
+{
+    return x->count_ == 0;
+}
+
+/*
+ * Declares the 'rbtree_augment' named '_name' for '_type' whose rbnode is
+ * '_rbfield' and whose augmented value is '_augfield'. '_compute(n, exit)'
+ * recomputes n->_augfield from its children and, when 'exit' is true,
+ * returns true if the value did not change.
+ */
+#define RBTREE_DECLARE_CALLBACKS(_name, _type, _rbfield, _augfield, _compute) \
+    static inline void _name##_propagate(struct rbnode *x,                    \
+                                         struct rbnode *stop)                 \
+    {                                                                         \
+        while ((x != stop) && !rbnode_is_nil(x)) {                            \
+            if (_compute(CONTAINER_OF(x, _type, _rbfield), true)) {           \
+                break;                                                        \
+            }                                                                 \
+                                                                              \
+            x = rbnode_parent(x);                                             \
+        }                                                                     \
+    }                                                                         \
+                                                                              \
+    static inline void _name##_copy(struct rbnode *old, struct rbnode *new_)  \
+    {                                                                         \
+        CONTAINER_OF(new_, _type, _rbfield)->_augfield =                      \
+            CONTAINER_OF(old, _type, _rbfield)->_augfield;                    \
+    }                                                                         \
+                                                                              \
+    static inline void _name##_rotate(struct rbnode *old,                     \
+                                      struct rbnode *new_)                    \
+    {                                                                         \
+        _name##_copy(old, new_);                                              \
+        _compute(CONTAINER_OF(old, _type, _rbfield), false);                  \
+    }                                                                         \
+                                                                              \
+    static const struct rbtree_augment _name = {                              \
+        _name##_propagate,                                                    \
+        _name##_copy,                                                         \
+        _name##_rotate,                                                       \
+    }
+
 static inline const struct rbnode *rbtree_nil(const struct rbtree *self)
 {
     return &self->NIL_;
@@ -49,9 +208,11 @@ static inline void rbtree_clear(struct rbtree *self)
     self->root_ = (struct rbnode *)NIL;
     self->size_ = 0;
 
-    self->NIL_.color_ = RBCOLOR_BLACK;
+    __rbnode_set_parent_color(&self->NIL_, (struct rbnode *)NIL,
+                              RBCOLOR_BLACK);
     self->NIL_.left_ = (struct rbnode *)NIL;
     self->NIL_.right_ = (struct rbnode *)NIL;
+    self->NIL_.count_ = 0;
     self->NIL_.entry_ = NULL;
 }
 
@@ -61,8 +222,92 @@ static inline void rbtree_init(struct rbtree *self,
 {
     rbtree_clear(self);
     self->compar_ = compar;
+    self->augment_ = NULL;
+#ifdef RBTREE_KEY_PREFIX
+    self->key_of_ = NULL;
+#endif /* RBTREE_KEY_PREFIX */
+#ifdef RBTREE_STATS
+    tree_stats_reset(&self->stats_);
+#endif /* RBTREE_STATS */
+}
+
+static inline void
+rbtree_init_augmented(struct rbtree *self,
+                      int (*compar)(const void *ke, const void *in_tree),
+                      const struct rbtree_augment *augment)
+{
+    rbtree_init(self, compar);
+    self->augment_ = augment;
 }
 
+#ifdef RBTREE_KEY_PREFIX
+/*
+ * Each node keeps a 64 bit key computed from its entry by 'key_of', such as
+ * an integer key or the first bytes of a string, big endian. A descent then
+ * compares it inline, and only calls compar on a tie, without reaching the
+ * entry on another cache line. 'key_of' must follow the order of compar :
+ * compar(a, b) < 0 implies key_of(a) <= key_of(b). Trees that exchange
+ * nodes (join, union, ...) must share it.
+ */
+static inline void
+rbtree_init_keyed(struct rbtree *self,
+                  int (*compar)(const void *ke, const void *in_tree),
+                  uint64_t (*key_of)(const void *e))
+{
+    rbtree_init(self, compar);
+    self->key_of_ = key_of;
+}
+
+static inline uint64_t __rbtree_key(const struct rbtree *self, const void *e)
+{
+    return self->key_of_ != NULL ? self->key_of_(e) : 0;
+}
+
+static inline uint64_t __rbnode_key(const struct rbnode *x)
+{
+    return x->key_;
+}
+
+static inline void __rbnode_set_entry(const struct rbtree *self,
+                                      struct rbnode *x, void *e)
+{
+    x->entry_ = e;
+    x->key_ = __rbtree_key(self, e);
+}
+
+static inline int __rbtree_compar(const struct rbtree *self, uint64_t key,
+                                  const void *ke, const struct rbnode *x)
+{
+    if (key != x->key_) {
+        return key < x->key_ ? -1 : 1;
+    }
+
+    return self->compar_(ke, x->entry_);
+}
+#else
+static inline uint64_t __rbtree_key(const struct rbtree *self, const void *e)
+{
+    return 0;
+}
+
+static inline uint64_t __rbnode_key(const struct rbnode *x)
+{
+    return 0;
+}
+
+static inline void __rbnode_set_entry(const struct rbtree *self,
+                                      struct rbnode *x, void *e)
+{
+    x->entry_ = e;
+}
+
+static inline int __rbtree_compar(const struct rbtree *self, uint64_t key,
+                                  const void *ke, const struct rbnode *x)
+{
+    return self->compar_(ke, x->entry_);
+}
+#endif /* RBTREE_KEY_PREFIX */
+
 static inline bool rbtree_empty(const struct rbtree *self)
 {
     return self->root_ == rbtree_nil(self);
@@ -130,7 +375,7 @@ static inline struct rbnode *rbtree_next(const struct rbtree *self,
         return (struct rbnode *)x;
     }
 
-    while (((parent = x->parent_) != NIL) && x == parent->right_) {
+    while (((parent = rbnode_parent(x)) != NIL) && x == parent->right_) {
         x = parent;
     }
 
@@ -157,7 +402,7 @@ static inline struct rbnode *rbtree_prev(const struct rbtree *self,
         return (struct rbnode *)x;
     }
 
-    while (((parent = x->parent_) != NIL) && x == parent->left_) {
+    while (((parent = rbnode_parent(x)) != NIL) && x == parent->left_) {
         x = parent;
     }
 
@@ -179,29 +424,42 @@ static inline void *rbtree_back(const struct rbtree *self)
     return rbtree_empty(self) ? NULL : rbtree_rbegin(self)->entry_;
 }
 
+static inline void __rbnode_update(struct rbnode *x)
+{
+    x->count_ = x->left_->count_ + x->right_->count_ + 1;
+}
+
 static inline void __rbtree_left_rotate(struct rbtree *self, struct rbnode *x)
 {
     const struct rbnode *const NIL = rbtree_nil(self);
     struct rbnode *y = x->right_;
 
-    x->right_ = y->left_;
+    __RBTREE_STATS(self, nr_rotations_, 1);
+    WRITE_ONCE(x->right_, y->left_);
 
     if (y->left_ != NIL) {
-        y->left_->parent_ = x;
+        __rbnode_set_parent(y->left_, x);
     }
 
-    y->parent_ = x->parent_;
+    __rbnode_set_parent(y, rbnode_parent(x));
 
-    if (x->parent_ == NIL) {
-        self->root_ = y;
-    } else if (x == x->parent_->left_) {
-        x->parent_->left_ = y;
+    if (rbnode_parent(x) == NIL) {
+        WRITE_ONCE(self->root_, y);
+    } else if (x == rbnode_parent(x)->left_) {
+        WRITE_ONCE(rbnode_parent(x)->left_, y);
     } else {
-        x->parent_->right_ = y;
+        WRITE_ONCE(rbnode_parent(x)->right_, y);
     }
 
-    y->left_ = x;
-    x->parent_ = y;
+    WRITE_ONCE(y->left_, x);
+    __rbnode_set_parent(x, y);
+
+    y->count_ = x->count_;
+    __rbnode_update(x);
+
+    if (self->augment_ != NULL) {
+        self->augment_->rotate(x, y);
+    }
 }
 
 static inline void __rbtree_right_rotate(struct rbtree *self, struct rbnode *x)
@@ -209,106 +467,297 @@ static inline void __rbtree_right_rotate(struct rbtree *self, struct rbnode *x)
     const struct rbnode *const NIL = rbtree_nil(self);
     struct rbnode *y = x->left_;
 
-    x->left_ = y->right_;
+    __RBTREE_STATS(self, nr_rotations_, 1);
+    WRITE_ONCE(x->left_, y->right_);
 
     if (y->right_ != NIL) {
-        y->right_->parent_ = x;
+        __rbnode_set_parent(y->right_, x);
     }
 
-    y->parent_ = x->parent_;
+    __rbnode_set_parent(y, rbnode_parent(x));
 
-    if (x->parent_ == NIL) {
-        self->root_ = y;
-    } else if (x == x->parent_->left_) {
-        x->parent_->left_ = y;
+    if (rbnode_parent(x) == NIL) {
+        WRITE_ONCE(self->root_, y);
+    } else if (x == rbnode_parent(x)->left_) {
+        WRITE_ONCE(rbnode_parent(x)->left_, y);
     } else {
-        x->parent_->right_ = y;
+        WRITE_ONCE(rbnode_parent(x)->right_, y);
     }
 
-    y->right_ = x;
-    x->parent_ = y;
+    WRITE_ONCE(y->right_, x);
+    __rbnode_set_parent(x, y);
+
+    y->count_ = x->count_;
+    __rbnode_update(x);
+
+    if (self->augment_ != NULL) {
+        self->augment_->rotate(x, y);
+    }
+}
+
+/* One entry left the subtree under 'x' : fix up the counts up to the root. */
+static inline void __rbnode_shrink(const struct rbtree *self, struct rbnode *x)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+
+    for (; x != NIL; x = rbnode_parent(x)) {
+        x->count_--;
+    }
+}
+
+static inline void __rbtree_propagate(const struct rbtree *self,
+                                      struct rbnode *x,
+                                      const struct rbnode *stop)
+{
+    if (self->augment_ != NULL) {
+        self->augment_->propagate(x, (struct rbnode *)stop);
+    }
 }
 
 static inline void __rbtree_insert_fixup(struct rbtree *self, struct rbnode *z)
 {
-    while (z->parent_->color_ == RBCOLOR_RED) {
-        if (z->parent_ == z->parent_->parent_->left_) {
-            struct rbnode *y = z->parent_->parent_->right_;
+    struct rbnode *p, *g;
+
+    while (rbnode_color(p = rbnode_parent(z)) == RBCOLOR_RED) {
+        __RBTREE_STATS(self, nr_fixups_, 1);
+        g = rbnode_parent(p);
 
-            if (y->color_ == RBCOLOR_RED) {
-                z->parent_->color_ = RBCOLOR_BLACK;
-                y->color_ = RBCOLOR_BLACK;
-                z->parent_->parent_->color_ = RBCOLOR_RED;
-                z = z->parent_->parent_;
+        if (p == g->left_) {
+            struct rbnode *y = g->right_;
+
+            if (rbnode_color(y) == RBCOLOR_RED) {
+                __rbnode_set_color(p, RBCOLOR_BLACK);
+                __rbnode_set_color(y, RBCOLOR_BLACK);
+                __rbnode_set_color(g, RBCOLOR_RED);
+                z = g;
             } else {
-                if (z == z->parent_->right_) {
-                    z = z->parent_;
+                if (z == p->right_) {
+                    z = p;
                     __rbtree_left_rotate(self, z);
+                    p = rbnode_parent(z);
                 }
 
-                z->parent_->color_ = RBCOLOR_BLACK;
-                z->parent_->parent_->color_ = RBCOLOR_RED;
-                __rbtree_right_rotate(self, z->parent_->parent_);
+                __rbnode_set_color(p, RBCOLOR_BLACK);
+                __rbnode_set_color(g, RBCOLOR_RED);
+                __rbtree_right_rotate(self, g);
             }
         } else {
-            struct rbnode *y = z->parent_->parent_->left_;
+            struct rbnode *y = g->left_;
 
-            if (y->color_ == RBCOLOR_RED) {
-                z->parent_->color_ = RBCOLOR_BLACK;
-                y->color_ = RBCOLOR_BLACK;
-                z->parent_->parent_->color_ = RBCOLOR_RED;
-                z = z->parent_->parent_;
+            if (rbnode_color(y) == RBCOLOR_RED) {
+                __rbnode_set_color(p, RBCOLOR_BLACK);
+                __rbnode_set_color(y, RBCOLOR_BLACK);
+                __rbnode_set_color(g, RBCOLOR_RED);
+                z = g;
             } else {
-                if (z == z->parent_->left_) {
-                    z = z->parent_;
+                if (z == p->left_) {
+                    z = p;
                     __rbtree_right_rotate(self, z);
+                    p = rbnode_parent(z);
                 }
 
-                z->parent_->color_ = RBCOLOR_BLACK;
-                z->parent_->parent_->color_ = RBCOLOR_RED;
-                __rbtree_left_rotate(self, z->parent_->parent_);
+                __rbnode_set_color(p, RBCOLOR_BLACK);
+                __rbnode_set_color(g, RBCOLOR_RED);
+                __rbtree_left_rotate(self, g);
             }
         }
     }
 
-    self->root_->color_ = RBCOLOR_BLACK;
+    __rbnode_set_color(self->root_, RBCOLOR_BLACK);
 }
 
-static inline int rbtree_insert(struct rbtree *self, struct rbnode *z, void *e)
+/* Links 'z' holding 'e' as the 'diff' side child of 'y', or as the root. */
+static inline void __rbtree_link(struct rbtree *self, struct rbnode *y,
+                                 int diff, struct rbnode *z, void *e)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+
+    __rbnode_set_entry(self, z, e);
+    __rbnode_set_parent_color(z, y, RBCOLOR_RED);
+    z->left_ = z->right_ = (struct rbnode *)NIL;
+    z->count_ = 1;
+
+    /* Lockless readers (rbtree_latch.h) reaching 'z' find it set up. */
+    if (y == NIL) {
+        __atomic_store_n(&self->root_, z, __ATOMIC_RELEASE);
+    } else if (diff < 0) {
+        __atomic_store_n(&y->left_, z, __ATOMIC_RELEASE);
+    } else {
+        __atomic_store_n(&y->right_, z, __ATOMIC_RELEASE);
+    }
+
+    for (; y != NIL; y = rbnode_parent(y)) {
+        y->count_++;
+    }
+
+    __rbtree_propagate(self, rbnode_parent(z), NIL);
+    __RBTREE_STATS(self, nr_inserts_, 1);
+    self->size_++;
+    __rbtree_insert_fixup(self, z);
+}
+
+/*
+ * Returns the node holding an entry equal to 'e', or NIL after linking 'z'
+ * holding 'e' where it belongs.
+ */
+static inline struct rbnode *__rbtree_insert(struct rbtree *self,
+                                             struct rbnode *z, void *e)
 {
     const struct rbnode *const NIL = rbtree_nil(self);
     struct rbnode *x = self->root_;
     struct rbnode *y = (struct rbnode *)NIL;
+    uint64_t key = __rbtree_key(self, e);
     int diff = 0;
 
     while (x != NIL) {
         y = x;
-        diff = self->compar_(e, y->entry_);
+        diff = __rbtree_compar(self, key, e, y);
+        __RBTREE_STATS(self, nr_insert_compars_, 1);
 
         if (diff < 0) {
             x = x->left_;
         } else if (diff > 0) {
             x = x->right_;
         } else {
-            return -EEXIST;
+            return x;
         }
     }
 
-    z->entry_ = e;
-    z->parent_ = y;
-    z->left_ = z->right_ = (struct rbnode *)NIL;
-    z->color_ = RBCOLOR_RED;
+    __rbtree_link(self, y, diff, z, e);
 
-    if (y == NIL) {
-        self->root_ = z;
-    } else if (diff < 0) {
-        y->left_ = z;
+    return (struct rbnode *)NIL;
+}
+
+static inline int rbtree_insert(struct rbtree *self, struct rbnode *z, void *e)
+{
+    return rbnode_is_nil(__rbtree_insert(self, z, e)) ? 0 : -EEXIST;
+}
+
+/*
+ * Inserts 'z' holding 'e' unless an equal entry is there already. Returns
+ * the node holding the entry in the tree, which is 'z' if it was inserted.
+ */
+static inline struct rbnode *rbtree_insert_or_get(struct rbtree *self,
+                                                  struct rbnode *z, void *e)
+{
+    struct rbnode *x = __rbtree_insert(self, z, e);
+
+    return rbnode_is_nil(x) ? z : x;
+}
+
+/*
+ * Inserts 'z' holding 'e' right after 'hint', or first if 'hint' is the end,
+ * without a descent when 'e' does belong there. Otherwise falls back to
+ * rbtree_insert(). The rebalancing is amortized O(1) either way, only the
+ * counts are still updated up to the root.
+ */
+static inline int rbtree_insert_hint(struct rbtree *self, struct rbnode *hint,
+                                     struct rbnode *z, void *e)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+    struct rbnode *next = hint == NIL ? rbtree_begin(self) :
+                                        rbtree_next(self, hint);
+    uint64_t key = __rbtree_key(self, e);
+    int diff;
+
+    if (hint != NIL) {
+        if ((diff = __rbtree_compar(self, key, e, hint)) <= 0) {
+            return diff == 0 ? -EEXIST : rbtree_insert(self, z, e);
+        }
+    }
+
+    if (next != NIL) {
+        if ((diff = __rbtree_compar(self, key, e, next)) >= 0) {
+            return diff == 0 ? -EEXIST : rbtree_insert(self, z, e);
+        }
+    }
+
+    if ((hint != NIL) && (hint->right_ == NIL)) {
+        __rbtree_link(self, hint, 1, z, e);
     } else {
-        y->right_ = z;
+        /* 'next' is the leftmost node of the right subtree of 'hint'. */
+        __rbtree_link(self, next, -1, z, e);
     }
 
-    self->size_++;
-    __rbtree_insert_fixup(self, z);
+    return 0;
+}
+
+static inline struct rbnode *
+__rbtree_build(struct rbtree *self, struct rbnode *parent,
+               struct rbnode *nodes[], void *entries[], size_t n,
+               size_t depth, size_t red_depth)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+    size_t mid = n / 2;
+    struct rbnode *x;
+
+    if (n == 0) {
+        return (struct rbnode *)NIL;
+    }
+
+    x = nodes[mid];
+    __rbnode_set_entry(self, x, entries[mid]);
+    __rbnode_set_parent_color(x, parent,
+                              depth == red_depth ? RBCOLOR_RED : RBCOLOR_BLACK);
+    x->count_ = n;
+    x->left_ = __rbtree_build(self, x, nodes, entries, mid, depth + 1,
+                              red_depth);
+    x->right_ = __rbtree_build(self, x, &nodes[mid + 1], &entries[mid + 1],
+                               n - mid - 1, depth + 1, red_depth);
+
+    __rbtree_propagate(self, x, parent);
+
+    return x;
+}
+
+/*
+ * Replaces the content of the tree with the 'n' entries of 'entries', which
+ * must be sorted in strictly ascending order, using nodes[i] for entries[i].
+ * compar is never called. The result is perfectly balanced : every path
+ * holds the same black nodes, and the nodes of the deepest level are red,
+ * whether it is full or not, once there is more than one node. O(n).
+ */
+static inline void rbtree_build_sorted(struct rbtree *self,
+                                       struct rbnode *nodes[],
+                                       void *entries[], size_t n)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+    size_t red_depth = 0;
+
+    rbtree_clear(self);
+
+    /* Depth of the deepest level. A root alone stays black. */
+    for (size_t m = n; m > 1; m >>= 1) {
+        red_depth++;
+    }
+
+    if (red_depth == 0) {
+        red_depth = SIZE_MAX;
+    }
+
+    self->root_ = __rbtree_build(self, (struct rbnode *)NIL, nodes, entries,
+                                 n, 0, red_depth);
+    self->size_ = n;
+}
+
+/*
+ * Fast path for ascending inserts : an entry greater than the last one is
+ * linked after it with a single comparison, the last one being found down
+ * the right spine. Others fall back to rbtree_insert().
+ * See also rbtree_insert_hint().
+ */
+static inline int rbtree_append_sorted(struct rbtree *self, struct rbnode *z,
+                                       void *e)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+    struct rbnode *y = rbtree_rbegin(self);
+
+    if ((y != NIL) &&
+        (__rbtree_compar(self, __rbtree_key(self, e), e, y) <= 0)) {
+        return rbtree_insert(self, z, e);
+    }
+
+    __rbtree_link(self, y, 1, z, e);
 
     return 0;
 }
@@ -318,80 +767,81 @@ static inline void __rbtree_transplant(struct rbtree *self, struct rbnode *u,
 {
     const struct rbnode *const NIL = rbtree_nil(self);
 
-    if (u->parent_ == NIL) {
-        self->root_ = v;
-    } else if (u == u->parent_->left_) {
-        u->parent_->left_ = v;
+    if (rbnode_parent(u) == NIL) {
+        WRITE_ONCE(self->root_, v);
+    } else if (u == rbnode_parent(u)->left_) {
+        WRITE_ONCE(rbnode_parent(u)->left_, v);
     } else {
-        u->parent_->right_ = v;
+        WRITE_ONCE(rbnode_parent(u)->right_, v);
     }
 
-    v->parent_ = u->parent_;
+    __rbnode_set_parent(v, rbnode_parent(u));
 }
 
 static inline void __rbtree_delete_fixup(struct rbtree *self, struct rbnode *x)
 {
-    while (x != self->root_ && x->color_ == RBCOLOR_BLACK) {
-        if (x == x->parent_->left_) {
-            struct rbnode *w = x->parent_->right_;
-
-            if (w->color_ == RBCOLOR_RED) {
-                w->color_ = RBCOLOR_BLACK;
-                x->parent_->color_ = RBCOLOR_RED;
-                __rbtree_left_rotate(self, x->parent_);
-                w = x->parent_->right_;
+    while (x != self->root_ && rbnode_color(x) == RBCOLOR_BLACK) {
+        __RBTREE_STATS(self, nr_fixups_, 1);
+        if (x == rbnode_parent(x)->left_) {
+            struct rbnode *w = rbnode_parent(x)->right_;
+
+            if (rbnode_color(w) == RBCOLOR_RED) {
+                __rbnode_set_color(w, RBCOLOR_BLACK);
+                __rbnode_set_color(rbnode_parent(x), RBCOLOR_RED);
+                __rbtree_left_rotate(self, rbnode_parent(x));
+                w = rbnode_parent(x)->right_;
             }
 
-            if ((w->left_->color_ == RBCOLOR_BLACK) &&
-                (w->right_->color_ == RBCOLOR_BLACK)) {
-                w->color_ = RBCOLOR_RED;
-                x = x->parent_;
+            if ((rbnode_color(w->left_) == RBCOLOR_BLACK) &&
+                (rbnode_color(w->right_) == RBCOLOR_BLACK)) {
+                __rbnode_set_color(w, RBCOLOR_RED);
+                x = rbnode_parent(x);
             } else {
-                if (w->right_->color_ == RBCOLOR_BLACK) {
-                    w->left_->color_ = RBCOLOR_BLACK;
-                    w->color_ = RBCOLOR_RED;
+                if (rbnode_color(w->right_) == RBCOLOR_BLACK) {
+                    __rbnode_set_color(w->left_, RBCOLOR_BLACK);
+                    __rbnode_set_color(w, RBCOLOR_RED);
                     __rbtree_right_rotate(self, w);
-                    w = x->parent_->right_;
+                    w = rbnode_parent(x)->right_;
                 }
 
-                w->color_ = x->parent_->color_;
-                x->parent_->color_ = RBCOLOR_BLACK;
-                w->right_->color_ = RBCOLOR_BLACK;
-                __rbtree_left_rotate(self, x->parent_);
+                __rbnode_set_color(w, rbnode_color(rbnode_parent(x)));
+                __rbnode_set_color(rbnode_parent(x), RBCOLOR_BLACK);
+                __rbnode_set_color(w->right_, RBCOLOR_BLACK);
+                __rbtree_left_rotate(self, rbnode_parent(x));
                 x = self->root_;
             }
         } else {
-            struct rbnode *w = x->parent_->left_;
+            struct rbnode *w = rbnode_parent(x)->left_;
 
-            if (w->color_ == RBCOLOR_RED) {
-                w->color_ = RBCOLOR_BLACK;
-                x->parent_->color_ = RBCOLOR_RED;
-                __rbtree_right_rotate(self, x->parent_);
-                w = x->parent_->left_;
+            if (rbnode_color(w) == RBCOLOR_RED) {
+                __rbnode_set_color(w, RBCOLOR_BLACK);
+                __rbnode_set_color(rbnode_parent(x), RBCOLOR_RED);
+                __rbtree_right_rotate(self, rbnode_parent(x));
+                w = rbnode_parent(x)->left_;
             }
 
-            if ((w->right_->color_ == RBCOLOR_BLACK) &&
-                (w->left_->color_ == RBCOLOR_BLACK)) {
-                w->color_ = RBCOLOR_RED;
-                x = x->parent_;
+            if ((rbnode_color(w->right_) == RBCOLOR_BLACK) &&
+                (rbnode_color(w->left_) == RBCOLOR_BLACK)) {
+                __rbnode_set_color(w, RBCOLOR_RED);
+                x = rbnode_parent(x);
             } else {
-                if (w->left_->color_ == RBCOLOR_BLACK) {
-                    w->right_->color_ = RBCOLOR_BLACK;
-                    w->color_ = RBCOLOR_RED;
+                if (rbnode_color(w->left_) == RBCOLOR_BLACK) {
+                    __rbnode_set_color(w->right_, RBCOLOR_BLACK);
+                    __rbnode_set_color(w, RBCOLOR_RED);
                     __rbtree_left_rotate(self, w);
-                    w = x->parent_->left_;
+                    w = rbnode_parent(x)->left_;
                 }
 
-                w->color_ = x->parent_->color_;
-                x->parent_->color_ = RBCOLOR_BLACK;
-                w->left_->color_ = RBCOLOR_BLACK;
-                __rbtree_right_rotate(self, x->parent_);
+                __rbnode_set_color(w, rbnode_color(rbnode_parent(x)));
+                __rbnode_set_color(rbnode_parent(x), RBCOLOR_BLACK);
+                __rbnode_set_color(w->left_, RBCOLOR_BLACK);
+                __rbtree_right_rotate(self, rbnode_parent(x));
                 x = self->root_;
             }
         }
     }
 
-    x->color_ = RBCOLOR_BLACK;
+    __rbnode_set_color(x, RBCOLOR_BLACK);
 }
 
 static inline struct rbnode *rbtree_find(const struct rbtree *self,
@@ -399,9 +849,14 @@ static inline struct rbnode *rbtree_find(const struct rbtree *self,
 {
     const struct rbnode *const NIL = rbtree_nil(self);
     struct rbnode *x = self->root_;
+    uint64_t key = __rbtree_key(self, ke);
+
+    __RBTREE_STATS(self, nr_finds_, 1);
 
     while (x != NIL) {
-        int diff = self->compar_(ke, x->entry_);
+        int diff = __rbtree_compar(self, key, ke, x);
+
+        __RBTREE_STATS(self, nr_find_compars_, 1);
 
         if (diff == 0) {
             return x;
@@ -415,56 +870,111 @@ static inline struct rbnode *rbtree_find(const struct rbtree *self,
     return (struct rbnode *)NIL;
 }
 
+/*
+ * Whether 'z' is a node of the tree, looked up as a find would, but left out
+ * of the statistics.
+ */
+static inline bool __rbtree_has(const struct rbtree *self,
+                                const struct rbnode *z)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+    const struct rbnode *x = self->root_;
+    uint64_t key = __rbtree_key(self, z->entry_);
+
+    while (x != NIL) {
+        int diff = __rbtree_compar(self, key, z->entry_, x);
+
+        if (diff == 0) {
+            return x == z;
+        } else if (diff < 0) {
+            x = x->left_;
+        } else {
+            x = x->right_;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Unlinks 'z', which must be a node of the tree. 'z' is trusted as is when
+ * NDEBUG is defined, and looked up to check it otherwise.
+ */
 static inline void *rbtree_erase(struct rbtree *self, struct rbnode *z)
 {
     const struct rbnode *const NIL = rbtree_nil(self);
-    struct rbnode *x = rbtree_find(self, z->entry_);
+    struct rbnode *x;
     struct rbnode *y;
     enum rbcolor y_original_color;
     void *e;
 
-    if ((x == NIL) || (x != z)) {
+    if (z == NIL) {
         return NULL;
     }
 
+#ifndef NDEBUG
+    if (!__rbtree_has(self, z)) {
+        return NULL;
+    }
+#endif /* NDEBUG */
+
     e = z->entry_;
     y = z;
-    y_original_color = y->color_;
+    y_original_color = rbnode_color(y);
+
+    if ((z->left_ == NIL) || (z->right_ == NIL)) {
+        __rbnode_shrink(self, rbnode_parent(z));
+    }
 
     if (z->left_ == NIL) {
         x = z->right_;
         __rbtree_transplant(self, z, z->right_);
+        __rbtree_propagate(self, rbnode_parent(z), NIL);
     } else if (z->right_ == NIL) {
         x = z->left_;
         __rbtree_transplant(self, z, z->left_);
+        __rbtree_propagate(self, rbnode_parent(z), NIL);
     } else {
+        struct rbnode *p;
+
         y = z->right_;
 
         while (y->left_ != NIL) {
             y = y->left_;
         }
 
-        y_original_color = y->color_;
+        __rbnode_shrink(self, rbnode_parent(y));
+        y_original_color = rbnode_color(y);
         x = y->right_;
+        p = rbnode_parent(y) == z ? y : rbnode_parent(y);
 
-        if (y->parent_ == z) {
-            x->parent_ = y;
+        if (rbnode_parent(y) == z) {
+            __rbnode_set_parent(x, y);
         } else {
             __rbtree_transplant(self, y, y->right_);
-            y->right_ = z->right_;
-            y->right_->parent_ = y;
+            WRITE_ONCE(y->right_, z->right_);
+            __rbnode_set_parent(y->right_, y);
         }
 
         __rbtree_transplant(self, z, y);
-        y->left_ = z->left_;
-        y->left_->parent_ = y;
-        y->color_ = z->color_;
+        WRITE_ONCE(y->left_, z->left_);
+        __rbnode_set_parent(y->left_, y);
+        __rbnode_set_color(y, rbnode_color(z));
+        y->count_ = z->count_;
+
+        if (self->augment_ != NULL) {
+            self->augment_->copy(z, y);
+        }
+
+        __rbtree_propagate(self, p, y);
+        __rbtree_propagate(self, y, NIL);
     }
 
     if (y_original_color == RBCOLOR_BLACK) {
         __rbtree_delete_fixup(self, x);
     }
 
+    __RBTREE_STATS(self, nr_erases_, 1);
     self->size_--;
 
     return e;
@@ -482,13 +992,43 @@ static inline void *rbtree_pop_back(struct rbtree *self)
 
 static inline void *rbtree_at(struct rbtree *self, size_t n)
 {
-    struct rbnode *x;
+    const struct rbnode *const NIL = rbtree_nil(self);
+    struct rbnode *x = self->root_;
+
+    while (x != NIL) {
+        size_t nr_left = x->left_->count_;
 
-    for (x = rbtree_begin(self); n != 0 && x != rbtree_end(self); --n) {
-        x = rbtree_next(self, x);
+        if (n == nr_left) {
+            return x->entry_;
+        } else if (n < nr_left) {
+            x = x->left_;
+        } else {
+            n -= nr_left + 1;
+            x = x->right_;
+        }
     }
 
-    return x == rbtree_end(self) ? NULL : x->entry_;
+    return NULL;
+}
+
+/* Number of entries less than 'ke', i.e. the position of its lower bound. */
+static inline size_t rbtree_rank(const struct rbtree *self, const void *ke)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+    struct rbnode *x = self->root_;
+    uint64_t key = __rbtree_key(self, ke);
+    size_t rank = 0;
+
+    while (x != NIL) {
+        if (__rbtree_compar(self, key, ke, x) <= 0) {
+            x = x->left_;
+        } else {
+            rank += x->left_->count_ + 1;
+            x = x->right_;
+        }
+    }
+
+    return rank;
 }
 
 static inline struct rbnode *rbtree_lower_bound(const struct rbtree *self,
@@ -497,9 +1037,14 @@ static inline struct rbnode *rbtree_lower_bound(const struct rbtree *self,
     const struct rbnode *const NIL = rbtree_nil(self);
     struct rbnode *x = self->root_;
     struct rbnode *result = (struct rbnode *)NIL;
+    uint64_t key = __rbtree_key(self, ke);
+
+    __RBTREE_STATS(self, nr_finds_, 1);
 
     while (x != NIL) {
-        int diff = self->compar_(ke, x->entry_);
+        int diff = __rbtree_compar(self, key, ke, x);
+
+        __RBTREE_STATS(self, nr_find_compars_, 1);
 
         if (diff <= 0) {
             result = x;
@@ -518,9 +1063,14 @@ static inline struct rbnode *rbtree_upper_bound(const struct rbtree *self,
     const struct rbnode *const NIL = rbtree_nil(self);
     struct rbnode *x = self->root_;
     struct rbnode *result = (struct rbnode *)NIL;
+    uint64_t key = __rbtree_key(self, ke);
+
+    __RBTREE_STATS(self, nr_finds_, 1);
 
     while (x != NIL) {
-        int diff = self->compar_(ke, x->entry_);
+        int diff = __rbtree_compar(self, key, ke, x);
+
+        __RBTREE_STATS(self, nr_find_compars_, 1);
 
         if (diff < 0) {
             result = x;
@@ -533,6 +1083,535 @@ static inline struct rbnode *rbtree_upper_bound(const struct rbtree *self,
     return result;
 }
 
+/*
+ * Calls 'fn' on the entries from 'lo' included to 'hi' excluded, in order,
+ * and returns their number. Both ends are looked up once, so the walk in
+ * between calls compar no more. 'fn' must not change the tree.
+ */
+static inline size_t rbtree_for_each_range(const struct rbtree *self,
+                                           const void *lo, const void *hi,
+                                           void (*fn)(void *e, void *arg),
+                                           void *arg)
+{
+    struct rbnode *x, *end;
+    size_t n = 0;
+
+    if (self->compar_(lo, hi) >= 0) {
+        return 0;
+    }
+
+    end = rbtree_lower_bound(self, hi);
+
+    for (x = rbtree_lower_bound(self, lo); x != end;
+         x = rbtree_next(self, x)) {
+        fn(x->entry_, arg);
+        n++;
+    }
+
+    return n;
+}
+
+/* Number of entries from 'lo' included to 'hi' excluded. O(log(n)). */
+static inline size_t rbtree_count_range(const struct rbtree *self,
+                                        const void *lo, const void *hi)
+{
+    if (self->compar_(lo, hi) >= 0) {
+        return 0;
+    }
+
+    return rbtree_rank(self, hi) - rbtree_rank(self, lo);
+}
+
+/*
+ * Join-based operations, after G. E. Blelloch, D. Ferizovic, Y. Sun,
+ * "Just Join for Parallel Ordered Sets", SPAA 2016. The helpers work on
+ * detached subtrees along with their black height 'bh', the number of black
+ * nodes from the subtree root down to NIL, NIL excluded. The parent_ of the
+ * subtree they return is stale and set by the caller. NIL is never written,
+ * so disjoint subtrees of a tree may be worked on from several threads.
+ * Each tree has its own NIL, so the nodes moved from a tree to another are
+ * relinked to the NIL of the destination, at O(1) per node. Union,
+ * intersection and difference, which may fork threads, are in rbtree_set.h.
+ */
+static inline bool __rbnode_is_red(const struct rbnode *x)
+{
+    return rbnode_color(x) == RBCOLOR_RED;
+}
+
+/* Recomputes 'x' alone : its parent_ may be stale, even 'x' itself. */
+static inline void __rbtree_join_update(const struct rbtree *self,
+                                        struct rbnode *x)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+    struct rbnode *parent = rbnode_parent(x);
+
+    __rbnode_update(x);
+
+    if (self->augment_ != NULL) {
+        __rbnode_set_parent(x, (struct rbnode *)NIL);
+        self->augment_->propagate(x, (struct rbnode *)NIL);
+        __rbnode_set_parent(x, parent);
+    }
+}
+
+static inline void __rbtree_join_link(const struct rbtree *self,
+                                      struct rbnode *l, struct rbnode *k,
+                                      struct rbnode *r)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+
+    k->left_ = l;
+    k->right_ = r;
+
+    if (l != NIL) {
+        __rbnode_set_parent(l, k);
+    }
+
+    if (r != NIL) {
+        __rbnode_set_parent(r, k);
+    }
+
+    __rbtree_join_update(self, k);
+}
+
+static inline struct rbnode *__rbtree_join_rotate(const struct rbtree *self,
+                                                  struct rbnode *x, bool left)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+    struct rbnode *y = left ? x->right_ : x->left_;
+    struct rbnode *t = left ? y->left_ : y->right_;
+
+    if (left) {
+        x->right_ = t;
+        y->left_ = x;
+    } else {
+        x->left_ = t;
+        y->right_ = x;
+    }
+
+    if (t != NIL) {
+        __rbnode_set_parent(t, x);
+    }
+
+    __rbnode_set_parent(y, rbnode_parent(x));
+    __rbnode_set_parent(x, y);
+
+    __rbtree_join_update(self, x);
+    __rbtree_join_update(self, y);
+
+    return y;
+}
+
+/* bh(l) > bh(r) : walks down the right spine of 'l'. */
+static struct rbnode *__rbtree_join_right(const struct rbtree *self,
+                                          struct rbnode *l, size_t bhl,
+                                          struct rbnode *k, struct rbnode *r,
+                                          size_t bhr)
+{
+    if (!__rbnode_is_red(l) && (bhl == bhr)) {
+        __rbnode_set_color(k, RBCOLOR_RED);
+        __rbtree_join_link(self, l, k, r);
+        return k;
+    }
+
+    struct rbnode *t = __rbtree_join_right(self, l->right_,
+                                           bhl - !__rbnode_is_red(l), k, r,
+                                           bhr);
+
+    l->right_ = t;
+    __rbnode_set_parent(t, l);
+
+    if (!__rbnode_is_red(l) && __rbnode_is_red(t) &&
+        __rbnode_is_red(t->right_)) {
+        __rbnode_set_color(t->right_, RBCOLOR_BLACK);
+        return __rbtree_join_rotate(self, l, true);
+    }
+
+    __rbtree_join_update(self, l);
+
+    return l;
+}
+
+/* bh(l) < bh(r) : walks down the left spine of 'r'. */
+static struct rbnode *__rbtree_join_left(const struct rbtree *self,
+                                         struct rbnode *l, size_t bhl,
+                                         struct rbnode *k, struct rbnode *r,
+                                         size_t bhr)
+{
+    if (!__rbnode_is_red(r) && (bhl == bhr)) {
+        __rbnode_set_color(k, RBCOLOR_RED);
+        __rbtree_join_link(self, l, k, r);
+        return k;
+    }
+
+    struct rbnode *t = __rbtree_join_left(self, l, bhl, k, r->left_,
+                                          bhr - !__rbnode_is_red(r));
+
+    r->left_ = t;
+    __rbnode_set_parent(t, r);
+
+    if (!__rbnode_is_red(r) && __rbnode_is_red(t) &&
+        __rbnode_is_red(t->left_)) {
+        __rbnode_set_color(t->left_, RBCOLOR_BLACK);
+        return __rbtree_join_rotate(self, r, false);
+    }
+
+    __rbtree_join_update(self, r);
+
+    return r;
+}
+
+/* All entries of 'l' < k->entry_ < all entries of 'r'. */
+static inline struct rbnode *__rbtree_join(const struct rbtree *self,
+                                           struct rbnode *l, size_t bhl,
+                                           struct rbnode *k, struct rbnode *r,
+                                           size_t bhr, size_t *bh)
+{
+    struct rbnode *t;
+
+    if (bhl > bhr) {
+        t = __rbtree_join_right(self, l, bhl, k, r, bhr);
+        *bh = bhl;
+
+        if (__rbnode_is_red(t) && __rbnode_is_red(t->right_)) {
+            __rbnode_set_color(t, RBCOLOR_BLACK);
+            (*bh)++;
+        }
+
+        return t;
+    }
+
+    if (bhl < bhr) {
+        t = __rbtree_join_left(self, l, bhl, k, r, bhr);
+        *bh = bhr;
+
+        if (__rbnode_is_red(t) && __rbnode_is_red(t->left_)) {
+            __rbnode_set_color(t, RBCOLOR_BLACK);
+            (*bh)++;
+        }
+
+        return t;
+    }
+
+    if (!__rbnode_is_red(l) && !__rbnode_is_red(r)) {
+        __rbnode_set_color(k, RBCOLOR_RED);
+        *bh = bhl;
+    } else {
+        __rbnode_set_color(k, RBCOLOR_BLACK);
+        *bh = bhl + 1;
+    }
+
+    __rbtree_join_link(self, l, k, r);
+
+    return k;
+}
+
+/* Detaches the last node of 'x' into 'last' and returns the rest. */
+static struct rbnode *__rbtree_split_last(const struct rbtree *self,
+                                          struct rbnode *x, size_t bh,
+                                          struct rbnode **last,
+                                          size_t *bh_rest)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+    size_t bhc = bh - !__rbnode_is_red(x);
+    size_t bht;
+
+    if (x->right_ == NIL) {
+        *last = x;
+        *bh_rest = bhc;
+        return x->left_;
+    }
+
+    struct rbnode *t = __rbtree_split_last(self, x->right_, bhc, last, &bht);
+
+    return __rbtree_join(self, x->left_, bhc, x, t, bht, bh_rest);
+}
+
+static inline struct rbnode *__rbtree_join2(const struct rbtree *self,
+                                            struct rbnode *l, size_t bhl,
+                                            struct rbnode *r, size_t bhr,
+                                            size_t *bh)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+    struct rbnode *k;
+
+    if (l == NIL) {
+        *bh = bhr;
+        return r;
+    }
+
+    if (r == NIL) {
+        *bh = bhl;
+        return l;
+    }
+
+    l = __rbtree_split_last(self, l, bhl, &k, &bhl);
+
+    return __rbtree_join(self, l, bhl, k, r, bhr, bh);
+}
+
+/*
+ * Splits 'x' into the entries less than 'ke' and the ones greater than 'ke',
+ * whose key is 'key'. Returns the node matching 'ke', detached from both, or
+ * NULL.
+ */
+static struct rbnode *__rbtree_split(const struct rbtree *self,
+                                     struct rbnode *x, size_t bh,
+                                     uint64_t key, const void *ke,
+                                     struct rbnode **l, size_t *bhl,
+                                     struct rbnode **r, size_t *bhr)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+    struct rbnode *m, *t;
+    size_t bhc, bht;
+
+    if (x == NIL) {
+        *l = *r = (struct rbnode *)NIL;
+        *bhl = *bhr = 0;
+        return NULL;
+    }
+
+    int diff = __rbtree_compar(self, key, ke, x);
+
+    bhc = bh - !__rbnode_is_red(x);
+
+    if (diff == 0) {
+        *l = x->left_;
+        *r = x->right_;
+        *bhl = *bhr = bhc;
+        return x;
+    } else if (diff < 0) {
+        m = __rbtree_split(self, x->left_, bhc, key, ke, l, bhl, &t, &bht);
+        *r = __rbtree_join(self, t, bht, x, x->right_, bhc, bhr);
+    } else {
+        m = __rbtree_split(self, x->right_, bhc, key, ke, &t, &bht, r, bhr);
+        *l = __rbtree_join(self, x->left_, bhc, x, t, bht, bhl);
+    }
+
+    return m;
+}
+
+static inline size_t __rbtree_black_height(const struct rbtree *self)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+    size_t bh = 0;
+
+    for (const struct rbnode *x = self->root_; x != NIL; x = x->left_) {
+        bh += !__rbnode_is_red(x);
+    }
+
+    return bh;
+}
+
+/* Points the NIL leaves of 'x' from 'from' to 'to'. O(size of 'x'). */
+static void __rbtree_relink(struct rbnode *x, const struct rbnode *from,
+                            const struct rbnode *to)
+{
+    if (x == from) {
+        return;
+    }
+
+    if (x->left_ == from) {
+        x->left_ = (struct rbnode *)to;
+    } else {
+        __rbtree_relink(x->left_, from, to);
+    }
+
+    if (x->right_ == from) {
+        x->right_ = (struct rbnode *)to;
+    } else {
+        __rbtree_relink(x->right_, from, to);
+    }
+}
+
+/* 'x' is a subtree linked to the NIL of 'from'. */
+static inline void __rbtree_set_root(struct rbtree *self, struct rbnode *x,
+                                     const struct rbtree *from)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+
+    if (x == rbtree_nil(from)) {
+        x = (struct rbnode *)NIL;
+    } else {
+        if (from != self) {
+            __rbtree_relink(x, rbtree_nil(from), NIL);
+        }
+
+        __rbnode_set_parent_color(x, (struct rbnode *)NIL, RBCOLOR_BLACK);
+    }
+
+    self->root_ = x;
+    self->size_ = x->count_;
+}
+
+/*
+ * Appends 'z' holding 'e', then the entries of 'other' which is left empty.
+ * The entries of the tree must be less than 'e', and 'e' less than the ones
+ * of 'other'. O(log(n) + m) where m is the size of 'other'.
+ */
+static inline void rbtree_join(struct rbtree *self, struct rbnode *z, void *e,
+                               struct rbtree *other)
+{
+    size_t bh1 = __rbtree_black_height(self);
+    size_t bh2 = __rbtree_black_height(other);
+    struct rbnode *r = other->root_;
+    size_t bh;
+
+    if (r != rbtree_nil(other)) {
+        __rbtree_relink(r, rbtree_nil(other), rbtree_nil(self));
+    } else {
+        r = (struct rbnode *)rbtree_nil(self);
+    }
+
+    __rbnode_set_entry(self, z, e);
+    __rbnode_set_parent_color(z, (struct rbnode *)rbtree_nil(self),
+                              RBCOLOR_BLACK);
+    __rbtree_set_root(self, __rbtree_join(self, self->root_, bh1, z, r, bh2,
+                                          &bh),
+                      self);
+    rbtree_clear(other);
+}
+
+/* Same as rbtree_join() without a middle entry. */
+static inline void rbtree_concat(struct rbtree *self, struct rbtree *other)
+{
+    size_t bh1 = __rbtree_black_height(self);
+    size_t bh2 = __rbtree_black_height(other);
+    struct rbnode *r = other->root_;
+    size_t bh;
+
+    if (r != rbtree_nil(other)) {
+        __rbtree_relink(r, rbtree_nil(other), rbtree_nil(self));
+    } else {
+        r = (struct rbnode *)rbtree_nil(self);
+    }
+
+    __rbtree_set_root(self,
+                      __rbtree_join2(self, self->root_, bh1, r, bh2, &bh),
+                      self);
+    rbtree_clear(other);
+}
+
+/*
+ * Keeps the entries less than 'ke' and moves the ones greater than 'ke' into
+ * 'right', whose content is replaced. The node matching 'ke' is removed and
+ * returned, or NULL if there is none. O(log(n) + m) where m is the number of
+ * entries moved.
+ */
+static inline struct rbnode *rbtree_split(struct rbtree *self, const void *ke,
+                                          struct rbtree *right)
+{
+    struct rbnode *l, *r, *m;
+    size_t bhl, bhr;
+
+    m = __rbtree_split(self, self->root_, __rbtree_black_height(self),
+                       __rbtree_key(self, ke), ke, &l, &bhl, &r, &bhr);
+    __rbtree_set_root(self, l, self);
+    __rbtree_set_root(right, r, self);
+
+    return m;
+}
+
+/*
+ * Moves the entries from 'lo' included to 'hi' excluded into 'out', whose
+ * content is replaced, and returns their number. The range is cut out with
+ * two splits and the rest joined back, O(log(n) + k) where k is the number of
+ * entries moved, instead of k erases each with its own rebalancing.
+ */
+static inline size_t rbtree_erase_range(struct rbtree *self, const void *lo,
+                                        const void *hi, struct rbtree *out)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+    struct rbnode *l, *m, *r, *first, *last;
+    size_t bhl, bhm, bhr, bh;
+
+    if (self->compar_(lo, hi) >= 0) {
+        __rbtree_set_root(out, (struct rbnode *)NIL, self);
+        return 0;
+    }
+
+    first = __rbtree_split(self, self->root_, __rbtree_black_height(self),
+                           __rbtree_key(self, lo), lo, &l, &bhl, &m, &bhm);
+    last = __rbtree_split(self, m, bhm, __rbtree_key(self, hi), hi, &m, &bhm,
+                          &r, &bhr);
+
+    /* The nodes matching 'lo' and 'hi' go back to their side. */
+    if (first != NULL) {
+        m = __rbtree_join(self, (struct rbnode *)NIL, 0, first, m, bhm, &bhm);
+    }
+
+    if (last != NULL) {
+        r = __rbtree_join(self, (struct rbnode *)NIL, 0, last, r, bhr, &bhr);
+    }
+
+    __rbtree_set_root(self, __rbtree_join2(self, l, bhl, r, bhr, &bh), self);
+    __rbtree_set_root(out, m, self);
+
+    return out->size_;
+}
+
+#ifdef RBTREE_STATS
+static inline const struct tree_stats *rbtree_stats(const struct rbtree *self)
+{
+    return &self->stats_;
+}
+
+static inline void rbtree_stats_reset(struct rbtree *self)
+{
+    tree_stats_reset(&self->stats_);
+}
+#endif /* RBTREE_STATS */
+
+/*
+ * Counts the nodes at each depth in hist[], the root at depth 0 and the ones
+ * at depth 'nr' - 1 or deeper in hist[nr - 1], and returns the height, 0 if
+ * the tree is empty. 'nr' must not be 0. O(n), without recursion.
+ */
+static inline size_t rbtree_depth_histogram(const struct rbtree *self,
+                                            size_t hist[], size_t nr)
+{
+    const struct rbnode *const NIL = rbtree_nil(self);
+    const struct rbnode *x = self->root_;
+    size_t depth = 0, height = 0;
+
+    for (size_t i = 0; i < nr; i++) {
+        hist[i] = 0;
+    }
+
+    if (x == NIL) {
+        return 0;
+    }
+
+    for (; x->left_ != NIL; x = x->left_) {
+        depth++;
+    }
+
+    while (x != NIL) {
+        const struct rbnode *parent;
+
+        hist[depth < nr ? depth : nr - 1]++;
+        height = depth + 1 > height ? depth + 1 : height;
+
+        if (x->right_ != NIL) {
+            for (x = x->right_, depth++; x->left_ != NIL; x = x->left_) {
+                depth++;
+            }
+
+            continue;
+        }
+
+        while (((parent = rbnode_parent(x)) != NIL) && x == parent->right_) {
+            x = parent;
+            depth--;
+        }
+
+        x = parent;
+        depth--;
+    }
+
+    return height;
+}
+
 static inline bool __rbtree_validate_node(const struct rbtree *self,
                                           const struct rbnode *x,
                                           size_t nr_black_expected,
@@ -547,9 +1626,14 @@ static inline bool __rbtree_validate_node(const struct rbtree *self,
     const struct rbnode *left = x->left_;
     const struct rbnode *right = x->right_;
 
-    if (x->color_ == RBCOLOR_RED) {
-        if (((left != NIL) && (left->color_ == RBCOLOR_RED)) ||
-            ((right != NIL) && (right->color_ == RBCOLOR_RED))) {
+    if ((x->count_ != left->count_ + right->count_ + 1) ||
+        (__rbnode_key(x) != __rbtree_key(self, x->entry_))) {
+        return false;
+    }
+
+    if (rbnode_color(x) == RBCOLOR_RED) {
+        if (((left != NIL) && (rbnode_color(left) == RBCOLOR_RED)) ||
+            ((right != NIL) && (rbnode_color(right) == RBCOLOR_RED))) {
             return false;
         }
     } else {
@@ -570,7 +1654,7 @@ static inline bool rbtree_validate(const struct rbtree *self)
         return true;
     }
 
-    if (self->root_->color_ != RBCOLOR_BLACK) {
+    if (rbnode_color(self->root_) != RBCOLOR_BLACK) {
         return false;
     }
 
@@ -578,7 +1662,7 @@ static inline bool rbtree_validate(const struct rbtree *self)
     size_t nr_black_expected = 0;
 
     while (x != NIL) {
-        if (x->color_ == RBCOLOR_BLACK) {
+        if (rbnode_color(x) == RBCOLOR_BLACK) {
             nr_black_expected++;
         }
 
@@ -0,0 +1,596 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ */
+
+/* Index-based Red-Black Tree (32-bit links into a record pool) */
+#ifndef __RCN_C_RBTREE_IDX_H__
+#define __RCN_C_RBTREE_IDX_H__
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/*
+ * The nodes are embedded in the records of a pool - an array of 'stride_'
+ * bytes records - and link to each other by record index instead of by
+ * address. A node is 12 bytes, and a tree holds no pointer at all : the pool
+ * together with its 'rbidx_root' may be copied, moved, put in shared memory
+ * or in an mmap'd file, and reattached with rbidx_init() at another address.
+ *
+ * Record 0 is reserved : its node is the NIL sentinel, and index 0 stands
+ * for "no node". At most 2^31 - 1 records may be linked.
+ */
+struct rbidx_node {
+    uint32_t parent_color_;
+    uint32_t left_;
+    uint32_t right_;
+};
+
+/* The persistent part of a tree, meant to live next to the pool. */
+struct rbidx_root {
+    uint32_t root_;
+    uint32_t size_;
+};
+
+struct rbidx {
+    struct rbidx_root *root_;
+    char *base_;
+    size_t stride_;
+    size_t offset_;
+    int (*compar_)(const void *ke, const void *in_tree);
+};
+
+#define RBIDX_NIL 0
+
+/* Same encoding as rbtree.h, kept apart so this header stands alone. */
+enum rbidx_color {
+    RBIDX_RED = 0,
+    RBIDX_BLACK,
+};
+
+/*
+ * Attaches a handle to the tree 'root' over the pool at 'base', whose
+ * records are 'stride' bytes with their rbidx_node at 'offset'. The tree is
+ * left as is : a new one must be set up with rbidx_clear().
+ */
+static inline void rbidx_init(struct rbidx *self, struct rbidx_root *root,
+                              void *base, size_t stride, size_t offset,
+                              int (*compar)(const void *ke,
+                                            const void *in_tree))
+{
+    self->root_ = root;
+    self->base_ = (char *)base;
+    self->stride_ = stride;
+    self->offset_ = offset;
+    self->compar_ = compar;
+}
+
+static inline void *rbidx_entry(const struct rbidx *self, uint32_t i)
+{
+    return self->base_ + (size_t)i * self->stride_;
+}
+
+static inline struct rbidx_node *__rbidx_node(const struct rbidx *self,
+                                              uint32_t i)
+{
+    return (struct rbidx_node *)(self->base_ + (size_t)i * self->stride_ +
+                                 self->offset_);
+}
+
+static inline uint32_t __rbidx_parent(const struct rbidx *self, uint32_t i)
+{
+    return __rbidx_node(self, i)->parent_color_ >> 1;
+}
+
+static inline uint32_t __rbidx_left(const struct rbidx *self, uint32_t i)
+{
+    return __rbidx_node(self, i)->left_;
+}
+
+static inline uint32_t __rbidx_right(const struct rbidx *self, uint32_t i)
+{
+    return __rbidx_node(self, i)->right_;
+}
+
+static inline enum rbidx_color __rbidx_color(const struct rbidx *self,
+                                             uint32_t i)
+{
+    return (enum rbidx_color)(__rbidx_node(self, i)->parent_color_ & 1);
+}
+
+static inline void __rbidx_set_parent(const struct rbidx *self, uint32_t i,
+                                      uint32_t p)
+{
+    struct rbidx_node *x = __rbidx_node(self, i);
+
+    x->parent_color_ = (p << 1) | (x->parent_color_ & 1);
+}
+
+static inline void __rbidx_set_color(const struct rbidx *self, uint32_t i,
+                                     enum rbidx_color color)
+{
+    struct rbidx_node *x = __rbidx_node(self, i);
+
+    x->parent_color_ = (x->parent_color_ & ~(uint32_t)1) | color;
+}
+
+static inline void rbidx_clear(struct rbidx *self)
+{
+    struct rbidx_node *nil = __rbidx_node(self, RBIDX_NIL);
+
+    self->root_->root_ = RBIDX_NIL;
+    self->root_->size_ = 0;
+
+    nil->parent_color_ = (RBIDX_NIL << 1) | RBIDX_BLACK;
+    nil->left_ = nil->right_ = RBIDX_NIL;
+}
+
+static inline bool rbidx_empty(const struct rbidx *self)
+{
+    return self->root_->root_ == RBIDX_NIL;
+}
+
+static inline size_t rbidx_size(const struct rbidx *self)
+{
+    return self->root_->size_;
+}
+
+static inline uint32_t __rbidx_minimum(const struct rbidx *self, uint32_t x)
+{
+    while (__rbidx_left(self, x) != RBIDX_NIL) {
+        x = __rbidx_left(self, x);
+    }
+
+    return x;
+}
+
+static inline uint32_t __rbidx_maximum(const struct rbidx *self, uint32_t x)
+{
+    while (__rbidx_right(self, x) != RBIDX_NIL) {
+        x = __rbidx_right(self, x);
+    }
+
+    return x;
+}
+
+static inline uint32_t rbidx_begin(const struct rbidx *self)
+{
+    return rbidx_empty(self) ? RBIDX_NIL :
+                               __rbidx_minimum(self, self->root_->root_);
+}
+
+static inline uint32_t rbidx_rbegin(const struct rbidx *self)
+{
+    return rbidx_empty(self) ? RBIDX_NIL :
+                               __rbidx_maximum(self, self->root_->root_);
+}
+
+static inline uint32_t rbidx_end(const struct rbidx *self)
+{
+    return RBIDX_NIL;
+}
+
+static inline uint32_t rbidx_next(const struct rbidx *self, uint32_t x)
+{
+    uint32_t parent;
+
+    if (__rbidx_right(self, x) != RBIDX_NIL) {
+        return __rbidx_minimum(self, __rbidx_right(self, x));
+    }
+
+    while (((parent = __rbidx_parent(self, x)) != RBIDX_NIL) &&
+           (x == __rbidx_right(self, parent))) {
+        x = parent;
+    }
+
+    return parent;
+}
+
+static inline uint32_t rbidx_prev(const struct rbidx *self, uint32_t x)
+{
+    uint32_t parent;
+
+    if (__rbidx_left(self, x) != RBIDX_NIL) {
+        return __rbidx_maximum(self, __rbidx_left(self, x));
+    }
+
+    while (((parent = __rbidx_parent(self, x)) != RBIDX_NIL) &&
+           (x == __rbidx_left(self, parent))) {
+        x = parent;
+    }
+
+    return parent;
+}
+
+/* Index of the record equal to 'ke', or RBIDX_NIL. */
+static inline uint32_t rbidx_find(const struct rbidx *self, const void *ke)
+{
+    uint32_t x = self->root_->root_;
+
+    while (x != RBIDX_NIL) {
+        int diff = self->compar_(ke, rbidx_entry(self, x));
+
+        if (diff == 0) {
+            break;
+        }
+
+        x = diff < 0 ? __rbidx_left(self, x) : __rbidx_right(self, x);
+    }
+
+    return x;
+}
+
+/* Index of the first record not less than 'ke', or RBIDX_NIL. */
+static inline uint32_t rbidx_lower_bound(const struct rbidx *self,
+                                         const void *ke)
+{
+    uint32_t x = self->root_->root_;
+    uint32_t found = RBIDX_NIL;
+
+    while (x != RBIDX_NIL) {
+        int diff = self->compar_(ke, rbidx_entry(self, x));
+
+        if (diff == 0) {
+            return x;
+        } else if (diff < 0) {
+            found = x;
+            x = __rbidx_left(self, x);
+        } else {
+            x = __rbidx_right(self, x);
+        }
+    }
+
+    return found;
+}
+
+/* Puts 'v' in the place of 'u' under the parent of 'u'. */
+static inline void __rbidx_replace_child(struct rbidx *self, uint32_t u,
+                                         uint32_t v)
+{
+    uint32_t parent = __rbidx_parent(self, u);
+
+    if (parent == RBIDX_NIL) {
+        self->root_->root_ = v;
+    } else if (u == __rbidx_left(self, parent)) {
+        __rbidx_node(self, parent)->left_ = v;
+    } else {
+        __rbidx_node(self, parent)->right_ = v;
+    }
+
+    __rbidx_set_parent(self, v, parent);
+}
+
+static inline void __rbidx_left_rotate(struct rbidx *self, uint32_t x)
+{
+    uint32_t y = __rbidx_right(self, x);
+    uint32_t t = __rbidx_left(self, y);
+
+    __rbidx_node(self, x)->right_ = t;
+
+    if (t != RBIDX_NIL) {
+        __rbidx_set_parent(self, t, x);
+    }
+
+    __rbidx_replace_child(self, x, y);
+    __rbidx_node(self, y)->left_ = x;
+    __rbidx_set_parent(self, x, y);
+}
+
+static inline void __rbidx_right_rotate(struct rbidx *self, uint32_t x)
+{
+    uint32_t y = __rbidx_left(self, x);
+    uint32_t t = __rbidx_right(self, y);
+
+    __rbidx_node(self, x)->left_ = t;
+
+    if (t != RBIDX_NIL) {
+        __rbidx_set_parent(self, t, x);
+    }
+
+    __rbidx_replace_child(self, x, y);
+    __rbidx_node(self, y)->right_ = x;
+    __rbidx_set_parent(self, x, y);
+}
+
+static inline void __rbidx_insert_fixup(struct rbidx *self, uint32_t z)
+{
+    uint32_t p, g, y;
+
+    while (__rbidx_color(self, p = __rbidx_parent(self, z)) == RBIDX_RED) {
+        g = __rbidx_parent(self, p);
+
+        if (p == __rbidx_left(self, g)) {
+            y = __rbidx_right(self, g);
+
+            if (__rbidx_color(self, y) == RBIDX_RED) {
+                __rbidx_set_color(self, p, RBIDX_BLACK);
+                __rbidx_set_color(self, y, RBIDX_BLACK);
+                __rbidx_set_color(self, g, RBIDX_RED);
+                z = g;
+                continue;
+            }
+
+            if (z == __rbidx_right(self, p)) {
+                z = p;
+                __rbidx_left_rotate(self, z);
+                p = __rbidx_parent(self, z);
+            }
+
+            __rbidx_set_color(self, p, RBIDX_BLACK);
+            __rbidx_set_color(self, g, RBIDX_RED);
+            __rbidx_right_rotate(self, g);
+        } else {
+            y = __rbidx_left(self, g);
+
+            if (__rbidx_color(self, y) == RBIDX_RED) {
+                __rbidx_set_color(self, p, RBIDX_BLACK);
+                __rbidx_set_color(self, y, RBIDX_BLACK);
+                __rbidx_set_color(self, g, RBIDX_RED);
+                z = g;
+                continue;
+            }
+
+            if (z == __rbidx_left(self, p)) {
+                z = p;
+                __rbidx_right_rotate(self, z);
+                p = __rbidx_parent(self, z);
+            }
+
+            __rbidx_set_color(self, p, RBIDX_BLACK);
+            __rbidx_set_color(self, g, RBIDX_RED);
+            __rbidx_left_rotate(self, g);
+        }
+    }
+
+    __rbidx_set_color(self, self->root_->root_, RBIDX_BLACK);
+}
+
+/* Links the record 'z'. Returns -EEXIST if an equal record is linked. */
+static inline int rbidx_insert(struct rbidx *self, uint32_t z)
+{
+    void *e = rbidx_entry(self, z);
+    struct rbidx_node *n = __rbidx_node(self, z);
+    uint32_t x = self->root_->root_;
+    uint32_t y = RBIDX_NIL;
+    int diff = 0;
+
+    if (z == RBIDX_NIL) {
+        return -EINVAL;
+    }
+
+    while (x != RBIDX_NIL) {
+        diff = self->compar_(e, rbidx_entry(self, x));
+
+        if (diff == 0) {
+            return -EEXIST;
+        }
+
+        y = x;
+        x = diff < 0 ? __rbidx_left(self, x) : __rbidx_right(self, x);
+    }
+
+    n->parent_color_ = (y << 1) | RBIDX_RED;
+    n->left_ = n->right_ = RBIDX_NIL;
+
+    if (y == RBIDX_NIL) {
+        self->root_->root_ = z;
+    } else if (diff < 0) {
+        __rbidx_node(self, y)->left_ = z;
+    } else {
+        __rbidx_node(self, y)->right_ = z;
+    }
+
+    self->root_->size_++;
+    __rbidx_insert_fixup(self, z);
+
+    return 0;
+}
+
+static inline void __rbidx_erase_fixup(struct rbidx *self, uint32_t x)
+{
+    uint32_t p, w;
+
+    while ((x != self->root_->root_) &&
+           (__rbidx_color(self, x) == RBIDX_BLACK)) {
+        p = __rbidx_parent(self, x);
+
+        if (x == __rbidx_left(self, p)) {
+            w = __rbidx_right(self, p);
+
+            if (__rbidx_color(self, w) == RBIDX_RED) {
+                __rbidx_set_color(self, w, RBIDX_BLACK);
+                __rbidx_set_color(self, p, RBIDX_RED);
+                __rbidx_left_rotate(self, p);
+                w = __rbidx_right(self, p);
+            }
+
+            if ((__rbidx_color(self, __rbidx_left(self, w)) ==
+                 RBIDX_BLACK) &&
+                (__rbidx_color(self, __rbidx_right(self, w)) ==
+                 RBIDX_BLACK)) {
+                __rbidx_set_color(self, w, RBIDX_RED);
+                x = p;
+                continue;
+            }
+
+            if (__rbidx_color(self, __rbidx_right(self, w)) ==
+                RBIDX_BLACK) {
+                __rbidx_set_color(self, __rbidx_left(self, w), RBIDX_BLACK);
+                __rbidx_set_color(self, w, RBIDX_RED);
+                __rbidx_right_rotate(self, w);
+                w = __rbidx_right(self, p);
+            }
+
+            __rbidx_set_color(self, w, __rbidx_color(self, p));
+            __rbidx_set_color(self, p, RBIDX_BLACK);
+            __rbidx_set_color(self, __rbidx_right(self, w), RBIDX_BLACK);
+            __rbidx_left_rotate(self, p);
+        } else {
+            w = __rbidx_left(self, p);
+
+            if (__rbidx_color(self, w) == RBIDX_RED) {
+                __rbidx_set_color(self, w, RBIDX_BLACK);
+                __rbidx_set_color(self, p, RBIDX_RED);
+                __rbidx_right_rotate(self, p);
+                w = __rbidx_left(self, p);
+            }
+
+            if ((__rbidx_color(self, __rbidx_right(self, w)) ==
+                 RBIDX_BLACK) &&
+                (__rbidx_color(self, __rbidx_left(self, w)) ==
+                 RBIDX_BLACK)) {
+                __rbidx_set_color(self, w, RBIDX_RED);
+                x = p;
+                continue;
+            }
+
+            if (__rbidx_color(self, __rbidx_left(self, w)) ==
+                RBIDX_BLACK) {
+                __rbidx_set_color(self, __rbidx_right(self, w), RBIDX_BLACK);
+                __rbidx_set_color(self, w, RBIDX_RED);
+                __rbidx_left_rotate(self, w);
+                w = __rbidx_left(self, p);
+            }
+
+            __rbidx_set_color(self, w, __rbidx_color(self, p));
+            __rbidx_set_color(self, p, RBIDX_BLACK);
+            __rbidx_set_color(self, __rbidx_left(self, w), RBIDX_BLACK);
+            __rbidx_right_rotate(self, p);
+        }
+
+        x = self->root_->root_;
+    }
+
+    __rbidx_set_color(self, x, RBIDX_BLACK);
+}
+
+/*
+ * Unlinks the record 'z', which must be in the tree, and returns 0. 'z' is
+ * trusted as is when NDEBUG is defined, and looked up to check it otherwise :
+ * -ENOENT if it is not in the tree. RBIDX_NIL always gives -ENOENT.
+ */
+static inline int rbidx_erase(struct rbidx *self, uint32_t z)
+{
+    uint32_t x, y = z;
+    enum rbidx_color y_original_color;
+
+    if (z == RBIDX_NIL) {
+        return -ENOENT;
+    }
+
+#ifndef NDEBUG
+    if (rbidx_find(self, rbidx_entry(self, z)) != z) {
+        return -ENOENT;
+    }
+#endif /* NDEBUG */
+
+    y_original_color = __rbidx_color(self, y);
+
+    if (__rbidx_left(self, z) == RBIDX_NIL) {
+        x = __rbidx_right(self, z);
+        __rbidx_replace_child(self, z, x);
+    } else if (__rbidx_right(self, z) == RBIDX_NIL) {
+        x = __rbidx_left(self, z);
+        __rbidx_replace_child(self, z, x);
+    } else {
+        y = __rbidx_minimum(self, __rbidx_right(self, z));
+        y_original_color = __rbidx_color(self, y);
+        x = __rbidx_right(self, y);
+
+        if (__rbidx_parent(self, y) == z) {
+            __rbidx_set_parent(self, x, y);
+        } else {
+            __rbidx_replace_child(self, y, x);
+            __rbidx_node(self, y)->right_ = __rbidx_right(self, z);
+            __rbidx_set_parent(self, __rbidx_right(self, y), y);
+        }
+
+        __rbidx_replace_child(self, z, y);
+        __rbidx_node(self, y)->left_ = __rbidx_left(self, z);
+        __rbidx_set_parent(self, __rbidx_left(self, y), y);
+        __rbidx_set_color(self, y, __rbidx_color(self, z));
+    }
+
+    if (y_original_color == RBIDX_BLACK) {
+        __rbidx_erase_fixup(self, x);
+    }
+
+    self->root_->size_--;
+
+    return 0;
+}
+
+static ssize_t __rbidx_black_height(const struct rbidx *self, uint32_t x)
+{
+    uint32_t left, right;
+    ssize_t left_bh, right_bh;
+
+    if (x == RBIDX_NIL) {
+        return 1;
+    }
+
+    left = __rbidx_left(self, x);
+    right = __rbidx_right(self, x);
+
+    if (((left != RBIDX_NIL) && (__rbidx_parent(self, left) != x)) ||
+        ((right != RBIDX_NIL) && (__rbidx_parent(self, right) != x))) {
+        return -1;
+    }
+
+    if ((__rbidx_color(self, x) == RBIDX_RED) &&
+        ((__rbidx_color(self, left) == RBIDX_RED) ||
+         (__rbidx_color(self, right) == RBIDX_RED))) {
+        return -1;
+    }
+
+    left_bh = __rbidx_black_height(self, left);
+    right_bh = __rbidx_black_height(self, right);
+
+    if ((left_bh < 0) || (left_bh != right_bh)) {
+        return -1;
+    }
+
+    return left_bh + (__rbidx_color(self, x) == RBIDX_BLACK);
+}
+
+static inline bool rbidx_validate(const struct rbidx *self)
+{
+    uint32_t root = self->root_->root_;
+    size_t n = 0;
+
+    if ((__rbidx_color(self, RBIDX_NIL) != RBIDX_BLACK) ||
+        (__rbidx_color(self, root) != RBIDX_BLACK) ||
+        ((root != RBIDX_NIL) && (__rbidx_parent(self, root) != RBIDX_NIL))) {
+        return false;
+    }
+
+    if (__rbidx_black_height(self, root) < 0) {
+        return false;
+    }
+
+    for (uint32_t x = rbidx_begin(self), y; x != RBIDX_NIL; x = y, n++) {
+        y = rbidx_next(self, x);
+
+        if ((y != RBIDX_NIL) &&
+            (self->compar_(rbidx_entry(self, x), rbidx_entry(self, y)) >= 0)) {
+            return false;
+        }
+    }
+
+    return n == rbidx_size(self);
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_RBTREE_IDX_H__ */
@@ -0,0 +1,228 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ *
+ * Reference : linux/include/linux/rbtree_latch.h
+ */
+
+/* Latched Red-Black Tree (lock-free lookups, one writer at a time) */
+#ifndef __RCN_C_RBTREE_LATCH_H__
+#define __RCN_C_RBTREE_LATCH_H__
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "epoch.h"
+#include "rbtree.h"
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/*
+ * Every entry sits in two copies of the tree. The writer updates one copy
+ * while the readers are steered to the other by the latch sequence 'seq_',
+ * so a lookup never waits for the writer : it only retries if the copy it
+ * walked was changed under it.
+ *
+ * Lookups must be done between rbtree_latch_read_lock() and
+ * rbtree_latch_read_unlock(), and an erased node may only be reused or freed
+ * after rbtree_latch_synchronize() returned, once every reader that may
+ * still see it has left.
+ */
+struct rblatch_node {
+    struct rbnode node_[2];
+};
+
+struct rbtree_latch {
+    struct rbtree tree_[2];
+    size_t size_;
+    unsigned int seq_;
+    pthread_mutex_t lock_;
+    struct epoch epoch_;
+};
+
+static inline void rbtree_latch_init(struct rbtree_latch *self,
+                                     int (*compar)(const void *ke,
+                                                   const void *in_tree))
+{
+    rbtree_init(&self->tree_[0], compar);
+    rbtree_init(&self->tree_[1], compar);
+    self->size_ = 0;
+    self->seq_ = 0;
+    pthread_mutex_init(&self->lock_, NULL);
+    epoch_init(&self->epoch_);
+}
+
+static inline void rbtree_latch_destroy(struct rbtree_latch *self)
+{
+    epoch_destroy(&self->epoch_);
+    pthread_mutex_destroy(&self->lock_);
+}
+
+static inline size_t rbtree_latch_size(const struct rbtree_latch *self)
+{
+    return __atomic_load_n(&self->size_, __ATOMIC_RELAXED);
+}
+
+static inline bool rbtree_latch_empty(const struct rbtree_latch *self)
+{
+    return rbtree_latch_size(self) == 0;
+}
+
+/* Steers the readers to the other copy. */
+static inline void __rbtree_latch_flip(struct rbtree_latch *self)
+{
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&self->seq_, self->seq_ + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline int rbtree_latch_insert(struct rbtree_latch *self,
+                                      struct rblatch_node *z, void *e)
+{
+    int err;
+
+    pthread_mutex_lock(&self->lock_);
+
+    __rbtree_latch_flip(self);
+    err = rbtree_insert(&self->tree_[0], &z->node_[0], e);
+    __rbtree_latch_flip(self);
+
+    if (err == 0) {
+        rbtree_insert(&self->tree_[1], &z->node_[1], e);
+        __atomic_store_n(&self->size_, self->size_ + 1, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_unlock(&self->lock_);
+
+    return err;
+}
+
+/*
+ * Unlinks 'z' from both copies. Readers may still walk through it : see
+ * rbtree_latch_synchronize().
+ */
+static inline void *rbtree_latch_erase(struct rbtree_latch *self,
+                                       struct rblatch_node *z)
+{
+    void *e;
+
+    pthread_mutex_lock(&self->lock_);
+
+    __rbtree_latch_flip(self);
+    e = rbtree_erase(&self->tree_[0], &z->node_[0]);
+    __rbtree_latch_flip(self);
+
+    if (e != NULL) {
+        rbtree_erase(&self->tree_[1], &z->node_[1]);
+        __atomic_store_n(&self->size_, self->size_ - 1, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_unlock(&self->lock_);
+
+    return e;
+}
+
+/* Returns the token to pass to rbtree_latch_read_unlock(). */
+static inline unsigned int rbtree_latch_read_lock(struct rbtree_latch *self)
+{
+    return epoch_read_lock(&self->epoch_);
+}
+
+static inline void rbtree_latch_read_unlock(struct rbtree_latch *self,
+                                            unsigned int token)
+{
+    epoch_read_unlock(&self->epoch_, token);
+}
+
+/*
+ * Waits until every reader that may still see a node erased before the call
+ * has left.
+ */
+static inline void rbtree_latch_synchronize(struct rbtree_latch *self)
+{
+    epoch_synchronize(&self->epoch_);
+}
+
+/*
+ * A copy being changed may briefly look inconsistent : the walk is bounded
+ * by the deepest a red-black tree can be, and its result is only trusted if
+ * the copy was not touched meanwhile.
+ */
+#define __RBTREE_LATCH_MAX_DEPTH (2 * 8 * sizeof(size_t))
+
+static inline void *__rbtree_latch_walk(const struct rbtree *tree,
+                                        const void *ke, bool lower)
+{
+    const struct rbnode *const NIL = rbtree_nil(tree);
+    struct rbnode *x = __atomic_load_n(&tree->root_, __ATOMIC_ACQUIRE);
+    void *found = NULL;
+
+    for (size_t depth = 0;
+         (x != NIL) && (depth < __RBTREE_LATCH_MAX_DEPTH); depth++) {
+        void *e = x->entry_;
+        int diff = tree->compar_(ke, e);
+
+        if (diff == 0) {
+            return e;
+        } else if (diff < 0) {
+            found = lower ? e : found;
+            x = __atomic_load_n(&x->left_, __ATOMIC_ACQUIRE);
+        } else {
+            x = __atomic_load_n(&x->right_, __ATOMIC_ACQUIRE);
+        }
+    }
+
+    return found;
+}
+
+static inline void *__rbtree_latch_lookup(const struct rbtree_latch *self,
+                                          const void *ke, bool lower)
+{
+    unsigned int seq;
+    void *e;
+
+    do {
+        seq = __atomic_load_n(&self->seq_, __ATOMIC_ACQUIRE);
+        e = __rbtree_latch_walk(&self->tree_[seq & 1], ke, lower);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (__atomic_load_n(&self->seq_, __ATOMIC_RELAXED) != seq);
+
+    return e;
+}
+
+/* The entry equal to 'ke', or NULL. Must be called under the read lock. */
+static inline void *rbtree_latch_find(const struct rbtree_latch *self,
+                                      const void *ke)
+{
+    return __rbtree_latch_lookup(self, ke, false);
+}
+
+/*
+ * The first entry not less than 'ke', or NULL. Must be called under the read
+ * lock.
+ */
+static inline void *rbtree_latch_lower_bound(const struct rbtree_latch *self,
+                                             const void *ke)
+{
+    return __rbtree_latch_lookup(self, ke, true);
+}
+
+static inline bool rbtree_latch_validate(const struct rbtree_latch *self)
+{
+    return rbtree_validate(&self->tree_[0]) &&
+           rbtree_validate(&self->tree_[1]) &&
+           (self->tree_[0].size_ == self->size_) &&
+           (self->tree_[1].size_ == self->size_);
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_RBTREE_LATCH_H__ */
@@ -0,0 +1,284 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ *
+ * Reference : G. E. Blelloch, D. Ferizovic, Y. Sun, "Just Join for Parallel
+ *             Ordered Sets", 2016
+ */
+
+/* Red-Black Tree - Parallel Set Operations */
+#ifndef __RCN_C_RBTREE_SET_H__
+#define __RCN_C_RBTREE_SET_H__
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <unistd.h>
+
+#include "rbtree.h"
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/*
+ * Set operations, O(m log(n / m + 1)) for sizes n >= m, plus the relinking
+ * of the nodes moved between trees. The two halves of a recursion step run
+ * on a new thread when there are at least RBTREE_FORK_GRAIN entries left and
+ * the fork depth allows it.
+ */
+#ifndef RBTREE_FORK_GRAIN
+#define RBTREE_FORK_GRAIN 16384
+#endif /* RBTREE_FORK_GRAIN */
+
+/* CPUs to fork for, 0 for those online. */
+#ifndef RBTREE_FORK_CPUS
+#define RBTREE_FORK_CPUS 0
+#endif /* RBTREE_FORK_CPUS */
+
+struct __rbtree_set_args {
+    const struct rbtree *self_;
+    const struct rbnode *NIL2_;
+    struct rbnode *t1_;
+    size_t bh1_;
+    struct rbnode *t2_;
+    size_t bh2_;
+    struct rbnode *result_;
+    size_t bh_result_;
+    struct rbnode *rest_;
+    size_t bh_rest_;
+    int depth_;
+};
+
+static inline void __rbtree_set_args_init(struct __rbtree_set_args *args,
+                                          const struct __rbtree_set_args *up,
+                                          struct rbnode *t2)
+{
+    args->self_ = up->self_;
+    args->NIL2_ = up->NIL2_;
+    args->t1_ = NULL;
+    args->bh1_ = 0;
+    args->t2_ = t2;
+    args->bh2_ = up->bh2_ - !__rbnode_is_red(up->t2_);
+    args->result_ = args->rest_ = NULL;
+    args->bh_result_ = args->bh_rest_ = 0;
+    args->depth_ = up->depth_ - 1;
+}
+
+static inline void __rbtree_set_fork(void *(*fn)(void *),
+                                     struct __rbtree_set_args *left,
+                                     struct __rbtree_set_args *right)
+{
+    size_t nr_entries = left->t1_->count_ + left->t2_->count_ +
+                        right->t1_->count_ + right->t2_->count_;
+    bool forked = false;
+    pthread_t thread;
+
+    if ((left->depth_ >= 0) && (nr_entries >= RBTREE_FORK_GRAIN)) {
+        forked = pthread_create(&thread, NULL, fn, left) == 0;
+    }
+
+    if (!forked) {
+        fn(left);
+    }
+
+    fn(right);
+
+    if (forked) {
+        pthread_join(thread, NULL);
+    }
+}
+
+/* Number of levels to fork at : enough for two threads per CPU. */
+static inline int __rbtree_fork_depth(void)
+{
+    long nr_cpus = RBTREE_FORK_CPUS != 0 ? RBTREE_FORK_CPUS
+                                         : sysconf(_SC_NPROCESSORS_ONLN);
+    int depth = 0;
+
+    while ((1L << depth) < nr_cpus) {
+        depth++;
+    }
+
+    return depth;
+}
+
+/*
+ * result_ : t1_ U t2_, rest_ : the nodes of t2_ already in t1_. Both trees
+ * are linked to the NIL of self_.
+ */
+static void *__rbtree_union(void *_args)
+{
+    struct __rbtree_set_args *args = (struct __rbtree_set_args *)_args;
+    const struct rbtree *self = args->self_;
+    const struct rbnode *const NIL = rbtree_nil(self);
+    struct rbnode *t1 = args->t1_;
+    struct rbnode *t2 = args->t2_;
+    struct __rbtree_set_args left, right;
+    struct rbnode *m;
+
+    if ((t1 == NIL) || (t2 == NIL)) {
+        args->result_ = t1 == NIL ? t2 : t1;
+        args->bh_result_ = t1 == NIL ? args->bh2_ : args->bh1_;
+        args->rest_ = (struct rbnode *)NIL;
+        args->bh_rest_ = 0;
+        return NULL;
+    }
+
+    __rbtree_set_args_init(&left, args, t2->left_);
+    __rbtree_set_args_init(&right, args, t2->right_);
+    m = __rbtree_split(self, t1, args->bh1_, __rbnode_key(t2), t2->entry_,
+                       &left.t1_, &left.bh1_, &right.t1_, &right.bh1_);
+    __rbtree_set_fork(__rbtree_union, &left, &right);
+
+    if (m == NULL) {
+        args->result_ =
+            __rbtree_join(self, left.result_, left.bh_result_, t2,
+                          right.result_, right.bh_result_, &args->bh_result_);
+        args->rest_ = __rbtree_join2(self, left.rest_, left.bh_rest_,
+                                     right.rest_, right.bh_rest_,
+                                     &args->bh_rest_);
+    } else {
+        args->result_ =
+            __rbtree_join(self, left.result_, left.bh_result_, m,
+                          right.result_, right.bh_result_, &args->bh_result_);
+        args->rest_ =
+            __rbtree_join(self, left.rest_, left.bh_rest_, t2, right.rest_,
+                          right.bh_rest_, &args->bh_rest_);
+    }
+
+    return NULL;
+}
+
+/*
+ * result_ : t1_ & t2_, rest_ : t1_ - t2_. t2_ is linked to NIL2_ and only
+ * read.
+ */
+static void *__rbtree_intersect(void *_args)
+{
+    struct __rbtree_set_args *args = (struct __rbtree_set_args *)_args;
+    const struct rbtree *self = args->self_;
+    const struct rbnode *const NIL = rbtree_nil(self);
+    struct rbnode *t1 = args->t1_;
+    struct rbnode *t2 = args->t2_;
+    struct __rbtree_set_args left, right;
+    struct rbnode *m;
+
+    if ((t1 == NIL) || (t2 == args->NIL2_)) {
+        args->result_ = (struct rbnode *)NIL;
+        args->bh_result_ = 0;
+        args->rest_ = t1;
+        args->bh_rest_ = args->bh1_;
+        return NULL;
+    }
+
+    __rbtree_set_args_init(&left, args, t2->left_);
+    __rbtree_set_args_init(&right, args, t2->right_);
+    m = __rbtree_split(self, t1, args->bh1_, __rbnode_key(t2), t2->entry_,
+                       &left.t1_, &left.bh1_, &right.t1_, &right.bh1_);
+    __rbtree_set_fork(__rbtree_intersect, &left, &right);
+
+    if (m == NULL) {
+        args->result_ = __rbtree_join2(self, left.result_, left.bh_result_,
+                                       right.result_, right.bh_result_,
+                                       &args->bh_result_);
+    } else {
+        args->result_ =
+            __rbtree_join(self, left.result_, left.bh_result_, m,
+                          right.result_, right.bh_result_, &args->bh_result_);
+    }
+
+    args->rest_ = __rbtree_join2(self, left.rest_, left.bh_rest_, right.rest_,
+                                 right.bh_rest_, &args->bh_rest_);
+
+    return NULL;
+}
+
+static inline void __rbtree_set_args_top(struct __rbtree_set_args *args,
+                                         const struct rbtree *self,
+                                         const struct rbtree *other)
+{
+    args->self_ = self;
+    args->NIL2_ = rbtree_nil(other);
+    args->t1_ = self->root_;
+    args->bh1_ = __rbtree_black_height(self);
+    args->t2_ = other->root_;
+    args->bh2_ = __rbtree_black_height(other);
+    args->depth_ = __rbtree_fork_depth();
+}
+
+/*
+ * Moves the entries of 'other' into the tree. 'other' is left empty, and the
+ * nodes of the entries the tree already had are moved into 'rest' if it is
+ * not NULL. 'rest' may be 'other'.
+ */
+static inline void rbtree_union(struct rbtree *self, struct rbtree *other,
+                                struct rbtree *rest)
+{
+    struct __rbtree_set_args args;
+
+    __rbtree_set_args_top(&args, self, other);
+
+    if (args.t2_ != rbtree_nil(other)) {
+        __rbtree_relink(args.t2_, rbtree_nil(other), rbtree_nil(self));
+    } else {
+        args.t2_ = (struct rbnode *)rbtree_nil(self);
+    }
+
+    __rbtree_union(&args);
+
+    __rbtree_set_root(self, args.result_, self);
+    rbtree_clear(other);
+
+    if (rest != NULL) {
+        __rbtree_set_root(rest, args.rest_, self);
+    }
+}
+
+/*
+ * Keeps the entries which are also in 'other'. The others are moved into
+ * 'rest' if it is not NULL. 'other' is not modified.
+ */
+static inline void rbtree_intersection(struct rbtree *self,
+                                       const struct rbtree *other,
+                                       struct rbtree *rest)
+{
+    struct __rbtree_set_args args;
+
+    __rbtree_set_args_top(&args, self, other);
+    __rbtree_intersect(&args);
+
+    __rbtree_set_root(self, args.result_, self);
+
+    if (rest != NULL) {
+        __rbtree_set_root(rest, args.rest_, self);
+    }
+}
+
+/*
+ * Removes the entries which are also in 'other', and moves them into 'rest'
+ * if it is not NULL. 'other' is not modified.
+ */
+static inline void rbtree_difference(struct rbtree *self,
+                                     const struct rbtree *other,
+                                     struct rbtree *rest)
+{
+    struct __rbtree_set_args args;
+
+    __rbtree_set_args_top(&args, self, other);
+    __rbtree_intersect(&args);
+
+    __rbtree_set_root(self, args.rest_, self);
+
+    if (rest != NULL) {
+        __rbtree_set_root(rest, args.result_, self);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_RBTREE_SET_H__ */
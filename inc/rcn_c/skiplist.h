@@ -0,0 +1,455 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ *
+ * Reference : Herlihy, Shavit - The Art of Multiprocessor Programming,
+ *             14.4 A Lock-Free Concurrent Skiplist
+ */
+
+/* Lock-Free Skip List */
+#ifndef __RCN_C_SKIPLIST_H__
+#define __RCN_C_SKIPLIST_H__
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "epoch.h"
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/*
+ * Any number of threads may insert, erase and look up at the same time.
+ * A node is unlinked in two steps : its links are first marked, from the
+ * top level down, bit 0 of next_[0] being the one that takes it out of the
+ * set, then the searches going by cut it out of each level.
+ *
+ * Every call must be made between skiplist_read_lock() and
+ * skiplist_read_unlock(), except skiplist_reclaim(). An erased node may
+ * still be walked through by the other threads : hand it to
+ * skiplist_retire(), and it is released by the next skiplist_reclaim() once
+ * no thread can reach it anymore.
+ */
+#ifndef SKIPLIST_MAX_LEVEL
+#define SKIPLIST_MAX_LEVEL 16
+#endif /* SKIPLIST_MAX_LEVEL */
+
+struct skipnode {
+    void *entry_;
+    struct skipnode *retired_;
+    unsigned int level_;
+    struct skipnode *next_[SKIPLIST_MAX_LEVEL];
+};
+
+struct skiplist {
+    struct skipnode head_;
+    int (*compar_)(const void *ke, const void *in_tree);
+    size_t size_;
+    struct skipnode *retired_;
+    struct epoch epoch_;
+};
+
+static inline void skiplist_init(struct skiplist *self,
+                                 int (*compar)(const void *ke,
+                                               const void *in_tree))
+{
+    self->head_.entry_ = NULL;
+    self->head_.retired_ = NULL;
+    self->head_.level_ = SKIPLIST_MAX_LEVEL;
+
+    for (size_t i = 0; i < SKIPLIST_MAX_LEVEL; i++) {
+        self->head_.next_[i] = NULL;
+    }
+
+    self->compar_ = compar;
+    self->size_ = 0;
+    self->retired_ = NULL;
+    epoch_init(&self->epoch_);
+}
+
+static inline void skiplist_destroy(struct skiplist *self)
+{
+    epoch_destroy(&self->epoch_);
+}
+
+static inline size_t skiplist_size(const struct skiplist *self)
+{
+    return __atomic_load_n(&self->size_, __ATOMIC_RELAXED);
+}
+
+static inline bool skiplist_empty(const struct skiplist *self)
+{
+    return skiplist_size(self) == 0;
+}
+
+/* Returns the token to pass to skiplist_read_unlock(). */
+static inline unsigned int skiplist_read_lock(struct skiplist *self)
+{
+    return epoch_read_lock(&self->epoch_);
+}
+
+static inline void skiplist_read_unlock(struct skiplist *self,
+                                        unsigned int token)
+{
+    epoch_read_unlock(&self->epoch_, token);
+}
+
+static inline bool __skipnode_is_marked(const struct skipnode *x)
+{
+    return (uintptr_t)x & 1;
+}
+
+static inline struct skipnode *__skipnode_mark(const struct skipnode *x)
+{
+    return (struct skipnode *)((uintptr_t)x | 1);
+}
+
+static inline struct skipnode *__skipnode_unmark(const struct skipnode *x)
+{
+    return (struct skipnode *)((uintptr_t)x & ~(uintptr_t)1);
+}
+
+static inline struct skipnode *__skipnode_next(const struct skipnode *x,
+                                               unsigned int i)
+{
+    return __atomic_load_n(&x->next_[i], __ATOMIC_SEQ_CST);
+}
+
+static inline bool __skipnode_cas(struct skipnode *x, unsigned int i,
+                                  struct skipnode **expected,
+                                  struct skipnode *desired)
+{
+    return __atomic_compare_exchange_n(&x->next_[i], expected, desired, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+/* 1 + the number of times in a row a 1/4 chance came true, per thread. */
+static inline unsigned int __skiplist_random_level(void)
+{
+    static __thread uint64_t state;
+    unsigned int level = 1;
+
+    if (state == 0) {
+        state = (uintptr_t)&state | 1;
+    }
+
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    for (uint64_t r = state; ((r & 3) == 0) && (level < SKIPLIST_MAX_LEVEL);
+         r >>= 2) {
+        level++;
+    }
+
+    return level;
+}
+
+/*
+ * Fills preds[i] and succs[i] with the nodes around 'ke' on every level,
+ * cutting out the marked nodes on the way. Returns true if succs[0] holds
+ * an entry equal to 'ke'.
+ */
+static inline bool __skiplist_search(struct skiplist *self, const void *ke,
+                                     struct skipnode *preds[],
+                                     struct skipnode *succs[])
+{
+    struct skipnode *pred, *curr, *succ;
+    int diff;
+
+retry:
+    pred = &self->head_;
+    diff = 1;
+
+    for (int i = SKIPLIST_MAX_LEVEL - 1; i >= 0; i--) {
+        curr = __skipnode_unmark(__skipnode_next(pred, i));
+
+        while (curr != NULL) {
+            succ = __skipnode_next(curr, i);
+
+            if (__skipnode_is_marked(succ)) {
+                struct skipnode *expected = curr;
+
+                if (!__skipnode_cas(pred, i, &expected,
+                                    __skipnode_unmark(succ))) {
+                    goto retry;
+                }
+
+                curr = __skipnode_unmark(succ);
+                continue;
+            }
+
+            if ((diff = self->compar_(ke, curr->entry_)) <= 0) {
+                break;
+            }
+
+            pred = curr;
+            curr = succ;
+        }
+
+        preds[i] = pred;
+        succs[i] = curr;
+    }
+
+    return (succs[0] != NULL) && (diff == 0);
+}
+
+/* Returns -EEXIST if an equal entry is in the list. */
+static inline int skiplist_insert(struct skiplist *self, struct skipnode *z,
+                                  void *e)
+{
+    struct skipnode *preds[SKIPLIST_MAX_LEVEL];
+    struct skipnode *succs[SKIPLIST_MAX_LEVEL];
+    unsigned int level = __skiplist_random_level();
+    struct skipnode *expected;
+
+    z->entry_ = e;
+    z->retired_ = NULL;
+    z->level_ = level;
+
+    do {
+        if (__skiplist_search(self, e, preds, succs)) {
+            return -EEXIST;
+        }
+
+        for (unsigned int i = 0; i < level; i++) {
+            __atomic_store_n(&z->next_[i], succs[i], __ATOMIC_RELAXED);
+        }
+
+        expected = succs[0];
+    } while (!__skipnode_cas(preds[0], 0, &expected, z));
+
+    __atomic_fetch_add(&self->size_, 1, __ATOMIC_RELAXED);
+
+    /* In the set from here on : the upper levels are only shortcuts. */
+    for (unsigned int i = 1; i < level; i++) {
+        while (true) {
+            struct skipnode *next = __skipnode_next(z, i);
+
+            if (__skipnode_is_marked(next)) {
+                goto out;
+            }
+
+            if ((next != succs[i]) && !__skipnode_cas(z, i, &next, succs[i])) {
+                continue;
+            }
+
+            expected = succs[i];
+
+            if (__skipnode_cas(preds[i], i, &expected, z)) {
+                break;
+            }
+
+            if (!__skiplist_search(self, e, preds, succs) || (succs[0] != z)) {
+                goto out;
+            }
+        }
+    }
+
+out:
+    /* Erased meanwhile : a level may have been linked after it was cut. */
+    if (__skipnode_is_marked(__skipnode_next(z, 0))) {
+        __skiplist_search(self, e, preds, succs);
+    }
+
+    return 0;
+}
+
+/*
+ * Takes 'z' out of the list and returns its entry, or NULL if another
+ * thread erased it first.
+ */
+static inline void *skiplist_erase(struct skiplist *self, struct skipnode *z)
+{
+    struct skipnode *preds[SKIPLIST_MAX_LEVEL];
+    struct skipnode *succs[SKIPLIST_MAX_LEVEL];
+    struct skipnode *next;
+
+    for (unsigned int i = z->level_ - 1; i > 0; i--) {
+        next = __skipnode_next(z, i);
+
+        while (!__skipnode_is_marked(next) &&
+               !__skipnode_cas(z, i, &next, __skipnode_mark(next))) {
+        }
+    }
+
+    next = __skipnode_next(z, 0);
+
+    do {
+        if (__skipnode_is_marked(next)) {
+            return NULL;
+        }
+    } while (!__skipnode_cas(z, 0, &next, __skipnode_mark(next)));
+
+    __atomic_fetch_sub(&self->size_, 1, __ATOMIC_RELAXED);
+    __skiplist_search(self, z->entry_, preds, succs);
+
+    return z->entry_;
+}
+
+/*
+ * The first node not less than 'ke', or greater than 'ke' if 'upper'. It
+ * only reads, stepping over the marked nodes without cutting them out.
+ */
+static inline struct skipnode *__skiplist_bound(const struct skiplist *self,
+                                                const void *ke, bool upper)
+{
+    const struct skipnode *pred = &self->head_;
+    struct skipnode *curr = NULL, *succ;
+
+    for (int i = SKIPLIST_MAX_LEVEL - 1; i >= 0; i--) {
+        curr = __skipnode_unmark(__skipnode_next(pred, i));
+
+        while (curr != NULL) {
+            int diff;
+
+            succ = __skipnode_next(curr, i);
+
+            if (__skipnode_is_marked(succ)) {
+                curr = __skipnode_unmark(succ);
+                continue;
+            }
+
+            diff = self->compar_(ke, curr->entry_);
+
+            if ((diff < 0) || ((diff == 0) && !upper)) {
+                break;
+            }
+
+            pred = curr;
+            curr = succ;
+        }
+    }
+
+    return curr;
+}
+
+static inline struct skipnode *skiplist_lower_bound(const struct skiplist *self,
+                                                    const void *ke)
+{
+    return __skiplist_bound(self, ke, false);
+}
+
+static inline struct skipnode *skiplist_upper_bound(const struct skiplist *self,
+                                                    const void *ke)
+{
+    return __skiplist_bound(self, ke, true);
+}
+
+static inline struct skipnode *skiplist_find(const struct skiplist *self,
+                                             const void *ke)
+{
+    struct skipnode *x = __skiplist_bound(self, ke, false);
+
+    return (x != NULL) && (self->compar_(ke, x->entry_) == 0) ? x : NULL;
+}
+
+/* The first node in the set after 'x', which itself may have been erased. */
+static inline struct skipnode *skiplist_next(const struct skiplist *self,
+                                             const struct skipnode *x)
+{
+    struct skipnode *curr = __skipnode_unmark(__skipnode_next(x, 0));
+
+    while ((curr != NULL) && __skipnode_is_marked(__skipnode_next(curr, 0))) {
+        curr = __skipnode_unmark(__skipnode_next(curr, 0));
+    }
+
+    return curr;
+}
+
+static inline struct skipnode *skiplist_begin(const struct skiplist *self)
+{
+    return skiplist_next(self, &self->head_);
+}
+
+static inline const struct skipnode *skiplist_end(const struct skiplist *self)
+{
+    return NULL;
+}
+
+/* Queues an erased node for the next skiplist_reclaim(). */
+static inline void skiplist_retire(struct skiplist *self, struct skipnode *z)
+{
+    z->retired_ = __atomic_load_n(&self->retired_, __ATOMIC_RELAXED);
+
+    while (!__atomic_compare_exchange_n(&self->retired_, &z->retired_, z,
+                                        false, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED)) {
+    }
+}
+
+/*
+ * Waits until no thread can reach the nodes retired so far, then passes
+ * each of them to 'release'. Must not be called between skiplist_read_lock()
+ * and skiplist_read_unlock(). Returns the number of nodes released.
+ */
+static inline size_t skiplist_reclaim(struct skiplist *self,
+                                      void (*release)(struct skipnode *x))
+{
+    struct skipnode *x =
+        __atomic_exchange_n(&self->retired_, NULL, __ATOMIC_ACQUIRE);
+    size_t n = 0;
+
+    if (x == NULL) {
+        return 0;
+    }
+
+    epoch_synchronize(&self->epoch_);
+
+    while (x != NULL) {
+        struct skipnode *next = x->retired_;
+
+        release(x);
+        x = next;
+        n++;
+    }
+
+    return n;
+}
+
+/*
+ * Checks that each level is sorted, only holds nodes of the level below and
+ * has nothing marked left. Not to be called while the list is changing.
+ */
+static inline bool skiplist_validate(const struct skiplist *self)
+{
+    size_t size = 0;
+
+    for (unsigned int i = 0; i < SKIPLIST_MAX_LEVEL; i++) {
+        const struct skipnode *below = self->head_.next_[0];
+
+        for (const struct skipnode *x = self->head_.next_[i]; x != NULL;
+             x = x->next_[i]) {
+            const struct skipnode *next = x->next_[i];
+
+            if (__skipnode_is_marked(next) || (x->level_ <= i) ||
+                ((next != NULL) &&
+                 (self->compar_(x->entry_, next->entry_) >= 0))) {
+                return false;
+            }
+
+            while ((below != NULL) && (below != x)) {
+                below = below->next_[0];
+            }
+
+            if (below == NULL) {
+                return false;
+            }
+
+            size += i == 0;
+        }
+    }
+
+    return size == skiplist_size(self);
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_SKIPLIST_H__ */
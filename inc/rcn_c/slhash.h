@@ -13,6 +13,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "ilog2.h"
 #include "slist.h"
 
 #ifdef __cplusplus
@@ -20,12 +21,40 @@ namespace rcn_c
 {
 #endif
 
+/*
+ * A table set up by slhash_init_resizable() resizes with its load as those
+ * of dlhash do, after the SLHASH_ tunables below : see dlhash.h. Entries
+ * may be erased while iterating, slhash_erase() moves nothing.
+ */
+#ifndef SLHASH_MAX_LOAD
+#define SLHASH_MAX_LOAD 100
+#endif /* SLHASH_MAX_LOAD */
+
+#ifndef SLHASH_MIN_LOAD
+#define SLHASH_MIN_LOAD 10
+#endif /* SLHASH_MIN_LOAD */
+
+/* A power of 2. */
+#ifndef SLHASH_MIN_BUCKETS
+#define SLHASH_MIN_BUCKETS 16
+#endif /* SLHASH_MIN_BUCKETS */
+
+#ifndef SLHASH_REHASH_STEP
+#define SLHASH_REHASH_STEP 4
+#endif /* SLHASH_REHASH_STEP */
+
 struct slhash {
     size_t nr_buckets_;
     size_t (*key_hash_)(const void *ke);
     int (*compar_)(const void *ke, const void *in_table);
     struct slist *bucket_;
     size_t size_;
+    bool resizable_;
+    unsigned int shift_;
+    struct slist *old_bucket_;
+    size_t nr_old_buckets_;
+    unsigned int old_shift_;
+    size_t rehash_idx_;
 };
 
 static inline size_t __slhash_index(const struct slhash *table, const void *ke)
@@ -33,10 +62,53 @@ static inline size_t __slhash_index(const struct slhash *table, const void *ke)
     return table->key_hash_(ke) % table->nr_buckets_;
 }
 
+/* The bucket of the key 'ke' : the old one until it has moved. */
+static inline struct slist *__slhash_bucket(const struct slhash *self,
+                                            const void *ke)
+{
+    uint64_t m;
+
+    if (!self->resizable_) {
+        return &self->bucket_[__slhash_index(self, ke)];
+    }
+
+    m = (uint64_t)self->key_hash_(ke) * 0x9e3779b97f4a7c15ULL;
+
+    if (self->old_bucket_ != NULL &&
+        (m >> self->old_shift_) >= self->rehash_idx_) {
+        return &self->old_bucket_[m >> self->old_shift_];
+    }
+
+    return &self->bucket_[m >> self->shift_];
+}
+
+/* The new buckets set up so far, all of them unless resizing. */
+static inline size_t __slhash_ready(const struct slhash *self)
+{
+    unsigned int shrink;
+
+    if (self->old_bucket_ == NULL) {
+        return self->nr_buckets_;
+    }
+
+    if (self->shift_ < self->old_shift_) {
+        return self->rehash_idx_ << (self->old_shift_ - self->shift_);
+    }
+
+    shrink = self->shift_ - self->old_shift_;
+
+    return (self->rehash_idx_ + ((size_t)1 << shrink) - 1) >> shrink;
+}
+
 static inline void slhash_clear(struct slhash *self)
 {
     self->size_ = 0;
 
+    free(self->old_bucket_);
+    self->old_bucket_ = NULL;
+    self->nr_old_buckets_ = 0;
+    self->rehash_idx_ = 0;
+
     if (self->bucket_ == NULL) {
         return;
     }
@@ -54,6 +126,9 @@ static inline void slhash_init(
     self->key_hash_ = key_hash;
     self->compar_ = compar;
     self->bucket_ = bucket;
+    self->resizable_ = false;
+    self->shift_ = 0;
+    self->old_bucket_ = NULL;
     slhash_clear(self);
 }
 
@@ -62,16 +137,36 @@ static inline size_t slhash_buckets(const struct slhash *self)
     return self->nr_buckets_;
 }
 
+static inline bool slhash_rehashing(const struct slhash *self)
+{
+    return self->old_bucket_ != NULL;
+}
+
 static inline const struct slnode *slhash_end(const struct slhash *self)
 {
     return slist_end(&self->bucket_[self->nr_buckets_ - 1]);
 }
 
-static inline struct slnode *slhash_begin(const struct slhash *self)
+/*
+ * The first entry of the buckets from 'list' on, going on from the end of
+ * the old buckets to the new ones if 'list' is an old one.
+ */
+static inline struct slnode *__slhash_first(const struct slhash *self,
+                                            const struct slist *list, bool old)
 {
-    for (size_t n = 0; n < self->nr_buckets_; n++) {
-        struct slist *list = &self->bucket_[n];
+    const struct slist *end = &self->bucket_[__slhash_ready(self)];
+
+    if (old) {
+        for (; list < &self->old_bucket_[self->nr_old_buckets_]; list++) {
+            if (!slist_empty(list)) {
+                return slist_begin(list);
+            }
+        }
 
+        list = self->bucket_;
+    }
+
+    for (; list < end; list++) {
         if (!slist_empty(list)) {
             return slist_begin(list);
         }
@@ -80,21 +175,28 @@ static inline struct slnode *slhash_begin(const struct slhash *self)
     return (struct slnode *)slhash_end(self);
 }
 
+static inline struct slnode *slhash_begin(const struct slhash *self)
+{
+    if (self->old_bucket_ != NULL) {
+        return __slhash_first(self, &self->old_bucket_[self->rehash_idx_],
+                                true);
+    }
+
+    return __slhash_first(self, self->bucket_, false);
+}
+
 static inline struct slnode *slhash_next(const struct slhash *self,
                                          const struct slnode *x)
 {
+    const struct slist *old = self->old_bucket_;
+
     if (x->next_ != slist_end(x->list_)) {
         return x->next_;
     }
 
-    for (size_t m = 1; (uintptr_t)(&x->list_[m]) < (uintptr_t)slhash_end(self);
-         m++) {
-        if (!slist_empty(&x->list_[m])) {
-            return slist_begin(&x->list_[m]);
-        }
-    }
-
-    return (struct slnode *)slhash_end(self);
+    return __slhash_first(self, x->list_ + 1,
+                            old != NULL && x->list_ >= old &&
+                                x->list_ < &old[self->nr_old_buckets_]);
 }
 
 static inline size_t slhash_size(const struct slhash *self)
@@ -107,10 +209,135 @@ static inline bool slhash_empty(const struct slhash *self)
     return slhash_size(self) == 0;
 }
 
+/* Sets up the new buckets that take the entries of the old bucket 'n'. */
+static inline void __slhash_prepare(struct slhash *self, size_t n)
+{
+    unsigned int shrink;
+
+    if (self->shift_ < self->old_shift_) {
+        unsigned int grow = self->old_shift_ - self->shift_;
+
+        for (size_t i = n << grow; i < (n + 1) << grow; i++) {
+            slist_init(&self->bucket_[i]);
+        }
+
+        return;
+    }
+
+    shrink = self->shift_ - self->old_shift_;
+
+    if ((n & (((size_t)1 << shrink) - 1)) == 0) {
+        slist_init(&self->bucket_[n >> shrink]);
+    }
+}
+
+/*
+ * Moves the chains of up to 'nr' old buckets to the new ones, skipping up
+ * to ten times as many empty ones. Returns true while some are left, as
+ * slhash_rehashing() does.
+ */
+static inline bool slhash_rehash(struct slhash *self, size_t nr)
+{
+    size_t nr_empty = nr * 10;
+
+    if (self->old_bucket_ == NULL) {
+        return false;
+    }
+
+    while (nr != 0 && self->rehash_idx_ < self->nr_old_buckets_) {
+        struct slist *list = &self->old_bucket_[self->rehash_idx_];
+
+        __slhash_prepare(self, self->rehash_idx_++);
+
+        if (slist_empty(list)) {
+            if (--nr_empty == 0) {
+                break;
+            }
+
+            continue;
+        }
+
+        while (!slist_empty(list)) {
+            struct slnode *x = slist_begin(list);
+            void *e = slist_pop_front(list);
+
+            slist_push_front(__slhash_bucket(self, e), x, e);
+        }
+
+        nr--;
+    }
+
+    if (self->rehash_idx_ < self->nr_old_buckets_) {
+        return true;
+    }
+
+    free(self->old_bucket_);
+    self->old_bucket_ = NULL;
+    self->nr_old_buckets_ = 0;
+    self->rehash_idx_ = 0;
+
+    return false;
+}
+
+/* 'nr' buckets, a power of 2, are picked by the 'shift' high bits. */
+static inline unsigned int __slhash_shift(size_t nr)
+{
+    return 64 - (unsigned int)ilog2ll(nr);
+}
+
+/*
+ * Moves a few chains if a resize is on, or starts one if the load calls for
+ * it. Called by the updates that may move entries.
+ */
+static inline void __slhash_resize(struct slhash *self)
+{
+    struct slist *bucket;
+    size_t nr = SLHASH_MIN_BUCKETS;
+
+    if (!self->resizable_) {
+        return;
+    }
+
+    if (self->old_bucket_ != NULL) {
+        slhash_rehash(self, SLHASH_REHASH_STEP);
+        return;
+    }
+
+    if (self->size_ * 100 <= self->nr_buckets_ * SLHASH_MAX_LOAD &&
+        (self->size_ * 100 >= self->nr_buckets_ * SLHASH_MIN_LOAD ||
+         self->nr_buckets_ <= SLHASH_MIN_BUCKETS)) {
+        return;
+    }
+
+    while (nr < self->size_ * 2) {
+        nr <<= 1;
+    }
+
+    if (nr == self->nr_buckets_) {
+        return;
+    }
+
+    bucket = (struct slist *)malloc(nr * sizeof(*bucket));
+
+    if (bucket == NULL) {
+        return;
+    }
+
+    self->old_bucket_ = self->bucket_;
+    self->nr_old_buckets_ = self->nr_buckets_;
+    self->old_shift_ = self->shift_;
+    self->rehash_idx_ = 0;
+    self->bucket_ = bucket;
+    self->nr_buckets_ = nr;
+    self->shift_ = __slhash_shift(nr);
+}
+
 static inline int slhash_insert(struct slhash *self, struct slnode *z, void *e)
 {
-    size_t n = __slhash_index(self, e);
-    struct slist *bucket = &self->bucket_[n];
+    struct slist *bucket;
+
+    __slhash_resize(self);
+    bucket = __slhash_bucket(self, e);
 
     for (struct slnode *x = slist_begin(bucket); x != slist_end(bucket);
          x = x->next_) {
@@ -128,10 +355,8 @@ static inline int slhash_insert(struct slhash *self, struct slnode *z, void *e)
 static inline void slhash_insert_multi(struct slhash *self, struct slnode *z,
                                        void *e)
 {
-    size_t n = __slhash_index(self, e);
-    struct slist *bucket = &self->bucket_[n];
-
-    slist_push_front(bucket, z, e);
+    __slhash_resize(self);
+    slist_push_front(__slhash_bucket(self, e), z, e);
     self->size_++;
 }
 
@@ -145,8 +370,7 @@ static inline struct slnode *slhash_find(const struct slhash *self,
                                          const void *ke)
 {
     struct slnode *x;
-    size_t n = __slhash_index(self, ke);
-    struct slist *list = &self->bucket_[n];
+    struct slist *list = __slhash_bucket(self, ke);
 
     for (x = slist_begin(list); x != slist_end(list); x = x->next_) {
         if (self->compar_(ke, x->entry_) == 0) {
@@ -164,11 +388,25 @@ static inline void *slhash_at(const struct slhash *self, const void *ke)
     return x == NULL ? NULL : x->entry_;
 }
 
-static inline size_t slhash_size(const struct slhash *self, const void *ke)
+static inline struct slnode *slhash_remove(struct slhash *self, const void *ke)
 {
-    size_t n = __slhash_index(self, ke);
+    struct slnode *x;
+
+    __slhash_resize(self);
+    x = slhash_find(self, ke);
+
+    if (x == NULL) {
+        return NULL;
+    }
 
-    return slist_size(&self->bucket_[n]);
+    slhash_erase(self, x);
+
+    return x;
+}
+
+static inline size_t slhash_size(const struct slhash *self, const void *ke)
+{
+    return slist_size(__slhash_bucket(self, ke));
 }
 
 static inline void slhash_swap(struct slhash *self, struct slhash *other)
@@ -179,16 +417,39 @@ static inline void slhash_swap(struct slhash *self, struct slhash *other)
     *other = tmp;
 }
 
-static inline bool slhash_validate(struct slhash *self)
+static inline bool __slhash_validate_buckets(const struct slhash *self,
+                                             const struct slist *bucket,
+                                             size_t nr, size_t *size)
 {
-    size_t size = 0;
+    for (size_t n = 0; n < nr; n++) {
+        const struct slist *list = &bucket[n];
 
-    for (size_t n = 0; n < self->nr_buckets_; n++) {
-        if (!slist_validate(&self->bucket_[n])) {
+        if (!slist_validate(list)) {
             return false;
         }
 
-        size += slist_size(&self->bucket_[n]);
+        for (const struct slnode *x = slist_begin(list); x != slist_end(list);
+             x = x->next_) {
+            if (__slhash_bucket(self, x->entry_) != list) {
+                return false;
+            }
+        }
+
+        *size += slist_size(list);
+    }
+
+    return true;
+}
+
+static inline bool slhash_validate(struct slhash *self)
+{
+    size_t size = 0;
+
+    if (!__slhash_validate_buckets(self, self->bucket_, __slhash_ready(self),
+                                   &size) ||
+        !__slhash_validate_buckets(self, self->old_bucket_,
+                                   self->nr_old_buckets_, &size)) {
+        return false;
     }
 
     if (slhash_size(self) != size) {
@@ -216,6 +477,37 @@ static inline int __slhash_alloc_bucket(struct slhash *self)
 static inline void __slhash_free_bucket(struct slhash *self)
 {
     free(self->bucket_);
+    free(self->old_bucket_);
+}
+
+/*
+ * Sets up a table that allocates its buckets by itself, 'sz_bucket' of them
+ * at first, rounded up to a power of 2, and resizes them with the load.
+ * Returns 0, or -ENOMEM. To be released by slhash_destroy().
+ */
+static inline int slhash_init_resizable(
+    struct slhash *self, size_t sz_bucket, size_t (*key_hash)(const void *ke),
+    int (*compar)(const void *ke, const void *in_table))
+{
+    size_t nr = SLHASH_MIN_BUCKETS;
+
+    while (nr < sz_bucket) {
+        nr <<= 1;
+    }
+
+    slhash_init(self, nr, key_hash, compar, NULL);
+    self->resizable_ = true;
+    self->shift_ = __slhash_shift(nr);
+
+    return __slhash_alloc_bucket(self);
+}
+
+static inline void slhash_destroy(struct slhash *self)
+{
+    __slhash_free_bucket(self);
+    self->bucket_ = NULL;
+    self->old_bucket_ = NULL;
+    self->size_ = 0;
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,333 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ *
+ * Reference : P. Khuong, P. Morin, "Array Layouts for Comparison-Based
+ *             Searching", ACM JEA 2017
+ */
+
+/* Flat Snapshot of an Ordered Set */
+#ifndef __RCN_C_SNAPSHOT_H__
+#define __RCN_C_SNAPSHOT_H__
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/*
+ * The entries of an ordered set, of a fixed size, saved to a file after a
+ * versioned header. The file is mapped back as is : lookups may be served
+ * from the mapping directly, or a tree rebuilt in O(n) from its entries with
+ * rbtree_build_sorted() or avltree_build_sorted(). The mapping is private
+ * and writable, so intrusive nodes embedded in the entries may be linked in
+ * place, without touching the file.
+ *
+ * Two layouts :
+ *  - SNAPSHOT_SORTED    : ascending order, searched by bisection.
+ *  - SNAPSHOT_EYTZINGER : the implicit complete tree in BFS order, where the
+ *                         children of the k-th entry (from 1) are the 2k-th
+ *                         and (2k+1)-th. The first levels share a few cache
+ *                         lines and the next ones can be prefetched.
+ *
+ * The entries are saved as raw bytes : the file is only meant to be loaded
+ * on the same architecture, by the same build of the program.
+ */
+#define SNAPSHOT_MAGIC "RCNSNAP"
+#define SNAPSHOT_VERSION 1
+
+enum snapshot_layout {
+    SNAPSHOT_SORTED = 0,
+    SNAPSHOT_EYTZINGER,
+};
+
+struct snapshot_header {
+    char magic_[8];
+    uint32_t version_;
+    uint32_t layout_;
+    uint64_t entry_size_;
+    uint64_t nr_entries_;
+};
+
+/* The entries start on a cache line of their own. */
+#define SNAPSHOT_DATA_OFFSET 64
+
+struct snapshot {
+    void *map_;
+    size_t map_size_;
+    enum snapshot_layout layout_;
+    size_t entry_size_;
+    size_t nr_entries_;
+    char *entries_;
+    int (*compar_)(const void *ke, const void *in_tree);
+};
+
+static inline void *__snapshot_at(const struct snapshot *self, size_t i)
+{
+    return self->entries_ + i * self->entry_size_;
+}
+
+/*
+ * Fills the slots of the implicit subtree rooted at 'k' (from 1) with the
+ * next entries in order. The recursion is as deep as the tree, O(log(n)).
+ */
+static void __snapshot_fill(char *entries, size_t esize, size_t n, size_t k,
+                            const void *(*next)(void *it), void *it)
+{
+    if (k > n) {
+        return;
+    }
+
+    __snapshot_fill(entries, esize, n, 2 * k, next, it);
+    memcpy(&entries[(k - 1) * esize], next(it), esize);
+    __snapshot_fill(entries, esize, n, 2 * k + 1, next, it);
+}
+
+/*
+ * Saves 'n' entries of 'esize' bytes to 'path', replacing it. 'next(it)'
+ * must return them one by one in ascending order. To replace a snapshot in
+ * use, save to another path and rename() it over. Returns 0 or a negative
+ * errno.
+ */
+static inline int snapshot_save(const char *path, size_t esize, size_t n,
+                                enum snapshot_layout layout,
+                                const void *(*next)(void *it), void *it)
+{
+    size_t size = SNAPSHOT_DATA_OFFSET + esize * n;
+    struct snapshot_header *hdr;
+    char *entries;
+    void *map;
+    int fd, err = 0;
+
+    if ((esize == 0) || (layout > SNAPSHOT_EYTZINGER)) {
+        return -EINVAL;
+    }
+
+    if ((fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0) {
+        return -errno;
+    }
+
+    if (ftruncate(fd, size) != 0) {
+        err = -errno;
+        goto out;
+    }
+
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (map == MAP_FAILED) {
+        err = -errno;
+        goto out;
+    }
+
+    entries = (char *)map + SNAPSHOT_DATA_OFFSET;
+
+    if (layout == SNAPSHOT_SORTED) {
+        for (size_t i = 0; i < n; i++) {
+            memcpy(&entries[i * esize], next(it), esize);
+        }
+    } else {
+        __snapshot_fill(entries, esize, n, 1, next, it);
+    }
+
+    hdr = (struct snapshot_header *)map;
+    hdr->version_ = SNAPSHOT_VERSION;
+    hdr->layout_ = layout;
+    hdr->entry_size_ = esize;
+    hdr->nr_entries_ = n;
+    memcpy(hdr->magic_, SNAPSHOT_MAGIC, sizeof(hdr->magic_));
+
+    if (msync(map, size, MS_SYNC) != 0) {
+        err = -errno;
+    }
+
+    munmap(map, size);
+
+out:
+    close(fd);
+
+    return err;
+}
+
+/*
+ * Maps the snapshot saved at 'path'. Returns -EINVAL if 'esize' is 0, or if it
+ * is not a snapshot of this version, of entries of 'esize' bytes, or a
+ * negative errno.
+ */
+static inline int snapshot_open(struct snapshot *self, const char *path,
+                                size_t esize,
+                                int (*compar)(const void *ke,
+                                              const void *in_tree))
+{
+    const struct snapshot_header *hdr;
+    struct stat st;
+    void *map;
+    int fd, err = 0;
+
+    if (esize == 0) {
+        return -EINVAL;
+    }
+
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        return -errno;
+    }
+
+    if (fstat(fd, &st) != 0) {
+        err = -errno;
+        goto out;
+    }
+
+    if ((size_t)st.st_size < SNAPSHOT_DATA_OFFSET) {
+        err = -EINVAL;
+        goto out;
+    }
+
+    map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+    if (map == MAP_FAILED) {
+        err = -errno;
+        goto out;
+    }
+
+    hdr = (const struct snapshot_header *)map;
+
+    if ((memcmp(hdr->magic_, SNAPSHOT_MAGIC, sizeof(hdr->magic_)) != 0) ||
+        (hdr->version_ != SNAPSHOT_VERSION) ||
+        (hdr->layout_ > SNAPSHOT_EYTZINGER) || (hdr->entry_size_ != esize) ||
+        (hdr->nr_entries_ > (st.st_size - SNAPSHOT_DATA_OFFSET) / esize)) {
+        munmap(map, st.st_size);
+        err = -EINVAL;
+        goto out;
+    }
+
+    self->map_ = map;
+    self->map_size_ = st.st_size;
+    self->layout_ = (enum snapshot_layout)hdr->layout_;
+    self->entry_size_ = esize;
+    self->nr_entries_ = hdr->nr_entries_;
+    self->entries_ = (char *)map + SNAPSHOT_DATA_OFFSET;
+    self->compar_ = compar;
+
+out:
+    close(fd);
+
+    return err;
+}
+
+static inline void snapshot_close(struct snapshot *self)
+{
+    munmap(self->map_, self->map_size_);
+    self->map_ = NULL;
+}
+
+static inline size_t snapshot_size(const struct snapshot *self)
+{
+    return self->nr_entries_;
+}
+
+static inline bool snapshot_empty(const struct snapshot *self)
+{
+    return snapshot_size(self) == 0;
+}
+
+static inline void *snapshot_lower_bound(const struct snapshot *self,
+                                         const void *ke)
+{
+    const size_t n = self->nr_entries_;
+
+    if (self->layout_ == SNAPSHOT_SORTED) {
+        size_t left = 0, right = n;
+
+        while (left < right) {
+            size_t mid = left + (right - left) / 2;
+
+            if (self->compar_(ke, __snapshot_at(self, mid)) > 0) {
+                left = mid + 1;
+            } else {
+                right = mid;
+            }
+        }
+
+        return left < n ? __snapshot_at(self, left) : NULL;
+    }
+
+    size_t k = 1;
+
+    while (k <= n) {
+        /* The 16k-th slot is 4 levels down, on the path of 'k'. */
+        __builtin_prefetch(self->entries_ + (16 * k - 1) * self->entry_size_);
+        k = 2 * k + (self->compar_(ke, __snapshot_at(self, k - 1)) > 0);
+    }
+
+    /* Back up to the last node where the walk went left. */
+    k >>= __builtin_ctzll(~(unsigned long long)k) + 1;
+
+    return k != 0 ? __snapshot_at(self, k - 1) : NULL;
+}
+
+static inline void *snapshot_find(const struct snapshot *self, const void *ke)
+{
+    void *e = snapshot_lower_bound(self, ke);
+
+    return (e != NULL) && (self->compar_(ke, e) == 0) ? e : NULL;
+}
+
+/*
+ * Fills entries[] with the addresses of the entries in ascending order, as
+ * expected by rbtree_build_sorted() and avltree_build_sorted(). O(n).
+ */
+static inline void snapshot_sorted(const struct snapshot *self,
+                                   void *entries[])
+{
+    const size_t n = self->nr_entries_;
+    size_t k = 1;
+
+    if (self->layout_ == SNAPSHOT_SORTED) {
+        for (size_t i = 0; i < n; i++) {
+            entries[i] = __snapshot_at(self, i);
+        }
+
+        return;
+    }
+
+    if (n == 0) {
+        return;
+    }
+
+    /* In-order walk of the implicit tree, from its leftmost slot. */
+    while (2 * k <= n) {
+        k *= 2;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        entries[i] = __snapshot_at(self, k - 1);
+
+        if (2 * k + 1 <= n) {
+            for (k = 2 * k + 1; 2 * k <= n; k *= 2) {
+            }
+        } else {
+            /* Up while coming from a right child, then once more. */
+            while (k & 1) {
+                k >>= 1;
+            }
+
+            k >>= 1;
+        }
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_SNAPSHOT_H__ */
@@ -0,0 +1,428 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ */
+
+/* Splay Tree Sequence (Rope) */
+#ifndef __RCN_C_SPLSEQ_H__
+#define __RCN_C_SPLSEQ_H__
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "common.h"
+#include "spltree.h"
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/*
+ * A sequence kept in a splay tree ordered by position instead of by key :
+ * the rank of a node is the number of nodes before it, found from count_.
+ * Insert at a rank, erase of a range, split and concatenation are all
+ * amortized O(log n).
+ *
+ * A range may be reversed lazily : the flag is only handed down to the
+ * children when a walk goes through the node. The augment hooks given to
+ * splseq_init() may keep an aggregate of every subtree (which should not
+ * depend on the order of the elements, as a reversal does not update it)
+ * and a lazy tag of their own, applied to a whole range by splseq_apply().
+ */
+struct splseq_node {
+    struct splnode node_;
+    bool reversed_;
+};
+
+struct splseq {
+    struct spltree tree_;
+};
+
+static inline void splseq_clear(struct splseq *self)
+{
+    spltree_clear(&self->tree_);
+}
+
+/* 'augment' may be NULL. */
+static inline void splseq_init(struct splseq *self,
+                               const struct spltree_augment *augment)
+{
+    spltree_init_augmented(&self->tree_, NULL, augment);
+}
+
+static inline bool splseq_empty(const struct splseq *self)
+{
+    return spltree_empty(&self->tree_);
+}
+
+static inline size_t splseq_size(const struct splseq *self)
+{
+    return spltree_size(&self->tree_);
+}
+
+static inline struct splseq_node *__splseq_node(const struct splnode *x)
+{
+    return CONTAINER_OF(x, struct splseq_node, node_);
+}
+
+static inline void __splseq_push(const struct splseq *self, struct splnode *x)
+{
+    struct splseq_node *n = __splseq_node(x);
+
+    if (n->reversed_) {
+        struct splnode *t = x->left_;
+
+        x->left_ = x->right_;
+        x->right_ = t;
+
+        if (x->left_ != NULL) {
+            __splseq_node(x->left_)->reversed_ ^= true;
+        }
+
+        if (x->right_ != NULL) {
+            __splseq_node(x->right_)->reversed_ ^= true;
+        }
+
+        n->reversed_ = false;
+    }
+
+    if ((self->tree_.augment_ != NULL) &&
+        (self->tree_.augment_->push != NULL)) {
+        self->tree_.augment_->push(x);
+    }
+}
+
+/*
+ * Splays the node of rank 'n' to the root. Tags are pushed down on the way,
+ * so that the rotations only move nodes with none pending.
+ */
+static inline struct splnode *__splseq_splay_at(struct splseq *self, size_t n)
+{
+    struct splnode *x = self->tree_.root_;
+
+    while (true) {
+        size_t left;
+
+        __splseq_push(self, x);
+        left = x->left_ != NULL ? x->left_->count_ : 0;
+
+        if (n < left) {
+            x = x->left_;
+        } else if (n == left) {
+            break;
+        } else {
+            n -= left + 1;
+            x = x->right_;
+        }
+    }
+
+    __spltree_splay(&self->tree_, x);
+
+    return x;
+}
+
+/* The entry of rank 'n', or NULL if out of range. */
+static inline void *splseq_at(struct splseq *self, size_t n)
+{
+    if (n >= splseq_size(self)) {
+        return NULL;
+    }
+
+    return __splseq_splay_at(self, n)->entry_;
+}
+
+/* Appends all of 'other' to 'self', leaving 'other' empty. */
+static inline void splseq_concat(struct splseq *self, struct splseq *other)
+{
+    struct splnode *r = other->tree_.root_;
+    struct splnode *x;
+
+    if (r == NULL) {
+        return;
+    }
+
+    splseq_clear(other);
+
+    if (splseq_empty(self)) {
+        self->tree_.root_ = r;
+        return;
+    }
+
+    x = __splseq_splay_at(self, splseq_size(self) - 1);
+    x->right_ = r;
+    r->parent_ = x;
+    __spltree_update(&self->tree_, x);
+}
+
+/*
+ * Moves the entries from rank 'n' on to 'rest', which must be empty and set
+ * up with the same hooks.
+ */
+static inline void splseq_split(struct splseq *self, size_t n,
+                                struct splseq *rest)
+{
+    struct splnode *x, *l;
+
+    if (n >= splseq_size(self)) {
+        return;
+    }
+
+    if (n == 0) {
+        rest->tree_.root_ = self->tree_.root_;
+        splseq_clear(self);
+        return;
+    }
+
+    x = __splseq_splay_at(self, n);
+    l = x->left_;
+    x->left_ = NULL;
+    l->parent_ = NULL;
+    __spltree_update(&self->tree_, x);
+
+    self->tree_.root_ = l;
+    rest->tree_.root_ = x;
+}
+
+/*
+ * Inserts 'z' holding 'e' at rank 'n' : it will have 'n' entries before it.
+ * Returns -EINVAL if 'n' is past the end.
+ */
+static inline int splseq_insert(struct splseq *self, size_t n,
+                                struct splseq_node *z, void *e)
+{
+    struct splnode *x = &z->node_;
+    struct splseq rest;
+
+    if (n > splseq_size(self)) {
+        return -EINVAL;
+    }
+
+    splseq_init(&rest, self->tree_.augment_);
+    splseq_split(self, n, &rest);
+
+    x->entry_ = e;
+    x->parent_ = NULL;
+    x->left_ = self->tree_.root_;
+    x->right_ = rest.tree_.root_;
+    z->reversed_ = false;
+
+    if (x->left_ != NULL) {
+        x->left_->parent_ = x;
+    }
+
+    if (x->right_ != NULL) {
+        x->right_->parent_ = x;
+    }
+
+    __spltree_update(&self->tree_, x);
+    self->tree_.root_ = x;
+
+    return 0;
+}
+
+static inline int splseq_push_back(struct splseq *self, struct splseq_node *z,
+                                   void *e)
+{
+    return splseq_insert(self, splseq_size(self), z, e);
+}
+
+/*
+ * Splits 'self' into itself [0, pos), 'range' [pos, pos + n) and 'rest'.
+ * Returns -EINVAL if the range does not fit.
+ */
+static inline int __splseq_cut(struct splseq *self, size_t pos, size_t n,
+                               struct splseq *range, struct splseq *rest)
+{
+    if ((pos > splseq_size(self)) || (n > splseq_size(self) - pos)) {
+        return -EINVAL;
+    }
+
+    splseq_init(range, self->tree_.augment_);
+    splseq_init(rest, self->tree_.augment_);
+    splseq_split(self, pos, range);
+    splseq_split(range, n, rest);
+
+    return 0;
+}
+
+static inline void __splseq_paste(struct splseq *self, struct splseq *range,
+                                  struct splseq *rest)
+{
+    splseq_concat(self, range);
+    splseq_concat(self, rest);
+}
+
+/*
+ * Moves the 'n' entries from rank 'pos' to 'out', which must be empty and
+ * set up with the same hooks. Returns -EINVAL if the range does not fit.
+ */
+static inline int splseq_erase_range(struct splseq *self, size_t pos,
+                                     size_t n, struct splseq *out)
+{
+    struct splseq range, rest;
+    int err;
+
+    if ((err = __splseq_cut(self, pos, n, &range, &rest)) != 0) {
+        return err;
+    }
+
+    out->tree_.root_ = range.tree_.root_;
+    splseq_concat(self, &rest);
+
+    return 0;
+}
+
+/* Unlinks the entry of rank 'n' and returns it, or NULL if out of range. */
+static inline void *splseq_erase(struct splseq *self, size_t n)
+{
+    struct splseq out;
+
+    if (n >= splseq_size(self)) {
+        return NULL;
+    }
+
+    splseq_init(&out, self->tree_.augment_);
+    splseq_erase_range(self, n, 1, &out);
+
+    return out.tree_.root_->entry_;
+}
+
+/* Reverses the order of the 'n' entries from rank 'pos'. */
+static inline int splseq_reverse(struct splseq *self, size_t pos, size_t n)
+{
+    struct splseq range, rest;
+    int err;
+
+    if ((err = __splseq_cut(self, pos, n, &range, &rest)) != 0) {
+        return err;
+    }
+
+    if (!splseq_empty(&range)) {
+        __splseq_node(range.tree_.root_)->reversed_ ^= true;
+    }
+
+    __splseq_paste(self, &range, &rest);
+
+    return 0;
+}
+
+/*
+ * Calls 'fn' with the root of a subtree holding exactly the 'n' entries
+ * from rank 'pos', which is NULL if 'n' is 0. 'fn' may read the aggregate of
+ * the range, or set a lazy tag on the root and update its aggregate to
+ * match. The ancestors are brought up to date afterwards.
+ */
+static inline int splseq_apply(struct splseq *self, size_t pos, size_t n,
+                               void (*fn)(struct splnode *x, void *arg),
+                               void *arg)
+{
+    struct splseq range, rest;
+    int err;
+
+    if ((err = __splseq_cut(self, pos, n, &range, &rest)) != 0) {
+        return err;
+    }
+
+    fn(range.tree_.root_, arg);
+    __splseq_paste(self, &range, &rest);
+
+    return 0;
+}
+
+/*
+ * Calls 'fn' on every entry in order, handing the pending tags down on the
+ * way. The walk follows the parent links, so it needs no stack however
+ * unbalanced the tree is.
+ */
+static inline void splseq_for_each(struct splseq *self,
+                                   void (*fn)(void *e, void *arg), void *arg)
+{
+    struct splnode *x = self->tree_.root_;
+
+    while (x != NULL) {
+        __splseq_push(self, x);
+
+        if (x->left_ != NULL) {
+            x = x->left_;
+            continue;
+        }
+
+        while (true) {
+            fn(x->entry_, arg);
+
+            if (x->right_ != NULL) {
+                x = x->right_;
+                break;
+            }
+
+            while ((x->parent_ != NULL) && (x == x->parent_->right_)) {
+                x = x->parent_;
+            }
+
+            if ((x = x->parent_) == NULL) {
+                return;
+            }
+        }
+    }
+}
+
+static inline bool splseq_validate(const struct splseq *self)
+{
+    const struct splnode *x = self->tree_.root_;
+    size_t size = 0;
+
+    if ((x != NULL) && (x->parent_ != NULL)) {
+        return false;
+    }
+
+    /* Pre-order walk over the parent links. */
+    while (x != NULL) {
+        size_t count = 1;
+
+        if (x->left_ != NULL) {
+            count += x->left_->count_;
+
+            if (x->left_->parent_ != x) {
+                return false;
+            }
+        }
+
+        if (x->right_ != NULL) {
+            count += x->right_->count_;
+
+            if (x->right_->parent_ != x) {
+                return false;
+            }
+        }
+
+        if (x->count_ != count) {
+            return false;
+        }
+
+        size++;
+
+        if (x->left_ != NULL) {
+            x = x->left_;
+        } else if (x->right_ != NULL) {
+            x = x->right_;
+        } else {
+            while ((x->parent_ != NULL) && ((x == x->parent_->right_) ||
+                                            (x->parent_->right_ == NULL))) {
+                x = x->parent_;
+            }
+
+            x = x->parent_ != NULL ? x->parent_->right_ : NULL;
+        }
+    }
+
+    return size == splseq_size(self);
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_SPLSEQ_H__ */
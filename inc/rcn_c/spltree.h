@@ -14,6 +14,10 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#ifdef SPLTREE_STATS
+#include "tree_stats.h"
+#endif /* SPLTREE_STATS */
+
 #ifdef __cplusplus
 namespace rcn_c
 {
@@ -27,11 +31,53 @@ struct splnode {
     void *entry_;
 };
 
+/*
+ * Hooks to keep per-node augmented data (e.g. the sum of a subtree) in sync
+ * with the tree shape :
+ *  - update : recompute 'x' from its children, count_ being up to date.
+ *  - push   : hand a pending lazy tag of 'x' down to its children. Only
+ *             called by the rank-keyed walks of splseq.h, before they splay.
+ * The augmented value of a node must be set up as for a leaf before it is
+ * linked. 'push' may be NULL.
+ */
+struct spltree_augment {
+    void (*update)(struct splnode *x);
+    void (*push)(struct splnode *x);
+};
+
+/*
+ * How spltree_find() restructures the tree on a hit, to spare read-mostly
+ * workloads a write to the top nodes on every lookup :
+ *  - period_ : splay only every period_-th hit.
+ *  - depth_  : splay only a node found deeper than depth_.
+ *  - semi_   : semi-splay, which rotates about half as much and only halves
+ *              the depth of the path instead of moving the node to the root.
+ * The default { 1, 0, false } splays every hit all the way up.
+ */
+struct spltree_policy {
+    unsigned int period_;
+    unsigned int depth_;
+    bool semi_;
+};
+
 struct spltree {
     struct splnode *root_;
     int (*compar_)(const void *ke, const void *in_tree);
+    const struct spltree_augment *augment_;
+    struct spltree_policy policy_;
+    unsigned int nr_hits_;
+#ifdef SPLTREE_STATS
+    struct tree_stats stats_;
+#endif /* SPLTREE_STATS */
 };
 
+#ifdef SPLTREE_STATS
+#define __SPLTREE_STATS(self, field, n) \
+    TREE_STATS_ADD(&(self)->stats_, field, n)
+#else
+#define __SPLTREE_STATS(self, field, n) ((void)0)
+#endif /* SPLTREE_STATS */
+
 static inline void spltree_clear(struct spltree *self)
 {
     self->root_ = NULL;
@@ -43,6 +89,37 @@ static inline void spltree_init(struct spltree *self,
 {
     spltree_clear(self);
     self->compar_ = compar;
+    self->augment_ = NULL;
+    self->policy_.period_ = 1;
+    self->policy_.depth_ = 0;
+    self->policy_.semi_ = false;
+    self->nr_hits_ = 0;
+#ifdef SPLTREE_STATS
+    tree_stats_reset(&self->stats_);
+#endif /* SPLTREE_STATS */
+}
+
+static inline void
+spltree_init_augmented(struct spltree *self,
+                       int (*compar)(const void *ke, const void *in_tree),
+                       const struct spltree_augment *augment)
+{
+    spltree_init(self, compar);
+    self->augment_ = augment;
+}
+
+/* Returns -EINVAL if the period is 0. */
+static inline int spltree_set_policy(struct spltree *self,
+                                     const struct spltree_policy *policy)
+{
+    if (policy->period_ == 0) {
+        return -EINVAL;
+    }
+
+    self->policy_ = *policy;
+    self->nr_hits_ = 0;
+
+    return 0;
 }
 
 static inline bool spltree_empty(const struct spltree *self)
@@ -170,11 +247,23 @@ static inline void __splnode_update(struct splnode *x)
     }
 }
 
+static inline void __spltree_update(const struct spltree *self,
+                                    struct splnode *x)
+{
+    __splnode_update(x);
+
+    if (self->augment_ != NULL) {
+        self->augment_->update(x);
+    }
+}
+
 static inline void __spltree_rotate(struct spltree *self, struct splnode *x)
 {
     struct splnode *p = x->parent_;
     struct splnode *b;
 
+    __SPLTREE_STATS(self, nr_rotations_, 1);
+
     if (x == p->left_) {
         p->left_ = b = x->right_;
         x->right_ = p;
@@ -200,8 +289,8 @@ static inline void __spltree_rotate(struct spltree *self, struct splnode *x)
         self->root_ = x;
     }
 
-    __splnode_update(p);
-    __splnode_update(x);
+    __spltree_update(self, p);
+    __spltree_update(self, x);
 }
 
 static inline void __spltree_splay(struct spltree *self, struct splnode *x)
@@ -210,6 +299,8 @@ static inline void __spltree_splay(struct spltree *self, struct splnode *x)
         struct splnode *p = x->parent_;
         struct splnode *g = p->parent_;
 
+        __SPLTREE_STATS(self, nr_fixups_, 1);
+
         if (g != NULL) {
             __spltree_rotate(self, (x == p->left_) == (p == g->left_) ? p : x);
         }
@@ -218,58 +309,192 @@ static inline void __spltree_splay(struct spltree *self, struct splnode *x)
     }
 }
 
-static inline int spltree_insert(struct spltree *self, struct splnode *z,
-                                 void *e)
+/*
+ * Moves 'x' up the way a splay does, but on a zig-zig only rotates its
+ * parent and goes on from there : the path is about halved while 'x' itself
+ * only climbs part of the way.
+ */
+static inline void __spltree_semisplay(struct spltree *self, struct splnode *x)
 {
-    struct splnode *p = self->root_, **pp;
+    while (x->parent_ != NULL) {
+        struct splnode *p = x->parent_;
+        struct splnode *g = p->parent_;
+
+        __SPLTREE_STATS(self, nr_fixups_, 1);
 
+        if (g == NULL) {
+            __spltree_rotate(self, x);
+        } else if ((x == p->left_) == (p == g->left_)) {
+            __spltree_rotate(self, p);
+            x = p;
+        } else {
+            __spltree_rotate(self, x);
+            __spltree_rotate(self, x);
+        }
+    }
+}
+
+/*
+ * Links 'z' holding 'e' as the 'diff' side child of 'p', or as the root, and
+ * splays it.
+ */
+static inline void __spltree_link(struct spltree *self, struct splnode *p,
+                                  int diff, struct splnode *z, void *e)
+{
     z->entry_ = e;
+    z->parent_ = p;
     z->left_ = z->right_ = NULL;
     z->count_ = 1;
+    __SPLTREE_STATS(self, nr_inserts_, 1);
 
     if (p == NULL) {
         self->root_ = z;
-        z->parent_ = NULL;
-        return 0;
+        return;
     }
 
-    while (true) {
-        int diff = self->compar_(e, p->entry_);
+    if (diff < 0) {
+        p->left_ = z;
+    } else {
+        p->right_ = z;
+    }
 
-        if (diff == 0) {
-            return -EEXIST;
-        } else if (diff < 0) {
-            if (p->left_ == NULL) {
-                pp = &p->left_;
-                break;
-            }
+    __spltree_splay(self, z);
+}
 
-            p = p->left_;
+/*
+ * Returns the node holding an entry equal to 'e', splayed, or NULL after
+ * linking 'z' holding 'e' where it belongs.
+ */
+static inline struct splnode *__spltree_insert(struct spltree *self,
+                                               struct splnode *z, void *e)
+{
+    struct splnode *x = self->root_;
+    struct splnode *p = NULL;
+    int diff = 0;
+
+    while (x != NULL) {
+        p = x;
+        diff = self->compar_(e, p->entry_);
+        __SPLTREE_STATS(self, nr_insert_compars_, 1);
+
+        if (diff < 0) {
+            x = x->left_;
+        } else if (diff > 0) {
+            x = x->right_;
         } else {
-            if (p->right_ == NULL) {
-                pp = &p->right_;
-                break;
-            }
+            __spltree_splay(self, x);
+            return x;
+        }
+    }
 
-            p = p->right_;
+    __spltree_link(self, p, diff, z, e);
+
+    return NULL;
+}
+
+static inline int spltree_insert(struct spltree *self, struct splnode *z,
+                                 void *e)
+{
+    return __spltree_insert(self, z, e) == NULL ? 0 : -EEXIST;
+}
+
+/*
+ * Inserts 'z' holding 'e' unless an equal entry is there already. Returns
+ * the node holding the entry in the tree, which is 'z' if it was inserted.
+ */
+static inline struct splnode *spltree_insert_or_get(struct spltree *self,
+                                                    struct splnode *z, void *e)
+{
+    struct splnode *x = __spltree_insert(self, z, e);
+
+    return x == NULL ? z : x;
+}
+
+/*
+ * Inserts 'z' holding 'e' right after 'hint', or first if 'hint' is NULL,
+ * without a descent when 'e' does belong there. Otherwise falls back to
+ * spltree_insert(). 'z' is splayed either way.
+ */
+static inline int spltree_insert_hint(struct spltree *self,
+                                      struct splnode *hint, struct splnode *z,
+                                      void *e)
+{
+    struct splnode *next = hint == NULL ? spltree_begin(self) :
+                                          spltree_next(self, hint);
+    int diff;
+
+    if (hint != NULL) {
+        if ((diff = self->compar_(e, hint->entry_)) <= 0) {
+            return diff == 0 ? -EEXIST : spltree_insert(self, z, e);
         }
     }
 
-    *pp = z;
-    z->parent_ = p;
-    __spltree_splay(self, z);
+    if (next != NULL) {
+        if ((diff = self->compar_(e, next->entry_)) >= 0) {
+            return diff == 0 ? -EEXIST : spltree_insert(self, z, e);
+        }
+    }
+
+    if ((hint != NULL) && (hint->right_ == NULL)) {
+        __spltree_link(self, hint, 1, z, e);
+    } else {
+        /* 'next' is the leftmost node of the right subtree of 'hint'. */
+        __spltree_link(self, next, -1, z, e);
+    }
 
     return 0;
 }
 
+static struct splnode *__spltree_build(const struct spltree *self,
+                                       struct splnode *parent,
+                                       struct splnode *nodes[],
+                                       void *entries[], size_t n)
+{
+    size_t mid = n / 2;
+    struct splnode *x;
+
+    if (n == 0) {
+        return NULL;
+    }
+
+    x = nodes[mid];
+    x->entry_ = entries[mid];
+    x->parent_ = parent;
+    x->left_ = __spltree_build(self, x, nodes, entries, mid);
+    x->right_ = __spltree_build(self, x, &nodes[mid + 1], &entries[mid + 1],
+                                n - mid - 1);
+    __spltree_update(self, x);
+
+    return x;
+}
+
+/*
+ * Replaces the content of the tree with the 'n' entries of 'entries', which
+ * must be sorted in strictly ascending order, using nodes[i] for entries[i].
+ * compar is never called. The result is perfectly balanced, with the augment
+ * data of every node updated, and the splay period starts over. O(n).
+ */
+static inline void spltree_build_sorted(struct spltree *self,
+                                        struct splnode *nodes[],
+                                        void *entries[], size_t n)
+{
+    self->root_ = __spltree_build(self, NULL, nodes, entries, n);
+    self->nr_hits_ = 0;
+}
+
 static inline const struct splnode *
-spltree_find_const(const struct spltree *self, const void *ke)
+__spltree_find_depth(const struct spltree *self, const void *ke,
+                     unsigned int *depth)
 {
     const struct splnode *x = self->root_;
 
-    while (x != NULL) {
+    __SPLTREE_STATS(self, nr_finds_, 1);
+
+    for (*depth = 0; x != NULL; (*depth)++) {
         int diff = self->compar_(ke, x->entry_);
 
+        __SPLTREE_STATS(self, nr_find_compars_, 1);
+
         if (diff == 0) {
             return x;
         } else if (diff < 0) {
@@ -282,28 +507,89 @@ spltree_find_const(const struct spltree *self, const void *ke)
     return NULL;
 }
 
+/*
+ * Looks up without changing anything, so concurrent readers may share the
+ * tree (e.g. under the read side of a rwlock) as long as no one modifies it.
+ */
+static inline const struct splnode *
+spltree_find_const(const struct spltree *self, const void *ke)
+{
+    unsigned int depth;
+
+    return __spltree_find_depth(self, ke, &depth);
+}
+
+/* Looks up and restructures on a hit, as the policy of the tree says. */
 static inline struct splnode *spltree_find(struct spltree *self, const void *ke)
 {
-    struct splnode *x = (struct splnode *)spltree_find_const(self, ke);
+    unsigned int depth;
+    struct splnode *x =
+        (struct splnode *)__spltree_find_depth(self, ke, &depth);
 
-    if (x != NULL) {
+    if ((x == NULL) || (depth <= self->policy_.depth_) ||
+        (++self->nr_hits_ < self->policy_.period_)) {
+        return x;
+    }
+
+    self->nr_hits_ = 0;
+
+    if (self->policy_.semi_) {
+        __spltree_semisplay(self, x);
+    } else {
         __spltree_splay(self, x);
     }
 
     return x;
 }
 
+/*
+ * Whether 'z' is a node of the tree, looked up as a find would, but left out
+ * of the statistics.
+ */
+static inline bool __spltree_has(const struct spltree *self,
+                                 const struct splnode *z)
+{
+    const struct splnode *x = self->root_;
+
+    while (x != NULL) {
+        int diff = self->compar_(z->entry_, x->entry_);
+
+        if (diff == 0) {
+            return x == z;
+        } else if (diff < 0) {
+            x = x->left_;
+        } else {
+            x = x->right_;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Unlinks 'z', which must be a node of the tree, after splaying it to the
+ * root. 'z' is trusted as is when NDEBUG is defined, and looked up to check
+ * it otherwise.
+ */
 static inline void *spltree_erase(struct spltree *self, struct splnode *z)
 {
     struct splnode *p;
-    struct splnode *x = spltree_find(self, z->entry_);
+    struct splnode *x;
     void *e;
 
-    if ((x == NULL) || (x != z)) {
+    if (z == NULL) {
         return NULL;
     }
 
-    e = x->entry_;
+#ifndef NDEBUG
+    if (!__spltree_has(self, z)) {
+        return NULL;
+    }
+#endif /* NDEBUG */
+
+    __SPLTREE_STATS(self, nr_erases_, 1);
+    __spltree_splay(self, z);
+    e = z->entry_;
     p = self->root_;
 
     if ((p->left_ != NULL) && (p->right_ != NULL)) {
@@ -329,7 +615,7 @@ static inline void *spltree_erase(struct spltree *self, struct splnode *z)
         return e;
     }
 
-    __splnode_update(self->root_);
+    __spltree_update(self, self->root_);
 
     return e;
 }
@@ -384,9 +670,13 @@ static inline struct splnode *spltree_lower_bound(const struct spltree *self,
     struct splnode *x = self->root_;
     struct splnode *result = NULL;
 
+    __SPLTREE_STATS(self, nr_finds_, 1);
+
     while (x != NULL) {
         int diff = self->compar_(ke, x->entry_);
 
+        __SPLTREE_STATS(self, nr_find_compars_, 1);
+
         if (diff <= 0) {
             result = x;
             x = x->left_;
@@ -404,9 +694,13 @@ static inline struct splnode *spltree_upper_bound(const struct spltree *self,
     struct splnode *x = self->root_;
     struct splnode *result = NULL;
 
+    __SPLTREE_STATS(self, nr_finds_, 1);
+
     while (x != NULL) {
         int diff = self->compar_(ke, x->entry_);
 
+        __SPLTREE_STATS(self, nr_find_compars_, 1);
+
         if (diff < 0) {
             result = x;
             x = x->left_;
@@ -418,6 +712,67 @@ static inline struct splnode *spltree_upper_bound(const struct spltree *self,
     return result;
 }
 
+#ifdef SPLTREE_STATS
+static inline const struct tree_stats *spltree_stats(const struct spltree *self)
+{
+    return &self->stats_;
+}
+
+static inline void spltree_stats_reset(struct spltree *self)
+{
+    tree_stats_reset(&self->stats_);
+}
+#endif /* SPLTREE_STATS */
+
+/*
+ * Counts the nodes at each depth in hist[], the root at depth 0 and the ones
+ * at depth 'nr' - 1 or deeper in hist[nr - 1], and returns the height, 0 if
+ * the tree is empty. 'nr' must not be 0. O(n), without recursion.
+ */
+static inline size_t spltree_depth_histogram(const struct spltree *self,
+                                             size_t hist[], size_t nr)
+{
+    const struct splnode *x = self->root_;
+    size_t depth = 0, height = 0;
+
+    for (size_t i = 0; i < nr; i++) {
+        hist[i] = 0;
+    }
+
+    if (x == NULL) {
+        return 0;
+    }
+
+    for (; x->left_ != NULL; x = x->left_) {
+        depth++;
+    }
+
+    while (x != NULL) {
+        const struct splnode *parent;
+
+        hist[depth < nr ? depth : nr - 1]++;
+        height = depth + 1 > height ? depth + 1 : height;
+
+        if (x->right_ != NULL) {
+            for (x = x->right_, depth++; x->left_ != NULL; x = x->left_) {
+                depth++;
+            }
+
+            continue;
+        }
+
+        while (((parent = x->parent_) != NULL) && x == parent->right_) {
+            x = parent;
+            depth--;
+        }
+
+        x = parent;
+        depth--;
+    }
+
+    return height;
+}
+
 static inline bool spltree_validate(const struct spltree *self)
 {
     size_t size = 0;
@@ -0,0 +1,162 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Copyright (c) 2025 YOUNGJIN JOO (neoelec@gmail.com)
+ */
+
+/* Tree Statistics */
+#ifndef __RCN_C_TREE_STATS_H__
+#define __RCN_C_TREE_STATS_H__
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __cplusplus
+namespace rcn_c
+{
+#endif
+
+/*
+ * Operation counters, kept by bstree, avltree, rbtree and spltree built with
+ * BSTREE_STATS, AVLTREE_STATS, RBTREE_STATS or SPLTREE_STATS, and read with
+ * bstree_stats() and the like. Without, the trees keep and count nothing.
+ *
+ *  - nr_finds_, nr_find_compars_ : find, lower_bound and upper_bound calls,
+ *    and the comparisons they made.
+ *  - nr_inserts_ : entries linked, by any of the insert calls.
+ *  - nr_insert_compars_ : comparisons of the insert descents, duplicates
+ *    included.
+ *  - nr_erases_ : entries unlinked by erase, pop_front or pop_back.
+ *  - nr_rotations_ : single rotations, a double one counts 2.
+ *  - nr_fixups_ : rebalancing steps. Red-black fixup loop iterations, AVL
+ *    retracing steps, splay steps, bstree subtree rebuilds.
+ *  - nr_rebuilt_ : nodes relinked by the bstree rebuilds.
+ *
+ * The counters are bumped from const lookups as well, with relaxed atomic
+ * adds, so that concurrent readers (rbtree_latch.h, spltree_find_const()
+ * under a rwlock) lose no count. The lookup erase makes without NDEBUG, to
+ * check its node, is not counted.
+ */
+struct tree_stats {
+    uint64_t nr_finds_;
+    uint64_t nr_find_compars_;
+    uint64_t nr_inserts_;
+    uint64_t nr_insert_compars_;
+    uint64_t nr_erases_;
+    uint64_t nr_rotations_;
+    uint64_t nr_fixups_;
+    uint64_t nr_rebuilt_;
+};
+
+/*
+ * Relaxed atomic adds : the lookups are const and may run concurrently, and
+ * the counts need no ordering against anything else.
+ */
+#define TREE_STATS_ADD(stats, field, n)                               \
+    ((void)__atomic_fetch_add(&((struct tree_stats *)(stats))->field, \
+                              (uint64_t)(n), __ATOMIC_RELAXED))
+
+static inline uint64_t __tree_stats_load(const uint64_t *count)
+{
+    return __atomic_load_n(count, __ATOMIC_RELAXED);
+}
+
+static inline void tree_stats_reset(struct tree_stats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+static inline void __tree_stats_printf(char *buf, size_t size, int *len,
+                                       const char *fmt, ...)
+{
+    size_t off = (size_t)*len < size ? (size_t)*len : size;
+    va_list ap;
+
+    va_start(ap, fmt);
+    *len += vsnprintf(buf + off, size - off, fmt, ap);
+    va_end(ap);
+}
+
+/*
+ * Formats 'stats' and the depth histogram 'hist' of 'nr' buckets, as filled
+ * by rbtree_depth_histogram() and the like, for the tree called 'name', in
+ * the Prometheus text format. Either may be NULL. There are no TYPE lines,
+ * so that the text of several trees may be put together. The last bucket
+ * holds the deeper nodes as well : if it is not empty, _sum and _max are
+ * lower bounds.
+ *
+ * Returns the length of the whole text, as snprintf() does : 'buf' was too
+ * small if it is 'size' or more.
+ */
+static inline int tree_stats_format(char *buf, size_t size, const char *name,
+                                    const struct tree_stats *stats,
+                                    const size_t hist[], size_t nr)
+{
+    size_t count = 0, sum = 0, max = 0;
+    int len = 0;
+
+    if (size != 0) {
+        buf[0] = '\0';
+    }
+
+    if (stats != NULL) {
+        const struct {
+            const char *name_;
+            uint64_t value_;
+        } counter[] = {
+            { "finds", __tree_stats_load(&stats->nr_finds_) },
+            { "find_compars", __tree_stats_load(&stats->nr_find_compars_) },
+            { "inserts", __tree_stats_load(&stats->nr_inserts_) },
+            { "insert_compars", __tree_stats_load(&stats->nr_insert_compars_) },
+            { "erases", __tree_stats_load(&stats->nr_erases_) },
+            { "rotations", __tree_stats_load(&stats->nr_rotations_) },
+            { "fixups", __tree_stats_load(&stats->nr_fixups_) },
+            { "rebuilt_nodes", __tree_stats_load(&stats->nr_rebuilt_) },
+        };
+
+        for (size_t i = 0; i < sizeof(counter) / sizeof(counter[0]); i++) {
+            __tree_stats_printf(buf, size, &len,
+                                "rcn_tree_%s_total{tree=\"%s\"} %llu\n",
+                                counter[i].name_, name,
+                                (unsigned long long)counter[i].value_);
+        }
+    }
+
+    if (hist == NULL) {
+        return len;
+    }
+
+    for (size_t d = 0; d < nr; d++) {
+        count += hist[d];
+        sum += d * hist[d];
+        max = hist[d] != 0 ? d : max;
+
+        if (d + 1 < nr) {
+            __tree_stats_printf(buf, size, &len,
+                                "rcn_tree_depth_bucket{tree=\"%s\",le=\"%zu\"}"
+                                " %zu\n",
+                                name, d, count);
+        }
+    }
+
+    __tree_stats_printf(buf, size, &len,
+                        "rcn_tree_depth_bucket{tree=\"%s\",le=\"+Inf\"} %zu\n",
+                        name, count);
+
+    __tree_stats_printf(buf, size, &len,
+                        "rcn_tree_depth_sum{tree=\"%s\"} %zu\n"
+                        "rcn_tree_depth_count{tree=\"%s\"} %zu\n"
+                        "rcn_tree_depth_max{tree=\"%s\"} %zu\n",
+                        name, sum, name, count, name, max);
+
+    return len;
+}
+
+#ifdef __cplusplus
+}
+#endif /* namespace rcn_c */
+
+#endif /* __RCN_C_TREE_STATS_H__ */
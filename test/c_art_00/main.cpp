@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rcn_c/art.h"
+
+/* The key is held as raw bytes, so std::string orders it as the tree. */
+struct TestData {
+    TestData(const std::string &key)
+        : key_(key)
+    {
+    }
+
+    std::string key_;
+    rcn_c::artleaf leaf_;
+};
+
+class ArtTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        art_init(&tree_, _KeyOf);
+    }
+
+    void TearDown() override
+    {
+        art_clear(&tree_);
+    }
+
+    static const void *_KeyOf(const void *e, size_t *len)
+    {
+        auto d = (const TestData *)e;
+
+        *len = d->key_.size();
+
+        return d->key_.data();
+    }
+
+    static std::string _Key(uint64_t v)
+    {
+        uint8_t key[8];
+
+        rcn_c::art_key_u64(key, v);
+
+        return std::string((const char *)key, sizeof(key));
+    }
+
+    static const std::string &_Key(const rcn_c::artleaf *z)
+    {
+        return ((const TestData *)z->entry_)->key_;
+    }
+
+    TestData *New(const std::string &key)
+    {
+        data_.emplace_back(new TestData(key));
+
+        return data_.back().get();
+    }
+
+    int Insert(TestData *d)
+    {
+        return art_insert(&tree_, &d->leaf_, d);
+    }
+
+    rcn_c::artleaf *Find(const std::string &key)
+    {
+        return art_find(&tree_, key.data(), key.size());
+    }
+
+    /* Walks the tree both ways and checks it against 'ref'. */
+    void Check(const std::set<std::string> &ref)
+    {
+        std::vector<std::string> keys;
+        auto it = ref.begin();
+
+        ASSERT_TRUE(art_validate(&tree_));
+        ASSERT_EQ(art_size(&tree_), ref.size());
+
+        for (auto z = art_begin(&tree_); z != art_end(&tree_);
+             z = art_next(&tree_, z), it++) {
+            ASSERT_NE(it, ref.end());
+            ASSERT_EQ(_Key(z), *it);
+        }
+
+        ASSERT_EQ(it, ref.end());
+        ASSERT_EQ(art_for_each(
+                      &tree_,
+                      [](void *e, void *arg) {
+                          ((std::vector<std::string> *)arg)
+                              ->push_back(((TestData *)e)->key_);
+                      },
+                      &keys),
+                  ref.size());
+        ASSERT_TRUE(std::equal(keys.begin(), keys.end(), ref.begin()));
+
+        if (!ref.empty()) {
+            ASSERT_EQ(_Key(art_rbegin(&tree_)), *ref.rbegin());
+        }
+    }
+
+    rcn_c::art tree_;
+    std::vector<std::unique_ptr<TestData>> data_;
+};
+
+TEST_F(ArtTest, InitAndEmpty)
+{
+    ASSERT_TRUE(art_empty(&tree_));
+    ASSERT_EQ(Find("a"), nullptr);
+    ASSERT_EQ(art_lower_bound(&tree_, "a", 1), nullptr);
+    ASSERT_EQ(art_begin(&tree_), art_end(&tree_));
+    ASSERT_EQ(art_remove(&tree_, "a", 1), nullptr);
+    ASSERT_TRUE(art_validate(&tree_));
+}
+
+TEST_F(ArtTest, Integers)
+{
+    /* Dense keys : the last byte fills Node256s, shrunk back on erase. */
+    std::vector<uint64_t> values;
+    std::set<std::string> ref;
+
+    for (uint64_t v = 0; v < 2000; v++) {
+        values.push_back(v * 3 + (v >= 1000 ? 1ULL << 40 : 0));
+    }
+
+    std::shuffle(values.begin(), values.end(), std::mt19937(45));
+
+    for (uint64_t v : values) {
+        ASSERT_EQ(Insert(New(_Key(v))), 0);
+        ref.insert(_Key(v));
+    }
+
+    Check(ref);
+
+    for (uint64_t v : values) {
+        auto z = Find(_Key(v));
+
+        ASSERT_NE(z, nullptr);
+        ASSERT_EQ(_Key(z), _Key(v));
+        ASSERT_EQ(Find(_Key(v + 1)), nullptr);
+        ASSERT_EQ(_Key(art_lower_bound(&tree_, _Key(v).data(), 8)), _Key(v));
+    }
+
+    ASSERT_EQ(_Key(art_lower_bound(&tree_, _Key(2998).data(), 8)),
+              _Key((1ULL << 40) + 3000));
+    ASSERT_EQ(_Key(art_upper_bound(&tree_, _Key(3).data(), 8)), _Key(6));
+    ASSERT_EQ(art_upper_bound(&tree_, _Key(values.size() * 3 + (1ULL << 40))
+                                           .data(), 8),
+              nullptr);
+
+    for (size_t i = 0; i < values.size(); i++) {
+        auto z = Find(_Key(values[i]));
+
+        ASSERT_EQ(art_erase(&tree_, z), z->entry_);
+        ASSERT_EQ(Find(_Key(values[i])), nullptr);
+        ref.erase(_Key(values[i]));
+
+        if (i % 97 == 0) {
+            Check(ref);
+        }
+    }
+
+    Check(ref);
+    ASSERT_EQ(tree_.root_, nullptr);
+}
+
+TEST_F(ArtTest, RandomStringsAgainstSet)
+{
+    /* Long shared paths, a few bytes apart, and the upper half of a byte. */
+    const char alphabet[] = { 'a', 'b', 'c', '\xfe' };
+    std::set<std::string> ref;
+    std::mt19937 gen(45);
+
+    auto random_string = [&](bool terminated) {
+        std::string s = gen() % 2 ? "session/user/" : "";
+
+        for (size_t n = gen() % 13; n > 0; n--) {
+            s += alphabet[gen() % sizeof(alphabet)];
+        }
+
+        return terminated ? s + '\0' : s;
+    };
+
+    for (int i = 0; i < 20000; i++) {
+        std::string key = random_string(true);
+        auto z = Find(key);
+
+        ASSERT_EQ(z != nullptr, ref.count(key) != 0);
+
+        if (z == nullptr) {
+            ASSERT_EQ(Insert(New(key)), 0);
+            ref.insert(key);
+        } else {
+            ASSERT_EQ(Insert(New(key)), -EEXIST);
+            ASSERT_EQ(art_remove(&tree_, key.data(), key.size()), z);
+            ref.erase(key);
+        }
+
+        if (i % 1000 == 0) {
+            Check(ref);
+        }
+    }
+
+    Check(ref);
+
+    /* Unterminated, the keys may end anywhere along a path. */
+    for (int i = 0; i < 20000; i++) {
+        std::string key = random_string(i % 2);
+        auto lower = ref.lower_bound(key);
+        auto upper = ref.upper_bound(key);
+        auto z = art_lower_bound(&tree_, key.data(), key.size());
+
+        ASSERT_EQ(z == nullptr, lower == ref.end());
+
+        if (z != nullptr) {
+            ASSERT_EQ(_Key(z), *lower);
+        }
+
+        z = art_upper_bound(&tree_, key.data(), key.size());
+        ASSERT_EQ(z == nullptr, upper == ref.end());
+
+        if (z != nullptr) {
+            ASSERT_EQ(_Key(z), *upper);
+        }
+    }
+}
+
+TEST_F(ArtTest, RejectPrefix)
+{
+    std::set<std::string> ref = { "abc", "abd", "xxxxxxxxxxxxxxxx1",
+                                  "xxxxxxxxxxxxxxxx2" };
+
+    for (auto &key : ref) {
+        ASSERT_EQ(Insert(New(key)), 0);
+    }
+
+    ASSERT_EQ(Insert(New("abc")), -EEXIST);
+
+    /* Ending in a path, at an inner node, or past a leaf. */
+    for (auto key : { "ab", "a", "xxxxx", "xxxxxxxxxxxxxxxx", "abcd" }) {
+        ASSERT_EQ(Insert(New(key)), -EINVAL);
+        ASSERT_EQ(Find(key), nullptr);
+    }
+
+    Check(ref);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,4 @@
+/* The art tests, with most of the paths only checked at the leaves. */
+#define ART_PREFIX_MAX 1
+
+#include "../c_art_00/main.cpp"
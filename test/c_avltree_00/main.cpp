@@ -1,5 +1,10 @@
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "rcn_c/avltree.h"
+#include "rcn_c/avltree_set.h"
 
 struct TestData {
     TestData(int value)
@@ -335,6 +340,431 @@ TEST_F(AVLTreeTest, AVLTreeValidation)
     ASSERT_TRUE(avltree_validate(tree_));
 }
 
+TEST_F(AVLTreeTest, Rank)
+{
+    auto data1 = new TestData(100);
+    auto data2 = new TestData(50);
+    auto data3 = new TestData(150);
+
+    avltree_insert(tree_, &data1->node_, data1);
+    avltree_insert(tree_, &data2->node_, data2);
+    avltree_insert(tree_, &data3->node_, data3);
+
+    auto key = new TestData(50);
+    ASSERT_EQ(avltree_rank(tree_, key), 0);
+
+    key->value_ = 100;
+    ASSERT_EQ(avltree_rank(tree_, key), 1);
+
+    key->value_ = 125;
+    ASSERT_EQ(avltree_rank(tree_, key), 2);
+
+    key->value_ = 200;
+    ASSERT_EQ(avltree_rank(tree_, key), 3);
+
+    delete key;
+}
+
+TEST_F(AVLTreeTest, OrderStatistic)
+{
+    const int nr_entries = 1000;
+    std::vector<TestData *> data;
+    std::vector<int> sorted;
+
+    for (int i = 0; i < nr_entries; i++) {
+        data.push_back(new TestData((i * 7919) % nr_entries));
+        avltree_insert(tree_, &data.back()->node_, data.back());
+    }
+
+    ASSERT_TRUE(avltree_validate(tree_));
+
+    for (int i = 0; i < nr_entries; i++) {
+        if (i % 3 == 0) {
+            avltree_erase(tree_, &data[i]->node_);
+            delete data[i];
+        } else {
+            sorted.push_back(data[i]->value_);
+        }
+    }
+
+    ASSERT_TRUE(avltree_validate(tree_));
+    std::sort(sorted.begin(), sorted.end());
+
+    auto key = new TestData(0);
+
+    for (size_t n = 0; n < sorted.size(); n++) {
+        ASSERT_EQ(((TestData *)avltree_at(tree_, n))->value_, sorted[n]);
+
+        key->value_ = sorted[n];
+        ASSERT_EQ(avltree_rank(tree_, key), n);
+    }
+
+    ASSERT_EQ(avltree_at(tree_, sorted.size()), nullptr);
+
+    delete key;
+}
+
+TEST_F(AVLTreeTest, BuildSorted)
+{
+    for (int nr_entries = 0; nr_entries < 300; nr_entries++) {
+        std::vector<TestData *> data;
+        std::vector<rcn_c::avlnode *> nodes;
+        std::vector<void *> entries;
+
+        for (int i = 0; i < nr_entries; i++) {
+            data.push_back(new TestData(i * 2));
+            nodes.push_back(&data.back()->node_);
+            entries.push_back(data.back());
+        }
+
+        avltree_build_sorted(tree_, nodes.data(), entries.data(), nr_entries);
+        ASSERT_TRUE(avltree_validate(tree_));
+        ASSERT_EQ(avltree_size(tree_), nr_entries);
+
+        for (int i = 0; i < nr_entries; i++) {
+            ASSERT_EQ(avltree_at(tree_, i), data[i]);
+        }
+
+        /* The result is a regular tree. */
+        auto extra = new TestData(-1);
+        avltree_insert(tree_, &extra->node_, extra);
+        ASSERT_TRUE(avltree_validate(tree_));
+
+        while (!avltree_empty(tree_)) {
+            delete (TestData *)avltree_pop_front(tree_);
+        }
+    }
+}
+
+TEST_F(AVLTreeTest, AppendSorted)
+{
+    const int nr_entries = 1000;
+
+    for (int i = 0; i < nr_entries; i++) {
+        auto data = new TestData(i);
+
+        ASSERT_EQ(avltree_append_sorted(tree_, &data->node_, data), 0);
+    }
+
+    ASSERT_TRUE(avltree_validate(tree_));
+
+    /* Out of order entries fall back to a regular insert. */
+    auto data = new TestData(nr_entries / 2);
+    ASSERT_EQ(avltree_append_sorted(tree_, &data->node_, data), -EEXIST);
+    data->value_ = -1;
+    ASSERT_EQ(avltree_append_sorted(tree_, &data->node_, data), 0);
+    ASSERT_TRUE(avltree_validate(tree_));
+    ASSERT_EQ(avltree_size(tree_), nr_entries + 1);
+
+    for (int i = 0; i <= nr_entries; i++) {
+        ASSERT_EQ(((TestData *)avltree_at(tree_, i))->value_, i - 1);
+    }
+}
+
+
+TEST_F(AVLTreeTest, JoinSplit)
+{
+    const int nr_entries = 1000;
+    rcn_c::avltree right;
+
+    avltree_init(&right, _ValueCompare);
+
+    for (int i = 0; i < nr_entries; i++) {
+        auto data = new TestData(i);
+        avltree_insert(tree_, &data->node_, data);
+    }
+
+    auto key = new TestData(nr_entries / 3);
+    auto node = avltree_split(tree_, key, &right);
+
+    ASSERT_NE(node, nullptr);
+    ASSERT_EQ(((TestData *)node->entry_)->value_, nr_entries / 3);
+    ASSERT_TRUE(avltree_validate(tree_));
+    ASSERT_TRUE(avltree_validate(&right));
+    ASSERT_EQ(avltree_size(tree_), nr_entries / 3);
+    ASSERT_EQ(avltree_size(&right), nr_entries - nr_entries / 3 - 1);
+    ASSERT_EQ(((TestData *)avltree_back(tree_))->value_, nr_entries / 3 - 1);
+    ASSERT_EQ(((TestData *)avltree_front(&right))->value_, nr_entries / 3 + 1);
+
+    avltree_join(tree_, node, node->entry_, &right);
+    ASSERT_TRUE(avltree_validate(tree_));
+    ASSERT_TRUE(avltree_empty(&right));
+    ASSERT_EQ(avltree_size(tree_), nr_entries);
+
+    key->value_ = -1;
+    ASSERT_EQ(avltree_split(tree_, key, &right), nullptr);
+    ASSERT_TRUE(avltree_empty(tree_));
+    ASSERT_EQ(avltree_size(&right), nr_entries);
+
+    avltree_concat(tree_, &right);
+    ASSERT_TRUE(avltree_validate(tree_));
+    ASSERT_EQ(avltree_size(tree_), nr_entries);
+
+    for (int i = 0; i < nr_entries; i++) {
+        ASSERT_EQ(((TestData *)avltree_at(tree_, i))->value_, i);
+    }
+
+    delete key;
+}
+
+TEST_F(AVLTreeTest, SetOperations)
+{
+    const int nr_entries = 1000;
+    rcn_c::avltree other, rest;
+    std::vector<int> a, b, expected;
+
+    avltree_init(&other, _ValueCompare);
+    avltree_init(&rest, _ValueCompare);
+
+    auto values = [](rcn_c::avltree *tree) {
+        std::vector<int> v;
+
+        for (auto x = avltree_begin(tree); x != avltree_end(tree);
+             x = avltree_next(tree, x)) {
+            v.push_back(((TestData *)x->entry_)->value_);
+        }
+
+        return v;
+    };
+
+    auto fill = [this, &a, &b, &other]() {
+        a.clear();
+        b.clear();
+
+        for (int i = 0; i < nr_entries; i++) {
+            auto data = new TestData(i * 2);
+            avltree_insert(tree_, &data->node_, data);
+            a.push_back(i * 2);
+
+            data = new TestData(i * 3);
+            avltree_insert(&other, &data->node_, data);
+            b.push_back(i * 3);
+        }
+    };
+
+    auto drain = [](rcn_c::avltree *tree) {
+        while (!avltree_empty(tree)) {
+            delete (TestData *)avltree_pop_front(tree);
+        }
+    };
+
+    fill();
+    avltree_union(tree_, &other, &other);
+    ASSERT_TRUE(avltree_validate(tree_));
+    ASSERT_TRUE(avltree_validate(&other));
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                   std::back_inserter(expected));
+    ASSERT_EQ(values(tree_), expected);
+    expected.clear();
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                          std::back_inserter(expected));
+    ASSERT_EQ(values(&other), expected);
+    drain(tree_);
+    drain(&other);
+
+    fill();
+    avltree_intersection(tree_, &other, &rest);
+    ASSERT_TRUE(avltree_validate(tree_));
+    ASSERT_TRUE(avltree_validate(&rest));
+    ASSERT_EQ(values(tree_), expected);
+    ASSERT_EQ(values(&other), b);
+    expected.clear();
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                        std::back_inserter(expected));
+    ASSERT_EQ(values(&rest), expected);
+    drain(tree_);
+    drain(&rest);
+    drain(&other);
+
+    fill();
+    avltree_difference(tree_, &other, &rest);
+    ASSERT_TRUE(avltree_validate(tree_));
+    ASSERT_TRUE(avltree_validate(&rest));
+    ASSERT_EQ(values(tree_), expected);
+    drain(&rest);
+    drain(&other);
+}
+
+
+TEST_F(AVLTreeTest, InsertHint)
+{
+    const int nr_entries = 1000;
+    rcn_c::avlnode *hint = nullptr;
+
+    /* Ascending with the last node as the hint, then the gaps after them. */
+    for (int i = 0; i < nr_entries; i += 2) {
+        auto data = new TestData(i);
+
+        ASSERT_EQ(avltree_insert_hint(tree_, hint, &data->node_, data), 0);
+        hint = &data->node_;
+    }
+
+    for (int i = 1; i < nr_entries; i += 2) {
+        TestData key(i - 1);
+        auto data = new TestData(i);
+
+        hint = avltree_find(tree_, &key);
+        ASSERT_EQ(avltree_insert_hint(tree_, hint, &data->node_, data), 0);
+    }
+
+    /* A wrong hint falls back to a plain insert. */
+    auto data = new TestData(-1);
+    TestData dup(500);
+
+    ASSERT_EQ(avltree_insert_hint(tree_, hint, &data->node_, data), 0);
+    ASSERT_EQ(avltree_insert_hint(tree_, nullptr, &dup.node_, &dup), -EEXIST);
+    ASSERT_EQ(avltree_size(tree_), nr_entries + 1);
+    ASSERT_TRUE(avltree_validate(tree_));
+
+    int i = -1;
+
+    for (auto x = avltree_begin(tree_); x != avltree_end(tree_);
+         x = avltree_next(tree_, x)) {
+        ASSERT_EQ(((TestData *)x->entry_)->value_, i++);
+    }
+
+    ASSERT_EQ(i, nr_entries);
+}
+
+TEST_F(AVLTreeTest, InsertOrGet)
+{
+    auto data1 = new TestData(100);
+    auto data2 = new TestData(100);
+    auto data3 = new TestData(50);
+
+    ASSERT_EQ(avltree_insert_or_get(tree_, &data1->node_, data1),
+              &data1->node_);
+    ASSERT_EQ(avltree_insert_or_get(tree_, &data2->node_, data2),
+              &data1->node_);
+    ASSERT_EQ(avltree_insert_or_get(tree_, &data3->node_, data3),
+              &data3->node_);
+    ASSERT_EQ(avltree_size(tree_), 2);
+    ASSERT_TRUE(avltree_validate(tree_));
+
+    delete data2;
+}
+
+TEST_F(AVLTreeTest, RandomInsertErase)
+{
+    std::vector<TestData> data;
+    std::vector<bool> linked(512, false);
+    unsigned int seed = 38;
+
+    data.reserve(linked.size());
+
+    for (size_t i = 0; i < linked.size(); i++) {
+        data.emplace_back(i);
+    }
+
+    for (int i = 0; i < 20000; i++) {
+        size_t k;
+
+        seed = seed * 1103515245 + 12345;
+        k = (seed >> 16) % linked.size();
+
+        if (linked[k]) {
+            ASSERT_EQ(avltree_erase(tree_, &data[k].node_), &data[k]);
+        } else {
+            ASSERT_EQ(avltree_insert(tree_, &data[k].node_, &data[k]), 0);
+        }
+
+        linked[k] = !linked[k];
+        ASSERT_TRUE(avltree_validate(tree_));
+    }
+
+    ASSERT_EQ(avltree_size(tree_),
+              (size_t)std::count(linked.begin(), linked.end(), true));
+
+    for (size_t k = 0; k < linked.size(); k++) {
+        if (linked[k]) {
+            avltree_erase(tree_, &data[k].node_);
+        }
+    }
+
+    ASSERT_TRUE(avltree_empty(tree_));
+}
+
+static void _CollectValue(void *e, void *arg)
+{
+    ((std::vector<int> *)arg)->push_back(((TestData *)e)->value_);
+}
+
+TEST_F(AVLTreeTest, Range)
+{
+    std::vector<int> ref;
+
+    /* Even values 0 .. 398, inserted in a scattered order. */
+    for (int i = 0; i < 200; i++) {
+        auto d = new TestData((i * 37 % 200) * 2);
+
+        avltree_insert(tree_, &d->node_, d);
+        ref.push_back(i * 2);
+    }
+
+    for (int lo = -3; lo < 403; lo += 7) {
+        for (int hi = lo - 5; hi < 410; hi += 11) {
+            TestData key_lo(lo), key_hi(hi);
+            std::vector<int> values;
+            auto first = std::lower_bound(ref.begin(), ref.end(), lo);
+            auto last = std::lower_bound(ref.begin(), ref.end(), hi);
+            std::vector<int> expected(first, std::max(first, last));
+
+            ASSERT_EQ(avltree_for_each_range(tree_, &key_lo, &key_hi,
+                                            _CollectValue, &values),
+                      expected.size());
+            ASSERT_EQ(values, expected);
+            ASSERT_EQ(avltree_count_range(tree_, &key_lo, &key_hi),
+                      expected.size());
+        }
+    }
+
+    /* Cut out ranges until little is left. */
+    for (int lo = 5, round = 0; round < 12; lo = (lo + 97) % 400, round++) {
+        TestData key_lo(lo), key_hi(lo + 30 + round * 3);
+        auto first = std::lower_bound(ref.begin(), ref.end(), key_lo.value_);
+        auto last = std::lower_bound(ref.begin(), ref.end(), key_hi.value_);
+        std::vector<int> expected(first, last), values;
+        rcn_c::avltree out;
+
+        avltree_init(&out, _ValueCompare);
+        ASSERT_EQ(avltree_erase_range(tree_, &key_lo, &key_hi, &out),
+                  expected.size());
+        ref.erase(first, last);
+
+        ASSERT_TRUE(avltree_validate(tree_));
+        ASSERT_TRUE(avltree_validate(&out));
+        ASSERT_EQ(avltree_size(tree_), ref.size());
+
+        for (auto x = avltree_begin(&out); x != avltree_end(&out);
+             x = avltree_next(&out, x)) {
+            values.push_back(((TestData *)x->entry_)->value_);
+        }
+
+        ASSERT_EQ(values, expected);
+
+        while (!avltree_empty(&out)) {
+            delete (TestData *)avltree_pop_front(&out);
+        }
+    }
+
+    std::vector<int> values;
+
+    for (auto x = avltree_begin(tree_); x != avltree_end(tree_);
+         x = avltree_next(tree_, x)) {
+        values.push_back(((TestData *)x->entry_)->value_);
+    }
+
+    ASSERT_EQ(values, ref);
+
+    TestData key_lo(1000), key_hi(0);
+    rcn_c::avltree out;
+
+    avltree_init(&out, _ValueCompare);
+    ASSERT_EQ(avltree_erase_range(tree_, &key_lo, &key_hi, &out), 0);
+    ASSERT_TRUE(avltree_empty(&out));
+    ASSERT_EQ(avltree_size(tree_), ref.size());
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,9 @@
+/* The avltree tests, with the height packed with the subtree size. */
+#define AVLTREE_COMPACT
+
+#include "../c_avltree_00/main.cpp"
+
+TEST(AvlTreeCompactTest, NodeSize)
+{
+    EXPECT_EQ(sizeof(rcn_c::avlnode), 5 * sizeof(void *));
+}
@@ -0,0 +1,150 @@
+/* The avltree tests, with a key prefix cached in the nodes. */
+#define AVLTREE_KEY_PREFIX
+
+#include <cstring>
+#include <set>
+#include <string>
+
+#include "../c_avltree_00/main.cpp"
+
+struct KeyedData {
+    rcn_c::avlnode node_;
+    std::string name_;
+};
+
+static size_t nr_compar;
+
+static int NameCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const KeyedData *)_ke;
+    auto in_tree = (const KeyedData *)_in_tree;
+
+    nr_compar++;
+
+    return strcmp(ke->name_.c_str(), in_tree->name_.c_str());
+}
+
+/* The first 8 bytes, big endian, so that integer order is string order. */
+static uint64_t NamePrefix(const void *_e)
+{
+    auto e = (const KeyedData *)_e;
+    uint64_t key = 0;
+
+    for (size_t i = 0; i < 8; i++) {
+        key <<= 8;
+        key |= i < e->name_.size() ? (unsigned char)e->name_[i] : 0;
+    }
+
+    return key;
+}
+
+/* Half of the names share their first 8 bytes, to force ties. */
+static std::string RandomName(unsigned int *seed)
+{
+    std::string name = rand_r(seed) % 2 ? "sharedpf" : "";
+
+    for (int i = 0, n = 1 + rand_r(seed) % 6; i < n; i++) {
+        name += 'a' + rand_r(seed) % 26;
+    }
+
+    return name;
+}
+
+TEST(AVLTreeKeyedTest, AgainstStdSet)
+{
+    std::vector<KeyedData> data(3000);
+    std::set<std::string> ref;
+    unsigned int seed = 1;
+    rcn_c::avltree tree, right;
+
+    avltree_init_keyed(&tree, NameCompare, NamePrefix);
+
+    for (auto &d : data) {
+        d.name_ = RandomName(&seed);
+        ASSERT_EQ(avltree_insert(&tree, &d.node_, &d) == 0,
+                  ref.insert(d.name_).second);
+    }
+
+    ASSERT_TRUE(avltree_validate(&tree));
+
+    for (int i = 0; i < 3000; i++) {
+        KeyedData key;
+        auto it = ref.lower_bound(key.name_ = RandomName(&seed));
+        auto x = avltree_lower_bound(&tree, &key);
+
+        ASSERT_EQ(avltree_find(&tree, &key) == nullptr,
+                  ref.count(key.name_) == 0);
+        ASSERT_EQ(avltree_rank(&tree, &key), std::distance(ref.begin(), it));
+
+        if (it == ref.end()) {
+            ASSERT_EQ(x, nullptr);
+        } else {
+            ASSERT_EQ(((KeyedData *)x->entry_)->name_, *it);
+        }
+    }
+
+    /* Split at a shared prefix and merge back. */
+    KeyedData pivot;
+
+    pivot.name_ = "sharedpfm0";
+    avltree_init_keyed(&right, NameCompare, NamePrefix);
+    ASSERT_EQ(avltree_split(&tree, &pivot, &right), nullptr);
+    ASSERT_TRUE(avltree_validate(&tree));
+    ASSERT_TRUE(avltree_validate(&right));
+    ASSERT_EQ(avltree_size(&tree),
+              std::distance(ref.begin(), ref.lower_bound(pivot.name_)));
+    avltree_concat(&tree, &right);
+    ASSERT_EQ(avltree_size(&tree), ref.size());
+    ASSERT_TRUE(avltree_validate(&tree));
+
+    for (auto &d : data) {
+        auto x = avltree_find(&tree, &d);
+
+        if (x == &d.node_) {
+            avltree_erase(&tree, x);
+            ref.erase(d.name_);
+        }
+    }
+
+    ASSERT_TRUE(avltree_empty(&tree));
+    ASSERT_TRUE(ref.empty());
+}
+
+TEST(AVLTreeKeyedTest, FewerComparCalls)
+{
+    std::vector<KeyedData> data(1000);
+    rcn_c::avltree keyed, plain;
+    size_t nr_keyed, nr_plain;
+
+    avltree_init_keyed(&keyed, NameCompare, NamePrefix);
+    avltree_init(&plain, NameCompare);
+
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i].name_ = std::to_string(1000000 + i * 7);
+        avltree_insert(&keyed, &data[i].node_, &data[i]);
+    }
+
+    nr_compar = 0;
+
+    for (auto &d : data) {
+        ASSERT_EQ(avltree_find(&keyed, &d), &d.node_);
+    }
+
+    nr_keyed = nr_compar;
+
+    for (auto &d : data) {
+        avltree_insert(&plain, &d.node_, &d);
+    }
+
+    nr_compar = 0;
+
+    for (auto &d : data) {
+        ASSERT_EQ(avltree_find(&plain, &d), &d.node_);
+    }
+
+    nr_plain = nr_compar;
+
+    /* Names of 7 digits fit the prefix : compar only confirms the match. */
+    ASSERT_EQ(nr_keyed, data.size());
+    ASSERT_GT(nr_plain, nr_keyed * 5);
+}
@@ -0,0 +1,98 @@
+/* The avltree tests, with the operation counters kept. */
+#define AVLTREE_STATS
+
+#include "../c_avltree_00/main.cpp"
+
+TEST_F(AVLTreeTest, Stats)
+{
+    const int nr_entries = 1000;
+    std::vector<TestData *> data;
+    auto stats = avltree_stats(tree_);
+
+    /* In order, then from both ends inwards for the double rotations. */
+    for (int i = 0; i < nr_entries; i++) {
+        int value = i < nr_entries / 2 ? i : 3 * nr_entries / 2 - i + 9999;
+
+        data.push_back(new TestData(value));
+        ASSERT_EQ(avltree_insert(tree_, &data.back()->node_, data.back()), 0);
+    }
+
+    ASSERT_EQ(stats->nr_inserts_, nr_entries);
+    ASSERT_GE(stats->nr_insert_compars_, nr_entries - 1);
+    ASSERT_GT(stats->nr_rotations_, 0);
+    ASSERT_GE(stats->nr_fixups_, nr_entries - 1);
+    ASSERT_EQ(stats->nr_finds_, 0);
+
+    avltree_stats_reset(tree_);
+
+    for (int i = 0; i < nr_entries; i++) {
+        ASSERT_EQ(avltree_find(tree_, data[i])->entry_, data[i]);
+    }
+
+    /* 1.44 * log2(n + 2) bounds the height of an AVL tree. */
+    ASSERT_EQ(stats->nr_finds_, nr_entries);
+    ASSERT_GE(stats->nr_find_compars_, nr_entries);
+    ASSERT_LE(stats->nr_find_compars_, nr_entries * 15);
+
+    for (int i = 0; i < nr_entries; i += 2) {
+        ASSERT_EQ(avltree_erase(tree_, &data[i]->node_), data[i]);
+        delete data[i];
+    }
+
+    /* The lookup erase checks its node with is not counted. */
+    ASSERT_EQ(stats->nr_erases_, nr_entries / 2);
+    ASSERT_EQ(stats->nr_finds_, nr_entries);
+    ASSERT_EQ(stats->nr_inserts_, 0);
+}
+
+TEST_F(AVLTreeTest, StatsRotations)
+{
+    auto stats = avltree_stats(tree_);
+    TestData a(1), b(2), c(3);
+
+    /* 3, 1, 2 : a left-right case, the one double rotation. */
+    avltree_insert(tree_, &c.node_, &c);
+    avltree_insert(tree_, &a.node_, &a);
+    ASSERT_EQ(stats->nr_rotations_, 0);
+    avltree_insert(tree_, &b.node_, &b);
+    ASSERT_EQ(stats->nr_rotations_, 2);
+    ASSERT_EQ(tree_->root_, &b.node_);
+
+    avltree_clear(tree_);
+    avltree_stats_reset(tree_);
+
+    /* 1, 2, 3 : a right-right case, a single rotation. */
+    avltree_insert(tree_, &a.node_, &a);
+    avltree_insert(tree_, &b.node_, &b);
+    avltree_insert(tree_, &c.node_, &c);
+    ASSERT_EQ(stats->nr_rotations_, 1);
+    ASSERT_EQ(tree_->root_, &b.node_);
+
+    avltree_clear(tree_);
+}
+
+TEST_F(AVLTreeTest, DepthHistogram)
+{
+    const int nr_entries = 1023;
+    size_t hist[16];
+
+    ASSERT_EQ(avltree_depth_histogram(tree_, hist, 16), 0);
+    ASSERT_EQ(std::count(hist, hist + 16, 0), 16);
+
+    /* In order, 2^k - 1 entries make a perfect tree. */
+    for (int i = 0; i < nr_entries; i++) {
+        auto data = new TestData(i);
+
+        avltree_insert(tree_, &data->node_, data);
+    }
+
+    ASSERT_EQ(avltree_depth_histogram(tree_, hist, 16), 10);
+
+    for (size_t d = 0; d < 16; d++) {
+        ASSERT_EQ(hist[d], d < 10 ? 1u << d : 0);
+    }
+
+    ASSERT_EQ(avltree_depth_histogram(tree_, hist, 4), 10);
+    ASSERT_EQ(hist[2], 4);
+    ASSERT_EQ(hist[3], nr_entries - 7);
+}
@@ -0,0 +1,81 @@
+/*
+ * The avltree tests, with the set operations forking down to small subtrees,
+ * as on a machine of 16 CPUs.
+ */
+#define AVLTREE_FORK_GRAIN 8
+#define AVLTREE_FORK_CPUS 16
+
+#include <random>
+#include <set>
+
+#include "../c_avltree_00/main.cpp"
+
+/* Random sets of all sizes, checked against std::set. */
+TEST_F(AVLTreeTest, ForkedSetOperations)
+{
+    std::mt19937 gen(33);
+
+    auto values = [](rcn_c::avltree *tree) {
+        std::set<int> v;
+
+        for (auto x = avltree_begin(tree); x != avltree_end(tree);
+             x = avltree_next(tree, x)) {
+            v.insert(((TestData *)x->entry_)->value_);
+        }
+
+        return v;
+    };
+
+    auto fill = [&gen](rcn_c::avltree *tree, size_t nr, std::set<int> &v) {
+        for (size_t i = 0; i < nr; i++) {
+            auto data = new TestData(gen() % 8000);
+
+            if (avltree_insert(tree, &data->node_, data) == 0) {
+                v.insert(data->value_);
+            } else {
+                delete data;
+            }
+        }
+    };
+
+    auto drain = [](rcn_c::avltree *tree) {
+        while (!avltree_empty(tree)) {
+            delete (TestData *)avltree_pop_front(tree);
+        }
+    };
+
+    for (int round = 0; round < 30; round++) {
+        rcn_c::avltree other, rest;
+        std::set<int> a, b, both, only;
+
+        avltree_init(&other, _ValueCompare);
+        avltree_init(&rest, _ValueCompare);
+        fill(tree_, gen() % 4000, a);
+        fill(&other, gen() % 4000, b);
+
+        for (int v : a) {
+            (b.count(v) ? both : only).insert(v);
+        }
+
+        if (round % 3 == 0) {
+            avltree_union(tree_, &other, &rest);
+            a.insert(b.begin(), b.end());
+            ASSERT_EQ(values(tree_), a);
+            ASSERT_EQ(values(&rest), both);
+        } else if (round % 3 == 1) {
+            avltree_intersection(tree_, &other, &rest);
+            ASSERT_EQ(values(tree_), both);
+            ASSERT_EQ(values(&rest), only);
+        } else {
+            avltree_difference(tree_, &other, &rest);
+            ASSERT_EQ(values(tree_), only);
+            ASSERT_EQ(values(&rest), both);
+        }
+
+        ASSERT_TRUE(avltree_validate(tree_));
+        ASSERT_TRUE(avltree_validate(&rest));
+        drain(tree_);
+        drain(&other);
+        drain(&rest);
+    }
+}
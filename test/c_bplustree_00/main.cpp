@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rcn_c/bplustree.h"
+
+struct TestData {
+    TestData(int value)
+        : value_(value)
+    {
+    }
+
+    int value_;
+};
+
+class BPlusTreeTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        tree_ = new rcn_c::bplustree;
+        bplustree_init(tree_, _ValueCompare);
+    }
+
+    void TearDown() override
+    {
+        while (!bplustree_empty(tree_)) {
+            delete (TestData *)bplustree_pop_front(tree_);
+        }
+
+        bplustree_clear(tree_);
+        delete tree_;
+    }
+
+    static int _ValueCompare(const void *_ke, const void *_in_tree)
+    {
+        auto ke = (const TestData *)_ke;
+        auto in_tree = (const TestData *)_in_tree;
+
+        if (ke->value_ < in_tree->value_) {
+            return -1;
+        }
+
+        if (ke->value_ > in_tree->value_) {
+            return 1;
+        }
+
+        return 0;
+    }
+
+    int _Value(void **x)
+    {
+        return ((TestData *)*x)->value_;
+    }
+
+    rcn_c::bplustree *tree_;
+};
+
+TEST_F(BPlusTreeTest, InitAndEmpty)
+{
+    ASSERT_TRUE(bplustree_empty(tree_));
+    ASSERT_EQ(bplustree_begin(tree_), bplustree_end(tree_));
+    ASSERT_EQ(bplustree_front(tree_), nullptr);
+    ASSERT_TRUE(bplustree_validate(tree_));
+}
+
+TEST_F(BPlusTreeTest, InsertAndFind)
+{
+    auto data1 = new TestData(100);
+    auto data2 = new TestData(50);
+    auto data3 = new TestData(150);
+
+    ASSERT_EQ(bplustree_insert(tree_, data1), 0);
+    ASSERT_EQ(bplustree_insert(tree_, data2), 0);
+    ASSERT_EQ(bplustree_insert(tree_, data3), 0);
+    ASSERT_EQ(bplustree_insert(tree_, data1), -EEXIST);
+    ASSERT_EQ(bplustree_size(tree_), 3);
+
+    TestData key(100);
+    void **found = bplustree_find(tree_, &key);
+    ASSERT_NE(found, nullptr);
+    ASSERT_EQ(*found, data1);
+
+    key.value_ = 20;
+    ASSERT_EQ(bplustree_find(tree_, &key), bplustree_end(tree_));
+}
+
+TEST_F(BPlusTreeTest, BeginNextEnd)
+{
+    const int nr_entries = 1000;
+
+    for (int i = nr_entries - 1; i >= 0; i--) {
+        ASSERT_EQ(bplustree_insert(tree_, new TestData(i)), 0);
+    }
+
+    ASSERT_TRUE(bplustree_validate(tree_));
+
+    int i = 0;
+
+    for (void **x = bplustree_begin(tree_); x != bplustree_end(tree_);
+         x = bplustree_next(tree_, x)) {
+        ASSERT_EQ(_Value(x), i++);
+    }
+
+    ASSERT_EQ(i, nr_entries);
+
+    for (void **x = bplustree_rbegin(tree_); x != bplustree_rend(tree_);
+         x = bplustree_prev(tree_, x)) {
+        ASSERT_EQ(_Value(x), --i);
+    }
+
+    ASSERT_EQ(i, 0);
+    ASSERT_EQ(((TestData *)bplustree_front(tree_))->value_, 0);
+    ASSERT_EQ(((TestData *)bplustree_back(tree_))->value_, nr_entries - 1);
+    ASSERT_EQ(((TestData *)bplustree_at(tree_, 500))->value_, 500);
+    ASSERT_EQ(bplustree_at(tree_, nr_entries), nullptr);
+}
+
+TEST_F(BPlusTreeTest, LowerUpperBound)
+{
+    for (int i = 0; i < 1000; i += 2) {
+        bplustree_insert(tree_, new TestData(i));
+    }
+
+    for (int i = -1; i < 1000; i++) {
+        TestData key(i);
+        void **lower = bplustree_lower_bound(tree_, &key);
+        void **upper = bplustree_upper_bound(tree_, &key);
+        int expected_lower = (i + 1) & ~1;
+        int expected_upper = (i + 2) & ~1;
+
+        if (expected_lower < 1000) {
+            ASSERT_NE(lower, nullptr);
+            ASSERT_EQ(_Value(lower), expected_lower);
+        } else {
+            ASSERT_EQ(lower, bplustree_end(tree_));
+        }
+
+        if (expected_upper < 1000) {
+            ASSERT_NE(upper, nullptr);
+            ASSERT_EQ(_Value(upper), expected_upper);
+        } else {
+            ASSERT_EQ(upper, bplustree_end(tree_));
+        }
+    }
+}
+
+TEST_F(BPlusTreeTest, Erase)
+{
+    const int nr_entries = 1000;
+
+    for (int i = 0; i < nr_entries; i++) {
+        bplustree_insert(tree_, new TestData(i));
+    }
+
+    for (int i = 0; i < nr_entries; i += 3) {
+        TestData key(i);
+        void **x = bplustree_find(tree_, &key);
+
+        ASSERT_NE(x, nullptr);
+        delete (TestData *)bplustree_erase(tree_, x);
+        ASSERT_EQ(bplustree_find(tree_, &key), bplustree_end(tree_));
+    }
+
+    ASSERT_TRUE(bplustree_validate(tree_));
+    ASSERT_EQ(bplustree_size(tree_), nr_entries - (nr_entries + 2) / 3);
+
+    while (!bplustree_empty(tree_)) {
+        delete (TestData *)bplustree_pop_back(tree_);
+        ASSERT_TRUE(bplustree_validate(tree_));
+    }
+
+    ASSERT_EQ(bplustree_begin(tree_), bplustree_end(tree_));
+}
+
+TEST_F(BPlusTreeTest, Random)
+{
+    std::vector<TestData> data;
+    std::set<int> expected;
+    std::mt19937 gen(0);
+
+    for (int i = 0; i < 4096; i++) {
+        data.emplace_back(i);
+    }
+
+    for (int round = 0; round < 20000; round++) {
+        TestData *d = &data[gen() % data.size()];
+
+        if (expected.count(d->value_) == 0) {
+            ASSERT_EQ(bplustree_insert(tree_, d), 0);
+            expected.insert(d->value_);
+        } else {
+            void **x = bplustree_find(tree_, d);
+
+            ASSERT_NE(x, nullptr);
+            ASSERT_EQ(bplustree_erase(tree_, x), d);
+            expected.erase(d->value_);
+        }
+
+        if (round % 1000 == 0) {
+            ASSERT_TRUE(bplustree_validate(tree_));
+        }
+    }
+
+    ASSERT_TRUE(bplustree_validate(tree_));
+    ASSERT_EQ(bplustree_size(tree_), expected.size());
+
+    auto it = expected.begin();
+
+    for (void **x = bplustree_begin(tree_); x != bplustree_end(tree_);
+         x = bplustree_next(tree_, x)) {
+        ASSERT_EQ(_Value(x), *it++);
+    }
+
+    /* The entries live in 'data' : drop them without deleting. */
+    bplustree_clear(tree_);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
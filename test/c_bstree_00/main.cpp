@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "rcn_c/bstree.h"
 
@@ -334,6 +337,175 @@ TEST_F(BinarySearchTreeTest, BinarySearchTreeValidation)
     ASSERT_TRUE(bstree_validate(tree_));
 }
 
+TEST_F(BinarySearchTreeTest, InsertHint)
+{
+    const int nr_entries = 1000;
+    rcn_c::bsnode *hint = nullptr;
+
+    /* Ascending with the last node as the hint, then the gaps after them. */
+    for (int i = 0; i < nr_entries; i += 2) {
+        auto data = new TestData(i);
+
+        ASSERT_EQ(bstree_insert_hint(tree_, hint, &data->node_, data), 0);
+        hint = &data->node_;
+    }
+
+    for (int i = 1; i < nr_entries; i += 2) {
+        TestData key(i - 1);
+        auto data = new TestData(i);
+
+        hint = bstree_find(tree_, &key);
+        ASSERT_EQ(bstree_insert_hint(tree_, hint, &data->node_, data), 0);
+    }
+
+    /* A wrong hint falls back to a plain insert. */
+    auto data = new TestData(-1);
+    TestData dup(500);
+
+    ASSERT_EQ(bstree_insert_hint(tree_, hint, &data->node_, data), 0);
+    ASSERT_EQ(bstree_insert_hint(tree_, nullptr, &dup.node_, &dup), -EEXIST);
+    ASSERT_EQ(bstree_size(tree_), nr_entries + 1);
+    ASSERT_TRUE(bstree_validate(tree_));
+
+    int i = -1;
+
+    for (auto x = bstree_begin(tree_); x != bstree_end(tree_);
+         x = bstree_next(tree_, x)) {
+        ASSERT_EQ(((TestData *)x->entry_)->value_, i++);
+    }
+
+    ASSERT_EQ(i, nr_entries);
+}
+
+TEST_F(BinarySearchTreeTest, InsertOrGet)
+{
+    auto data1 = new TestData(100);
+    auto data2 = new TestData(100);
+    auto data3 = new TestData(50);
+
+    ASSERT_EQ(bstree_insert_or_get(tree_, &data1->node_, data1), &data1->node_);
+    ASSERT_EQ(bstree_insert_or_get(tree_, &data2->node_, data2), &data1->node_);
+    ASSERT_EQ(bstree_insert_or_get(tree_, &data3->node_, data3), &data3->node_);
+    ASSERT_EQ(bstree_size(tree_), 2);
+    ASSERT_TRUE(bstree_validate(tree_));
+
+    delete data2;
+}
+
+static size_t _Height(const rcn_c::bsnode *x)
+{
+    return x == nullptr ? 0
+                        : 1 + std::max(_Height(x->left_), _Height(x->right_));
+}
+
+TEST_F(BinarySearchTreeTest, Rebalance)
+{
+    const int nr_entries = 1000;
+
+    bstree_rebalance(tree_);
+    ASSERT_TRUE(bstree_empty(tree_));
+
+    for (int i = 0; i < nr_entries; i++) {
+        auto data = new TestData(i);
+
+        bstree_insert(tree_, &data->node_, data);
+    }
+
+    bstree_rebalance(tree_);
+    ASSERT_TRUE(bstree_validate(tree_));
+    ASSERT_EQ(_Height(tree_->root_), 10);
+
+    int i = 0;
+
+    for (auto x = bstree_begin(tree_); x != bstree_end(tree_);
+         x = bstree_next(tree_, x)) {
+        ASSERT_EQ(((TestData *)x->entry_)->value_, i++);
+    }
+
+    ASSERT_EQ(i, nr_entries);
+}
+
+static void _CollectValue(void *e, void *arg)
+{
+    ((std::vector<int> *)arg)->push_back(((TestData *)e)->value_);
+}
+
+TEST_F(BinarySearchTreeTest, Range)
+{
+    std::vector<int> ref;
+
+    /* Even values 0 .. 398, inserted in a scattered order. */
+    for (int i = 0; i < 200; i++) {
+        auto d = new TestData((i * 37 % 200) * 2);
+
+        bstree_insert(tree_, &d->node_, d);
+        ref.push_back(i * 2);
+    }
+
+    for (int lo = -3; lo < 403; lo += 7) {
+        for (int hi = lo - 5; hi < 410; hi += 11) {
+            TestData key_lo(lo), key_hi(hi);
+            std::vector<int> values;
+            auto first = std::lower_bound(ref.begin(), ref.end(), lo);
+            auto last = std::lower_bound(ref.begin(), ref.end(), hi);
+            std::vector<int> expected(first, std::max(first, last));
+
+            ASSERT_EQ(bstree_for_each_range(tree_, &key_lo, &key_hi,
+                                            _CollectValue, &values),
+                      expected.size());
+            ASSERT_EQ(values, expected);
+            ASSERT_EQ(bstree_count_range(tree_, &key_lo, &key_hi),
+                      expected.size());
+        }
+    }
+
+    /* Cut out ranges until little is left. */
+    for (int lo = 5, round = 0; round < 12; lo = (lo + 97) % 400, round++) {
+        TestData key_lo(lo), key_hi(lo + 30 + round * 3);
+        auto first = std::lower_bound(ref.begin(), ref.end(), key_lo.value_);
+        auto last = std::lower_bound(ref.begin(), ref.end(), key_hi.value_);
+        std::vector<int> expected(first, last), values;
+        rcn_c::bstree out;
+
+        bstree_init(&out, _ValueCompare);
+        ASSERT_EQ(bstree_erase_range(tree_, &key_lo, &key_hi, &out),
+                  expected.size());
+        ref.erase(first, last);
+
+        ASSERT_TRUE(bstree_validate(tree_));
+        ASSERT_TRUE(bstree_validate(&out));
+        ASSERT_EQ(bstree_size(tree_), ref.size());
+
+        for (auto x = bstree_begin(&out); x != bstree_end(&out);
+             x = bstree_next(&out, x)) {
+            values.push_back(((TestData *)x->entry_)->value_);
+        }
+
+        ASSERT_EQ(values, expected);
+
+        while (!bstree_empty(&out)) {
+            delete (TestData *)bstree_pop_front(&out);
+        }
+    }
+
+    std::vector<int> values;
+
+    for (auto x = bstree_begin(tree_); x != bstree_end(tree_);
+         x = bstree_next(tree_, x)) {
+        values.push_back(((TestData *)x->entry_)->value_);
+    }
+
+    ASSERT_EQ(values, ref);
+
+    TestData key_lo(1000), key_hi(0);
+    rcn_c::bstree out;
+
+    bstree_init(&out, _ValueCompare);
+    ASSERT_EQ(bstree_erase_range(tree_, &key_lo, &key_hi, &out), 0);
+    ASSERT_TRUE(bstree_empty(&out));
+    ASSERT_EQ(bstree_size(tree_), ref.size());
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,54 @@
+/* The bstree tests, kept balanced as a scapegoat tree. */
+#define BSTREE_SCAPEGOAT
+
+#include <cmath>
+#include <random>
+
+#include "../c_bstree_00/main.cpp"
+
+/* The deepest node allowed for 'n' nodes, plus one for the root level. */
+static size_t _MaxHeight(size_t n)
+{
+    return (size_t)(std::log((double)n) /
+                    std::log(100.0 / BSTREE_SCAPEGOAT_ALPHA)) +
+           1;
+}
+
+TEST(BinarySearchTreeScapegoatTest, NodeSize)
+{
+    EXPECT_EQ(sizeof(rcn_c::bsnode), 4 * sizeof(void *));
+}
+
+TEST_F(BinarySearchTreeTest, ScapegoatSortedInput)
+{
+    const int nr_entries = 100000;
+    std::vector<TestData *> data;
+
+    for (int i = 0; i < nr_entries; i++) {
+        data.push_back(new TestData(i));
+        ASSERT_EQ(bstree_insert(tree_, &data.back()->node_, data.back()), 0);
+
+        if (i % 997 == 0) {
+            ASSERT_LE(_Height(tree_->root_), _MaxHeight(i + 1));
+        }
+    }
+
+    ASSERT_TRUE(bstree_validate(tree_));
+    ASSERT_LE(_Height(tree_->root_), _MaxHeight(nr_entries));
+
+    /* Erasing rebuilds before the height gets off by more than a level. */
+    std::shuffle(data.begin(), data.end(), std::mt19937(46));
+
+    for (int i = 0; i < nr_entries - 1; i++) {
+        ASSERT_EQ(bstree_erase(tree_, &data[i]->node_), data[i]);
+        delete data[i];
+
+        if (i % 997 == 0) {
+            ASSERT_LE(_Height(tree_->root_),
+                      _MaxHeight(nr_entries - i - 1) + 1);
+            ASSERT_TRUE(bstree_validate(tree_));
+        }
+    }
+
+    ASSERT_EQ(bstree_size(tree_), 1);
+}
@@ -0,0 +1,79 @@
+/* The scapegoat bstree tests, with the operation counters kept. */
+#define BSTREE_SCAPEGOAT
+#define BSTREE_STATS
+
+#include "../c_bstree_00/main.cpp"
+
+TEST_F(BinarySearchTreeTest, Stats)
+{
+    const int nr_entries = 1000;
+    std::vector<TestData *> data;
+    auto stats = bstree_stats(tree_);
+
+    /* In order, every insert lands too deep now and then. */
+    for (int i = 0; i < nr_entries; i++) {
+        data.push_back(new TestData(i));
+        ASSERT_EQ(bstree_insert(tree_, &data.back()->node_, data.back()), 0);
+    }
+
+    ASSERT_EQ(stats->nr_inserts_, nr_entries);
+    ASSERT_GE(stats->nr_insert_compars_, nr_entries - 1);
+    ASSERT_EQ(stats->nr_rotations_, 0);
+    ASSERT_GT(stats->nr_fixups_, 0);
+    ASSERT_GE(stats->nr_rebuilt_, stats->nr_fixups_);
+
+    bstree_stats_reset(tree_);
+    bstree_rebalance(tree_);
+    ASSERT_EQ(stats->nr_fixups_, 1);
+    ASSERT_EQ(stats->nr_rebuilt_, nr_entries);
+
+    for (int i = 0; i < nr_entries; i++) {
+        ASSERT_EQ(bstree_find(tree_, data[i])->entry_, data[i]);
+    }
+
+    /* A hit at depth d takes d + 1 compars. */
+    size_t hist[16], nr_compars = 0;
+
+    ASSERT_EQ(bstree_depth_histogram(tree_, hist, 16), 10);
+
+    for (size_t d = 0; d < 16; d++) {
+        nr_compars += (d + 1) * hist[d];
+    }
+
+    ASSERT_EQ(stats->nr_finds_, nr_entries);
+    ASSERT_EQ(stats->nr_find_compars_, nr_compars);
+
+    for (int i = 0; i < nr_entries; i += 2) {
+        ASSERT_EQ(bstree_erase(tree_, &data[i]->node_), data[i]);
+        delete data[i];
+    }
+
+    /* The lookup erase checks its node with is not counted. */
+    ASSERT_EQ(stats->nr_erases_, nr_entries / 2);
+    ASSERT_EQ(stats->nr_finds_, nr_entries);
+    ASSERT_EQ(stats->nr_find_compars_, nr_compars);
+}
+
+TEST_F(BinarySearchTreeTest, DepthHistogram)
+{
+    const int nr_entries = 1023;
+    size_t hist[16];
+
+    ASSERT_EQ(bstree_depth_histogram(tree_, hist, 16), 0);
+    ASSERT_EQ(std::count(hist, hist + 16, 0), 16);
+
+    for (int i = 0; i < nr_entries; i++) {
+        auto data = new TestData(i);
+
+        bstree_insert(tree_, &data->node_, data);
+    }
+
+    ASSERT_EQ(bstree_depth_histogram(tree_, hist, 16), _Height(tree_->root_));
+
+    bstree_rebalance(tree_);
+    ASSERT_EQ(bstree_depth_histogram(tree_, hist, 16), 10);
+
+    for (size_t d = 0; d < 16; d++) {
+        ASSERT_EQ(hist[d], d < 10 ? 1u << d : 0);
+    }
+}
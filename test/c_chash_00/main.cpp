@@ -0,0 +1,383 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rcn_c/chash.h"
+
+struct TestData {
+    TestData(int value)
+        : value_(value)
+    {
+    }
+
+    rcn_c::chnode node_;
+    int value_;
+};
+
+class CHashTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        table_ = new rcn_c::chash;
+        ASSERT_EQ(chash_init(table_, 0, _KeyHash, _ValueCompare), 0);
+    }
+
+    void TearDown() override
+    {
+        chash_destroy(table_);
+        delete table_;
+    }
+
+    static size_t _KeyHash(const void *_ke)
+    {
+        auto ke = (const TestData *)_ke;
+
+        return ke->value_;
+    }
+
+    static int _ValueCompare(const void *_ke, const void *_in_table)
+    {
+        auto ke = (const TestData *)_ke;
+        auto in_table = (const TestData *)_in_table;
+
+        return (ke->value_ > in_table->value_) -
+               (ke->value_ < in_table->value_);
+    }
+
+    void *Find(int value)
+    {
+        TestData key(value);
+        unsigned int token = chash_read_lock(table_);
+        void *e = chash_find(table_, &key);
+
+        chash_read_unlock(table_, token);
+
+        return e;
+    }
+
+    /* Lets the updates finish the resize on. */
+    void Settle()
+    {
+        while (chash_rehash(table_)) {
+        }
+    }
+
+    rcn_c::chash *table_;
+};
+
+TEST_F(CHashTest, InitAndEmpty)
+{
+    ASSERT_TRUE(chash_empty(table_));
+    ASSERT_EQ(chash_size(table_), 0);
+    ASSERT_EQ(chash_buckets(table_), CHASH_NR_STRIPES);
+    ASSERT_FALSE(chash_rehashing(table_));
+    ASSERT_EQ(Find(1), nullptr);
+    ASSERT_TRUE(chash_validate(table_));
+}
+
+TEST_F(CHashTest, InsertFindEraseRemove)
+{
+    std::vector<TestData> data;
+    TestData dup(4);
+
+    for (int i = 0; i < 100; i++) {
+        data.emplace_back(i * 2);
+    }
+
+    for (auto &d : data) {
+        ASSERT_EQ(chash_insert(table_, &d.node_, &d), 0);
+    }
+
+    ASSERT_EQ(chash_insert(table_, &dup.node_, &dup), -EEXIST);
+    ASSERT_EQ(chash_size(table_), 100);
+    ASSERT_TRUE(chash_validate(table_));
+
+    for (int i = 0; i < 200; i++) {
+        ASSERT_EQ(Find(i), i % 2 == 0 ? &data[i / 2] : nullptr);
+    }
+
+    ASSERT_EQ(chash_erase(table_, &data[2].node_), &data[2]);
+    ASSERT_EQ(Find(4), nullptr);
+    ASSERT_EQ(chash_insert(table_, &dup.node_, &dup), 0);
+    ASSERT_EQ(Find(4), &dup);
+
+    TestData key(6);
+
+    ASSERT_EQ(chash_remove(table_, &key), &data[3].node_);
+    ASSERT_EQ(chash_remove(table_, &key), nullptr);
+    ASSERT_EQ(chash_size(table_), 99);
+    ASSERT_TRUE(chash_validate(table_));
+}
+
+TEST_F(CHashTest, GrowAndShrink)
+{
+    const int nr = 20000;
+    std::vector<TestData> data;
+    bool rehashed = false;
+
+    for (int i = 0; i < nr; i++) {
+        data.emplace_back(i);
+    }
+
+    for (int i = 0; i < nr; i++) {
+        ASSERT_EQ(chash_insert(table_, &data[i].node_, &data[i]), 0);
+
+        if (chash_rehashing(table_) && (i % 13 == 0)) {
+            rehashed = true;
+            ASSERT_TRUE(chash_validate(table_));
+
+            for (int j = 0; j <= i; j += 7) {
+                ASSERT_EQ(Find(j), &data[j]);
+            }
+        }
+    }
+
+    Settle();
+
+    ASSERT_TRUE(rehashed);
+    ASSERT_GE(chash_buckets(table_) * CHASH_MAX_LOAD, nr * 50);
+    ASSERT_TRUE(chash_validate(table_));
+
+    size_t nr_buckets = chash_buckets(table_);
+
+    for (int i = 0; i < nr - 10; i++) {
+        TestData key(i);
+
+        ASSERT_EQ(chash_remove(table_, &key), &data[i].node_);
+    }
+
+    Settle();
+
+    ASSERT_EQ(chash_size(table_), 10);
+    ASSERT_LT(chash_buckets(table_), nr_buckets);
+    ASSERT_TRUE(chash_validate(table_));
+
+    for (int i = 0; i < nr; i++) {
+        ASSERT_EQ(Find(i), i >= nr - 10 ? &data[i] : nullptr);
+    }
+
+    chash_synchronize(table_);
+}
+
+TEST_F(CHashTest, ConcurrentReadersDuringResizes)
+{
+    const int nr_stable = 2000;
+    const int nr_readers = 3;
+    std::vector<TestData> stable;
+    std::atomic<bool> stop(false);
+    std::atomic<long> misses(0);
+    std::vector<std::thread> readers;
+
+    stable.reserve(nr_stable);
+
+    for (int i = 0; i < nr_stable; i++) {
+        stable.emplace_back(i * 2);
+        chash_insert(table_, &stable.back().node_, &stable.back());
+    }
+
+    for (int t = 0; t < nr_readers; t++) {
+        readers.emplace_back([&, t] {
+            for (int i = t; !stop.load(); i = (i + 7) % nr_stable) {
+                if (Find(i * 2) != &stable[i]) {
+                    misses++;
+                }
+            }
+        });
+    }
+
+    /*
+     * Odd values come and go by the ten thousand, so that the table grows
+     * and shrinks over and over, and their nodes are recycled.
+     */
+    for (int round = 0; round < 10; round++) {
+        std::vector<TestData *> volatiles;
+
+        for (int i = 0; i < 10000; i++) {
+            auto d = new TestData(i * 2 + 1);
+
+            ASSERT_EQ(chash_insert(table_, &d->node_, d), 0);
+            volatiles.push_back(d);
+        }
+
+        for (auto d : volatiles) {
+            ASSERT_EQ(chash_erase(table_, &d->node_), d);
+        }
+
+        chash_synchronize(table_);
+
+        for (auto d : volatiles) {
+            delete d;
+        }
+    }
+
+    stop = true;
+
+    for (auto &r : readers) {
+        r.join();
+    }
+
+    ASSERT_EQ(misses.load(), 0);
+    ASSERT_EQ(chash_size(table_), nr_stable);
+
+    Settle();
+
+    ASSERT_TRUE(chash_validate(table_));
+}
+
+TEST_F(CHashTest, ConcurrentWriters)
+{
+    const int nr_writers = 4;
+    const int nr_per_writer = 10000;
+    std::vector<TestData> data;
+    std::vector<std::thread> writers;
+    std::atomic<long> errors(0);
+
+    for (int i = 0; i < nr_writers * nr_per_writer; i++) {
+        data.emplace_back(i);
+    }
+
+    for (int t = 0; t < nr_writers; t++) {
+        writers.emplace_back([&, t] {
+            int first = t * nr_per_writer;
+
+            for (int i = first; i < first + nr_per_writer; i++) {
+                errors += chash_insert(table_, &data[i].node_, &data[i]) != 0;
+            }
+
+            for (int i = first; i < first + nr_per_writer; i += 2) {
+                errors += chash_erase(table_, &data[i].node_) != &data[i];
+            }
+
+            for (int i = first; i < first + nr_per_writer; i++) {
+                errors += Find(i) != (i % 2 != 0 ? &data[i] : nullptr);
+            }
+        });
+    }
+
+    for (auto &w : writers) {
+        w.join();
+    }
+
+    ASSERT_EQ(errors.load(), 0);
+    ASSERT_EQ(chash_size(table_), nr_writers * nr_per_writer / 2);
+
+    Settle();
+
+    ASSERT_TRUE(chash_validate(table_));
+    chash_synchronize(table_);
+}
+
+/*
+ * A lookup for 'key' that stalls on 'decoy', an entry of the same hash, in
+ * the table it started from, while the table is resized twice : the decoy
+ * is erased, and 'key' moves on to the table after the next one.
+ */
+struct StalledData {
+    rcn_c::chnode node_;
+    size_t hash_;
+    int value_;
+};
+
+static std::atomic<const void *> stall_on(nullptr);
+static std::atomic<bool> stalled(false);
+
+static size_t StalledHash(const void *_ke)
+{
+    return ((const StalledData *)_ke)->hash_;
+}
+
+static int StalledCompare(const void *_ke, const void *_in_table)
+{
+    auto ke = (const StalledData *)_ke;
+    auto in_table = (const StalledData *)_in_table;
+
+    if (in_table == stall_on.load()) {
+        stalled = true;
+
+        while (stall_on.load() != nullptr) {
+            std::this_thread::yield();
+        }
+    }
+
+    return (ke->value_ > in_table->value_) - (ke->value_ < in_table->value_);
+}
+
+TEST(CHashStallTest, LookupFallsBehindTwoResizes)
+{
+    rcn_c::chash table;
+    std::vector<StalledData> fillers(100000);
+    StalledData decoy, key;
+    size_t nr = 0;
+    void *found = nullptr;
+
+    ASSERT_EQ(rcn_c::chash_init(&table, 0, StalledHash, StalledCompare), 0);
+
+    /* The hash of the last bucket, so that it moves last. */
+    size_t shift = rcn_c::__chash_shift(rcn_c::chash_buckets(&table));
+
+    decoy.hash_ = key.hash_ = (size_t)1 << 40;
+
+    while ((((uint64_t)decoy.hash_ * 0x9e3779b97f4a7c15ULL) >> shift) !=
+           rcn_c::chash_buckets(&table) - 1) {
+        decoy.hash_ = key.hash_ = decoy.hash_ + 1;
+    }
+
+    decoy.value_ = -1;
+    key.value_ = -2;
+    ASSERT_EQ(rcn_c::chash_insert(&table, &decoy.node_, &decoy), 0);
+
+    auto fill = [&] {
+        while (!rcn_c::chash_rehashing(&table)) {
+            ASSERT_LT(nr, fillers.size());
+            fillers[nr].hash_ = nr;
+            fillers[nr].value_ = (int)nr;
+            ASSERT_EQ(rcn_c::chash_insert(&table, &fillers[nr].node_,
+                                          &fillers[nr]),
+                      0);
+            nr++;
+        }
+    };
+
+    /* 'key' goes to the future table, the decoy stays in the current one. */
+    fill();
+    ASSERT_EQ(rcn_c::chash_insert(&table, &key.node_, &key), 0);
+
+    stall_on = &decoy;
+
+    std::thread reader([&] {
+        unsigned int token = rcn_c::chash_read_lock(&table);
+
+        found = rcn_c::chash_find(&table, &key);
+        rcn_c::chash_read_unlock(&table, token);
+    });
+
+    while (!stalled.load()) {
+        std::this_thread::yield();
+    }
+
+    ASSERT_EQ(rcn_c::chash_erase(&table, &decoy.node_), &decoy);
+
+    while (rcn_c::chash_rehash(&table)) {
+    }
+
+    fill();
+
+    while (rcn_c::chash_rehash(&table)) {
+    }
+
+    stall_on = nullptr;
+    reader.join();
+
+    ASSERT_EQ(found, &key);
+    ASSERT_TRUE(rcn_c::chash_validate(&table));
+
+    rcn_c::chash_synchronize(&table);
+    rcn_c::chash_destroy(&table);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
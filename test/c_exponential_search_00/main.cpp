@@ -0,0 +1,122 @@
+#include "gtest/gtest.h"
+#include "rcn_c/common.h"
+#include "rcn_c/exponential_search.h"
+
+int IntCompar(const void *a, const void *b)
+{
+    return (*(int *)a - *(int *)b);
+}
+
+TEST(ExponentialSearchTest, EmptyArray)
+{
+    int key = 5;
+    int arr[] = {};
+    void *result = rcn_c::exponential_search(&key, arr, NR_ELEM(arr),
+                                             sizeof(arr[0]), IntCompar);
+
+    ASSERT_EQ(nullptr, result);
+}
+
+TEST(ExponentialSearchTest, SingleElementFound)
+{
+    int key = 5;
+    int arr[] = { 5 };
+    void *result = rcn_c::exponential_search(&key, arr, NR_ELEM(arr),
+                                             sizeof(arr[0]), IntCompar);
+
+    ASSERT_NE(nullptr, result);
+    ASSERT_EQ(key, *(int *)result);
+}
+
+TEST(ExponentialSearchTest, SingleElementNotFound)
+{
+    int key = 5;
+    int arr[] = { 10 };
+    void *result = rcn_c::exponential_search(&key, arr, NR_ELEM(arr),
+                                             sizeof(arr[0]), IntCompar);
+
+    ASSERT_EQ(nullptr, result);
+}
+
+TEST(ExponentialSearchTest, MultipleElementsFound)
+{
+    int arr[] = { 1, 3, 5, 7, 9 };
+
+    for (int key : arr) {
+        void *result = rcn_c::exponential_search(&key, arr, NR_ELEM(arr),
+                                                 sizeof(arr[0]), IntCompar);
+
+        ASSERT_NE(nullptr, result);
+        ASSERT_EQ(key, *(int *)result);
+    }
+}
+
+TEST(ExponentialSearchTest, MultipleElementsNotFound)
+{
+    int arr[] = { 1, 3, 5, 7, 9 };
+
+    for (int key : { 0, 2, 4, 6, 8, 10 }) {
+        void *result = rcn_c::exponential_search(&key, arr, NR_ELEM(arr),
+                                                 sizeof(arr[0]), IntCompar);
+
+        ASSERT_EQ(nullptr, result);
+    }
+}
+
+TEST(ExponentialSearchTest, HintFound)
+{
+    int arr[1000];
+
+    for (size_t i = 0; i < NR_ELEM(arr); ++i) {
+        arr[i] = i * 2;
+    }
+
+    for (size_t hint : { 0, 1, 250, 500, 998, 999 }) {
+        for (int key : { 0, 2, 500, 1000, 1996, 1998 }) {
+            void *result = rcn_c::exponential_search_hint(
+                &key, arr, NR_ELEM(arr), sizeof(arr[0]), IntCompar, hint);
+
+            ASSERT_NE(nullptr, result);
+            ASSERT_EQ(key, *(int *)result);
+        }
+
+        for (int key : { -1, 1, 501, 1999 }) {
+            void *result = rcn_c::exponential_search_hint(
+                &key, arr, NR_ELEM(arr), sizeof(arr[0]), IntCompar, hint);
+
+            ASSERT_EQ(nullptr, result);
+        }
+    }
+}
+
+TEST(ExponentialSearchTest, GallopLeftAndRight)
+{
+    int arr[] = { 1, 3, 3, 3, 5, 7, 7, 9 };
+
+    for (size_t hint = 0; hint < NR_ELEM(arr); ++hint) {
+        for (int key = 0; key <= 10; ++key) {
+            size_t lower = 0, upper = 0;
+
+            while (lower < NR_ELEM(arr) && arr[lower] < key) {
+                lower++;
+            }
+
+            while (upper < NR_ELEM(arr) && arr[upper] <= key) {
+                upper++;
+            }
+
+            ASSERT_EQ(lower, rcn_c::gallop_left(&key, arr, NR_ELEM(arr),
+                                                sizeof(arr[0]), IntCompar,
+                                                hint));
+            ASSERT_EQ(upper, rcn_c::gallop_right(&key, arr, NR_ELEM(arr),
+                                                 sizeof(arr[0]), IntCompar,
+                                                 hint));
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,347 @@
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rcn_c/flathash.h"
+
+/* Kept in the slots. */
+struct Pair {
+    int key_;
+    int value_;
+};
+
+/* Kept outside, the slots pointing to it. */
+struct TestData {
+    TestData(int value)
+        : value_(value)
+    {
+    }
+
+    int value_;
+};
+
+class FlatHashTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        flathash_init(&table_, sizeof(Pair), _KeyHash, _KeyCompare);
+    }
+
+    void TearDown() override
+    {
+        flathash_destroy(&table_);
+    }
+
+    static size_t _KeyHash(const void *_ke)
+    {
+        return ((const Pair *)_ke)->key_;
+    }
+
+    /* Few homes, for long runs of taken slots wrapping around the end. */
+    static size_t _BadHash(const void *_ke)
+    {
+        return ((const Pair *)_ke)->key_ % 4 * (SIZE_MAX / 4);
+    }
+
+    /* Constant low bits, as the hashes of aligned pointers have. */
+    static size_t _ShiftedHash(const void *_ke)
+    {
+        return (size_t)((const Pair *)_ke)->key_ << 7;
+    }
+
+    static int _CountingCompare(const void *_ke, const void *_in_table)
+    {
+        nr_compars_++;
+
+        return _KeyCompare(_ke, _in_table);
+    }
+
+    static int _KeyCompare(const void *_ke, const void *_in_table)
+    {
+        auto ke = (const Pair *)_ke;
+        auto in_table = (const Pair *)_in_table;
+
+        return (ke->key_ > in_table->key_) - (ke->key_ < in_table->key_);
+    }
+
+    static size_t _ValueHash(const void *_ke)
+    {
+        return ((const TestData *)_ke)->value_;
+    }
+
+    static int _ValueCompare(const void *_ke, const void *_in_table)
+    {
+        auto ke = (const TestData *)_ke;
+        auto in_table = (const TestData *)_in_table;
+
+        return (ke->value_ > in_table->value_) -
+               (ke->value_ < in_table->value_);
+    }
+
+    /* Random inserts and removes, checked against std::unordered_map. */
+    void RandomOps(int nr_ops, int nr_keys)
+    {
+        std::unordered_map<int, int> ref;
+        std::mt19937 gen(48);
+
+        for (int i = 0; i < nr_ops; i++) {
+            Pair p = { (int)(gen() % nr_keys), i }, out = { -1, -1 };
+
+            if (gen() % 3 != 0) {
+                int err = flathash_insert(&table_, &p);
+
+                ASSERT_EQ(err, ref.count(p.key_) ? -EEXIST : 0);
+                ref.emplace(p.key_, p.value_);
+            } else if (ref.count(p.key_)) {
+                ASSERT_EQ(flathash_remove(&table_, &p, &out), 0);
+                ASSERT_EQ(out.key_, p.key_);
+                ASSERT_EQ(out.value_, ref[p.key_]);
+                ref.erase(p.key_);
+            } else {
+                ASSERT_EQ(flathash_remove(&table_, &p, &out), -ENOENT);
+            }
+
+            if (i % 1000 == 0) {
+                ASSERT_TRUE(flathash_validate(&table_));
+            }
+        }
+
+        ASSERT_TRUE(flathash_validate(&table_));
+        ASSERT_EQ(flathash_size(&table_), ref.size());
+
+        for (int k = 0; k < nr_keys; k++) {
+            Pair key = { k, 0 };
+            auto p = (Pair *)flathash_find(&table_, &key);
+
+            if (ref.count(k)) {
+                ASSERT_NE(p, nullptr);
+                ASSERT_EQ(p->value_, ref[k]);
+            } else {
+                ASSERT_EQ(p, nullptr);
+            }
+        }
+    }
+
+    rcn_c::flathash table_;
+    static size_t nr_compars_;
+};
+
+size_t FlatHashTest::nr_compars_;
+
+TEST_F(FlatHashTest, InitAndEmpty)
+{
+    Pair key = { 1, 0 };
+
+    ASSERT_TRUE(flathash_empty(&table_));
+    ASSERT_EQ(flathash_slots(&table_), 0);
+    ASSERT_EQ(flathash_find(&table_, &key), nullptr);
+    ASSERT_EQ(flathash_remove(&table_, &key, NULL), -ENOENT);
+    ASSERT_EQ(flathash_begin(&table_), flathash_end(&table_));
+    ASSERT_TRUE(flathash_validate(&table_));
+}
+
+TEST_F(FlatHashTest, InsertAndFind)
+{
+    const int nr_entries = 100000;
+
+    for (int i = 0; i < nr_entries; i++) {
+        Pair p = { i, -i };
+
+        ASSERT_EQ(flathash_insert(&table_, &p), 0);
+        ASSERT_EQ(flathash_insert(&table_, &p), -EEXIST);
+    }
+
+    ASSERT_EQ(flathash_size(&table_), nr_entries);
+    ASSERT_TRUE(flathash_validate(&table_));
+
+    /* A power of 2, no more than half empty. */
+    size_t nr_slots = flathash_slots(&table_);
+
+    ASSERT_EQ(nr_slots & (nr_slots - 1), 0);
+    ASSERT_LE(nr_slots, 2 * 100 * nr_entries / FLATHASH_MAX_LOAD);
+
+    for (int i = -10; i < nr_entries + 10; i++) {
+        Pair key = { i, 0 };
+        auto p = (Pair *)flathash_find(&table_, &key);
+
+        if (i < 0 || i >= nr_entries) {
+            ASSERT_EQ(p, nullptr);
+        } else {
+            ASSERT_NE(p, nullptr);
+            ASSERT_EQ(p->value_, -i);
+        }
+    }
+}
+
+TEST_F(FlatHashTest, InsertOrGet)
+{
+    const int words[] = { 3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5 };
+
+    for (int w : words) {
+        Pair p = { w, 0 };
+
+        ((Pair *)flathash_insert_or_get(&table_, &p))->value_++;
+    }
+
+    Pair key = { 5, 0 };
+
+    ASSERT_EQ(flathash_size(&table_), 7);
+    ASSERT_EQ(((Pair *)flathash_find(&table_, &key))->value_, 3);
+}
+
+TEST_F(FlatHashTest, RandomOps)
+{
+    RandomOps(200000, 5000);
+}
+
+TEST_F(FlatHashTest, RandomOpsBadHash)
+{
+    table_.key_hash_ = _BadHash;
+    RandomOps(20000, 500);
+}
+
+/* The tags still filter the slots to compare when the low bits are fixed. */
+TEST_F(FlatHashTest, TagsOfShiftedHash)
+{
+    const int nr_entries = 100000;
+
+    table_.key_hash_ = _ShiftedHash;
+    table_.compar_ = _CountingCompare;
+
+    for (int i = 0; i < nr_entries; i++) {
+        Pair p = { i, i };
+
+        ASSERT_EQ(flathash_insert(&table_, &p), 0);
+    }
+
+    nr_compars_ = 0;
+
+    for (int i = nr_entries; i < nr_entries * 2; i++) {
+        Pair key = { i, 0 };
+
+        ASSERT_EQ(flathash_find(&table_, &key), nullptr);
+    }
+
+    ASSERT_LT(nr_compars_, nr_entries / 10);
+    ASSERT_TRUE(flathash_validate(&table_));
+}
+
+TEST_F(FlatHashTest, EraseAndIterate)
+{
+    const int nr_entries = 1000;
+    long sum = 0;
+
+    for (int i = 0; i < nr_entries; i++) {
+        Pair p = { i, i };
+
+        flathash_insert(&table_, &p);
+    }
+
+    for (size_t i = flathash_begin(&table_); i != flathash_end(&table_);
+         i = flathash_next(&table_, i)) {
+        sum += ((Pair *)flathash_entry(&table_, i))->value_;
+    }
+
+    ASSERT_EQ(sum, (long)nr_entries * (nr_entries - 1) / 2);
+
+    /* Erase from a find, each erase shifting the others around. */
+    for (int i = 0; i < nr_entries; i += 2) {
+        Pair key = { i, 0 };
+
+        flathash_erase(&table_, flathash_find(&table_, &key));
+    }
+
+    ASSERT_EQ(flathash_size(&table_), nr_entries / 2);
+    ASSERT_TRUE(flathash_validate(&table_));
+
+    for (int i = 0; i < nr_entries; i++) {
+        Pair key = { i, 0 };
+
+        ASSERT_EQ(flathash_find(&table_, &key) != nullptr, i % 2 == 1);
+    }
+}
+
+TEST_F(FlatHashTest, Reserve)
+{
+    const int nr_entries = 1000;
+
+    ASSERT_EQ(flathash_reserve(&table_, nr_entries), 0);
+
+    size_t nr_slots = flathash_slots(&table_);
+
+    for (int i = 0; i < nr_entries; i++) {
+        Pair p = { i, i };
+
+        flathash_insert(&table_, &p);
+    }
+
+    ASSERT_EQ(flathash_slots(&table_), nr_slots);
+
+    flathash_clear(&table_);
+    ASSERT_TRUE(flathash_empty(&table_));
+    ASSERT_EQ(flathash_begin(&table_), flathash_end(&table_));
+    ASSERT_EQ(flathash_slots(&table_), nr_slots);
+    ASSERT_TRUE(flathash_validate(&table_));
+}
+
+TEST_F(FlatHashTest, Pointers)
+{
+    const int nr_entries = 1000;
+    std::vector<TestData> data;
+    rcn_c::flathash table;
+    TestData *out;
+
+    flathash_init(&table, 0, _ValueHash, _ValueCompare);
+
+    for (int i = 0; i < nr_entries; i++) {
+        data.emplace_back(i);
+    }
+
+    for (auto &d : data) {
+        ASSERT_EQ(flathash_insert(&table, &d), 0);
+    }
+
+    ASSERT_TRUE(flathash_validate(&table));
+
+    for (int i = 0; i < nr_entries; i++) {
+        TestData key(i);
+
+        ASSERT_EQ(flathash_find(&table, &key), &data[i]);
+    }
+
+    TestData key(7);
+
+    ASSERT_EQ(flathash_remove(&table, &key, &out), 0);
+    ASSERT_EQ(out, &data[7]);
+    ASSERT_EQ(flathash_find(&table, &key), nullptr);
+
+    flathash_erase(&table, &data[8]);
+    key.value_ = 8;
+    ASSERT_EQ(flathash_find(&table, &key), nullptr);
+    ASSERT_EQ(flathash_size(&table), nr_entries - 2);
+    ASSERT_TRUE(flathash_validate(&table));
+
+    flathash_destroy(&table);
+}
+
+TEST_F(FlatHashTest, Swap)
+{
+    rcn_c::flathash other;
+    Pair p = { 1, 1 };
+
+    flathash_init(&other, sizeof(Pair), _KeyHash, _KeyCompare);
+    flathash_insert(&table_, &p);
+    flathash_swap(&table_, &other);
+
+    ASSERT_TRUE(flathash_empty(&table_));
+    ASSERT_NE(flathash_find(&other, &p), nullptr);
+
+    flathash_destroy(&other);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rcn_c/fractional_cascading.h"
+
+class FractionalCascadingTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        fc_ = new rcn_c::fcascade;
+    }
+
+    void TearDown() override
+    {
+        __fcascade_free_level(fc_);
+        delete fc_;
+    }
+
+    static int _ValueCompare(const void *_a, const void *_b)
+    {
+        int a = *(const int *)_a;
+        int b = *(const int *)_b;
+
+        if (a < b) {
+            return -1;
+        }
+
+        if (a > b) {
+            return 1;
+        }
+
+        return 0;
+    }
+
+    void Build(const std::vector<std::vector<int>> &lists)
+    {
+        base_.clear();
+        nmemb_.clear();
+
+        for (auto &list : lists) {
+            base_.push_back(list.data());
+            nmemb_.push_back(list.size());
+        }
+
+        fcascade_init(fc_, lists.size(), sizeof(int), _ValueCompare, nullptr);
+        ASSERT_EQ(__fcascade_alloc_level(fc_), 0);
+        ASSERT_EQ(fcascade_build(fc_, base_.data(), nmemb_.data()), 0);
+    }
+
+    void Check(const std::vector<std::vector<int>> &lists, int key)
+    {
+        std::vector<size_t> pos(lists.size());
+
+        fcascade_lower_bound(fc_, &key, pos.data());
+
+        for (size_t n = 0; n < lists.size(); n++) {
+            size_t expected =
+                std::lower_bound(lists[n].begin(), lists[n].end(), key) -
+                lists[n].begin();
+
+            ASSERT_EQ(pos[n], expected) << "list " << n << " key " << key;
+        }
+    }
+
+    rcn_c::fcascade *fc_;
+    std::vector<const void *> base_;
+    std::vector<size_t> nmemb_;
+};
+
+TEST_F(FractionalCascadingTest, SingleList)
+{
+    std::vector<std::vector<int>> lists = { { 10, 20, 30 } };
+
+    Build(lists);
+    ASSERT_EQ(fcascade_lists(fc_), 1);
+
+    for (int key = 0; key <= 40; key += 5) {
+        Check(lists, key);
+    }
+}
+
+TEST_F(FractionalCascadingTest, MultipleLists)
+{
+    std::vector<std::vector<int>> lists = {
+        { 24, 64, 65, 80, 93 },
+        { 23, 25, 26 },
+        { 13, 44, 62, 66 },
+        { 11, 35, 46, 79, 81 },
+    };
+
+    Build(lists);
+
+    for (int key = 0; key <= 100; key++) {
+        Check(lists, key);
+    }
+}
+
+TEST_F(FractionalCascadingTest, EmptyLists)
+{
+    std::vector<std::vector<int>> lists = { {}, { 1, 2, 3 }, {}, { 2 }, {} };
+
+    Build(lists);
+
+    for (int key = 0; key <= 4; key++) {
+        Check(lists, key);
+    }
+}
+
+TEST_F(FractionalCascadingTest, Random)
+{
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> dist(0, 2000);
+    std::vector<std::vector<int>> lists(32);
+
+    for (auto &list : lists) {
+        list.resize(gen() % 300);
+
+        for (auto &x : list) {
+            x = dist(gen);
+        }
+
+        std::sort(list.begin(), list.end());
+    }
+
+    Build(lists);
+
+    for (int key = -1; key <= 2001; key++) {
+        Check(lists, key);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,157 @@
+#include <random>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rcn_c/interval_tree.h"
+
+struct TestData {
+    TestData(int start, int last)
+        : start_(start)
+        , last_(last)
+    {
+    }
+
+    rcn_c::itnode node_;
+    int start_;
+    int last_;
+};
+
+class IntervalTreeTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        tree_ = new rcn_c::itree;
+        itree_init(tree_);
+    }
+
+    void TearDown() override
+    {
+        while (!itree_empty(tree_)) {
+            auto x = rcn_c::rbtree_begin(&tree_->rbtree_);
+            auto n = CONTAINER_OF(x, rcn_c::itnode, rbnode_);
+            delete (TestData *)itree_erase(tree_, n);
+        }
+
+        delete tree_;
+    }
+
+    TestData *Insert(int start, int last)
+    {
+        auto data = new TestData(start, last);
+
+        itree_insert(tree_, &data->node_, start, last, data);
+
+        return data;
+    }
+
+    std::multiset<std::pair<int, int>> Query(int start, int last)
+    {
+        std::multiset<std::pair<int, int>> result;
+
+        for (auto x = itree_iter_first(tree_, start, last); x != nullptr;
+             x = itree_iter_next(tree_, x, start, last)) {
+            auto data = (TestData *)x->entry_;
+            result.insert({ data->start_, data->last_ });
+        }
+
+        return result;
+    }
+
+    rcn_c::itree *tree_;
+};
+
+TEST_F(IntervalTreeTest, InitAndEmpty)
+{
+    ASSERT_TRUE(itree_empty(tree_));
+    ASSERT_EQ(itree_iter_first(tree_, 0, 100), nullptr);
+}
+
+TEST_F(IntervalTreeTest, InsertAndQuery)
+{
+    Insert(15, 20);
+    Insert(10, 30);
+    Insert(17, 19);
+    Insert(5, 20);
+    Insert(12, 15);
+    Insert(30, 40);
+
+    ASSERT_EQ(itree_size(tree_), 6);
+    ASSERT_TRUE(itree_validate(tree_));
+
+    std::multiset<std::pair<int, int>> expected = { { 5, 20 },
+                                                    { 10, 30 },
+                                                    { 15, 20 },
+                                                    { 17, 19 } };
+    ASSERT_EQ(Query(16, 18), expected);
+
+    expected = { { 10, 30 }, { 30, 40 } };
+    ASSERT_EQ(Query(30, 30), expected);
+
+    ASSERT_TRUE(Query(41, 50).empty());
+    ASSERT_TRUE(Query(0, 4).empty());
+}
+
+TEST_F(IntervalTreeTest, DuplicateIntervals)
+{
+    Insert(1, 5);
+    Insert(1, 5);
+
+    ASSERT_EQ(itree_size(tree_), 2);
+    ASSERT_EQ(Query(3, 3).size(), 2);
+}
+
+TEST_F(IntervalTreeTest, Erase)
+{
+    auto data1 = Insert(10, 30);
+    Insert(5, 20);
+    Insert(25, 35);
+
+    ASSERT_EQ(itree_erase(tree_, &data1->node_), data1);
+    delete data1;
+
+    ASSERT_TRUE(itree_validate(tree_));
+
+    std::multiset<std::pair<int, int>> expected = { { 25, 35 } };
+    ASSERT_EQ(Query(21, 24).size(), 0);
+    ASSERT_EQ(Query(26, 26), expected);
+}
+
+TEST_F(IntervalTreeTest, Random)
+{
+    std::mt19937 gen(0);
+    std::vector<TestData *> data;
+
+    for (int i = 0; i < 2000; i++) {
+        int start = gen() % 10000;
+        data.push_back(Insert(start, start + gen() % 500));
+    }
+
+    for (size_t i = 0; i < data.size(); i += 2) {
+        itree_erase(tree_, &data[i]->node_);
+        delete data[i];
+        data[i] = nullptr;
+    }
+
+    ASSERT_TRUE(itree_validate(tree_));
+
+    for (int q = 0; q < 200; q++) {
+        int start = gen() % 10500;
+        int last = start + gen() % 100;
+        std::multiset<std::pair<int, int>> expected;
+
+        for (auto d : data) {
+            if ((d != nullptr) && (d->start_ <= last) && (start <= d->last_)) {
+                expected.insert({ d->start_, d->last_ });
+            }
+        }
+
+        ASSERT_EQ(Query(start, last), expected);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -83,6 +83,29 @@ TEST(MergeSortTest, LargeArray)
     EXPECT_TRUE(0 == std::memcmp(arr, expected, sizeof(expected)));
 }
 
+TEST(MergeSortTest, StableRuns)
+{
+    struct {
+        int key_;
+        int order_;
+    } arr[1000];
+
+    for (size_t i = 0; i < NR_ELEM(arr); ++i) {
+        arr[i].key_ = i < NR_ELEM(arr) / 2 ? (int)i % 7 : (int)i % 3;
+        arr[i].order_ = i;
+    }
+
+    rcn_c::merge_sort(arr, NR_ELEM(arr), sizeof(arr[0]), IntCompar);
+
+    for (size_t i = 1; i < NR_ELEM(arr); ++i) {
+        ASSERT_LE(arr[i - 1].key_, arr[i].key_);
+
+        if (arr[i - 1].key_ == arr[i].key_) {
+            ASSERT_LT(arr[i - 1].order_, arr[i].order_);
+        }
+    }
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,254 @@
+#include <atomic>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rcn_c/pavltree.h"
+
+struct TestData {
+    TestData(int value)
+        : value_(value)
+    {
+    }
+
+    int value_;
+};
+
+class PersistentAVLTreeTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        for (int i = 0; i < 1024; i++) {
+            data_.emplace_back(i);
+        }
+
+        tree_ = new rcn_c::pavltree;
+        pavltree_init(tree_, _ValueCompare);
+    }
+
+    void TearDown() override
+    {
+        pavltree_clear(tree_);
+        delete tree_;
+    }
+
+    static int _ValueCompare(const void *_ke, const void *_in_tree)
+    {
+        auto ke = (const TestData *)_ke;
+        auto in_tree = (const TestData *)_in_tree;
+
+        if (ke->value_ < in_tree->value_) {
+            return -1;
+        }
+
+        if (ke->value_ > in_tree->value_) {
+            return 1;
+        }
+
+        return 0;
+    }
+
+    static std::vector<int> _Values(const rcn_c::pavltree *tree)
+    {
+        std::vector<int> values;
+        rcn_c::pavltree_iter it;
+
+        for (void *e = pavltree_iter_begin(tree, &it); e != NULL;
+             e = pavltree_iter_next(&it)) {
+            values.push_back(((TestData *)e)->value_);
+        }
+
+        return values;
+    }
+
+    static void _Nodes(const rcn_c::pavlnode *x,
+                       std::set<const rcn_c::pavlnode *> &nodes)
+    {
+        if (x != NULL) {
+            nodes.insert(x);
+            _Nodes(x->left_, nodes);
+            _Nodes(x->right_, nodes);
+        }
+    }
+
+    std::vector<TestData> data_;
+    rcn_c::pavltree *tree_;
+};
+
+TEST_F(PersistentAVLTreeTest, InitAndEmpty)
+{
+    rcn_c::pavltree_iter it;
+
+    ASSERT_TRUE(pavltree_empty(tree_));
+    ASSERT_EQ(pavltree_size(tree_), 0);
+    ASSERT_EQ(pavltree_iter_begin(tree_, &it), nullptr);
+    ASSERT_TRUE(pavltree_validate(tree_));
+}
+
+TEST_F(PersistentAVLTreeTest, InsertFindErase)
+{
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(pavltree_insert(tree_, &data_[(i * 37) % 100]), 0);
+    }
+
+    ASSERT_EQ(pavltree_insert(tree_, &data_[50]), -EEXIST);
+    ASSERT_EQ(pavltree_size(tree_), 100);
+    ASSERT_TRUE(pavltree_validate(tree_));
+    ASSERT_EQ(pavltree_find(tree_, &data_[42]), &data_[42]);
+    ASSERT_EQ(pavltree_find(tree_, &data_[100]), nullptr);
+    ASSERT_EQ(pavltree_at(tree_, 10), &data_[10]);
+    ASSERT_EQ(pavltree_at(tree_, 100), nullptr);
+
+    for (int i = 0; i < 100; i += 2) {
+        ASSERT_EQ(pavltree_erase(tree_, &data_[i]), &data_[i]);
+    }
+
+    ASSERT_EQ(pavltree_erase(tree_, &data_[0]), nullptr);
+    ASSERT_EQ(pavltree_size(tree_), 50);
+    ASSERT_TRUE(pavltree_validate(tree_));
+    ASSERT_EQ(pavltree_lower_bound(tree_, &data_[10]), &data_[11]);
+    ASSERT_EQ(pavltree_lower_bound(tree_, &data_[99]), &data_[99]);
+    ASSERT_EQ(pavltree_lower_bound(tree_, &data_[100]), nullptr);
+}
+
+TEST_F(PersistentAVLTreeTest, Snapshot)
+{
+    rcn_c::pavltree snap;
+
+    for (int i = 0; i < 100; i++) {
+        pavltree_insert(tree_, &data_[i]);
+    }
+
+    pavltree_snapshot(tree_, &snap);
+    ASSERT_EQ(snap.root_, tree_->root_);
+
+    /* Only the path down to the new entry is copied. */
+    std::set<const rcn_c::pavlnode *> nodes;
+
+    pavltree_insert(tree_, &data_[100]);
+    _Nodes(tree_->root_, nodes);
+    _Nodes(snap.root_, nodes);
+    ASSERT_LE(nodes.size(), 100 + 1 + (size_t)tree_->root_->height_);
+    ASSERT_EQ(pavltree_erase(tree_, &data_[100]), &data_[100]);
+
+    for (int i = 0; i < 100; i += 3) {
+        ASSERT_EQ(pavltree_erase(tree_, &data_[i]), &data_[i]);
+    }
+
+    for (int i = 100; i < 200; i++) {
+        ASSERT_EQ(pavltree_insert(tree_, &data_[i]), 0);
+    }
+
+    ASSERT_TRUE(pavltree_validate(tree_));
+    ASSERT_TRUE(pavltree_validate(&snap));
+    ASSERT_EQ(pavltree_size(&snap), 100);
+
+    std::vector<int> values = _Values(&snap);
+
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(values[i], i);
+    }
+
+    /* A snapshot is a tree of its own. */
+    ASSERT_EQ(pavltree_erase(&snap, &data_[1]), &data_[1]);
+    ASSERT_EQ(pavltree_find(tree_, &data_[1]), &data_[1]);
+    ASSERT_EQ(pavltree_size(tree_), 100 - 34 + 100);
+
+    pavltree_clear(&snap);
+    ASSERT_TRUE(pavltree_validate(tree_));
+}
+
+TEST_F(PersistentAVLTreeTest, Random)
+{
+    std::vector<rcn_c::pavltree> snaps(16);
+    std::vector<std::set<int>> expected_snaps(snaps.size());
+    std::set<int> expected;
+    std::mt19937 gen(0);
+
+    for (int round = 0; round < 20000; round++) {
+        TestData *d = &data_[gen() % data_.size()];
+
+        if (expected.count(d->value_) == 0) {
+            ASSERT_EQ(pavltree_insert(tree_, d), 0);
+            expected.insert(d->value_);
+        } else {
+            ASSERT_EQ(pavltree_erase(tree_, d), d);
+            expected.erase(d->value_);
+        }
+
+        if (round % 500 == 0) {
+            size_t i = (round / 500) % snaps.size();
+
+            if (round / 500 >= (int)snaps.size()) {
+                ASSERT_TRUE(pavltree_validate(&snaps[i]));
+                ASSERT_EQ(_Values(&snaps[i]),
+                          std::vector<int>(expected_snaps[i].begin(),
+                                           expected_snaps[i].end()));
+                pavltree_clear(&snaps[i]);
+            }
+
+            pavltree_snapshot(tree_, &snaps[i]);
+            expected_snaps[i] = expected;
+        }
+    }
+
+    ASSERT_TRUE(pavltree_validate(tree_));
+    ASSERT_EQ(_Values(tree_),
+              std::vector<int>(expected.begin(), expected.end()));
+
+    for (size_t i = 0; i < snaps.size(); i++) {
+        ASSERT_EQ(_Values(&snaps[i]),
+                  std::vector<int>(expected_snaps[i].begin(),
+                                   expected_snaps[i].end()));
+        pavltree_clear(&snaps[i]);
+    }
+}
+
+TEST_F(PersistentAVLTreeTest, ConcurrentReaders)
+{
+    const int nr_readers = 4;
+    std::vector<std::thread> readers;
+    std::atomic<long> errors(0);
+
+    for (int i = 0; i < 512; i++) {
+        pavltree_insert(tree_, &data_[i]);
+    }
+
+    for (int t = 0; t < nr_readers; t++) {
+        rcn_c::pavltree snap;
+
+        pavltree_snapshot(tree_, &snap);
+        readers.emplace_back([&, snap]() mutable {
+            for (int round = 0; round < 50; round++) {
+                std::vector<int> values = _Values(&snap);
+
+                if (values.size() != 512 || values.back() != 511) {
+                    errors++;
+                }
+            }
+
+            pavltree_clear(&snap);
+        });
+    }
+
+    for (int i = 0; i < 512; i++) {
+        pavltree_erase(tree_, &data_[i]);
+        pavltree_insert(tree_, &data_[512 + i]);
+    }
+
+    for (auto &r : readers) {
+        r.join();
+    }
+
+    ASSERT_EQ(errors.load(), 0);
+    ASSERT_EQ(_Values(tree_).front(), 512);
+    ASSERT_TRUE(pavltree_validate(tree_));
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <random>
+#include <set>
+
+#include "gtest/gtest.h"
+#include "rcn_c/common.h"
+#include "rcn_c/pma.h"
+
+class PackedMemoryArrayTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        pma_ = new rcn_c::pma;
+        pma_init(pma_, sizeof(int), _ValueCompare);
+        __pma_alloc_slot(pma_);
+    }
+
+    void TearDown() override
+    {
+        __pma_free_slot(pma_);
+        delete pma_;
+    }
+
+    static int _ValueCompare(const void *_a, const void *_b)
+    {
+        int a = *(const int *)_a;
+        int b = *(const int *)_b;
+
+        if (a < b) {
+            return -1;
+        }
+
+        if (a > b) {
+            return 1;
+        }
+
+        return 0;
+    }
+
+    rcn_c::pma *pma_;
+};
+
+TEST_F(PackedMemoryArrayTest, InitAndEmpty)
+{
+    ASSERT_TRUE(pma_empty(pma_));
+    ASSERT_EQ(pma_size(pma_), 0);
+    ASSERT_EQ(pma_begin(pma_), pma_end(pma_));
+    ASSERT_TRUE(pma_validate(pma_));
+}
+
+TEST_F(PackedMemoryArrayTest, InsertAndSearch)
+{
+    int v[] = { 100, 50, 150, 75, 125 };
+
+    for (int x : v) {
+        ASSERT_EQ(pma_insert(pma_, &x), 0);
+    }
+
+    ASSERT_EQ(pma_size(pma_), NR_ELEM(v));
+    ASSERT_EQ(pma_insert(pma_, &v[0]), -EEXIST);
+
+    for (int x : v) {
+        int *found = (int *)pma_search(pma_, &x);
+        ASSERT_NE(found, nullptr);
+        ASSERT_EQ(*found, x);
+    }
+
+    int key = 20;
+    ASSERT_EQ(pma_search(pma_, &key), nullptr);
+    ASSERT_TRUE(pma_validate(pma_));
+}
+
+TEST_F(PackedMemoryArrayTest, BeginNextEnd)
+{
+    int v[] = { 100, 50, 150 };
+
+    for (int x : v) {
+        pma_insert(pma_, &x);
+    }
+
+    size_t pos = pma_begin(pma_);
+    ASSERT_EQ(*(int *)pma_entry(pma_, pos), 50);
+
+    pos = pma_next(pma_, pos);
+    ASSERT_EQ(*(int *)pma_entry(pma_, pos), 100);
+
+    pos = pma_next(pma_, pos);
+    ASSERT_EQ(*(int *)pma_entry(pma_, pos), 150);
+
+    pos = pma_next(pma_, pos);
+    ASSERT_EQ(pos, pma_end(pma_));
+}
+
+TEST_F(PackedMemoryArrayTest, Delete)
+{
+    int v[] = { 100, 50, 150 };
+
+    for (int x : v) {
+        pma_insert(pma_, &x);
+    }
+
+    int key = 50;
+    ASSERT_EQ(pma_delete(pma_, &key), 0);
+    ASSERT_EQ(pma_search(pma_, &key), nullptr);
+    ASSERT_EQ(pma_size(pma_), 2);
+    ASSERT_EQ(pma_delete(pma_, &key), -EEXIST);
+    ASSERT_TRUE(pma_validate(pma_));
+}
+
+TEST_F(PackedMemoryArrayTest, At)
+{
+    int v[] = { 100, 50, 150 };
+
+    for (int x : v) {
+        pma_insert(pma_, &x);
+    }
+
+    ASSERT_EQ(*(int *)pma_at(pma_, 0), 50);
+    ASSERT_EQ(*(int *)pma_at(pma_, 1), 100);
+    ASSERT_EQ(*(int *)pma_at(pma_, 2), 150);
+    ASSERT_EQ(pma_at(pma_, 3), nullptr);
+}
+
+TEST_F(PackedMemoryArrayTest, LowerAndUpperBound)
+{
+    int v[] = { 100, 50, 150, 75, 125 };
+
+    for (int x : v) {
+        pma_insert(pma_, &x);
+    }
+
+    int key = 70;
+    ASSERT_EQ(*(int *)pma_entry(pma_, pma_lower_bound(pma_, &key)), 75);
+    ASSERT_EQ(*(int *)pma_entry(pma_, pma_upper_bound(pma_, &key)), 75);
+
+    key = 100;
+    ASSERT_EQ(*(int *)pma_entry(pma_, pma_lower_bound(pma_, &key)), 100);
+    ASSERT_EQ(*(int *)pma_entry(pma_, pma_upper_bound(pma_, &key)), 125);
+
+    key = 200;
+    ASSERT_EQ(pma_lower_bound(pma_, &key), pma_end(pma_));
+    ASSERT_EQ(pma_upper_bound(pma_, &key), pma_end(pma_));
+}
+
+TEST_F(PackedMemoryArrayTest, Sequential)
+{
+    const int nr_entries = 10000;
+
+    for (int i = 0; i < nr_entries; i++) {
+        ASSERT_EQ(pma_insert(pma_, &i), 0);
+    }
+
+    ASSERT_EQ(pma_size(pma_), nr_entries);
+    ASSERT_TRUE(pma_validate(pma_));
+
+    for (int i = nr_entries - 1; i >= 0; i -= 2) {
+        ASSERT_EQ(pma_delete(pma_, &i), 0);
+    }
+
+    ASSERT_EQ(pma_size(pma_), nr_entries / 2);
+    ASSERT_TRUE(pma_validate(pma_));
+
+    for (int i = 0; i < nr_entries; i++) {
+        ASSERT_EQ(pma_search(pma_, &i) != nullptr, i % 2 == 0);
+    }
+}
+
+TEST_F(PackedMemoryArrayTest, Random)
+{
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> dist(0, 4096);
+    std::set<int> ref;
+
+    for (int i = 0; i < 50000; i++) {
+        int x = dist(gen);
+
+        if (i % 3 == 2) {
+            ASSERT_EQ(pma_delete(pma_, &x), ref.erase(x) ? 0 : -EEXIST);
+        } else {
+            ASSERT_EQ(pma_insert(pma_, &x), ref.insert(x).second ? 0 : -EEXIST);
+        }
+    }
+
+    ASSERT_EQ(pma_size(pma_), ref.size());
+    ASSERT_TRUE(pma_validate(pma_));
+
+    auto it = ref.begin();
+
+    for (size_t pos = pma_begin(pma_); pos != pma_end(pma_);
+         pos = pma_next(pma_, pos), ++it) {
+        ASSERT_EQ(*(int *)pma_entry(pma_, pos), *it);
+    }
+
+    while (!ref.empty()) {
+        int x = *ref.begin();
+        ASSERT_EQ(pma_delete(pma_, &x), 0);
+        ref.erase(ref.begin());
+    }
+
+    ASSERT_TRUE(pma_empty(pma_));
+    ASSERT_TRUE(pma_validate(pma_));
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
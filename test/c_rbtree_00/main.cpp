@@ -1,5 +1,10 @@
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "rcn_c/rbtree.h"
+#include "rcn_c/rbtree_set.h"
 
 struct TestData {
     TestData(int value)
@@ -335,6 +340,390 @@ TEST_F(RedBlackTreeTest, RedBlackTreeValidation)
     ASSERT_TRUE(rbtree_validate(tree_));
 }
 
+TEST_F(RedBlackTreeTest, Rank)
+{
+    auto data1 = new TestData(100);
+    auto data2 = new TestData(50);
+    auto data3 = new TestData(150);
+
+    rbtree_insert(tree_, &data1->node_, data1);
+    rbtree_insert(tree_, &data2->node_, data2);
+    rbtree_insert(tree_, &data3->node_, data3);
+
+    auto key = new TestData(50);
+    ASSERT_EQ(rbtree_rank(tree_, key), 0);
+
+    key->value_ = 100;
+    ASSERT_EQ(rbtree_rank(tree_, key), 1);
+
+    key->value_ = 125;
+    ASSERT_EQ(rbtree_rank(tree_, key), 2);
+
+    key->value_ = 200;
+    ASSERT_EQ(rbtree_rank(tree_, key), 3);
+
+    delete key;
+}
+
+TEST_F(RedBlackTreeTest, OrderStatistic)
+{
+    const int nr_entries = 1000;
+    std::vector<TestData *> data;
+    std::vector<int> sorted;
+
+    for (int i = 0; i < nr_entries; i++) {
+        data.push_back(new TestData((i * 7919) % nr_entries));
+        rbtree_insert(tree_, &data.back()->node_, data.back());
+    }
+
+    ASSERT_TRUE(rbtree_validate(tree_));
+
+    for (int i = 0; i < nr_entries; i++) {
+        if (i % 3 == 0) {
+            rbtree_erase(tree_, &data[i]->node_);
+            delete data[i];
+        } else {
+            sorted.push_back(data[i]->value_);
+        }
+    }
+
+    ASSERT_TRUE(rbtree_validate(tree_));
+    std::sort(sorted.begin(), sorted.end());
+
+    auto key = new TestData(0);
+
+    for (size_t n = 0; n < sorted.size(); n++) {
+        ASSERT_EQ(((TestData *)rbtree_at(tree_, n))->value_, sorted[n]);
+
+        key->value_ = sorted[n];
+        ASSERT_EQ(rbtree_rank(tree_, key), n);
+    }
+
+    ASSERT_EQ(rbtree_at(tree_, sorted.size()), nullptr);
+
+    delete key;
+}
+
+TEST_F(RedBlackTreeTest, BuildSorted)
+{
+    for (int nr_entries = 0; nr_entries < 300; nr_entries++) {
+        std::vector<TestData *> data;
+        std::vector<rcn_c::rbnode *> nodes;
+        std::vector<void *> entries;
+
+        for (int i = 0; i < nr_entries; i++) {
+            data.push_back(new TestData(i * 2));
+            nodes.push_back(&data.back()->node_);
+            entries.push_back(data.back());
+        }
+
+        rbtree_build_sorted(tree_, nodes.data(), entries.data(), nr_entries);
+        ASSERT_TRUE(rbtree_validate(tree_));
+        ASSERT_EQ(rbtree_size(tree_), nr_entries);
+
+        for (int i = 0; i < nr_entries; i++) {
+            ASSERT_EQ(rbtree_at(tree_, i), data[i]);
+        }
+
+        /* The result is a regular tree. */
+        auto extra = new TestData(-1);
+        rbtree_insert(tree_, &extra->node_, extra);
+        ASSERT_TRUE(rbtree_validate(tree_));
+
+        while (!rbtree_empty(tree_)) {
+            delete (TestData *)rbtree_pop_front(tree_);
+        }
+    }
+}
+
+TEST_F(RedBlackTreeTest, AppendSorted)
+{
+    const int nr_entries = 1000;
+
+    for (int i = 0; i < nr_entries; i++) {
+        auto data = new TestData(i);
+
+        ASSERT_EQ(rbtree_append_sorted(tree_, &data->node_, data), 0);
+    }
+
+    ASSERT_TRUE(rbtree_validate(tree_));
+
+    /* Out of order entries fall back to a regular insert. */
+    auto data = new TestData(nr_entries / 2);
+    ASSERT_EQ(rbtree_append_sorted(tree_, &data->node_, data), -EEXIST);
+    data->value_ = -1;
+    ASSERT_EQ(rbtree_append_sorted(tree_, &data->node_, data), 0);
+    ASSERT_TRUE(rbtree_validate(tree_));
+    ASSERT_EQ(rbtree_size(tree_), nr_entries + 1);
+
+    for (int i = 0; i <= nr_entries; i++) {
+        ASSERT_EQ(((TestData *)rbtree_at(tree_, i))->value_, i - 1);
+    }
+}
+
+
+TEST_F(RedBlackTreeTest, JoinSplit)
+{
+    const int nr_entries = 1000;
+    rcn_c::rbtree right;
+
+    rbtree_init(&right, _ValueCompare);
+
+    for (int i = 0; i < nr_entries; i++) {
+        auto data = new TestData(i);
+        rbtree_insert(tree_, &data->node_, data);
+    }
+
+    auto key = new TestData(nr_entries / 3);
+    auto node = rbtree_split(tree_, key, &right);
+
+    ASSERT_NE(node, nullptr);
+    ASSERT_EQ(((TestData *)node->entry_)->value_, nr_entries / 3);
+    ASSERT_TRUE(rbtree_validate(tree_));
+    ASSERT_TRUE(rbtree_validate(&right));
+    ASSERT_EQ(rbtree_size(tree_), nr_entries / 3);
+    ASSERT_EQ(rbtree_size(&right), nr_entries - nr_entries / 3 - 1);
+    ASSERT_EQ(((TestData *)rbtree_back(tree_))->value_, nr_entries / 3 - 1);
+    ASSERT_EQ(((TestData *)rbtree_front(&right))->value_, nr_entries / 3 + 1);
+
+    rbtree_join(tree_, node, node->entry_, &right);
+    ASSERT_TRUE(rbtree_validate(tree_));
+    ASSERT_TRUE(rbtree_empty(&right));
+    ASSERT_EQ(rbtree_size(tree_), nr_entries);
+
+    key->value_ = -1;
+    ASSERT_EQ(rbtree_split(tree_, key, &right), nullptr);
+    ASSERT_TRUE(rbtree_empty(tree_));
+    ASSERT_EQ(rbtree_size(&right), nr_entries);
+
+    rbtree_concat(tree_, &right);
+    ASSERT_TRUE(rbtree_validate(tree_));
+    ASSERT_EQ(rbtree_size(tree_), nr_entries);
+
+    for (int i = 0; i < nr_entries; i++) {
+        ASSERT_EQ(((TestData *)rbtree_at(tree_, i))->value_, i);
+    }
+
+    delete key;
+}
+
+TEST_F(RedBlackTreeTest, SetOperations)
+{
+    const int nr_entries = 1000;
+    rcn_c::rbtree other, rest;
+    std::vector<int> a, b, expected;
+
+    rbtree_init(&other, _ValueCompare);
+    rbtree_init(&rest, _ValueCompare);
+
+    auto values = [](rcn_c::rbtree *tree) {
+        std::vector<int> v;
+
+        for (auto x = rbtree_begin(tree); x != rbtree_end(tree);
+             x = rbtree_next(tree, x)) {
+            v.push_back(((TestData *)x->entry_)->value_);
+        }
+
+        return v;
+    };
+
+    auto fill = [this, &a, &b, &other]() {
+        a.clear();
+        b.clear();
+
+        for (int i = 0; i < nr_entries; i++) {
+            auto data = new TestData(i * 2);
+            rbtree_insert(tree_, &data->node_, data);
+            a.push_back(i * 2);
+
+            data = new TestData(i * 3);
+            rbtree_insert(&other, &data->node_, data);
+            b.push_back(i * 3);
+        }
+    };
+
+    auto drain = [](rcn_c::rbtree *tree) {
+        while (!rbtree_empty(tree)) {
+            delete (TestData *)rbtree_pop_front(tree);
+        }
+    };
+
+    fill();
+    rbtree_union(tree_, &other, &other);
+    ASSERT_TRUE(rbtree_validate(tree_));
+    ASSERT_TRUE(rbtree_validate(&other));
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                   std::back_inserter(expected));
+    ASSERT_EQ(values(tree_), expected);
+    expected.clear();
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                          std::back_inserter(expected));
+    ASSERT_EQ(values(&other), expected);
+    drain(tree_);
+    drain(&other);
+
+    fill();
+    rbtree_intersection(tree_, &other, &rest);
+    ASSERT_TRUE(rbtree_validate(tree_));
+    ASSERT_TRUE(rbtree_validate(&rest));
+    ASSERT_EQ(values(tree_), expected);
+    ASSERT_EQ(values(&other), b);
+    expected.clear();
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                        std::back_inserter(expected));
+    ASSERT_EQ(values(&rest), expected);
+    drain(tree_);
+    drain(&rest);
+    drain(&other);
+
+    fill();
+    rbtree_difference(tree_, &other, &rest);
+    ASSERT_TRUE(rbtree_validate(tree_));
+    ASSERT_TRUE(rbtree_validate(&rest));
+    ASSERT_EQ(values(tree_), expected);
+    drain(&rest);
+    drain(&other);
+}
+
+
+TEST_F(RedBlackTreeTest, InsertHint)
+{
+    const int nr_entries = 1000;
+    rcn_c::rbnode *hint = (rcn_c::rbnode *)rbtree_end(tree_);
+
+    /* Ascending with the last node as the hint, then the gaps after them. */
+    for (int i = 0; i < nr_entries; i += 2) {
+        auto data = new TestData(i);
+
+        ASSERT_EQ(rbtree_insert_hint(tree_, hint, &data->node_, data), 0);
+        hint = &data->node_;
+    }
+
+    for (int i = 1; i < nr_entries; i += 2) {
+        TestData key(i - 1);
+        auto data = new TestData(i);
+
+        hint = rbtree_find(tree_, &key);
+        ASSERT_EQ(rbtree_insert_hint(tree_, hint, &data->node_, data), 0);
+    }
+
+    /* A wrong hint falls back to a plain insert. */
+    auto data = new TestData(-1);
+    TestData dup(500);
+
+    ASSERT_EQ(rbtree_insert_hint(tree_, hint, &data->node_, data), 0);
+    ASSERT_EQ(rbtree_insert_hint(tree_, (rcn_c::rbnode *)rbtree_end(tree_),
+                                 &dup.node_, &dup),
+              -EEXIST);
+    ASSERT_EQ(rbtree_size(tree_), nr_entries + 1);
+    ASSERT_TRUE(rbtree_validate(tree_));
+
+    int i = -1;
+
+    for (auto x = rbtree_begin(tree_); x != rbtree_end(tree_);
+         x = rbtree_next(tree_, x)) {
+        ASSERT_EQ(((TestData *)x->entry_)->value_, i++);
+    }
+
+    ASSERT_EQ(i, nr_entries);
+}
+
+TEST_F(RedBlackTreeTest, InsertOrGet)
+{
+    auto data1 = new TestData(100);
+    auto data2 = new TestData(100);
+    auto data3 = new TestData(50);
+
+    ASSERT_EQ(rbtree_insert_or_get(tree_, &data1->node_, data1), &data1->node_);
+    ASSERT_EQ(rbtree_insert_or_get(tree_, &data2->node_, data2), &data1->node_);
+    ASSERT_EQ(rbtree_insert_or_get(tree_, &data3->node_, data3), &data3->node_);
+    ASSERT_EQ(rbtree_size(tree_), 2);
+    ASSERT_TRUE(rbtree_validate(tree_));
+
+    delete data2;
+}
+
+static void _CollectValue(void *e, void *arg)
+{
+    ((std::vector<int> *)arg)->push_back(((TestData *)e)->value_);
+}
+
+TEST_F(RedBlackTreeTest, Range)
+{
+    std::vector<int> ref;
+
+    /* Even values 0 .. 398, inserted in a scattered order. */
+    for (int i = 0; i < 200; i++) {
+        auto d = new TestData((i * 37 % 200) * 2);
+
+        rbtree_insert(tree_, &d->node_, d);
+        ref.push_back(i * 2);
+    }
+
+    for (int lo = -3; lo < 403; lo += 7) {
+        for (int hi = lo - 5; hi < 410; hi += 11) {
+            TestData key_lo(lo), key_hi(hi);
+            std::vector<int> values;
+            auto first = std::lower_bound(ref.begin(), ref.end(), lo);
+            auto last = std::lower_bound(ref.begin(), ref.end(), hi);
+            std::vector<int> expected(first, std::max(first, last));
+
+            ASSERT_EQ(rbtree_for_each_range(tree_, &key_lo, &key_hi,
+                                            _CollectValue, &values),
+                      expected.size());
+            ASSERT_EQ(values, expected);
+            ASSERT_EQ(rbtree_count_range(tree_, &key_lo, &key_hi),
+                      expected.size());
+        }
+    }
+
+    /* Cut out ranges until little is left. */
+    for (int lo = 5, round = 0; round < 12; lo = (lo + 97) % 400, round++) {
+        TestData key_lo(lo), key_hi(lo + 30 + round * 3);
+        auto first = std::lower_bound(ref.begin(), ref.end(), key_lo.value_);
+        auto last = std::lower_bound(ref.begin(), ref.end(), key_hi.value_);
+        std::vector<int> expected(first, last), values;
+        rcn_c::rbtree out;
+
+        rbtree_init(&out, _ValueCompare);
+        ASSERT_EQ(rbtree_erase_range(tree_, &key_lo, &key_hi, &out),
+                  expected.size());
+        ref.erase(first, last);
+
+        ASSERT_TRUE(rbtree_validate(tree_));
+        ASSERT_TRUE(rbtree_validate(&out));
+        ASSERT_EQ(rbtree_size(tree_), ref.size());
+
+        for (auto x = rbtree_begin(&out); x != rbtree_end(&out);
+             x = rbtree_next(&out, x)) {
+            values.push_back(((TestData *)x->entry_)->value_);
+        }
+
+        ASSERT_EQ(values, expected);
+
+        while (!rbtree_empty(&out)) {
+            delete (TestData *)rbtree_pop_front(&out);
+        }
+    }
+
+    std::vector<int> values;
+
+    for (auto x = rbtree_begin(tree_); x != rbtree_end(tree_);
+         x = rbtree_next(tree_, x)) {
+        values.push_back(((TestData *)x->entry_)->value_);
+    }
+
+    ASSERT_EQ(values, ref);
+
+    TestData key_lo(1000), key_hi(0);
+    rcn_c::rbtree out;
+
+    rbtree_init(&out, _ValueCompare);
+    ASSERT_EQ(rbtree_erase_range(tree_, &key_lo, &key_hi, &out), 0);
+    ASSERT_TRUE(rbtree_empty(&out));
+    ASSERT_EQ(rbtree_size(tree_), ref.size());
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
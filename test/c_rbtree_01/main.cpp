@@ -0,0 +1,9 @@
+/* The rbtree tests, with the color packed into the parent pointer. */
+#define RBTREE_COMPACT
+
+#include "../c_rbtree_00/main.cpp"
+
+TEST(RedBlackTreeCompactTest, NodeSize)
+{
+    EXPECT_EQ(sizeof(rcn_c::rbnode), 5 * sizeof(void *));
+}
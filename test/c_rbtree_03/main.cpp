@@ -0,0 +1,99 @@
+/* The rbtree tests, with the operation counters kept. */
+#define RBTREE_STATS
+
+#include "../c_rbtree_00/main.cpp"
+
+static void _Depths(const rcn_c::rbnode *x, size_t depth,
+                    std::vector<size_t> &hist)
+{
+    if (rcn_c::rbnode_is_nil(x)) {
+        return;
+    }
+
+    if (hist.size() <= depth) {
+        hist.resize(depth + 1);
+    }
+
+    hist[depth]++;
+    _Depths(x->left_, depth + 1, hist);
+    _Depths(x->right_, depth + 1, hist);
+}
+
+TEST_F(RedBlackTreeTest, Stats)
+{
+    const int nr_entries = 1000;
+    std::vector<TestData *> data;
+    auto stats = rbtree_stats(tree_);
+
+    for (int i = 0; i < nr_entries; i++) {
+        data.push_back(new TestData(i));
+        ASSERT_EQ(rbtree_insert(tree_, &data.back()->node_, data.back()), 0);
+    }
+
+    ASSERT_EQ(stats->nr_inserts_, nr_entries);
+    ASSERT_GE(stats->nr_insert_compars_, nr_entries - 1);
+    ASSERT_GT(stats->nr_rotations_, 0);
+    ASSERT_GT(stats->nr_fixups_, 0);
+    ASSERT_EQ(stats->nr_finds_, 0);
+
+    /* A duplicate takes the descent, but links nothing. */
+    TestData dup(0);
+
+    ASSERT_EQ(rbtree_insert(tree_, &dup.node_, &dup), -EEXIST);
+    ASSERT_EQ(stats->nr_inserts_, nr_entries);
+
+    rbtree_stats_reset(tree_);
+
+    for (int i = 0; i < nr_entries; i++) {
+        ASSERT_EQ(rbtree_find(tree_, data[i])->entry_, data[i]);
+    }
+
+    /* 2 * log2(n + 1) bounds the height of a red-black tree. */
+    ASSERT_EQ(stats->nr_finds_, nr_entries);
+    ASSERT_GE(stats->nr_find_compars_, nr_entries);
+    ASSERT_LE(stats->nr_find_compars_, nr_entries * 20);
+
+    rbtree_lower_bound(tree_, data[0]);
+    rbtree_upper_bound(tree_, data[0]);
+    ASSERT_EQ(stats->nr_finds_, nr_entries + 2);
+
+    for (int i = 0; i < nr_entries; i += 2) {
+        ASSERT_EQ(rbtree_erase(tree_, &data[i]->node_), data[i]);
+        delete data[i];
+    }
+
+    /* The lookup erase checks its node with is not counted. */
+    ASSERT_EQ(stats->nr_erases_, nr_entries / 2);
+    ASSERT_EQ(stats->nr_finds_, nr_entries + 2);
+    ASSERT_EQ(stats->nr_inserts_, 0);
+    ASSERT_EQ(stats->nr_rebuilt_, 0);
+}
+
+TEST_F(RedBlackTreeTest, DepthHistogram)
+{
+    const int nr_entries = 1000;
+    std::vector<size_t> expected;
+    size_t hist[32];
+
+    ASSERT_EQ(rbtree_depth_histogram(tree_, hist, 32), 0);
+    ASSERT_EQ(std::count(hist, hist + 32, 0), 32);
+
+    for (int i = 0; i < nr_entries; i++) {
+        auto data = new TestData(i * 7919 % nr_entries);
+
+        rbtree_insert(tree_, &data->node_, data);
+    }
+
+    _Depths(tree_->root_, 0, expected);
+    ASSERT_EQ(rbtree_depth_histogram(tree_, hist, 32), expected.size());
+
+    for (size_t d = 0; d < 32; d++) {
+        ASSERT_EQ(hist[d], d < expected.size() ? expected[d] : 0);
+    }
+
+    /* The deeper nodes add up in the last bucket. */
+    ASSERT_EQ(rbtree_depth_histogram(tree_, hist, 3), expected.size());
+    ASSERT_EQ(hist[0], 1);
+    ASSERT_EQ(hist[1], 2);
+    ASSERT_EQ(hist[2], nr_entries - 3);
+}
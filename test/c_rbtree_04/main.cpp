@@ -0,0 +1,81 @@
+/*
+ * The rbtree tests, with the set operations forking down to small subtrees,
+ * as on a machine of 16 CPUs.
+ */
+#define RBTREE_FORK_GRAIN 8
+#define RBTREE_FORK_CPUS 16
+
+#include <random>
+#include <set>
+
+#include "../c_rbtree_00/main.cpp"
+
+/* Random sets of all sizes, checked against std::set. */
+TEST_F(RedBlackTreeTest, ForkedSetOperations)
+{
+    std::mt19937 gen(33);
+
+    auto values = [](rcn_c::rbtree *tree) {
+        std::set<int> v;
+
+        for (auto x = rbtree_begin(tree); x != rbtree_end(tree);
+             x = rbtree_next(tree, x)) {
+            v.insert(((TestData *)x->entry_)->value_);
+        }
+
+        return v;
+    };
+
+    auto fill = [&gen](rcn_c::rbtree *tree, size_t nr, std::set<int> &v) {
+        for (size_t i = 0; i < nr; i++) {
+            auto data = new TestData(gen() % 8000);
+
+            if (rbtree_insert(tree, &data->node_, data) == 0) {
+                v.insert(data->value_);
+            } else {
+                delete data;
+            }
+        }
+    };
+
+    auto drain = [](rcn_c::rbtree *tree) {
+        while (!rbtree_empty(tree)) {
+            delete (TestData *)rbtree_pop_front(tree);
+        }
+    };
+
+    for (int round = 0; round < 30; round++) {
+        rcn_c::rbtree other, rest;
+        std::set<int> a, b, both, only;
+
+        rbtree_init(&other, _ValueCompare);
+        rbtree_init(&rest, _ValueCompare);
+        fill(tree_, gen() % 4000, a);
+        fill(&other, gen() % 4000, b);
+
+        for (int v : a) {
+            (b.count(v) ? both : only).insert(v);
+        }
+
+        if (round % 3 == 0) {
+            rbtree_union(tree_, &other, &rest);
+            a.insert(b.begin(), b.end());
+            ASSERT_EQ(values(tree_), a);
+            ASSERT_EQ(values(&rest), both);
+        } else if (round % 3 == 1) {
+            rbtree_intersection(tree_, &other, &rest);
+            ASSERT_EQ(values(tree_), both);
+            ASSERT_EQ(values(&rest), only);
+        } else {
+            rbtree_difference(tree_, &other, &rest);
+            ASSERT_EQ(values(tree_), only);
+            ASSERT_EQ(values(&rest), both);
+        }
+
+        ASSERT_TRUE(rbtree_validate(tree_));
+        ASSERT_TRUE(rbtree_validate(&rest));
+        drain(tree_);
+        drain(&other);
+        drain(&rest);
+    }
+}
@@ -0,0 +1,200 @@
+#include <cstddef>
+#include <cstring>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rcn_c/rbtree_idx.h"
+
+struct TestData {
+    rcn_c::rbidx_node node_;
+    int value_;
+};
+
+/* A pool meant to be copied around as a whole, root included. */
+struct TestPool {
+    rcn_c::rbidx_root root_;
+    TestData data_[1024];
+};
+
+class RedBlackTreeIdxTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        pool_ = new TestPool;
+        Attach(pool_);
+        rbidx_clear(&tree_);
+
+        for (uint32_t i = 0; i < nr_records; i++) {
+            pool_->data_[i].value_ = i;
+        }
+    }
+
+    void TearDown() override
+    {
+        delete pool_;
+    }
+
+    void Attach(TestPool *pool)
+    {
+        rbidx_init(&tree_, &pool->root_, pool->data_, sizeof(TestData),
+                   offsetof(TestData, node_), _ValueCompare);
+    }
+
+    uint32_t Find(int value)
+    {
+        TestData key;
+
+        key.value_ = value;
+        return rbidx_find(&tree_, &key);
+    }
+
+    static int _ValueCompare(const void *_ke, const void *_in_tree)
+    {
+        auto ke = (const TestData *)_ke;
+        auto in_tree = (const TestData *)_in_tree;
+
+        return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+    }
+
+    static const uint32_t nr_records = 1024;
+
+    TestPool *pool_;
+    rcn_c::rbidx tree_;
+};
+
+TEST_F(RedBlackTreeIdxTest, InitAndEmpty)
+{
+    ASSERT_TRUE(rbidx_empty(&tree_));
+    ASSERT_EQ(rbidx_begin(&tree_), rbidx_end(&tree_));
+    ASSERT_TRUE(rbidx_validate(&tree_));
+}
+
+TEST_F(RedBlackTreeIdxTest, NodeSize)
+{
+    EXPECT_EQ(sizeof(rcn_c::rbidx_node), 12);
+}
+
+TEST_F(RedBlackTreeIdxTest, InsertAndFind)
+{
+    ASSERT_EQ(rbidx_insert(&tree_, RBIDX_NIL), -EINVAL);
+
+    for (uint32_t i = nr_records - 1; i > 0; i--) {
+        ASSERT_EQ(rbidx_insert(&tree_, i), 0);
+    }
+
+    ASSERT_EQ(rbidx_size(&tree_), nr_records - 1);
+    ASSERT_TRUE(rbidx_validate(&tree_));
+    ASSERT_EQ(rbidx_insert(&tree_, 7), -EEXIST);
+
+    for (uint32_t i = 1; i < nr_records; i++) {
+        ASSERT_EQ(Find(i), i);
+    }
+
+    ASSERT_EQ(Find(nr_records), RBIDX_NIL);
+}
+
+TEST_F(RedBlackTreeIdxTest, Iterate)
+{
+    uint32_t x;
+    int n = 0;
+
+    for (uint32_t i = 1; i < nr_records; i += 2) {
+        rbidx_insert(&tree_, i);
+    }
+
+    for (x = rbidx_begin(&tree_); x != rbidx_end(&tree_);
+         x = rbidx_next(&tree_, x)) {
+        ASSERT_EQ(((TestData *)rbidx_entry(&tree_, x))->value_, 2 * n + 1);
+        n++;
+    }
+
+    ASSERT_EQ(n, (int)rbidx_size(&tree_));
+
+    for (x = rbidx_rbegin(&tree_); x != rbidx_end(&tree_);
+         x = rbidx_prev(&tree_, x)) {
+        n--;
+        ASSERT_EQ(((TestData *)rbidx_entry(&tree_, x))->value_, 2 * n + 1);
+    }
+
+    TestData key;
+
+    key.value_ = 10;
+    ASSERT_EQ(rbidx_lower_bound(&tree_, &key), 11);
+    key.value_ = 11;
+    ASSERT_EQ(rbidx_lower_bound(&tree_, &key), 11);
+    key.value_ = nr_records;
+    ASSERT_EQ(rbidx_lower_bound(&tree_, &key), RBIDX_NIL);
+}
+
+TEST_F(RedBlackTreeIdxTest, RandomInsertErase)
+{
+    std::mt19937 gen(37);
+    std::set<uint32_t> expected;
+
+    for (int i = 0; i < 20000; i++) {
+        uint32_t x = gen() % (nr_records - 1) + 1;
+
+        if (expected.count(x)) {
+            ASSERT_EQ(rbidx_erase(&tree_, x), 0);
+            expected.erase(x);
+        } else {
+            ASSERT_EQ(rbidx_insert(&tree_, x), 0);
+            expected.insert(x);
+        }
+
+        if (i % 1000 == 0) {
+            ASSERT_TRUE(rbidx_validate(&tree_));
+        }
+    }
+
+    ASSERT_TRUE(rbidx_validate(&tree_));
+    ASSERT_EQ(rbidx_size(&tree_), expected.size());
+
+    uint32_t x = rbidx_begin(&tree_);
+
+    for (uint32_t e : expected) {
+        ASSERT_EQ(x, e);
+        x = rbidx_next(&tree_, x);
+    }
+
+    while (!rbidx_empty(&tree_)) {
+        ASSERT_EQ(rbidx_erase(&tree_, rbidx_begin(&tree_)), 0);
+    }
+
+    ASSERT_TRUE(rbidx_validate(&tree_));
+}
+
+TEST_F(RedBlackTreeIdxTest, Relocate)
+{
+    std::vector<char> copy(sizeof(TestPool));
+
+    for (uint32_t i = 1; i < nr_records; i++) {
+        rbidx_insert(&tree_, (i * 37) % (nr_records - 1) + 1);
+    }
+
+    for (uint32_t i = 1; i < nr_records; i += 3) {
+        rbidx_erase(&tree_, i);
+    }
+
+    memcpy(copy.data(), pool_, sizeof(TestPool));
+    memset(pool_, 0, sizeof(TestPool));
+    Attach((TestPool *)copy.data());
+
+    ASSERT_TRUE(rbidx_validate(&tree_));
+
+    for (uint32_t i = 1; i < nr_records; i++) {
+        ASSERT_EQ(Find(i), i % 3 == 1 ? RBIDX_NIL : i);
+    }
+
+    ASSERT_EQ(rbidx_erase(&tree_, 2), 0);
+    ASSERT_EQ(Find(2), RBIDX_NIL);
+    ASSERT_TRUE(rbidx_validate(&tree_));
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,181 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rcn_c/rbtree_latch.h"
+
+struct TestData {
+    TestData(int value)
+        : value_(value)
+    {
+    }
+
+    rcn_c::rblatch_node node_;
+    int value_;
+};
+
+class RBTreeLatchTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        tree_ = new rcn_c::rbtree_latch;
+        rbtree_latch_init(tree_, _ValueCompare);
+    }
+
+    void TearDown() override
+    {
+        rbtree_latch_destroy(tree_);
+        delete tree_;
+    }
+
+    static int _ValueCompare(const void *_ke, const void *_in_tree)
+    {
+        auto ke = (const TestData *)_ke;
+        auto in_tree = (const TestData *)_in_tree;
+
+        if (ke->value_ < in_tree->value_) {
+            return -1;
+        }
+
+        if (ke->value_ > in_tree->value_) {
+            return 1;
+        }
+
+        return 0;
+    }
+
+    rcn_c::rbtree_latch *tree_;
+};
+
+TEST_F(RBTreeLatchTest, InitAndEmpty)
+{
+    TestData key(0);
+    unsigned int token = rbtree_latch_read_lock(tree_);
+
+    ASSERT_TRUE(rbtree_latch_empty(tree_));
+    ASSERT_EQ(rbtree_latch_find(tree_, &key), nullptr);
+    ASSERT_TRUE(rbtree_latch_validate(tree_));
+
+    rbtree_latch_read_unlock(tree_, token);
+}
+
+TEST_F(RBTreeLatchTest, InsertFindErase)
+{
+    std::vector<TestData> data;
+
+    for (int i = 0; i < 100; i++) {
+        data.emplace_back(i * 2);
+    }
+
+    for (auto &d : data) {
+        ASSERT_EQ(rbtree_latch_insert(tree_, &d.node_, &d), 0);
+    }
+
+    TestData dup(10);
+
+    ASSERT_EQ(rbtree_latch_insert(tree_, &dup.node_, &dup), -EEXIST);
+    ASSERT_EQ(rbtree_latch_size(tree_), 100);
+    ASSERT_TRUE(rbtree_latch_validate(tree_));
+
+    unsigned int token = rbtree_latch_read_lock(tree_);
+    TestData key(10);
+
+    ASSERT_EQ(rbtree_latch_find(tree_, &key), &data[5]);
+    key.value_ = 11;
+    ASSERT_EQ(rbtree_latch_find(tree_, &key), nullptr);
+    ASSERT_EQ(rbtree_latch_lower_bound(tree_, &key), &data[6]);
+    key.value_ = 198;
+    ASSERT_EQ(rbtree_latch_lower_bound(tree_, &key), &data[99]);
+    key.value_ = 199;
+    ASSERT_EQ(rbtree_latch_lower_bound(tree_, &key), nullptr);
+
+    rbtree_latch_read_unlock(tree_, token);
+
+    for (size_t i = 0; i < data.size(); i += 2) {
+        ASSERT_EQ(rbtree_latch_erase(tree_, &data[i].node_), &data[i]);
+    }
+
+    rbtree_latch_synchronize(tree_);
+    ASSERT_EQ(rbtree_latch_size(tree_), 50);
+    ASSERT_TRUE(rbtree_latch_validate(tree_));
+
+    token = rbtree_latch_read_lock(tree_);
+    key.value_ = 8;
+    ASSERT_EQ(rbtree_latch_find(tree_, &key), nullptr);
+    ASSERT_EQ(rbtree_latch_lower_bound(tree_, &key), &data[5]);
+    key.value_ = 10;
+    ASSERT_EQ(rbtree_latch_find(tree_, &key), &data[5]);
+    rbtree_latch_read_unlock(tree_, token);
+}
+
+TEST_F(RBTreeLatchTest, ConcurrentReaders)
+{
+    const int nr_stable = 1000;
+    const int nr_readers = 4;
+    std::vector<TestData> stable;
+    std::atomic<bool> stop(false);
+    std::atomic<long> misses(0);
+    std::vector<std::thread> readers;
+
+    /* The nodes must not move once linked. */
+    stable.reserve(nr_stable);
+
+    for (int i = 0; i < nr_stable; i++) {
+        stable.emplace_back(i * 2);
+        rbtree_latch_insert(tree_, &stable.back().node_, &stable.back());
+    }
+
+    for (int t = 0; t < nr_readers; t++) {
+        readers.emplace_back([&, t] {
+            for (int i = t; !stop.load(); i = (i + 7) % nr_stable) {
+                TestData key(i * 2);
+                unsigned int token = rbtree_latch_read_lock(tree_);
+
+                if (rbtree_latch_find(tree_, &key) != &stable[i]) {
+                    misses++;
+                }
+
+                rbtree_latch_read_unlock(tree_, token);
+            }
+        });
+    }
+
+    /* Odd values come and go, and their nodes are recycled. */
+    for (int round = 0; round < 200; round++) {
+        std::vector<TestData *> volatiles;
+
+        for (int i = 0; i < 50; i++) {
+            auto d = new TestData(((round * 50 + i) % nr_stable) * 2 + 1);
+
+            ASSERT_EQ(rbtree_latch_insert(tree_, &d->node_, d), 0);
+            volatiles.push_back(d);
+        }
+
+        for (auto d : volatiles) {
+            ASSERT_EQ(rbtree_latch_erase(tree_, &d->node_), d);
+        }
+
+        rbtree_latch_synchronize(tree_);
+
+        for (auto d : volatiles) {
+            delete d;
+        }
+    }
+
+    stop = true;
+
+    for (auto &r : readers) {
+        r.join();
+    }
+
+    ASSERT_EQ(misses.load(), 0);
+    ASSERT_EQ(rbtree_latch_size(tree_), nr_stable);
+    ASSERT_TRUE(rbtree_latch_validate(tree_));
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
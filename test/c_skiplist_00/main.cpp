@@ -0,0 +1,263 @@
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rcn_c/skiplist.h"
+
+struct TestData {
+    TestData(int value)
+        : value_(value)
+    {
+    }
+
+    rcn_c::skipnode node_;
+    int value_;
+};
+
+class SkipListTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        list_ = new rcn_c::skiplist;
+        skiplist_init(list_, _ValueCompare);
+    }
+
+    void TearDown() override
+    {
+        skiplist_destroy(list_);
+        delete list_;
+    }
+
+    static int _ValueCompare(const void *_ke, const void *_in_tree)
+    {
+        auto ke = (const TestData *)_ke;
+        auto in_tree = (const TestData *)_in_tree;
+
+        if (ke->value_ < in_tree->value_) {
+            return -1;
+        }
+
+        if (ke->value_ > in_tree->value_) {
+            return 1;
+        }
+
+        return 0;
+    }
+
+    static void _Release(rcn_c::skipnode *x)
+    {
+        delete (TestData *)x->entry_;
+    }
+
+    static int _Value(const rcn_c::skipnode *x)
+    {
+        return ((const TestData *)x->entry_)->value_;
+    }
+
+    rcn_c::skiplist *list_;
+};
+
+TEST_F(SkipListTest, InitAndEmpty)
+{
+    TestData key(0);
+    unsigned int token = skiplist_read_lock(list_);
+
+    ASSERT_TRUE(skiplist_empty(list_));
+    ASSERT_EQ(skiplist_find(list_, &key), nullptr);
+    ASSERT_EQ(skiplist_lower_bound(list_, &key), nullptr);
+    ASSERT_EQ(skiplist_begin(list_), skiplist_end(list_));
+    ASSERT_TRUE(skiplist_validate(list_));
+
+    skiplist_read_unlock(list_, token);
+}
+
+TEST_F(SkipListTest, InsertFindErase)
+{
+    std::vector<TestData> data;
+    unsigned int token = skiplist_read_lock(list_);
+
+    for (int i = 0; i < 100; i++) {
+        data.emplace_back(i * 2);
+    }
+
+    for (auto &d : data) {
+        ASSERT_EQ(skiplist_insert(list_, &d.node_, &d), 0);
+    }
+
+    TestData dup(10);
+
+    ASSERT_EQ(skiplist_insert(list_, &dup.node_, &dup), -EEXIST);
+    ASSERT_EQ(skiplist_size(list_), 100);
+    ASSERT_TRUE(skiplist_validate(list_));
+
+    TestData key(10);
+
+    ASSERT_EQ(skiplist_find(list_, &key), &data[5].node_);
+    ASSERT_EQ(skiplist_lower_bound(list_, &key), &data[5].node_);
+    ASSERT_EQ(skiplist_upper_bound(list_, &key), &data[6].node_);
+    key.value_ = 11;
+    ASSERT_EQ(skiplist_find(list_, &key), nullptr);
+    ASSERT_EQ(skiplist_lower_bound(list_, &key), &data[6].node_);
+    ASSERT_EQ(skiplist_upper_bound(list_, &key), &data[6].node_);
+    key.value_ = 198;
+    ASSERT_EQ(skiplist_upper_bound(list_, &key), nullptr);
+    key.value_ = -1;
+    ASSERT_EQ(skiplist_lower_bound(list_, &key), skiplist_begin(list_));
+
+    for (size_t i = 0; i < data.size(); i += 2) {
+        ASSERT_EQ(skiplist_erase(list_, &data[i].node_), &data[i]);
+        ASSERT_EQ(skiplist_erase(list_, &data[i].node_), nullptr);
+    }
+
+    ASSERT_EQ(skiplist_size(list_), 50);
+    ASSERT_TRUE(skiplist_validate(list_));
+
+    key.value_ = 8;
+    ASSERT_EQ(skiplist_find(list_, &key), nullptr);
+    ASSERT_EQ(skiplist_lower_bound(list_, &key), &data[5].node_);
+
+    int expected = 2;
+
+    for (auto x = skiplist_begin(list_); x != skiplist_end(list_);
+         x = skiplist_next(list_, x)) {
+        ASSERT_EQ(_Value(x), expected);
+        expected += 4;
+    }
+
+    ASSERT_EQ(expected, 202);
+
+    skiplist_read_unlock(list_, token);
+}
+
+TEST_F(SkipListTest, RandomAgainstSet)
+{
+    std::set<int> ref;
+    unsigned int seed = 1;
+
+    for (int i = 0; i < 20000; i++) {
+        int value = rand_r(&seed) % 2000;
+        TestData key(value);
+        unsigned int token = skiplist_read_lock(list_);
+        auto x = skiplist_find(list_, &key);
+
+        if (x == nullptr) {
+            auto d = new TestData(value);
+
+            ASSERT_EQ(skiplist_insert(list_, &d->node_, d), 0);
+            ref.insert(value);
+        } else {
+            ASSERT_EQ(skiplist_erase(list_, x), x->entry_);
+            skiplist_retire(list_, x);
+            ref.erase(value);
+        }
+
+        skiplist_read_unlock(list_, token);
+
+        if (i % 1000 == 0) {
+            skiplist_reclaim(list_, _Release);
+        }
+    }
+
+    unsigned int token = skiplist_read_lock(list_);
+    auto it = ref.begin();
+
+    ASSERT_EQ(skiplist_size(list_), ref.size());
+    ASSERT_TRUE(skiplist_validate(list_));
+
+    for (auto x = skiplist_begin(list_); x != skiplist_end(list_);
+         x = skiplist_next(list_, x), it++) {
+        ASSERT_EQ(_Value(x), *it);
+    }
+
+    ASSERT_EQ(it, ref.end());
+
+    for (auto x = skiplist_begin(list_); x != skiplist_end(list_);
+         x = skiplist_next(list_, x)) {
+        skiplist_erase(list_, x);
+        skiplist_retire(list_, x);
+    }
+
+    skiplist_read_unlock(list_, token);
+    skiplist_reclaim(list_, _Release);
+    ASSERT_TRUE(skiplist_empty(list_));
+}
+
+TEST_F(SkipListTest, ConcurrentInsertErase)
+{
+    const int nr_threads = 4;
+    const int nr_values = 4000;
+    std::vector<std::thread> threads;
+    std::atomic<int> nr_inserted(0), nr_erased(0);
+
+    /* All threads race on the same values, each winning some of them. */
+    for (int t = 0; t < nr_threads; t++) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < nr_values; i++) {
+                int value = (i * 7 + t) % nr_values;
+                auto d = new TestData(value);
+                unsigned int token = skiplist_read_lock(list_);
+
+                if (skiplist_insert(list_, &d->node_, d) == 0) {
+                    nr_inserted++;
+                } else {
+                    delete d;
+                }
+
+                /* Odd values are erased again by whoever gets there first. */
+                if (value & 1) {
+                    TestData key(value);
+                    auto x = skiplist_find(list_, &key);
+
+                    if ((x != nullptr) &&
+                        (skiplist_erase(list_, x) != nullptr)) {
+                        skiplist_retire(list_, x);
+                        nr_erased++;
+                    }
+                }
+
+                skiplist_read_unlock(list_, token);
+
+                if (i % 500 == 0) {
+                    skiplist_reclaim(list_, _Release);
+                }
+            }
+        });
+    }
+
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    ASSERT_TRUE(skiplist_validate(list_));
+
+    unsigned int token = skiplist_read_lock(list_);
+    int expected = 0;
+
+    /* Whoever inserted an odd value tried to erase it right after. */
+    for (auto x = skiplist_begin(list_); x != skiplist_end(list_);
+         x = skiplist_next(list_, x)) {
+        ASSERT_EQ(_Value(x), expected);
+        expected += 2;
+    }
+
+    ASSERT_EQ(expected, nr_values);
+    ASSERT_EQ(nr_inserted - nr_erased, nr_values / 2);
+    ASSERT_EQ(skiplist_size(list_), (size_t)nr_values / 2);
+
+    for (auto x = skiplist_begin(list_); x != skiplist_end(list_);
+         x = skiplist_next(list_, x)) {
+        skiplist_erase(list_, x);
+        skiplist_retire(list_, x);
+    }
+
+    skiplist_read_unlock(list_, token);
+    skiplist_reclaim(list_, _Release);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
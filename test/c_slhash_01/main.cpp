@@ -0,0 +1,303 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rcn_c/slhash.h"
+
+struct TestData {
+    TestData(int value)
+        : value_(value)
+    {
+    }
+
+    rcn_c::slnode node_;
+    int value_;
+};
+
+class SLHashResizeTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(slhash_init_resizable(&table_, 0, _KeyHash, _ValueCompare),
+                  0);
+    }
+
+    void TearDown() override
+    {
+        while (!slhash_empty(&table_)) {
+            rcn_c::slnode *x = slhash_begin(&table_);
+            delete (TestData *)slhash_erase(&table_, x);
+        }
+
+        slhash_destroy(&table_);
+    }
+
+    static size_t _KeyHash(const void *_ke)
+    {
+        auto ke = (const TestData *)_ke;
+
+        return ke->value_;
+    }
+
+    static int _ValueCompare(const void *_ke, const void *_in_table)
+    {
+        auto ke = (const TestData *)_ke;
+        auto in_table = (const TestData *)_in_table;
+
+        return (ke->value_ > in_table->value_) -
+               (ke->value_ < in_table->value_);
+    }
+
+    int Insert(int value)
+    {
+        auto data = new TestData(value);
+        int err = slhash_insert(&table_, &data->node_, data);
+
+        if (err != 0) {
+            delete data;
+        }
+
+        return err;
+    }
+
+    bool Remove(int value)
+    {
+        TestData key(value);
+        rcn_c::slnode *x = slhash_remove(&table_, &key);
+
+        if (x == NULL) {
+            return false;
+        }
+
+        delete (TestData *)x->entry_;
+
+        return true;
+    }
+
+    bool Find(int value)
+    {
+        TestData key(value);
+
+        return slhash_at(&table_, &key) != NULL;
+    }
+
+    rcn_c::slhash table_;
+};
+
+TEST_F(SLHashResizeTest, Init)
+{
+    ASSERT_TRUE(slhash_empty(&table_));
+    ASSERT_EQ(slhash_buckets(&table_), SLHASH_MIN_BUCKETS);
+    ASSERT_FALSE(slhash_rehashing(&table_));
+    ASSERT_TRUE(slhash_validate(&table_));
+    ASSERT_EQ(slhash_begin(&table_), slhash_end(&table_));
+}
+
+TEST_F(SLHashResizeTest, GrowWhileLookingUp)
+{
+    const int nr = 5000;
+    size_t nr_rehashing = 0;
+
+    for (int i = 0; i < nr; i++) {
+        ASSERT_EQ(Insert(i), 0);
+
+        if (!slhash_rehashing(&table_)) {
+            continue;
+        }
+
+        nr_rehashing++;
+
+        if (i % 7 == 0) {
+            ASSERT_TRUE(slhash_validate(&table_));
+
+            for (int j = 0; j <= i; j++) {
+                ASSERT_TRUE(Find(j));
+                ASSERT_EQ(Insert(j), -EEXIST);
+            }
+
+            ASSERT_FALSE(Find(i + 1));
+        }
+    }
+
+    ASSERT_NE(nr_rehashing, 0);
+    ASSERT_EQ(slhash_size(&table_), nr);
+    ASSERT_GE(slhash_buckets(&table_) * SLHASH_MAX_LOAD, nr * 50);
+    ASSERT_TRUE(slhash_validate(&table_));
+
+    while (slhash_rehash(&table_, 1)) {
+    }
+
+    ASSERT_TRUE(slhash_validate(&table_));
+
+    for (int i = 0; i < nr; i++) {
+        ASSERT_TRUE(Find(i));
+    }
+}
+
+TEST_F(SLHashResizeTest, Shrink)
+{
+    const int nr = 10000;
+
+    for (int i = 0; i < nr; i++) {
+        ASSERT_EQ(Insert(i), 0);
+    }
+
+    size_t nr_buckets = slhash_buckets(&table_);
+
+    for (int i = 0; i < nr - 10; i++) {
+        ASSERT_TRUE(Remove(i));
+
+        if (i % 101 == 0) {
+            ASSERT_TRUE(slhash_validate(&table_));
+        }
+    }
+
+    while (slhash_rehash(&table_, 1)) {
+    }
+
+    ASSERT_EQ(slhash_size(&table_), 10);
+    ASSERT_LT(slhash_buckets(&table_), nr_buckets / 100);
+    ASSERT_GE(slhash_buckets(&table_), SLHASH_MIN_BUCKETS);
+    ASSERT_TRUE(slhash_validate(&table_));
+
+    for (int i = nr - 10; i < nr; i++) {
+        ASSERT_TRUE(Find(i));
+    }
+}
+
+TEST_F(SLHashResizeTest, IterateAndEraseWhileRehashing)
+{
+    int nr = 0;
+
+    while (!slhash_rehashing(&table_) || nr < 100) {
+        ASSERT_EQ(Insert(nr++), 0);
+    }
+
+    std::set<int> seen;
+
+    for (rcn_c::slnode *x = slhash_begin(&table_); x != slhash_end(&table_);
+         x = slhash_next(&table_, x)) {
+        ASSERT_TRUE(seen.insert(((TestData *)x->entry_)->value_).second);
+    }
+
+    ASSERT_EQ(seen.size(), (size_t)nr);
+
+    for (rcn_c::slnode *x = slhash_begin(&table_), *y;
+         x != slhash_end(&table_); x = y) {
+        y = slhash_next(&table_, x);
+
+        if (((TestData *)x->entry_)->value_ % 2 != 0) {
+            delete (TestData *)slhash_erase(&table_, x);
+        }
+    }
+
+    ASSERT_TRUE(slhash_rehashing(&table_));
+    ASSERT_EQ(slhash_size(&table_), (size_t)(nr + 1) / 2);
+    ASSERT_TRUE(slhash_validate(&table_));
+
+    for (int i = 0; i < nr; i++) {
+        ASSERT_EQ(Find(i), i % 2 == 0);
+    }
+}
+
+TEST_F(SLHashResizeTest, RandomOps)
+{
+    std::mt19937 gen(49);
+    std::set<int> ref;
+
+    for (int i = 0; i < 100000; i++) {
+        int value = gen() % 4096;
+
+        /* Grows up to 4096 entries, then shrinks down, then again. */
+        if ((i / 20000) % 2 == 0 ? gen() % 4 != 0 : gen() % 4 == 0) {
+            ASSERT_EQ(Insert(value), ref.insert(value).second ? 0 : -EEXIST);
+        } else {
+            ASSERT_EQ(Remove(value), ref.erase(value) != 0);
+        }
+
+        if (i % 997 == 0) {
+            ASSERT_TRUE(slhash_validate(&table_));
+            ASSERT_EQ(slhash_size(&table_), ref.size());
+
+            for (int v : ref) {
+                ASSERT_TRUE(Find(v));
+            }
+        }
+    }
+
+    ASSERT_TRUE(slhash_validate(&table_));
+}
+
+TEST_F(SLHashResizeTest, InsertMulti)
+{
+    for (int i = 0; i < 1000; i++) {
+        auto data = new TestData(i % 10);
+
+        slhash_insert_multi(&table_, &data->node_, data);
+    }
+
+    ASSERT_EQ(slhash_size(&table_), 1000);
+    ASSERT_TRUE(slhash_validate(&table_));
+
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(Remove(i % 10));
+    }
+
+    ASSERT_TRUE(slhash_empty(&table_));
+    ASSERT_TRUE(slhash_validate(&table_));
+}
+
+TEST_F(SLHashResizeTest, Clear)
+{
+    std::vector<TestData *> data;
+    int nr = 0;
+
+    while (!slhash_rehashing(&table_) || nr < 100) {
+        data.push_back(new TestData(nr++));
+        slhash_insert(&table_, &data.back()->node_, data.back());
+    }
+
+    slhash_clear(&table_);
+
+    ASSERT_TRUE(slhash_empty(&table_));
+    ASSERT_FALSE(slhash_rehashing(&table_));
+    ASSERT_TRUE(slhash_validate(&table_));
+
+    for (auto d : data) {
+        delete d;
+    }
+
+    ASSERT_EQ(Insert(1), 0);
+    ASSERT_TRUE(Find(1));
+}
+
+TEST_F(SLHashResizeTest, FixedTableStays)
+{
+    rcn_c::slhash fixed;
+    std::vector<TestData> data;
+
+    for (int i = 0; i < 1000; i++) {
+        data.emplace_back(i);
+    }
+
+    slhash_init(&fixed, 53, _KeyHash, _ValueCompare, nullptr);
+    __slhash_alloc_bucket(&fixed);
+
+    for (auto &d : data) {
+        ASSERT_EQ(slhash_insert(&fixed, &d.node_, &d), 0);
+    }
+
+    ASSERT_EQ(slhash_buckets(&fixed), 53);
+    ASSERT_FALSE(slhash_rehashing(&fixed));
+    ASSERT_TRUE(slhash_validate(&fixed));
+
+    __slhash_free_bucket(&fixed);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,206 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rcn_c/rbtree.h"
+#include "rcn_c/snapshot.h"
+
+/* The node is saved along, and only rebuilt in place after a load. */
+struct TestData {
+    int value_;
+    int payload_;
+    rcn_c::rbnode node_;
+};
+
+class SnapshotTest : public ::testing::TestWithParam<rcn_c::snapshot_layout> {
+protected:
+    void SetUp() override
+    {
+        char path[] = "/tmp/c_snapshot_00.XXXXXX";
+        int fd = mkstemp(path);
+
+        ASSERT_GE(fd, 0);
+        close(fd);
+        path_ = path;
+        rbtree_init(&tree_, _ValueCompare);
+    }
+
+    void TearDown() override
+    {
+        unlink(path_.c_str());
+    }
+
+    static int _ValueCompare(const void *_ke, const void *_in_tree)
+    {
+        auto ke = (const TestData *)_ke;
+        auto in_tree = (const TestData *)_in_tree;
+
+        if (ke->value_ < in_tree->value_) {
+            return -1;
+        }
+
+        if (ke->value_ > in_tree->value_) {
+            return 1;
+        }
+
+        return 0;
+    }
+
+    /* Walks the tree for snapshot_save(). */
+    static const void *_Next(void *_it)
+    {
+        auto it = (std::pair<rcn_c::rbtree *, rcn_c::rbnode *> *)_it;
+        const void *e = it->second->entry_;
+
+        it->second = rbtree_next(it->first, it->second);
+
+        return e;
+    }
+
+    int Save(rcn_c::snapshot_layout layout)
+    {
+        std::pair<rcn_c::rbtree *, rcn_c::rbnode *> it(&tree_,
+                                                       rbtree_begin(&tree_));
+
+        return snapshot_save(path_.c_str(), sizeof(TestData),
+                             rbtree_size(&tree_), layout, _Next, &it);
+    }
+
+    std::string path_;
+    rcn_c::rbtree tree_;
+};
+
+TEST_P(SnapshotTest, Empty)
+{
+    rcn_c::snapshot snap = {};
+    TestData key = { 1, 0, {} };
+
+    ASSERT_EQ(Save(GetParam()), 0);
+    ASSERT_EQ(snapshot_open(&snap, path_.c_str(), sizeof(TestData),
+                            _ValueCompare),
+              0);
+    ASSERT_TRUE(snapshot_empty(&snap));
+    ASSERT_EQ(snapshot_lower_bound(&snap, &key), nullptr);
+    snapshot_close(&snap);
+}
+
+TEST_P(SnapshotTest, LookupAndRebuild)
+{
+    /* Sizes around a full implicit tree, to cover the partial last level. */
+    for (size_t n : { 1, 2, 3, 7, 8, 100, 1023, 1024, 1025 }) {
+        std::vector<TestData> data(n);
+        rcn_c::snapshot snap = {};
+
+        rbtree_clear(&tree_);
+
+        for (size_t i = 0; i < n; i++) {
+            data[i].value_ = (i * 37 % n) * 2;
+            data[i].payload_ = -data[i].value_;
+            rbtree_insert(&tree_, &data[i].node_, &data[i]);
+        }
+
+        ASSERT_EQ(Save(GetParam()), 0);
+        ASSERT_EQ(snapshot_open(&snap, path_.c_str(), sizeof(TestData),
+                                _ValueCompare),
+                  0);
+        ASSERT_EQ(snapshot_size(&snap), n);
+
+        for (int v = -1; v <= (int)n * 2; v++) {
+            TestData key = { v, 0, {} };
+            auto e = (TestData *)snapshot_lower_bound(&snap, &key);
+            int expected = v < 0 ? 0 : (v + 1) / 2 * 2;
+
+            if (expected >= (int)n * 2) {
+                ASSERT_EQ(e, nullptr);
+                continue;
+            }
+
+            ASSERT_NE(e, nullptr);
+            ASSERT_EQ(e->value_, expected);
+            ASSERT_EQ(e->payload_, -expected);
+            ASSERT_EQ(snapshot_find(&snap, &key) != nullptr, v == expected);
+        }
+
+        /* Links the saved nodes in place. */
+        std::vector<void *> entries(n);
+        std::vector<rcn_c::rbnode *> nodes(n);
+        rcn_c::rbtree tree;
+
+        snapshot_sorted(&snap, entries.data());
+
+        for (size_t i = 0; i < n; i++) {
+            ASSERT_EQ(((TestData *)entries[i])->value_, (int)i * 2);
+            nodes[i] = &((TestData *)entries[i])->node_;
+        }
+
+        rbtree_init(&tree, _ValueCompare);
+        rbtree_build_sorted(&tree, nodes.data(), entries.data(), n);
+        ASSERT_TRUE(rbtree_validate(&tree));
+        ASSERT_EQ(rbtree_size(&tree), n);
+
+        TestData key = { (int)n - 1, 0, {} };
+        auto x = rbtree_lower_bound(&tree, &key);
+
+        ASSERT_EQ(((TestData *)x->entry_)->value_, (int)n / 2 * 2);
+
+        snapshot_close(&snap);
+    }
+}
+
+TEST_P(SnapshotTest, RejectMismatch)
+{
+    std::vector<TestData> data(10);
+    rcn_c::snapshot snap = {};
+
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i].value_ = i;
+        rbtree_insert(&tree_, &data[i].node_, &data[i]);
+    }
+
+    ASSERT_EQ(Save(GetParam()), 0);
+    ASSERT_EQ(snapshot_open(&snap, path_.c_str(), sizeof(TestData) + 4,
+                            _ValueCompare),
+              -EINVAL);
+    ASSERT_EQ(snapshot_open(&snap, "/nonexistent/snapshot", sizeof(TestData),
+                            _ValueCompare),
+              -ENOENT);
+
+    /* Cut short : the header claims more entries than the file holds. */
+    ASSERT_EQ(truncate(path_.c_str(), SNAPSHOT_DATA_OFFSET +
+                                          5 * sizeof(TestData)),
+              0);
+    ASSERT_EQ(snapshot_open(&snap, path_.c_str(), sizeof(TestData),
+                            _ValueCompare),
+              -EINVAL);
+
+    /* A header of entries of 0 bytes, opened as such. */
+    uint64_t zero = 0;
+    FILE *z = fopen(path_.c_str(), "r+");
+
+    fseek(z, offsetof(rcn_c::snapshot_header, entry_size_), SEEK_SET);
+    fwrite(&zero, sizeof(zero), 1, z);
+    fclose(z);
+    ASSERT_EQ(snapshot_open(&snap, path_.c_str(), 0, _ValueCompare), -EINVAL);
+
+    /* Not a snapshot at all. */
+    FILE *f = fopen(path_.c_str(), "w");
+
+    fprintf(f, "%0128d", 0);
+    fclose(f);
+    ASSERT_EQ(snapshot_open(&snap, path_.c_str(), sizeof(TestData),
+                            _ValueCompare),
+              -EINVAL);
+}
+
+INSTANTIATE_TEST_SUITE_P(Layouts, SnapshotTest,
+                         ::testing::Values(rcn_c::SNAPSHOT_SORTED,
+                                           rcn_c::SNAPSHOT_EYTZINGER));
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
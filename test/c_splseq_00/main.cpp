@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rcn_c/splseq.h"
+
+/* value_ with the sum of the subtree, and a lazy "add to every value". */
+struct TestData {
+    rcn_c::splseq_node node_;
+    long value_;
+    long sum_;
+    long add_;
+};
+
+static TestData *_Data(rcn_c::splnode *x)
+{
+    return CONTAINER_OF(x, TestData, node_.node_);
+}
+
+static void _Add(rcn_c::splnode *x, long add)
+{
+    TestData *d = _Data(x);
+
+    d->value_ += add;
+    d->sum_ += add * (long)x->count_;
+    d->add_ += add;
+}
+
+static void _Update(rcn_c::splnode *x)
+{
+    TestData *d = _Data(x);
+
+    d->sum_ = d->value_;
+    d->sum_ += x->left_ != NULL ? _Data(x->left_)->sum_ : 0;
+    d->sum_ += x->right_ != NULL ? _Data(x->right_)->sum_ : 0;
+}
+
+static void _Push(rcn_c::splnode *x)
+{
+    TestData *d = _Data(x);
+
+    if (d->add_ != 0) {
+        if (x->left_ != NULL) {
+            _Add(x->left_, d->add_);
+        }
+
+        if (x->right_ != NULL) {
+            _Add(x->right_, d->add_);
+        }
+
+        d->add_ = 0;
+    }
+}
+
+static const rcn_c::spltree_augment _augment = { _Update, _Push };
+
+class SplaySequenceTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        splseq_init(&seq_, &_augment);
+    }
+
+    TestData *New(long value)
+    {
+        TestData *d = new TestData;
+
+        d->value_ = d->sum_ = value;
+        d->add_ = 0;
+        return d;
+    }
+
+    void Insert(size_t n, long value)
+    {
+        TestData *d = New(value);
+
+        ASSERT_EQ(splseq_insert(&seq_, n, &d->node_, d), 0);
+    }
+
+    void TearDown() override
+    {
+        while (!splseq_empty(&seq_)) {
+            delete (TestData *)splseq_erase(&seq_, 0);
+        }
+    }
+
+    static void _Collect(void *e, void *arg)
+    {
+        ((std::vector<long> *)arg)->push_back(((TestData *)e)->value_);
+    }
+
+    std::vector<long> Values()
+    {
+        std::vector<long> values;
+
+        splseq_for_each(&seq_, _Collect, &values);
+        return values;
+    }
+
+    static void _Sum(rcn_c::splnode *x, void *arg)
+    {
+        *(long *)arg = x == NULL ? 0 : _Data(x)->sum_;
+    }
+
+    static void _AddRange(rcn_c::splnode *x, void *arg)
+    {
+        if (x != NULL) {
+            _Add(x, *(long *)arg);
+        }
+    }
+
+    long Sum(size_t pos, size_t n)
+    {
+        long sum = -1;
+
+        EXPECT_EQ(splseq_apply(&seq_, pos, n, _Sum, &sum), 0);
+        return sum;
+    }
+
+    rcn_c::splseq seq_;
+};
+
+TEST_F(SplaySequenceTest, InitAndEmpty)
+{
+    ASSERT_TRUE(splseq_empty(&seq_));
+    ASSERT_EQ(splseq_at(&seq_, 0), nullptr);
+    ASSERT_EQ(splseq_erase(&seq_, 0), nullptr);
+    ASSERT_TRUE(splseq_validate(&seq_));
+}
+
+TEST_F(SplaySequenceTest, InsertAt)
+{
+    TestData *d = New(9);
+
+    ASSERT_EQ(splseq_insert(&seq_, 1, &d->node_, d), -EINVAL);
+    delete d;
+
+    Insert(0, 2);
+    Insert(0, 0);
+    Insert(1, 1);
+    Insert(3, 4);
+    Insert(3, 3);
+
+    ASSERT_EQ(splseq_size(&seq_), 5);
+    ASSERT_EQ(Values(), std::vector<long>({ 0, 1, 2, 3, 4 }));
+
+    for (size_t i = 0; i < 5; i++) {
+        ASSERT_EQ(((TestData *)splseq_at(&seq_, i))->value_, (long)i);
+    }
+
+    ASSERT_TRUE(splseq_validate(&seq_));
+}
+
+TEST_F(SplaySequenceTest, EraseRangeAndConcat)
+{
+    rcn_c::splseq out;
+
+    for (long i = 0; i < 10; i++) {
+        Insert(i, i);
+    }
+
+    splseq_init(&out, &_augment);
+    ASSERT_EQ(splseq_erase_range(&seq_, 8, 3, &out), -EINVAL);
+    ASSERT_EQ(splseq_erase_range(&seq_, 2, 3, &out), 0);
+    ASSERT_EQ(Values(), std::vector<long>({ 0, 1, 5, 6, 7, 8, 9 }));
+    ASSERT_EQ(splseq_size(&out), 3);
+    ASSERT_EQ(((TestData *)splseq_at(&out, 0))->value_, 2);
+
+    splseq_concat(&seq_, &out);
+    ASSERT_TRUE(splseq_empty(&out));
+    ASSERT_EQ(Values(), std::vector<long>({ 0, 1, 5, 6, 7, 8, 9, 2, 3, 4 }));
+    ASSERT_TRUE(splseq_validate(&seq_));
+}
+
+TEST_F(SplaySequenceTest, Split)
+{
+    rcn_c::splseq rest;
+
+    for (long i = 0; i < 10; i++) {
+        Insert(i, i);
+    }
+
+    splseq_init(&rest, &_augment);
+    splseq_split(&seq_, 4, &rest);
+    ASSERT_EQ(splseq_size(&seq_), 4);
+    ASSERT_EQ(splseq_size(&rest), 6);
+    ASSERT_EQ(((TestData *)splseq_at(&rest, 0))->value_, 4);
+    ASSERT_EQ(Sum(0, 4), 0 + 1 + 2 + 3);
+
+    splseq_concat(&rest, &seq_);
+    splseq_concat(&seq_, &rest);
+    ASSERT_EQ(Values(), std::vector<long>({ 4, 5, 6, 7, 8, 9, 0, 1, 2, 3 }));
+}
+
+TEST_F(SplaySequenceTest, Reverse)
+{
+    for (long i = 0; i < 8; i++) {
+        Insert(i, i);
+    }
+
+    ASSERT_EQ(splseq_reverse(&seq_, 2, 7), -EINVAL);
+    ASSERT_EQ(splseq_reverse(&seq_, 2, 4), 0);
+    ASSERT_EQ(Values(), std::vector<long>({ 0, 1, 5, 4, 3, 2, 6, 7 }));
+    ASSERT_EQ(splseq_reverse(&seq_, 0, 8), 0);
+    ASSERT_EQ(Values(), std::vector<long>({ 7, 6, 2, 3, 4, 5, 1, 0 }));
+    ASSERT_EQ(((TestData *)splseq_at(&seq_, 2))->value_, 2);
+    ASSERT_TRUE(splseq_validate(&seq_));
+}
+
+TEST_F(SplaySequenceTest, AggregateAndLazyTag)
+{
+    long add = 10;
+
+    for (long i = 0; i < 100; i++) {
+        Insert(i, i);
+    }
+
+    ASSERT_EQ(Sum(0, 100), 4950);
+    ASSERT_EQ(Sum(10, 5), 10 + 11 + 12 + 13 + 14);
+    ASSERT_EQ(Sum(10, 0), 0);
+
+    ASSERT_EQ(splseq_apply(&seq_, 50, 50, _AddRange, &add), 0);
+    ASSERT_EQ(Sum(0, 100), 4950 + 500);
+    ASSERT_EQ(Sum(45, 10), 45 + 46 + 47 + 48 + 49 + 5 * 10 + 50 + 51 + 52 +
+                               53 + 54);
+    ASSERT_EQ(((TestData *)splseq_at(&seq_, 99))->value_, 109);
+}
+
+/* Random edits checked against a vector. */
+TEST_F(SplaySequenceTest, RandomEdits)
+{
+    std::mt19937 gen(39);
+    std::vector<long> expected;
+    long next = 0;
+
+    for (int i = 0; i < 20000; i++) {
+        size_t size = expected.size();
+        size_t pos = gen() % (size + 1);
+        size_t n = gen() % (size - pos + 1);
+        rcn_c::splseq out;
+        long add;
+
+        switch (gen() % 5) {
+        case 0:
+        case 1:
+            Insert(pos, next);
+            expected.insert(expected.begin() + pos, next++);
+            break;
+        case 2:
+            n = std::min<size_t>(n, 8);
+            splseq_init(&out, &_augment);
+            ASSERT_EQ(splseq_erase_range(&seq_, pos, n, &out), 0);
+            ASSERT_EQ(splseq_size(&out), n);
+
+            while (!splseq_empty(&out)) {
+                delete (TestData *)splseq_erase(&out, 0);
+            }
+
+            expected.erase(expected.begin() + pos, expected.begin() + pos + n);
+            break;
+        case 3:
+            ASSERT_EQ(splseq_reverse(&seq_, pos, n), 0);
+            std::reverse(expected.begin() + pos, expected.begin() + pos + n);
+            break;
+        case 4:
+            add = gen() % 7;
+            ASSERT_EQ(splseq_apply(&seq_, pos, n, _AddRange, &add), 0);
+
+            for (size_t j = pos; j < pos + n; j++) {
+                expected[j] += add;
+            }
+
+            break;
+        }
+
+        if (i % 500 == 0) {
+            ASSERT_TRUE(splseq_validate(&seq_));
+            ASSERT_EQ(Values(), expected);
+        }
+
+        pos = gen() % (expected.size() + 1);
+        n = gen() % (expected.size() - pos + 1);
+        ASSERT_EQ(Sum(pos, n),
+                  std::accumulate(expected.begin() + pos,
+                                  expected.begin() + pos + n, 0L));
+    }
+
+    ASSERT_TRUE(splseq_validate(&seq_));
+    ASSERT_EQ(Values(), expected);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
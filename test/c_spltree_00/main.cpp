@@ -1,3 +1,5 @@
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "rcn_c/spltree.h"
 
@@ -328,6 +330,235 @@ TEST_F(SplayTreeTest, SplayTreeValidation)
     ASSERT_TRUE(spltree_validate(tree_));
 }
 
+TEST_F(SplayTreeTest, InsertHint)
+{
+    const int nr_entries = 1000;
+    rcn_c::splnode *hint = nullptr;
+
+    /* Ascending with the last node as the hint, then the gaps after them. */
+    for (int i = 0; i < nr_entries; i += 2) {
+        auto data = new TestData(i);
+
+        ASSERT_EQ(spltree_insert_hint(tree_, hint, &data->node_, data), 0);
+        hint = &data->node_;
+    }
+
+    for (int i = 1; i < nr_entries; i += 2) {
+        TestData key(i - 1);
+        auto data = new TestData(i);
+
+        hint = spltree_find(tree_, &key);
+        ASSERT_EQ(spltree_insert_hint(tree_, hint, &data->node_, data), 0);
+    }
+
+    /* A wrong hint falls back to a plain insert. */
+    auto data = new TestData(-1);
+    TestData dup(500);
+
+    ASSERT_EQ(spltree_insert_hint(tree_, hint, &data->node_, data), 0);
+    ASSERT_EQ(spltree_insert_hint(tree_, nullptr, &dup.node_, &dup), -EEXIST);
+    ASSERT_EQ(spltree_size(tree_), nr_entries + 1);
+    ASSERT_TRUE(spltree_validate(tree_));
+
+    int i = -1;
+
+    for (auto x = spltree_begin(tree_); x != spltree_end(tree_);
+         x = spltree_next(tree_, x)) {
+        ASSERT_EQ(((TestData *)x->entry_)->value_, i++);
+    }
+
+    ASSERT_EQ(i, nr_entries);
+}
+
+TEST_F(SplayTreeTest, InsertOrGet)
+{
+    auto data1 = new TestData(100);
+    auto data2 = new TestData(100);
+    auto data3 = new TestData(50);
+
+    ASSERT_EQ(spltree_insert_or_get(tree_, &data1->node_, data1),
+              &data1->node_);
+    ASSERT_EQ(spltree_insert_or_get(tree_, &data2->node_, data2),
+              &data1->node_);
+    ASSERT_EQ(spltree_insert_or_get(tree_, &data3->node_, data3),
+              &data3->node_);
+    ASSERT_EQ(spltree_size(tree_), 2);
+    ASSERT_TRUE(spltree_validate(tree_));
+
+    delete data2;
+}
+
+TEST_F(SplayTreeTest, Policy)
+{
+    const int nr_entries = 1024;
+    rcn_c::spltree_policy policy = { 0, 0, false };
+
+    ASSERT_EQ(spltree_set_policy(tree_, &policy), -EINVAL);
+
+    for (int i = 0; i < nr_entries; i++) {
+        auto data = new TestData(i);
+
+        spltree_insert(tree_, &data->node_, data);
+    }
+
+    /* Inserting in order left a path : 0 is at the bottom of it. */
+    TestData key(0);
+    rcn_c::splnode *root = tree_->root_;
+
+    policy.period_ = 3;
+    ASSERT_EQ(spltree_set_policy(tree_, &policy), 0);
+    ASSERT_EQ(spltree_find_const(tree_, &key), spltree_begin(tree_));
+    ASSERT_EQ(tree_->root_, root);
+    ASSERT_NE(spltree_find(tree_, &key), nullptr);
+    ASSERT_NE(spltree_find(tree_, &key), nullptr);
+    ASSERT_EQ(tree_->root_, root);
+    ASSERT_NE(spltree_find(tree_, &key), nullptr);
+    ASSERT_EQ(((TestData *)tree_->root_->entry_)->value_, 0);
+
+    /* A node is only splayed when found deeper than the threshold. */
+    unsigned int depth;
+
+    key.value_ = nr_entries / 2;
+    rcn_c::__spltree_find_depth(tree_, &key, &depth);
+    ASSERT_GT(depth, 1);
+    policy = { 1, depth, false };
+    ASSERT_EQ(spltree_set_policy(tree_, &policy), 0);
+    ASSERT_NE(spltree_find(tree_, &key), nullptr);
+    ASSERT_EQ(((TestData *)tree_->root_->entry_)->value_, 0);
+    policy.depth_ = depth - 1;
+    ASSERT_EQ(spltree_set_policy(tree_, &policy), 0);
+    ASSERT_NE(spltree_find(tree_, &key), nullptr);
+    ASSERT_EQ(((TestData *)tree_->root_->entry_)->value_, nr_entries / 2);
+
+    /* Semi-splaying a deep node at least halves its depth. */
+    policy = { 1, 0, true };
+    ASSERT_EQ(spltree_set_policy(tree_, &policy), 0);
+
+    for (int i = nr_entries - 1; i >= 0; i -= 7) {
+        unsigned int before, after;
+
+        key.value_ = i;
+        rcn_c::__spltree_find_depth(tree_, &key, &before);
+        ASSERT_NE(spltree_find(tree_, &key), nullptr);
+        rcn_c::__spltree_find_depth(tree_, &key, &after);
+        ASSERT_LE(after, before / 2 + 1);
+        ASSERT_TRUE(spltree_validate(tree_));
+    }
+
+    int i = 0;
+
+    for (auto x = spltree_begin(tree_); x != spltree_end(tree_);
+         x = spltree_next(tree_, x)) {
+        ASSERT_EQ(((TestData *)x->entry_)->value_, i++);
+    }
+
+    ASSERT_EQ(i, nr_entries);
+}
+
+TEST_F(SplayTreeTest, BuildSorted)
+{
+    for (int nr_entries = 0; nr_entries < 300; nr_entries++) {
+        std::vector<TestData *> data;
+        std::vector<rcn_c::splnode *> nodes;
+        std::vector<void *> entries;
+
+        for (int i = 0; i < nr_entries; i++) {
+            data.push_back(new TestData(i * 2));
+            nodes.push_back(&data.back()->node_);
+            entries.push_back(data.back());
+        }
+
+        spltree_build_sorted(tree_, nodes.data(), entries.data(), nr_entries);
+        ASSERT_TRUE(spltree_validate(tree_));
+        ASSERT_EQ(spltree_size(tree_), nr_entries);
+
+        /* Perfectly balanced : no key deeper than floor(log2(n)). */
+        for (int i = 0; i < nr_entries; i++) {
+            unsigned int depth;
+
+            ASSERT_EQ(rcn_c::__spltree_find_depth(tree_, data[i], &depth),
+                      &data[i]->node_);
+            ASSERT_LT(1u << depth, 2u * nr_entries);
+        }
+
+        auto extra = new TestData(-1);
+        spltree_insert(tree_, &extra->node_, extra);
+        ASSERT_EQ(spltree_at(tree_, 0), extra);
+
+        while (!spltree_empty(tree_)) {
+            delete (TestData *)spltree_pop_front(tree_);
+        }
+    }
+}
+
+/* The node first, so that a node is its entry. */
+struct SumData {
+    rcn_c::splnode node_;
+    int value_;
+    long sum_;
+};
+
+static void _SumUpdate(rcn_c::splnode *x)
+{
+    auto d = (SumData *)x;
+
+    d->sum_ = d->value_;
+
+    if (x->left_ != NULL) {
+        d->sum_ += ((SumData *)x->left_)->sum_;
+    }
+
+    if (x->right_ != NULL) {
+        d->sum_ += ((SumData *)x->right_)->sum_;
+    }
+}
+
+static int _SumCompare(const void *_ke, const void *_in_tree)
+{
+    auto ke = (const SumData *)_ke;
+    auto in_tree = (const SumData *)_in_tree;
+
+    return (ke->value_ > in_tree->value_) - (ke->value_ < in_tree->value_);
+}
+
+TEST(SplayTreeAugmentTest, BuildSorted)
+{
+    const rcn_c::spltree_augment augment = { _SumUpdate, NULL };
+    const int nr_entries = 100;
+    std::vector<SumData> data(nr_entries);
+    std::vector<rcn_c::splnode *> nodes;
+    std::vector<void *> entries;
+    rcn_c::spltree tree;
+
+    spltree_init_augmented(&tree, _SumCompare, &augment);
+
+    for (int i = 0; i < nr_entries; i++) {
+        data[i].value_ = i + 1;
+        data[i].sum_ = -1;
+        nodes.push_back(&data[i].node_);
+        entries.push_back(&data[i]);
+    }
+
+    spltree_build_sorted(&tree, nodes.data(), entries.data(), nr_entries);
+    ASSERT_TRUE(spltree_validate(&tree));
+    ASSERT_EQ(((SumData *)tree.root_)->sum_, nr_entries * (nr_entries + 1) / 2);
+
+    /* Every subtree, not just the root. */
+    for (auto &d : data) {
+        long sum = d.value_;
+
+        if (d.node_.left_ != NULL) {
+            sum += ((SumData *)d.node_.left_)->sum_;
+        }
+
+        if (d.node_.right_ != NULL) {
+            sum += ((SumData *)d.node_.right_)->sum_;
+        }
+
+        ASSERT_EQ(d.sum_, sum);
+    }
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,73 @@
+/* The spltree tests, with the operation counters kept. */
+#define SPLTREE_STATS
+
+#include <algorithm>
+
+#include "../c_spltree_00/main.cpp"
+
+TEST_F(SplayTreeTest, Stats)
+{
+    const int nr_entries = 100;
+    std::vector<TestData *> data;
+    auto stats = spltree_stats(tree_);
+
+    /* In order, each insert splays the new node up from the right child. */
+    for (int i = 0; i < nr_entries; i++) {
+        data.push_back(new TestData(i));
+        ASSERT_EQ(spltree_insert(tree_, &data.back()->node_, data.back()), 0);
+    }
+
+    ASSERT_EQ(stats->nr_inserts_, nr_entries);
+    ASSERT_EQ(stats->nr_insert_compars_, nr_entries - 1);
+    ASSERT_EQ(stats->nr_rotations_, nr_entries - 1);
+    ASSERT_EQ(stats->nr_fixups_, nr_entries - 1);
+
+    /* Down the left path to the smallest, which a splay brings to the top. */
+    spltree_stats_reset(tree_);
+    ASSERT_EQ(spltree_find(tree_, data[0])->entry_, data[0]);
+    ASSERT_EQ(stats->nr_finds_, 1);
+    ASSERT_EQ(stats->nr_find_compars_, nr_entries);
+    ASSERT_EQ(stats->nr_fixups_, nr_entries / 2);
+    ASSERT_EQ(stats->nr_rotations_, nr_entries - 1);
+    ASSERT_EQ(tree_->root_, &data[0]->node_);
+
+    spltree_stats_reset(tree_);
+    ASSERT_EQ(spltree_find_const(tree_, data[0])->entry_, data[0]);
+    ASSERT_EQ(stats->nr_find_compars_, 1);
+    spltree_lower_bound(tree_, data[1]);
+    spltree_upper_bound(tree_, data[1]);
+    ASSERT_EQ(stats->nr_finds_, 3);
+    ASSERT_GE(stats->nr_find_compars_, 1 + 2 + 2);
+    ASSERT_EQ(stats->nr_rotations_, 0);
+
+    /* The lookup erase checks its node with is not counted. */
+    spltree_stats_reset(tree_);
+    ASSERT_EQ(spltree_erase(tree_, &data[0]->node_), data[0]);
+    delete data[0];
+    ASSERT_EQ(stats->nr_erases_, 1);
+    ASSERT_EQ(stats->nr_finds_, 0);
+    ASSERT_EQ(stats->nr_find_compars_, 0);
+}
+
+TEST_F(SplayTreeTest, DepthHistogram)
+{
+    const int nr_entries = 100;
+    size_t hist[128];
+
+    ASSERT_EQ(spltree_depth_histogram(tree_, hist, 128), 0);
+    ASSERT_EQ(std::count(hist, hist + 128, 0), 128);
+
+    /* In order, the tree ends up a path down the left. */
+    for (int i = 0; i < nr_entries; i++) {
+        auto data = new TestData(i);
+
+        spltree_insert(tree_, &data->node_, data);
+    }
+
+    ASSERT_EQ(spltree_depth_histogram(tree_, hist, 128), nr_entries);
+    ASSERT_EQ(std::count(hist, hist + nr_entries, 1), nr_entries);
+    ASSERT_EQ(std::count(hist + nr_entries, hist + 128, 0), 128 - nr_entries);
+
+    ASSERT_EQ(spltree_depth_histogram(tree_, hist, 10), nr_entries);
+    ASSERT_EQ(hist[9], nr_entries - 9);
+}
@@ -0,0 +1,78 @@
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "rcn_c/tree_stats.h"
+
+TEST(TreeStatsTest, Format)
+{
+    rcn_c::tree_stats stats;
+    const size_t hist[] = { 1, 2, 3, 5 };
+    char buf[2048];
+
+    tree_stats_reset(&stats);
+    stats.nr_finds_ = 3;
+    stats.nr_find_compars_ = 12345678901ULL;
+
+    int len =
+        rcn_c::tree_stats_format(buf, sizeof(buf), "users", &stats, hist, 4);
+    std::string text(buf);
+
+    ASSERT_EQ(len, (int)text.size());
+    EXPECT_NE(text.find("rcn_tree_finds_total{tree=\"users\"} 3\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("rcn_tree_find_compars_total{tree=\"users\"} "
+                        "12345678901\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("rcn_tree_rotations_total{tree=\"users\"} 0\n"),
+              std::string::npos);
+
+    /* Cumulative, the last bucket counted as depth 3. */
+    EXPECT_NE(text.find("rcn_tree_depth_bucket{tree=\"users\",le=\"0\"} 1\n"
+                        "rcn_tree_depth_bucket{tree=\"users\",le=\"1\"} 3\n"
+                        "rcn_tree_depth_bucket{tree=\"users\",le=\"2\"} 6\n"
+                        "rcn_tree_depth_bucket{tree=\"users\",le=\"+Inf\"} "
+                        "11\n"
+                        "rcn_tree_depth_sum{tree=\"users\"} 23\n"
+                        "rcn_tree_depth_count{tree=\"users\"} 11\n"
+                        "rcn_tree_depth_max{tree=\"users\"} 3\n"),
+              std::string::npos);
+}
+
+TEST(TreeStatsTest, FormatPart)
+{
+    rcn_c::tree_stats stats;
+    const size_t hist[] = { 1 };
+    char buf[2048], small[16];
+
+    tree_stats_reset(&stats);
+
+    /* Counters only, or the histogram only. */
+    rcn_c::tree_stats_format(buf, sizeof(buf), "t", &stats, NULL, 0);
+    EXPECT_EQ(strstr(buf, "depth"), nullptr);
+    EXPECT_NE(strstr(buf, "rcn_tree_erases_total{tree=\"t\"} 0\n"), nullptr);
+
+    rcn_c::tree_stats_format(buf, sizeof(buf), "t", NULL, hist, 1);
+    EXPECT_EQ(strstr(buf, "_total"), nullptr);
+    EXPECT_EQ(std::string(buf),
+              "rcn_tree_depth_bucket{tree=\"t\",le=\"+Inf\"} 1\n"
+              "rcn_tree_depth_sum{tree=\"t\"} 0\n"
+              "rcn_tree_depth_count{tree=\"t\"} 1\n"
+              "rcn_tree_depth_max{tree=\"t\"} 0\n");
+
+    /* Cut short as snprintf() does, the full length returned. */
+    int len = rcn_c::tree_stats_format(buf, sizeof(buf), "t", &stats, hist, 1);
+
+    ASSERT_EQ(rcn_c::tree_stats_format(small, sizeof(small), "t", &stats, hist,
+                                       1),
+              len);
+    ASSERT_EQ(strlen(small), sizeof(small) - 1);
+    ASSERT_EQ(strncmp(small, buf, sizeof(small) - 1), 0);
+    ASSERT_EQ(rcn_c::tree_stats_format(NULL, 0, "t", &stats, hist, 1), len);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}